@@ -0,0 +1,384 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#include "benchmark.h"
+#include "utils/Encoders.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+using namespace benchmarks;
+
+namespace {
+
+// xorshift64* - fast and the same everywhere (unlike rand())
+class Random {
+public:
+  Random(unsigned __int64 seed) : state_(seed) {
+  }
+
+  unsigned __int64 Next() {
+    state_ ^= state_ >> 12;
+    state_ ^= state_ << 25;
+    state_ ^= state_ >> 27;
+    return state_ * 2685821657736338717ULL;
+  }
+
+  // [0, range)
+  size_t Below(size_t range) {
+    return (size_t)(Next() % range);
+  }
+
+private:
+  unsigned __int64 state_;
+};
+
+size_t NextLineLength(Random& random, LineLengths lengths) {
+  switch (lengths) {
+  case LINES_SHORT:
+    return 20 + random.Below(40);
+  case LINES_LONG:
+    return 3072 + random.Below(2048);
+  case LINES_MIXED:
+  default:
+    // 1 in 64 lines is a long one
+    if (0 == random.Below(64)) {
+      return 1024 + random.Below(8192);
+    }
+    return 40 + random.Below(120);
+  }
+}
+
+double Percentile(const std::vector<double>& sorted, double percentile) {
+  size_t index = (size_t)(percentile * (sorted.size() - 1) + 0.5);
+  return sorted[index];
+}
+
+void AppendNumber(const char* name, double value, std::string& ref_output) {
+  char buffer[64];
+  sprintf(buffer, ",\"%s\":%.6g", name, value);
+  ref_output += buffer;
+}
+
+void AppendInteger(
+  const char* name, 
+  unsigned __int64 value, 
+  std::string& ref_output) {
+  char buffer[64];
+  sprintf(buffer, ",\"%s\":%.0f", name, (double)value);
+  ref_output += buffer;
+}
+
+// see |DoNotOptimize|
+const void* volatile sink = nullptr;
+
+}; // namespace
+
+//-----------------------------------------------------------------------------
+Stopwatch::Stopwatch() {
+  Restart();
+}
+
+void Stopwatch::Restart() {
+  start_ = Now();
+}
+
+double Stopwatch::Elapsed() const {
+  return Now() - start_;
+}
+
+// static
+double Stopwatch::Now() {
+#ifdef _WIN32
+  static LARGE_INTEGER frequency = { 0 };
+  if (0 == frequency.QuadPart) {
+    QueryPerformanceFrequency(&frequency);
+  }
+
+  LARGE_INTEGER now;
+  QueryPerformanceCounter(&now);
+  return (double)now.QuadPart / (double)frequency.QuadPart;
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+Result::Result() :
+  seconds(0),
+  bytes(0),
+  items(0) {
+}
+
+//-----------------------------------------------------------------------------
+Runner::Runner() : quick_(false) {
+}
+
+void Runner::Add(const char* name, BenchmarkFunc func) {
+  Entry entry;
+  entry.name = name;
+  entry.func = func;
+  entries_.push_back(entry);
+}
+
+int Runner::Run(const std::string& filter) {
+  int count = 0;
+
+  std::vector<Entry>::const_iterator iter = entries_.begin();
+  for (; iter != entries_.end(); ++iter) {
+    if (!filter.empty() && (std::string::npos == iter->name.find(filter))) {
+      continue;
+    }
+
+    fprintf(stderr, "running %s...\n", iter->name.c_str());
+    iter->func(*this);
+    count++;
+  }
+
+  return count;
+}
+
+void Runner::Report(Result& result) {
+  std::string line("{\"benchmark\":");
+  utils::Encoders::json_append_string(
+    result.benchmark.c_str(), 
+    result.benchmark.size(), 
+    line);
+  line += ",\"variant\":";
+  utils::Encoders::json_append_string(
+    result.variant.c_str(), 
+    result.variant.size(), 
+    line);
+
+  AppendNumber("seconds", result.seconds, line);
+
+  if (0 != result.bytes) {
+    AppendInteger("bytes", result.bytes, line);
+  }
+  if (0 != result.items) {
+    AppendInteger("items", result.items, line);
+  }
+
+  if (result.seconds > 0) {
+    if (0 != result.bytes) {
+      AppendNumber(
+        "mb_per_s", 
+        (double)result.bytes / (1024.0 * 1024.0) / result.seconds, 
+        line);
+    }
+    if (0 != result.items) {
+      AppendNumber("items_per_s", (double)result.items / result.seconds, line);
+    }
+  }
+
+  if (!result.latencies_us.empty()) {
+    std::sort(result.latencies_us.begin(), result.latencies_us.end());
+    AppendNumber("p50_us", Percentile(result.latencies_us, 0.50), line);
+    AppendNumber("p99_us", Percentile(result.latencies_us, 0.99), line);
+    AppendNumber("max_us", result.latencies_us.back(), line);
+  }
+
+  for (size_t i = 0; i < result.metrics.size(); i++) {
+    AppendNumber(result.metrics[i].first.c_str(), result.metrics[i].second, 
+                 line);
+  }
+
+  line += "}\n";
+  fputs(line.c_str(), stdout);
+  fflush(stdout);
+}
+
+void Runner::set_quick(bool quick) {
+  quick_ = quick;
+}
+
+bool Runner::quick() const {
+  return quick_;
+}
+
+size_t Runner::Scale(size_t full) const {
+  return quick_ ? (full / 8) : full;
+}
+
+int Runner::repetitions() const {
+  return quick_ ? 1 : 5;
+}
+
+//-----------------------------------------------------------------------------
+const char* benchmarks::LineLengthsName(LineLengths lengths) {
+  switch (lengths) {
+  case LINES_SHORT:
+    return "short";
+  case LINES_LONG:
+    return "long";
+  case LINES_MIXED:
+  default:
+    return "mixed";
+  }
+}
+
+std::string benchmarks::GenerateLines(
+  size_t bytes, 
+  LineLengths lengths, 
+  bool crlf, 
+  size_t& ref_line_count) {
+
+  static const char kAlphabet[] = 
+    "abcdefghijklmnopqrstuvwxyz ABCDEFGHIJKLMNOPQRSTUVWXYZ 0123456789 "
+    ":;,.[]{}()=-_/\\\"'";
+
+  Random random(0x5EED0000 + lengths);
+
+  std::string output;
+  output.reserve(bytes + 16 * 1024);
+  ref_line_count = 0;
+
+  while (output.size() < bytes) {
+    size_t length = NextLineLength(random, lengths);
+    for (size_t i = 0; i < length; i++) {
+      output += kAlphabet[random.Below(sizeof(kAlphabet) - 1)];
+    }
+
+    if (crlf) {
+      output += '\r';
+    }
+    output += '\n';
+    ref_line_count++;
+  }
+
+  return output;
+}
+
+std::string benchmarks::GenerateText(size_t bytes, bool ascii_only) {
+  // a word per script - lengths in bytes are 1, 2, 3 and 4 per character
+  static const char* kWords[] = {
+    "simple ",
+    "io ",
+    "plugin ",
+    "caf\xc3\xa9 ",
+    "\xd0\xbf\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82 ",
+    "\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e ",
+    "\xf0\x9f\x8e\xae ",
+    "line\n"
+  };
+  const size_t kAsciiWords = 3;
+  const size_t kWordsCount = sizeof(kWords) / sizeof(kWords[0]);
+
+  Random random(ascii_only ? 0xA5C11 : 0x0DE);
+
+  std::string output;
+  output.reserve(bytes + 16);
+
+  while (output.size() < bytes) {
+    size_t word = random.Below(ascii_only ? kAsciiWords : kWordsCount);
+    output += kWords[word];
+  }
+
+  return output;
+}
+
+std::string benchmarks::GenerateBytes(size_t bytes) {
+  Random random(0xB17E5);
+
+  std::string output(bytes, '\0');
+  for (size_t i = 0; i < bytes; i++) {
+    output[i] = (char)random.Next();
+  }
+
+  return output;
+}
+
+//-----------------------------------------------------------------------------
+TempFile::TempFile(const std::string& content) : valid_(false) {
+  static unsigned int counter = 0;
+
+  char name[64];
+  sprintf(name, "simpleio_bench_%u_%u.tmp", (unsigned int)time(nullptr), 
+          counter++);
+
+#ifdef _WIN32
+  wchar_t temp_path[MAX_PATH + 1];
+  if (0 == GetTempPathW(MAX_PATH + 1, temp_path)) {
+    return;
+  }
+
+  path_ = temp_path;
+  path_ += utils::Encoders::utf8_decode(name);
+
+  FILE* file = _wfopen(path_.c_str(), L"wb");
+#else
+  const char* temp_path = getenv("TMPDIR");
+  std::string narrow_path((nullptr != temp_path) ? temp_path : "/tmp");
+  narrow_path += '/';
+  narrow_path += name;
+
+  path_ = utils::Encoders::utf8_decode(narrow_path);
+
+  FILE* file = fopen(narrow_path.c_str(), "wb");
+#endif
+
+  if (nullptr == file) {
+    return;
+  }
+
+  valid_ = 
+    (content.empty() || 
+     (1 == fwrite(content.c_str(), content.size(), 1, file)));
+  fclose(file);
+}
+
+TempFile::~TempFile() {
+#ifdef _WIN32
+  _wunlink(path_.c_str());
+#else
+  unlink(utils::Encoders::utf8_encode(path_).c_str());
+#endif
+}
+
+bool TempFile::valid() const {
+  return valid_;
+}
+
+const std::wstring& TempFile::path() const {
+  return path_;
+}
+
+//-----------------------------------------------------------------------------
+void benchmarks::DoNotOptimize(const void* value) {
+  sink = value;
+}
+
+double benchmarks::ThreadCpuSeconds() {
+#ifdef _WIN32
+  FILETIME creation_time, exit_time, kernel_time, user_time;
+  if (!GetThreadTimes(
+    GetCurrentThread(), 
+    &creation_time, 
+    &exit_time, 
+    &kernel_time, 
+    &user_time)) {
+    return 0;
+  }
+
+  // 100ns units
+  ULARGE_INTEGER kernel, user;
+  kernel.LowPart = kernel_time.dwLowDateTime;
+  kernel.HighPart = kernel_time.dwHighDateTime;
+  user.LowPart = user_time.dwLowDateTime;
+  user.HighPart = user_time.dwHighDateTime;
+  return (double)(kernel.QuadPart + user.QuadPart) / 1e7;
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+  return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,139 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef BENCHMARKS_BENCHMARK_H_
+#define BENCHMARKS_BENCHMARK_H_
+
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "utils/Platform.h"
+
+namespace benchmarks {
+
+// Wall clock time in seconds (QueryPerformanceCounter / CLOCK_MONOTONIC)
+class Stopwatch {
+public:
+  Stopwatch();
+
+public:
+  void Restart();
+  double Elapsed() const;
+
+  static double Now();
+
+private:
+  double start_;
+};
+
+struct Result {
+  Result();
+
+  std::string benchmark;
+  std::string variant;
+  double seconds; // best of the repetitions
+  unsigned __int64 bytes; // processed per repetition (0 = n/a)
+  unsigned __int64 items; // lines/tasks/calls per repetition (0 = n/a)
+
+  // per item latencies (microseconds) - left empty when not measured
+  std::vector<double> latencies_us;
+
+  // anything else worth diffing (e.g. memory), appended as is
+  std::vector<std::pair<std::string, double> > metrics;
+};
+
+// Runs the registered benchmarks and prints every result as a single line 
+// JSON object (JSON lines) to stdout, e.g.:
+//
+// {"benchmark":"parse_lines","variant":"mixed_crlf","seconds":0.0412,
+//  "bytes":67108864,"items":838861,"mb_per_s":1553.4,"items_per_s":20360703}
+//
+// Latency benchmarks add "p50_us", "p99_us" and "max_us".
+class Runner {
+public:
+  typedef std::function<void(Runner& runner)> BenchmarkFunc;
+
+  Runner();
+
+public:
+  void Add(const char* name, BenchmarkFunc func);
+
+  // runs the benchmarks whose name contains |filter| (all when empty)
+  int Run(const std::string& filter);
+
+  void Report(Result& result);
+
+  // --quick: smaller inputs and a single repetition (smoke runs)
+  void set_quick(bool quick);
+  bool quick() const;
+
+  // |full| normally, |full| / 8 for quick runs
+  size_t Scale(size_t full) const;
+  int repetitions() const;
+
+private:
+  struct Entry {
+    std::string name;
+    BenchmarkFunc func;
+  };
+
+  std::vector<Entry> entries_;
+  bool quick_;
+};
+
+// Synthetic inputs - deterministic, so runs can be compared
+enum LineLengths {
+  LINES_SHORT = 0, // ~40 bytes, like a terse game log
+  LINES_MIXED, // mostly ~100 bytes with a tail of multi KB lines (stacks)
+  LINES_LONG // ~4KB, e.g. JSON payloads
+};
+
+const char* LineLengthsName(LineLengths lengths);
+
+// |bytes| (roughly) of printable ASCII lines. Every line is terminated.
+std::string GenerateLines(
+  size_t bytes, 
+  LineLengths lengths, 
+  bool crlf, 
+  size_t& ref_line_count);
+
+// |bytes| (roughly) of UTF8 text - ASCII only or a mix of ASCII, Latin,
+// Cyrillic, CJK and emoji (non BMP)
+std::string GenerateText(size_t bytes, bool ascii_only);
+
+// |bytes| of random binary data
+std::string GenerateBytes(size_t bytes);
+
+// A file in the temp directory, removed on destruction
+class TempFile {
+public:
+  TempFile(const std::string& content);
+  ~TempFile();
+
+public:
+  bool valid() const;
+  const std::wstring& path() const;
+
+private:
+  std::wstring path_;
+  bool valid_;
+};
+
+// keeps the optimizer from dropping work whose result is unused
+void DoNotOptimize(const void* value);
+
+// CPU time (user + kernel, in seconds) used so far by the calling thread
+double ThreadCpuSeconds();
+
+// the benchmark groups (see benchmark_main.cpp)
+void RegisterTxtFileStreamBenchmarks(Runner& runner);
+void RegisterFileBenchmarks(Runner& runner);
+void RegisterEncodersBenchmarks(Runner& runner);
+void RegisterThreadBenchmarks(Runner& runner);
+void RegisterListenerBenchmarks(Runner& runner);
+
+}; // namespace benchmarks
+
+#endif // BENCHMARKS_BENCHMARK_H_
\ No newline at end of file
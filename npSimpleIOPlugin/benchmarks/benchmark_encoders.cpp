@@ -0,0 +1,89 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#include "benchmark.h"
+#include "utils/Encoders.h"
+
+using namespace benchmarks;
+
+namespace {
+
+// runs |func| |runner.repetitions()| times and reports the fastest run
+template<typename Func>
+void Measure(
+  Runner& runner, 
+  const char* benchmark, 
+  const char* variant,
+  size_t bytes,
+  Func func) {
+
+  Result result;
+  result.benchmark = benchmark;
+  result.variant = variant;
+  result.bytes = bytes;
+
+  for (int repetition = 0; repetition < runner.repetitions(); repetition++) {
+    Stopwatch stopwatch;
+    func();
+    double seconds = stopwatch.Elapsed();
+
+    if ((0 == repetition) || (seconds < result.seconds)) {
+      result.seconds = seconds;
+    }
+  }
+
+  runner.Report(result);
+}
+
+void BenchmarkEncoders(Runner& runner) {
+  for (int ascii_only = 1; ascii_only >= 0; ascii_only--) {
+    const char* variant = ascii_only ? "ascii" : "mixed";
+
+    std::string utf8 = GenerateText(runner.Scale(16 * 1024 * 1024), 
+                                    (0 != ascii_only));
+    std::wstring wide = utils::Encoders::utf8_decode(utf8);
+
+    // throughput is always in UTF8 bytes so the numbers compare
+    Measure(runner, "utf8_decode", variant, utf8.size(), [&]() {
+      std::wstring output = utils::Encoders::utf8_decode(utf8);
+      DoNotOptimize(output.c_str());
+    });
+
+    Measure(runner, "utf8_encode", variant, utf8.size(), [&]() {
+      std::string output = utils::Encoders::utf8_encode(wide);
+      DoNotOptimize(output.c_str());
+    });
+
+    // the listener's UTF-16 path - converted in read sized chunks
+    Measure(runner, "utf16_append_utf8", variant, utf8.size(), [&]() {
+      const size_t kChunk = 1024 * 1024;
+      std::string output;
+      for (size_t offset = 0; offset < wide.size(); ) {
+        size_t len = wide.size() - offset;
+        if (len > kChunk) {
+          len = kChunk;
+        }
+        size_t consumed = utils::Encoders::utf16_append_utf8(
+          wide.c_str() + offset, 
+          len, 
+          output);
+        offset += (0 == consumed) ? len : consumed;
+        output.clear();
+      }
+      DoNotOptimize(output.c_str());
+    });
+
+    Measure(runner, "json_append_string", variant, utf8.size(), [&]() {
+      std::string output;
+      utils::Encoders::json_append_string(utf8.c_str(), utf8.size(), output);
+      DoNotOptimize(output.c_str());
+    });
+  }
+}
+
+}; // namespace
+
+void benchmarks::RegisterEncodersBenchmarks(Runner& runner) {
+  runner.Add("encoders", BenchmarkEncoders);
+}
\ No newline at end of file
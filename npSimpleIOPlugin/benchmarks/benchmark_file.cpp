@@ -0,0 +1,107 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#include "benchmark.h"
+#include "utils/Encoders.h"
+
+#include <stdio.h>
+
+#ifdef _WIN32
+#include "utils/File.h"
+#endif
+
+using namespace benchmarks;
+
+namespace {
+
+const size_t kFileSizes[] = { 
+  64 * 1024, 
+  1024 * 1024, 
+  16 * 1024 * 1024, 
+  64 * 1024 * 1024 
+};
+const size_t kFileSizesCount = sizeof(kFileSizes) / sizeof(kFileSizes[0]);
+
+std::string SizeName(size_t size) {
+  char buffer[32];
+  if (size >= 1024 * 1024) {
+    sprintf(buffer, "%uMB", (unsigned int)(size / (1024 * 1024)));
+  } else {
+    sprintf(buffer, "%uKB", (unsigned int)(size / 1024));
+  }
+
+  return buffer;
+}
+
+#ifdef _WIN32
+// File::GetTextFile (copies the file aside and reads it in one go)
+void BenchmarkGetTextFile(Runner& runner) {
+  for (size_t i = 0; i < kFileSizesCount; i++) {
+    size_t line_count;
+    size_t size = runner.Scale(kFileSizes[i]);
+    TempFile file(GenerateLines(size, LINES_MIXED, true, line_count));
+    if (!file.valid()) {
+      continue;
+    }
+
+    Result result;
+    result.benchmark = "get_text_file";
+    result.variant = SizeName(kFileSizes[i]);
+
+    for (int repetition = 0; repetition < runner.repetitions(); 
+         repetition++) {
+      std::string output;
+      Stopwatch stopwatch;
+      if (!utils::File::GetTextFile(file.path(), output, 0)) {
+        break;
+      }
+      double seconds = stopwatch.Elapsed();
+
+      result.bytes = output.size();
+      if ((0 == repetition) || (seconds < result.seconds)) {
+        result.seconds = seconds;
+      }
+    }
+
+    if (0 != result.bytes) {
+      runner.Report(result);
+    }
+  }
+}
+#endif // _WIN32
+
+// the "1,2,-3,..." conversion getBinaryFile does on the worker thread
+void BenchmarkGetBinaryFileEncode(Runner& runner) {
+  for (size_t i = 0; i < kFileSizesCount - 1; i++) {
+    std::string data = GenerateBytes(runner.Scale(kFileSizes[i]));
+
+    Result result;
+    result.benchmark = "get_binary_file_encode";
+    result.variant = SizeName(kFileSizes[i]);
+    result.bytes = data.size();
+
+    for (int repetition = 0; repetition < runner.repetitions(); 
+         repetition++) {
+      Stopwatch stopwatch;
+      std::string output = utils::Encoders::byte_list_encode(data);
+      double seconds = stopwatch.Elapsed();
+      DoNotOptimize(output.c_str());
+
+      if ((0 == repetition) || (seconds < result.seconds)) {
+        result.seconds = seconds;
+      }
+    }
+
+    runner.Report(result);
+  }
+}
+
+}; // namespace
+
+void benchmarks::RegisterFileBenchmarks(Runner& runner) {
+#ifdef _WIN32
+  runner.Add("get_text_file", BenchmarkGetTextFile);
+#endif
+  runner.Add("get_binary_file_encode", BenchmarkGetBinaryFileEncode);
+}
\ No newline at end of file
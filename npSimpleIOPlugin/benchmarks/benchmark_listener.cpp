@@ -0,0 +1,371 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#include "benchmark.h"
+#include "log_writer.h"
+#include "utils/BufferPool.h"
+#include "utils/Clock.h"
+#include "utils/Event.h"
+#include "utils/Thread.h"
+#include "utils/TxtFileStream.h"
+
+using namespace benchmarks;
+
+namespace {
+
+// how long the listener gets to catch up once the writer is done
+const DWORD kDrainTimeout = 2000;
+
+// checks every line against what |LogWriter| wrote and measures its lag 
+// (written -> |OnNewLine|)
+class LagDelegate : public utils::TxtFileStreamDelegate {
+public:
+  LagDelegate(size_t expected_lines, utils::Event& done) :
+    expected_lines_(expected_lines),
+    done_(done),
+    lines_(0),
+    corrupt_lines_(0),
+    missing_lines_(0),
+    next_sequence_(0),
+    errors_(0),
+    stopping_(false),
+    last_line_time_(0) {
+    lags_us_.reserve(expected_lines);
+  }
+
+  virtual void OnNewLine(const char* line, unsigned int len) {
+    unsigned __int64 now_us = utils::Clock::NowMicroseconds();
+    last_line_time_ = Stopwatch::Now();
+    lines_++;
+
+    unsigned __int64 sequence = 0;
+    unsigned __int64 time_us = 0;
+    if (!LogWriter::ParseLine(line, len, sequence, time_us)) {
+      corrupt_lines_++;
+      return;
+    }
+
+    lags_us_.push_back((double)(now_us - time_us));
+
+    if (sequence > next_sequence_) {
+      missing_lines_ += (size_t)(sequence - next_sequence_);
+    }
+    next_sequence_ = sequence + 1;
+
+    if (sequence + 1 == expected_lines_) {
+      done_.Signal();
+    }
+  }
+
+  // anything but our own |StopListening| means the listener gave up (e.g. 
+  // on truncation) - no point waiting for more lines
+  virtual void OnError(const char* /*message*/, unsigned int /*len*/) {
+    if (!stopping_) {
+      errors_++;
+      done_.Signal();
+    }
+  }
+
+  void set_stopping() {
+    stopping_ = true;
+  }
+
+  size_t lines() const {
+    return lines_;
+  }
+
+  size_t corrupt_lines() const {
+    return corrupt_lines_;
+  }
+
+  // lines skipped over plus the ones after the last we got
+  size_t lost_lines(size_t lines_written) const {
+    size_t tail = (lines_written > next_sequence_) ? 
+      (size_t)(lines_written - next_sequence_) : 0;
+    return missing_lines_ + tail;
+  }
+
+  size_t errors() const {
+    return errors_;
+  }
+
+  double last_line_time() const {
+    return last_line_time_;
+  }
+
+  std::vector<double>& lags_us() {
+    return lags_us_;
+  }
+
+private:
+  size_t expected_lines_;
+  utils::Event& done_;
+
+  size_t lines_;
+  size_t corrupt_lines_;
+  size_t missing_lines_;
+  unsigned __int64 next_sequence_;
+  size_t errors_;
+  volatile bool stopping_;
+  double last_line_time_;
+
+  std::vector<double> lags_us_;
+};
+
+struct Scenario {
+  const char* variant;
+  LogWriter::Pattern pattern;
+};
+
+void RunScenario(Runner& runner, const Scenario& scenario) {
+  TempFile file("");
+  utils::Thread listener;
+  utils::Event done;
+  utils::Event exited;
+  if (!file.valid() || !listener.Start() || !done.Create(true, false) || 
+      !exited.Create(true, false)) {
+    return;
+  }
+
+  LagDelegate delegate(scenario.pattern.total_lines, done);
+  utils::TxtFileStream stream;
+  if (!stream.Initialize(file.path().c_str(), &delegate)) {
+    return;
+  }
+
+  double cpu_seconds = 0;
+  listener.PostTask([&stream, &exited, &cpu_seconds]() {
+    double cpu_start = ThreadCpuSeconds();
+    stream.StartListening();
+    cpu_seconds = ThreadCpuSeconds() - cpu_start;
+    exited.Signal();
+  });
+
+  LogWriter writer;
+  if (!writer.Start(file.path(), scenario.pattern)) {
+    fprintf(stderr, "listener/%s: failed to start the writer\n", 
+            scenario.variant);
+    delegate.set_stopping();
+    stream.StopListening();
+    exited.Wait();
+    return;
+  }
+
+  writer.Wait();
+  done.Wait(kDrainTimeout);
+
+  delegate.set_stopping();
+  stream.StopListening();
+  exited.Wait();
+  listener.Stop();
+
+  size_t lines_written = writer.lines_written();
+
+  Result result;
+  result.benchmark = "listener";
+  result.variant = scenario.variant;
+  result.items = delegate.lines();
+  result.bytes = writer.bytes_written();
+  result.seconds = (delegate.lines() > 0) ? 
+    delegate.last_line_time() - writer.first_write_time() : 0;
+  result.latencies_us.swap(delegate.lags_us());
+
+  result.metrics.push_back(
+    std::make_pair("lines_written", (double)lines_written));
+  result.metrics.push_back(
+    std::make_pair("lost_lines", (double)delegate.lost_lines(lines_written)));
+  result.metrics.push_back(
+    std::make_pair("corrupt_lines", (double)delegate.corrupt_lines()));
+  result.metrics.push_back(
+    std::make_pair("errors", (double)delegate.errors()));
+  result.metrics.push_back(
+    std::make_pair("cpu_us_per_line", (delegate.lines() > 0) ? 
+      cpu_seconds * 1e6 / delegate.lines() : 0));
+
+  runner.Report(result);
+}
+
+// A log written at a given pace while |TxtFileStream| listens on it - the 
+// sustained lines/s, the lag of every line (p50/p99/max_us), the listener's 
+// CPU time per line and the lines lost on the way. Runs for a fixed time, so
+// --quick shortens it instead of scaling it.
+void BenchmarkListener(Runner& runner) {
+  size_t seconds = runner.quick() ? 1 : 5;
+
+  std::vector<Scenario> scenarios;
+  Scenario scenario;
+
+  scenario.variant = "steady_1k_lf";
+  scenario.pattern = LogWriter::Pattern();
+  scenario.pattern.lines_per_second = 1000;
+  scenario.pattern.total_lines = 1000 * seconds;
+  scenarios.push_back(scenario);
+
+  scenario.variant = "steady_10k_crlf";
+  scenario.pattern = LogWriter::Pattern();
+  scenario.pattern.lines_per_second = 10000;
+  scenario.pattern.total_lines = 10000 * seconds;
+  scenario.pattern.crlf = true;
+  scenarios.push_back(scenario);
+
+  // 5K lines/s in bursts of 500 - the max lag is the one to watch
+  scenario.variant = "bursts_5k";
+  scenario.pattern = LogWriter::Pattern();
+  scenario.pattern.lines_per_second = 5000;
+  scenario.pattern.burst_lines = 500;
+  scenario.pattern.total_lines = 5000 * seconds;
+  scenarios.push_back(scenario);
+
+  // as fast as the disk takes it - the listener's ceiling
+  scenario.variant = "flood";
+  scenario.pattern = LogWriter::Pattern();
+  scenario.pattern.lines_per_second = 0;
+  scenario.pattern.burst_lines = 1000;
+  scenario.pattern.lengths = LINES_SHORT;
+  scenario.pattern.total_lines = runner.Scale(1000000);
+  scenarios.push_back(scenario);
+
+  scenario.variant = "partial_writes";
+  scenario.pattern = LogWriter::Pattern();
+  scenario.pattern.lines_per_second = 1000;
+  scenario.pattern.partial_writes = true;
+  scenario.pattern.total_lines = 1000 * seconds;
+  scenarios.push_back(scenario);
+
+  scenario.variant = "long_lines";
+  scenario.pattern = LogWriter::Pattern();
+  scenario.pattern.lines_per_second = 1000;
+  scenario.pattern.lengths = LINES_LONG;
+  scenario.pattern.total_lines = 1000 * seconds;
+  scenarios.push_back(scenario);
+
+  // the listener is expected to report an error and lose the rest
+  scenario.variant = "truncate";
+  scenario.pattern = LogWriter::Pattern();
+  scenario.pattern.lines_per_second = 1000;
+  scenario.pattern.total_lines = 1000 * seconds;
+  scenario.pattern.truncate_at = scenario.pattern.total_lines / 2;
+  scenarios.push_back(scenario);
+
+  scenario.variant = "rotate";
+  scenario.pattern = LogWriter::Pattern();
+  scenario.pattern.lines_per_second = 1000;
+  scenario.pattern.total_lines = 1000 * seconds;
+  scenario.pattern.rotate_at = scenario.pattern.total_lines / 2;
+  scenarios.push_back(scenario);
+
+  for (size_t i = 0; i < scenarios.size(); i++) {
+    RunScenario(runner, scenarios[i]);
+  }
+}
+
+// A dozen listeners on slow logs (10 lines/s each) - the read buffers they
+// hold once settled, then every listener restarted over and over (e.g. a
+// widget reloading) - the heap allocations the restarts cost.
+void BenchmarkListenerBuffers(Runner& runner) {
+  const size_t kListeners = 12;
+  const double kLinesPerSecond = 10;
+  size_t seconds = runner.quick() ? 1 : 3;
+  size_t restarts = runner.Scale(400);
+
+  struct Listener {
+    Listener() : file(""), done(), delegate(0, done) {
+    }
+
+    TempFile file;
+    utils::Thread thread;
+    utils::Event done;
+    utils::Event exited;
+    LagDelegate delegate;
+    utils::TxtFileStream stream;
+    LogWriter writer;
+  };
+
+  auto start = [](Listener& listener) -> bool {
+    if (!listener.stream.Initialize(listener.file.path().c_str(), 
+                                    &listener.delegate, 
+                                    true)) {
+      return false;
+    }
+
+    listener.exited.Reset();
+    return listener.thread.PostTask([&listener]() {
+      listener.stream.StartListening();
+      listener.exited.Signal();
+    });
+  };
+
+  auto stop = [](Listener& listener) {
+    listener.delegate.set_stopping();
+    listener.stream.StopListening();
+    listener.exited.Wait();
+  };
+
+  std::vector<Listener*> listeners;
+  bool started = true;
+  for (size_t i = 0; (i < kListeners) && started; i++) {
+    listeners.push_back(new Listener);
+    Listener& listener = *listeners.back();
+
+    LogWriter::Pattern pattern;
+    pattern.lines_per_second = kLinesPerSecond;
+    pattern.total_lines = (size_t)(kLinesPerSecond * seconds);
+
+    started = 
+      listener.file.valid() && listener.thread.Start() && 
+      listener.done.Create(true, false) && 
+      listener.exited.Create(true, false) &&
+      start(listener) && 
+      listener.writer.Start(listener.file.path(), pattern);
+  }
+
+  Result result;
+  result.benchmark = "listener_buffers";
+  result.variant = "12_slow_logs";
+
+  if (started) {
+    for (size_t i = 0; i < listeners.size(); i++) {
+      listeners[i]->writer.Wait();
+    }
+
+    result.metrics.push_back(std::make_pair(
+      "read_buffers_kb", 
+      utils::BufferPool::in_use_bytes() / 1024.0));
+
+    unsigned __int64 allocations = utils::BufferPool::allocations();
+
+    Stopwatch stopwatch;
+    for (size_t i = 0; i < restarts; i++) {
+      Listener& listener = *listeners[i % listeners.size()];
+      stop(listener);
+      start(listener);
+    }
+    result.seconds = stopwatch.Elapsed();
+    result.items = restarts;
+
+    result.metrics.push_back(std::make_pair(
+      "allocations_per_restart", 
+      (double)(utils::BufferPool::allocations() - allocations) / restarts));
+    result.metrics.push_back(std::make_pair(
+      "pooled_buffers_kb", 
+      utils::BufferPool::pooled_bytes() / 1024.0));
+  }
+
+  for (size_t i = 0; i < listeners.size(); i++) {
+    stop(*listeners[i]);
+    listeners[i]->thread.Stop();
+    delete listeners[i];
+  }
+
+  if (started) {
+    runner.Report(result);
+  }
+}
+
+}; // namespace
+
+void benchmarks::RegisterListenerBenchmarks(Runner& runner) {
+  runner.Add("listener", BenchmarkListener);
+  runner.Add("listener_buffers", BenchmarkListenerBuffers);
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#include "benchmark.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// npSimpleIOBench [--quick] [filter]
+//
+// Results go to stdout as JSON lines (see |benchmarks::Runner|), progress to
+// stderr - e.g. "npSimpleIOBench parse_lines > before.json"
+int main(int argc, char* argv[]) {
+  benchmarks::Runner runner;
+  std::string filter;
+
+  for (int i = 1; i < argc; i++) {
+    if (0 == strcmp(argv[i], "--quick")) {
+      runner.set_quick(true);
+    } else if ('-' == argv[i][0]) {
+      fprintf(stderr, "usage: %s [--quick] [filter]\n", argv[0]);
+      return 1;
+    } else {
+      filter = argv[i];
+    }
+  }
+
+  benchmarks::RegisterTxtFileStreamBenchmarks(runner);
+  benchmarks::RegisterFileBenchmarks(runner);
+  benchmarks::RegisterEncodersBenchmarks(runner);
+  benchmarks::RegisterThreadBenchmarks(runner);
+  benchmarks::RegisterListenerBenchmarks(runner);
+
+  if (0 == runner.Run(filter)) {
+    fprintf(stderr, "no benchmark matches '%s'\n", filter.c_str());
+    return 1;
+  }
+
+  return 0;
+}
\ No newline at end of file
@@ -0,0 +1,123 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#include "benchmark.h"
+#include "utils/Event.h"
+#include "utils/Thread.h"
+
+#include <stdio.h>
+
+using namespace benchmarks;
+
+namespace {
+
+// PostTask -> task runs -> the poster wakes up (what every plugin method 
+// pays before its Execute starts, plus the wake up of the caller)
+void BenchmarkPostTaskRoundTrip(Runner& runner) {
+  utils::Thread thread;
+  utils::Event done;
+  if (!thread.Start() || !done.Create(false, false)) {
+    return;
+  }
+
+  size_t count = runner.Scale(20000);
+
+  Result result;
+  result.benchmark = "post_task_round_trip";
+  result.variant = "single";
+  result.items = count;
+  result.latencies_us.reserve(count);
+
+  Stopwatch total;
+  for (size_t i = 0; i < count; i++) {
+    Stopwatch stopwatch;
+    thread.PostTask([&done]() {
+      done.Signal();
+    });
+    done.Wait();
+    result.latencies_us.push_back(stopwatch.Elapsed() * 1e6);
+  }
+  result.seconds = total.Elapsed();
+
+  thread.Stop();
+  runner.Report(result);
+}
+
+// |producers| threads flood a single |utils::Thread| (e.g. polling widgets
+// calling into the plugin at once) - tasks/s and the queueing delay
+void BenchmarkPostTaskContention(Runner& runner) {
+  const int kProducers[] = { 1, 2, 4, 8 };
+
+  for (size_t i = 0; i < sizeof(kProducers) / sizeof(kProducers[0]); i++) {
+    int producers_count = kProducers[i];
+    size_t tasks_per_producer = runner.Scale(200000) / producers_count;
+    LONG total_tasks = (LONG)(tasks_per_producer * producers_count);
+
+    utils::Thread consumer;
+    utils::Event go;
+    utils::Event done;
+    if (!consumer.Start() || !go.Create(true, false) || 
+        !done.Create(true, false)) {
+      return;
+    }
+
+    std::vector<utils::Thread*> producers;
+    for (int producer = 0; producer < producers_count; producer++) {
+      producers.push_back(new utils::Thread());
+      producers.back()->Start();
+    }
+
+    // only touched by the consumer thread
+    std::vector<double> delays_us;
+    delays_us.reserve(total_tasks);
+
+    volatile LONG executed = 0;
+
+    for (int producer = 0; producer < producers_count; producer++) {
+      producers[producer]->PostTask([&]() {
+        go.Wait();
+        for (size_t task = 0; task < tasks_per_producer; task++) {
+          double posted = Stopwatch::Now();
+          consumer.PostTask([&, posted]() {
+            delays_us.push_back((Stopwatch::Now() - posted) * 1e6);
+
+            if (total_tasks == InterlockedIncrement(&executed)) {
+              done.Signal();
+            }
+          });
+        }
+      });
+    }
+
+    Stopwatch stopwatch;
+    go.Signal();
+    bool completed = done.Wait(60000);
+
+    Result result;
+    result.benchmark = "post_task_contention";
+    char variant[32];
+    sprintf(variant, "%d_producers", producers_count);
+    result.variant = variant;
+    result.seconds = stopwatch.Elapsed();
+    result.items = total_tasks;
+    result.latencies_us.swap(delays_us);
+
+    for (int producer = 0; producer < producers_count; producer++) {
+      producers[producer]->Stop();
+      delete producers[producer];
+    }
+    consumer.Stop();
+
+    if (completed) {
+      runner.Report(result);
+    }
+  }
+}
+
+}; // namespace
+
+void benchmarks::RegisterThreadBenchmarks(Runner& runner) {
+  runner.Add("post_task_round_trip", BenchmarkPostTaskRoundTrip);
+  runner.Add("post_task_contention", BenchmarkPostTaskContention);
+}
\ No newline at end of file
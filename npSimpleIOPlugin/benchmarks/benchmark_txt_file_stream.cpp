@@ -0,0 +1,145 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#include "benchmark.h"
+#include "utils/Event.h"
+#include "utils/Thread.h"
+#include "utils/TxtFileStream.h"
+
+using namespace benchmarks;
+
+namespace {
+
+// counts the lines and notes when the last expected one arrived
+class CountingDelegate : public utils::TxtFileStreamDelegate {
+public:
+  CountingDelegate(size_t expected_lines, utils::Event& done) :
+    expected_lines_(expected_lines),
+    lines_(0),
+    bytes_(0),
+    done_(done),
+    done_time_(0) {
+  }
+
+  virtual void OnNewLine(const char* /*line*/, unsigned int len) {
+    lines_++;
+    bytes_ += len;
+    if (lines_ == expected_lines_) {
+      done_time_ = Stopwatch::Now();
+      done_.Signal();
+    }
+  }
+
+  virtual void OnError(const char* /*message*/, unsigned int /*len*/) {
+  }
+
+  size_t lines() const {
+    return lines_;
+  }
+
+  double done_time() const {
+    return done_time_;
+  }
+
+private:
+  size_t expected_lines_;
+  size_t lines_;
+  unsigned __int64 bytes_;
+  utils::Event& done_;
+  double done_time_;
+};
+
+// Reads the whole of a pre-written file through |TxtFileStream| - the read
+// loop, ParseChunk and ParseLines (the delegate is as cheap as it gets).
+// Returns the seconds from |StartListening| to the last line, < 0 on errors.
+double ReadAllLines(
+  utils::Thread& thread, 
+  const TempFile& file, 
+  size_t line_count) {
+
+  utils::Event done;
+  utils::Event exited;
+  if (!done.Create(true, false) || !exited.Create(true, false)) {
+    return -1;
+  }
+
+  CountingDelegate delegate(line_count, done);
+  utils::TxtFileStream stream;
+  if (!stream.Initialize(file.path().c_str(), &delegate)) {
+    return -1;
+  }
+
+  double start = Stopwatch::Now();
+  thread.PostTask([&stream, &exited]() {
+    stream.StartListening();
+    exited.Signal();
+  });
+
+  bool completed = done.Wait(60000);
+  stream.StopListening();
+  exited.Wait();
+
+  if (!completed || (delegate.lines() != line_count)) {
+    return -1;
+  }
+
+  return delegate.done_time() - start;
+}
+
+void BenchmarkParseLines(Runner& runner) {
+  const LineLengths kLengths[] = { LINES_SHORT, LINES_MIXED, LINES_LONG };
+
+  utils::Thread thread;
+  if (!thread.Start()) {
+    return;
+  }
+
+  for (size_t i = 0; i < sizeof(kLengths) / sizeof(kLengths[0]); i++) {
+    for (int crlf = 0; crlf < 2; crlf++) {
+      size_t line_count = 0;
+      std::string content = GenerateLines(
+        runner.Scale(64 * 1024 * 1024), 
+        kLengths[i], 
+        (0 != crlf), 
+        line_count);
+
+      TempFile file(content);
+      if (!file.valid()) {
+        continue;
+      }
+
+      Result result;
+      result.benchmark = "parse_lines";
+      result.variant = LineLengthsName(kLengths[i]);
+      result.variant += crlf ? "_crlf" : "_lf";
+      result.bytes = content.size();
+      result.items = line_count;
+
+      for (int repetition = 0; repetition < runner.repetitions(); 
+           repetition++) {
+        double seconds = ReadAllLines(thread, file, line_count);
+        if (seconds < 0) {
+          result.seconds = 0;
+          break;
+        }
+
+        if ((0 == repetition) || (seconds < result.seconds)) {
+          result.seconds = seconds;
+        }
+      }
+
+      if (result.seconds > 0) {
+        runner.Report(result);
+      }
+    }
+  }
+
+  thread.Stop();
+}
+
+}; // namespace
+
+void benchmarks::RegisterTxtFileStreamBenchmarks(Runner& runner) {
+  runner.Add("parse_lines", BenchmarkParseLines);
+}
\ No newline at end of file
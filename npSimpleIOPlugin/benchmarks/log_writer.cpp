@@ -0,0 +1,250 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#include "log_writer.h"
+#include "utils/Clock.h"
+#include "utils/Encoders.h"
+#include "utils/File.h"
+
+#include <algorithm>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+using namespace benchmarks;
+
+namespace {
+
+FILE* OpenLog(const std::wstring& path, const char* mode) {
+#ifdef _WIN32
+  return _wfopen(path.c_str(), utils::Encoders::utf8_decode(mode).c_str());
+#else
+  return fopen(utils::Encoders::utf8_encode(path).c_str(), mode);
+#endif
+}
+
+void RemoveLog(const std::wstring& path) {
+#ifdef _WIN32
+  _wunlink(path.c_str());
+#else
+  unlink(utils::Encoders::utf8_encode(path).c_str());
+#endif
+}
+
+// reads a decimal number up to a space - false if there's anything else
+bool ParseNumber(
+  const char*& ref_position, 
+  const char* end, 
+  unsigned __int64& ref_value) {
+
+  ref_value = 0;
+  const char* start = ref_position;
+  while ((ref_position < end) && (' ' != *ref_position)) {
+    if ((*ref_position < '0') || (*ref_position > '9')) {
+      return false;
+    }
+
+    ref_value = ref_value * 10 + (*ref_position - '0');
+    ref_position++;
+  }
+
+  if ((ref_position == start) || (ref_position == end)) {
+    return false;
+  }
+
+  ref_position++;
+  return true;
+}
+
+}; // namespace
+
+LogWriter::Pattern::Pattern() :
+  total_lines(10000),
+  lines_per_second(1000),
+  burst_lines(1),
+  lengths(LINES_MIXED),
+  crlf(false),
+  partial_writes(false),
+  truncate_at(0),
+  rotate_at(0) {
+}
+
+LogWriter::LogWriter() :
+  file_(nullptr),
+  rotated_(false),
+  lines_written_(0),
+  bytes_written_(0),
+  first_write_time_(0) {
+}
+
+LogWriter::~LogWriter() {
+  thread_.Stop();
+
+  if (nullptr != file_) {
+    fclose(file_);
+  }
+
+  if (rotated_) {
+    RemoveLog(path_ + L".1");
+  }
+}
+
+bool LogWriter::Start(const std::wstring& path, const Pattern& pattern) {
+  path_ = path;
+  pattern_ = pattern;
+  if (0 == pattern_.burst_lines) {
+    pattern_.burst_lines = 1;
+  }
+
+  size_t line_count = 0;
+  std::string lines = GenerateLines(
+    256 * 1024, 
+    pattern_.lengths, 
+    false, 
+    line_count);
+
+  size_t start = 0;
+  while (start < lines.size()) {
+    size_t end = lines.find('\n', start);
+    payloads_.push_back(lines.substr(start, end - start));
+    start = end + 1;
+  }
+
+  file_ = OpenLog(path_, "ab");
+  if ((nullptr == file_) || 
+      !done_.Create(true, false) || 
+      !sleep_.Create(false, false) ||
+      !thread_.Start()) {
+    return false;
+  }
+
+  return thread_.PostTask([this]() {
+    Run();
+    done_.Signal();
+  });
+}
+
+void LogWriter::Wait() {
+  done_.Wait();
+}
+
+size_t LogWriter::lines_written() {
+  return (size_t)lines_written_;
+}
+
+unsigned __int64 LogWriter::bytes_written() {
+  return bytes_written_;
+}
+
+double LogWriter::first_write_time() {
+  return first_write_time_;
+}
+
+// static
+bool LogWriter::ParseLine(
+  const char* line, 
+  size_t len, 
+  unsigned __int64& ref_sequence, 
+  unsigned __int64& ref_time_us) {
+
+  const char* position = line;
+  const char* end = line + len;
+  return ParseNumber(position, end, ref_sequence) && 
+         ParseNumber(position, end, ref_time_us);
+}
+
+void LogWriter::Run() {
+  Stopwatch stopwatch;
+  first_write_time_ = Stopwatch::Now();
+
+  std::string burst;
+  char prefix[64];
+  size_t line = 0;
+
+  while (line < pattern_.total_lines) {
+    // the lines that should have been written by now
+    if (pattern_.lines_per_second > 0) {
+      double due = stopwatch.Elapsed() * pattern_.lines_per_second;
+      if ((double)line > due) {
+        sleep_.Wait(1);
+        continue;
+      }
+    }
+
+    size_t burst_end = std::min(
+      line + pattern_.burst_lines, 
+      pattern_.total_lines);
+
+    // truncation/rotation happen between bursts
+    if ((0 != pattern_.truncate_at) && (line < pattern_.truncate_at) && 
+        (burst_end > pattern_.truncate_at)) {
+      burst_end = pattern_.truncate_at;
+    }
+    if ((0 != pattern_.rotate_at) && (line < pattern_.rotate_at) && 
+        (burst_end > pattern_.rotate_at)) {
+      burst_end = pattern_.rotate_at;
+    }
+
+    burst.clear();
+    unsigned __int64 now_us = utils::Clock::NowMicroseconds();
+    for (; line < burst_end; line++) {
+      sprintf(prefix, "%" FORMAT_UINT64 " %" FORMAT_UINT64 " ", 
+              (unsigned __int64)line, now_us);
+      burst += prefix;
+      burst += payloads_[line % payloads_.size()];
+      if (pattern_.crlf) {
+        burst += '\r';
+      }
+      burst += '\n';
+    }
+
+    if (!Write(burst)) {
+      return;
+    }
+    InterlockedExchange(&lines_written_, (LONG)line);
+
+    if ((line == pattern_.truncate_at) && !Reopen(false)) {
+      return;
+    }
+    if ((line == pattern_.rotate_at) && !Reopen(true)) {
+      return;
+    }
+  }
+}
+
+bool LogWriter::Write(const std::string& data) {
+  if (!pattern_.partial_writes || (data.size() < 2)) {
+    bool status = (1 == fwrite(data.c_str(), data.size(), 1, file_));
+    fflush(file_);
+    bytes_written_ += data.size();
+    return status;
+  }
+
+  // the reader gets to see the first half on its own
+  size_t half = data.size() / 2;
+  bool status = (1 == fwrite(data.c_str(), half, 1, file_));
+  fflush(file_);
+  sleep_.Wait(1);
+  status = status && 
+    (1 == fwrite(data.c_str() + half, data.size() - half, 1, file_));
+  fflush(file_);
+
+  bytes_written_ += data.size();
+  return status;
+}
+
+bool LogWriter::Reopen(bool rotate) {
+  fclose(file_);
+  file_ = nullptr;
+
+  if (rotate) {
+    // fails on Windows while the file is open without FILE_SHARE_DELETE -
+    // the log then just goes on
+    rotated_ = utils::File::RenameFile(path_, path_ + L".1");
+  }
+
+  file_ = OpenLog(path_, rotate ? "ab" : "wb");
+  return (nullptr != file_);
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef BENCHMARKS_LOG_WRITER_H_
+#define BENCHMARKS_LOG_WRITER_H_
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "benchmark.h"
+#include "utils/Event.h"
+#include "utils/Thread.h"
+
+namespace benchmarks {
+
+// Simulates an application writing its log: lines are appended to a file on
+// a thread of their own, at a given pace and in a given pattern. Every line 
+// starts with "<sequence> <write time> " (see |ParseLine|) so a reader can 
+// tell which lines it got and how late.
+class LogWriter {
+public:
+  struct Pattern {
+    Pattern();
+
+    size_t total_lines;
+    double lines_per_second; // 0 = as fast as the file takes them
+
+    // lines written (and flushed) together - 1 is a steady trickle, larger 
+    // values are bursts at the same average rate
+    size_t burst_lines;
+
+    LineLengths lengths;
+    bool crlf;
+
+    // every write is split mid-line and flushed in two halves ~1ms apart
+    bool partial_writes;
+
+    // after this many lines (0 = never) the file is truncated, like a log 
+    // reopened with "w" - or renamed to <file>.1 and started anew (rotation)
+    size_t truncate_at;
+    size_t rotate_at;
+  };
+
+  LogWriter();
+  virtual ~LogWriter();
+
+public:
+  bool Start(const std::wstring& path, const Pattern& pattern);
+
+  // waits for the last line to be written
+  void Wait();
+
+  size_t lines_written();
+  unsigned __int64 bytes_written();
+
+  // Stopwatch::Now() of the first write
+  double first_write_time();
+
+  // the <sequence> and <write time> (Clock::NowMicroseconds) of a line - 
+  // false if it isn't one of ours (e.g. a line torn apart)
+  static bool ParseLine(
+    const char* line, 
+    size_t len, 
+    unsigned __int64& ref_sequence, 
+    unsigned __int64& ref_time_us);
+
+private:
+  void Run();
+  bool Write(const std::string& data);
+  bool Reopen(bool rotate);
+
+private:
+  std::wstring path_;
+  Pattern pattern_;
+  FILE* file_;
+  bool rotated_;
+
+  // payloads of the requested lengths, used round robin
+  std::vector<std::string> payloads_;
+
+  volatile LONG lines_written_;
+  unsigned __int64 bytes_written_;
+  double first_write_time_;
+
+  utils::Thread thread_;
+  utils::Event done_;
+  utils::Event sleep_;
+};
+
+}; // namespace benchmarks
+
+#endif // BENCHMARKS_LOG_WRITER_H_
\ No newline at end of file
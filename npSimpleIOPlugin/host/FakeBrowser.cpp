@@ -0,0 +1,668 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#include "FakeBrowser.h"
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <psapi.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace host;
+
+namespace {
+
+char kMimeType[] = "application/x-simple-io-plugin";
+
+// every NPN_MemAlloc block starts with its size (keeps the block aligned)
+const size_t kAllocationHeader = 16;
+
+}; // namespace
+
+FakeBrowser* FakeBrowser::instance_ = nullptr;
+
+FakeBrowser::FakeBrowser() :
+  plugin_(nullptr),
+  loaded_(false),
+  live_objects_(0),
+  async_calls_count_(0) {
+
+  memset(&npp_, 0, sizeof(npp_));
+  memset(&memory_stats_, 0, sizeof(memory_stats_));
+  memset(&plugin_funcs_, 0, sizeof(plugin_funcs_));
+  plugin_funcs_.size = sizeof(plugin_funcs_);
+
+  // the stream, URL and drawing functions are left out - the plugin doesn't
+  // use them
+  memset(&browser_funcs_, 0, sizeof(browser_funcs_));
+  browser_funcs_.size = sizeof(browser_funcs_);
+  browser_funcs_.version = (NP_VERSION_MAJOR << 8) | NP_VERSION_MINOR;
+  browser_funcs_.uagent = UserAgent;
+  browser_funcs_.memalloc = MemAlloc;
+  browser_funcs_.memfree = MemFree;
+  browser_funcs_.memflush = MemFlush;
+  browser_funcs_.getvalue = GetValue;
+  browser_funcs_.setvalue = SetValue;
+  browser_funcs_.getstringidentifier = GetStringIdentifier;
+  browser_funcs_.getstringidentifiers = GetStringIdentifiers;
+  browser_funcs_.getintidentifier = GetIntIdentifier;
+  browser_funcs_.identifierisstring = IdentifierIsString;
+  browser_funcs_.utf8fromidentifier = UTF8FromIdentifier;
+  browser_funcs_.intfromidentifier = IntFromIdentifier;
+  browser_funcs_.createobject = CreateObject;
+  browser_funcs_.retainobject = RetainObject;
+  browser_funcs_.releaseobject = ReleaseObject;
+  browser_funcs_.invoke = InvokeMethod;
+  browser_funcs_.invokeDefault = InvokeDefault;
+  browser_funcs_.getproperty = GetObjectProperty;
+  browser_funcs_.setproperty = SetObjectProperty;
+  browser_funcs_.removeproperty = RemoveProperty;
+  browser_funcs_.hasproperty = HasProperty;
+  browser_funcs_.hasmethod = HasMethod;
+  browser_funcs_.enumerate = Enumerate;
+  browser_funcs_.releasevariantvalue = ReleaseVariantValue;
+  browser_funcs_.setexception = SetException;
+  browser_funcs_.pluginthreadasynccall = PluginThreadAsyncCall;
+
+  async_event_.Create(false, false);
+
+  instance_ = this;
+}
+
+FakeBrowser::~FakeBrowser() {
+  Unload();
+
+  // calls that were posted after the plugin went away
+  RunPending(0);
+
+  std::map<std::string, Identifier*>::iterator string_iter = 
+    string_identifiers_.begin();
+  for (; string_iter != string_identifiers_.end(); ++string_iter) {
+    delete string_iter->second;
+  }
+
+  std::map<int32_t, Identifier*>::iterator int_iter = 
+    int_identifiers_.begin();
+  for (; int_iter != int_identifiers_.end(); ++int_iter) {
+    delete int_iter->second;
+  }
+
+  async_event_.Destroy();
+
+  if (this == instance_) {
+    instance_ = nullptr;
+  }
+}
+
+// static
+FakeBrowser* FakeBrowser::Get() {
+  return instance_;
+}
+
+bool FakeBrowser::Load() {
+  if (loaded_) {
+    return true;
+  }
+
+#ifdef XP_UNIX
+  if (NPERR_NO_ERROR != NP_Initialize(&browser_funcs_, &plugin_funcs_)) {
+    return false;
+  }
+#else
+  if ((NPERR_NO_ERROR != NP_GetEntryPoints(&plugin_funcs_)) ||
+      (NPERR_NO_ERROR != NP_Initialize(&browser_funcs_))) {
+    return false;
+  }
+#endif
+
+  NPError error = plugin_funcs_.newp(
+    kMimeType, 
+    &npp_, 
+    NP_EMBED, 
+    0, 
+    nullptr, 
+    nullptr, 
+    nullptr);
+  if (NPERR_NO_ERROR != error) {
+    NP_Shutdown();
+    return false;
+  }
+
+  loaded_ = true;
+
+  NPObject* plugin = nullptr;
+  error = plugin_funcs_.getvalue(
+    &npp_, 
+    NPPVpluginScriptableNPObject, 
+    &plugin);
+  if ((NPERR_NO_ERROR != error) || (nullptr == plugin)) {
+    Unload();
+    return false;
+  }
+
+  plugin_ = plugin;
+  return true;
+}
+
+void FakeBrowser::Unload() {
+  if (!loaded_) {
+    return;
+  }
+
+  // the plugin instance holds its own reference to the scriptable object
+  // and releases it in NPP_Destroy - ours (from NPPVpluginScriptableNPObject)
+  // goes right after, like the page's
+  plugin_funcs_.destroy(&npp_, nullptr);
+
+  if (nullptr != plugin_) {
+    ReleaseObject(plugin_);
+    plugin_ = nullptr;
+  }
+
+  NP_Shutdown();
+
+  loaded_ = false;
+}
+
+NPP FakeBrowser::npp() {
+  return &npp_;
+}
+
+NPObject* FakeBrowser::plugin() const {
+  return plugin_;
+}
+
+bool FakeBrowser::Invoke(
+  const char* method, 
+  const NPVariant* args, 
+  uint32_t arg_count, 
+  NPVariant* result) {
+
+  if (nullptr == plugin_) {
+    return false;
+  }
+
+  VOID_TO_NPVARIANT(*result);
+  return InvokeMethod(
+    &npp_, 
+    plugin_, 
+    GetStringIdentifier(method), 
+    args, 
+    arg_count, 
+    result);
+}
+
+bool FakeBrowser::GetProperty(const char* name, NPVariant* result) {
+  if (nullptr == plugin_) {
+    return false;
+  }
+
+  VOID_TO_NPVARIANT(*result);
+  return GetObjectProperty(
+    &npp_, 
+    plugin_, 
+    GetStringIdentifier(name), 
+    result);
+}
+
+size_t FakeBrowser::RunPending(DWORD wait_ms) {
+  std::deque<AsyncCall> calls;
+  {
+    utils::CriticalSectionLock lock(async_critical_section_);
+    calls.swap(async_calls_);
+  }
+
+  if (calls.empty() && (wait_ms > 0)) {
+    async_event_.Wait(wait_ms);
+
+    utils::CriticalSectionLock lock(async_critical_section_);
+    calls.swap(async_calls_);
+  }
+
+  // in the order they were posted (like the browser)
+  std::deque<AsyncCall>::iterator iter = calls.begin();
+  for (; iter != calls.end(); ++iter) {
+    iter->func(iter->user_data);
+  }
+
+  return calls.size();
+}
+
+bool FakeBrowser::RunUntil(std::function<bool()> done, DWORD timeout_ms) {
+  DWORD start = GetTickCount();
+
+  while (!done()) {
+    DWORD elapsed = GetTickCount() - start;
+    if (elapsed >= timeout_ms) {
+      return false;
+    }
+
+    DWORD remaining = timeout_ms - elapsed;
+    RunPending((remaining < 10) ? remaining : 10);
+  }
+
+  return true;
+}
+
+FakeBrowser::MemoryStats FakeBrowser::memory_stats() {
+  utils::CriticalSectionLock lock(memory_critical_section_);
+  MemoryStats stats = memory_stats_;
+  stats.live_objects = live_objects_;
+  return stats;
+}
+
+unsigned __int64 FakeBrowser::async_calls_count() {
+  utils::CriticalSectionLock lock(async_critical_section_);
+  return async_calls_count_;
+}
+
+void FakeBrowser::ResetPeakMemory() {
+  utils::CriticalSectionLock lock(memory_critical_section_);
+  memory_stats_.peak_bytes = memory_stats_.live_bytes;
+}
+
+std::string FakeBrowser::TakeException() {
+  utils::CriticalSectionLock lock(exception_critical_section_);
+  std::string exception;
+  exception.swap(exception_);
+  return exception;
+}
+
+std::string FakeBrowser::IdentifierName(NPIdentifier identifier) {
+  Identifier* id = reinterpret_cast<Identifier*>(identifier);
+  if (nullptr == id) {
+    return "";
+  }
+
+  if (id->is_string) {
+    return id->name;
+  }
+
+  char value[16];
+  sprintf(value, "%d", (int)id->value);
+  return value;
+}
+
+// static
+unsigned __int64 FakeBrowser::ProcessMemoryBytes() {
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS counters;
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+    return 0;
+  }
+  return counters.WorkingSetSize;
+#else
+  // the second field of statm is the resident set, in pages
+  unsigned long long pages = 0;
+  FILE* statm = fopen("/proc/self/statm", "r");
+  if (nullptr == statm) {
+    return 0;
+  }
+
+  if (1 != fscanf(statm, "%*u %llu", &pages)) {
+    pages = 0;
+  }
+  fclose(statm);
+
+  return (unsigned __int64)pages * sysconf(_SC_PAGESIZE);
+#endif
+}
+
+FakeBrowser::Identifier* FakeBrowser::GetIdentifier(
+  const std::string& name, 
+  int32_t value, 
+  bool is_string) {
+
+  utils::CriticalSectionLock lock(identifiers_critical_section_);
+
+  // identifiers live as long as the browser (like in a real one)
+  Identifier*& ref_id = is_string ? 
+    string_identifiers_[name] : 
+    int_identifiers_[value];
+
+  if (nullptr == ref_id) {
+    ref_id = new Identifier;
+    ref_id->is_string = is_string;
+    ref_id->name = name;
+    ref_id->value = value;
+  }
+
+  return ref_id;
+}
+
+//-----------------------------------------------------------------------------
+// static
+void* FakeBrowser::MemAlloc(uint32_t size) {
+  char* block = (char*)malloc(kAllocationHeader + size);
+  if (nullptr == block) {
+    return nullptr;
+  }
+
+  *(uint32_t*)block = size;
+
+  if (nullptr != instance_) {
+    utils::CriticalSectionLock lock(instance_->memory_critical_section_);
+    MemoryStats& stats = instance_->memory_stats_;
+    stats.live_bytes += size;
+    stats.allocations++;
+    if (stats.live_bytes > stats.peak_bytes) {
+      stats.peak_bytes = stats.live_bytes;
+    }
+  }
+
+  return block + kAllocationHeader;
+}
+
+// static
+void FakeBrowser::MemFree(void* ptr) {
+  if (nullptr == ptr) {
+    return;
+  }
+
+  char* block = (char*)ptr - kAllocationHeader;
+
+  if (nullptr != instance_) {
+    utils::CriticalSectionLock lock(instance_->memory_critical_section_);
+    instance_->memory_stats_.live_bytes -= *(uint32_t*)block;
+  }
+
+  free(block);
+}
+
+// static
+uint32_t FakeBrowser::MemFlush(uint32_t /*size*/) {
+  return 0;
+}
+
+// static
+const char* FakeBrowser::UserAgent(NPP /*instance*/) {
+  return "npSimpleIOHost";
+}
+
+// static
+NPError FakeBrowser::GetValue(
+  NPP /*instance*/, 
+  NPNVariable /*variable*/, 
+  void* /*value*/) {
+  // no window and no DOM
+  return NPERR_GENERIC_ERROR;
+}
+
+// static
+NPError FakeBrowser::SetValue(
+  NPP /*instance*/, 
+  NPPVariable /*variable*/, 
+  void* /*value*/) {
+  return NPERR_NO_ERROR;
+}
+
+// static
+NPIdentifier FakeBrowser::GetStringIdentifier(const NPUTF8* name) {
+  if ((nullptr == name) || (nullptr == instance_)) {
+    return nullptr;
+  }
+
+  return instance_->GetIdentifier(name, 0, true);
+}
+
+// static
+void FakeBrowser::GetStringIdentifiers(
+  const NPUTF8** names, 
+  int32_t name_count, 
+  NPIdentifier* identifiers) {
+  for (int32_t i = 0; i < name_count; i++) {
+    identifiers[i] = GetStringIdentifier(names[i]);
+  }
+}
+
+// static
+NPIdentifier FakeBrowser::GetIntIdentifier(int32_t intid) {
+  if (nullptr == instance_) {
+    return nullptr;
+  }
+
+  return instance_->GetIdentifier("", intid, false);
+}
+
+// static
+bool FakeBrowser::IdentifierIsString(NPIdentifier identifier) {
+  Identifier* id = reinterpret_cast<Identifier*>(identifier);
+  return (nullptr != id) && id->is_string;
+}
+
+// static
+NPUTF8* FakeBrowser::UTF8FromIdentifier(NPIdentifier identifier) {
+  Identifier* id = reinterpret_cast<Identifier*>(identifier);
+  if ((nullptr == id) || !id->is_string) {
+    return nullptr;
+  }
+
+  NPUTF8* name = (NPUTF8*)MemAlloc((uint32_t)id->name.size() + 1);
+  memcpy(name, id->name.c_str(), id->name.size() + 1);
+  return name;
+}
+
+// static
+int32_t FakeBrowser::IntFromIdentifier(NPIdentifier identifier) {
+  Identifier* id = reinterpret_cast<Identifier*>(identifier);
+  if ((nullptr == id) || id->is_string) {
+    return INT_MIN;
+  }
+
+  return id->value;
+}
+
+// static
+NPObject* FakeBrowser::CreateObject(NPP npp, NPClass* np_class) {
+  if (nullptr == np_class) {
+    return nullptr;
+  }
+
+  NPObject* object = (nullptr != np_class->allocate) ?
+    np_class->allocate(npp, np_class) :
+    (NPObject*)malloc(sizeof(NPObject));
+
+  if (nullptr == object) {
+    return nullptr;
+  }
+
+  object->_class = np_class;
+  object->referenceCount = 1;
+
+  if (nullptr != instance_) {
+    InterlockedIncrement(&instance_->live_objects_);
+  }
+
+  return object;
+}
+
+// static
+NPObject* FakeBrowser::RetainObject(NPObject* object) {
+  if (nullptr != object) {
+    InterlockedIncrement((volatile LONG*)&object->referenceCount);
+  }
+
+  return object;
+}
+
+// static
+void FakeBrowser::ReleaseObject(NPObject* object) {
+  if (nullptr == object) {
+    return;
+  }
+
+  if (0 != InterlockedDecrement((volatile LONG*)&object->referenceCount)) {
+    return;
+  }
+
+  if (nullptr != instance_) {
+    InterlockedDecrement(&instance_->live_objects_);
+  }
+
+  if (nullptr != object->_class->deallocate) {
+    object->_class->deallocate(object);
+  } else {
+    free(object);
+  }
+}
+
+// static
+bool FakeBrowser::InvokeMethod(
+  NPP /*npp*/, 
+  NPObject* object, 
+  NPIdentifier name, 
+  const NPVariant* args, 
+  uint32_t arg_count, 
+  NPVariant* result) {
+
+  if ((nullptr == object) || (nullptr == object->_class->invoke)) {
+    return false;
+  }
+
+  VOID_TO_NPVARIANT(*result);
+  return object->_class->invoke(object, name, args, arg_count, result);
+}
+
+// static
+bool FakeBrowser::InvokeDefault(
+  NPP /*npp*/, 
+  NPObject* object, 
+  const NPVariant* args, 
+  uint32_t arg_count, 
+  NPVariant* result) {
+
+  if ((nullptr == object) || (nullptr == object->_class->invokeDefault)) {
+    return false;
+  }
+
+  VOID_TO_NPVARIANT(*result);
+  return object->_class->invokeDefault(object, args, arg_count, result);
+}
+
+// static
+bool FakeBrowser::GetObjectProperty(
+  NPP /*npp*/, 
+  NPObject* object, 
+  NPIdentifier name, 
+  NPVariant* result) {
+
+  if ((nullptr == object) || (nullptr == object->_class->getProperty)) {
+    return false;
+  }
+
+  VOID_TO_NPVARIANT(*result);
+  return object->_class->getProperty(object, name, result);
+}
+
+// static
+bool FakeBrowser::SetObjectProperty(
+  NPP /*npp*/, 
+  NPObject* object, 
+  NPIdentifier name, 
+  const NPVariant* value) {
+
+  if ((nullptr == object) || (nullptr == object->_class->setProperty)) {
+    return false;
+  }
+
+  return object->_class->setProperty(object, name, value);
+}
+
+// static
+bool FakeBrowser::RemoveProperty(
+  NPP /*npp*/, 
+  NPObject* object, 
+  NPIdentifier name) {
+
+  if ((nullptr == object) || (nullptr == object->_class->removeProperty)) {
+    return false;
+  }
+
+  return object->_class->removeProperty(object, name);
+}
+
+// static
+bool FakeBrowser::HasProperty(
+  NPP /*npp*/, 
+  NPObject* object, 
+  NPIdentifier name) {
+
+  if ((nullptr == object) || (nullptr == object->_class->hasProperty)) {
+    return false;
+  }
+
+  return object->_class->hasProperty(object, name);
+}
+
+// static
+bool FakeBrowser::HasMethod(NPP /*npp*/, NPObject* object, NPIdentifier name) {
+  if ((nullptr == object) || (nullptr == object->_class->hasMethod)) {
+    return false;
+  }
+
+  return object->_class->hasMethod(object, name);
+}
+
+// static
+bool FakeBrowser::Enumerate(
+  NPP /*npp*/, 
+  NPObject* /*object*/, 
+  NPIdentifier** /*identifiers*/, 
+  uint32_t* /*count*/) {
+  return false;
+}
+
+// static
+void FakeBrowser::ReleaseVariantValue(NPVariant* variant) {
+  if (nullptr == variant) {
+    return;
+  }
+
+  if (NPVARIANT_IS_STRING(*variant)) {
+    MemFree((void*)NPVARIANT_TO_STRING(*variant).UTF8Characters);
+  } else if (NPVARIANT_IS_OBJECT(*variant)) {
+    ReleaseObject(NPVARIANT_TO_OBJECT(*variant));
+  }
+
+  VOID_TO_NPVARIANT(*variant);
+}
+
+// static
+void FakeBrowser::SetException(NPObject* /*object*/, const NPUTF8* message) {
+  if ((nullptr == instance_) || (nullptr == message)) {
+    return;
+  }
+
+  utils::CriticalSectionLock lock(instance_->exception_critical_section_);
+  instance_->exception_ = message;
+}
+
+// static
+void FakeBrowser::PluginThreadAsyncCall(
+  NPP /*instance*/, 
+  void (*func)(void*), 
+  void* user_data) {
+
+  if ((nullptr == instance_) || (nullptr == func)) {
+    return;
+  }
+
+  AsyncCall call;
+  call.func = func;
+  call.user_data = user_data;
+
+  {
+    utils::CriticalSectionLock lock(instance_->async_critical_section_);
+    instance_->async_calls_.push_back(call);
+    instance_->async_calls_count_++;
+  }
+
+  instance_->async_event_.Signal();
+}
\ No newline at end of file
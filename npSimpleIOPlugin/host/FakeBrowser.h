@@ -0,0 +1,189 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef HOST_FAKE_BROWSER_H_
+#define HOST_FAKE_BROWSER_H_
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include "utils/Platform.h"
+#include "utils/CriticalSectionLock.h"
+#include "utils/Event.h"
+#include "plugin_common/pluginbase.h"
+
+namespace host {
+
+// An in-process stand-in for the browser side of NPAPI, so the plugin can be
+// driven without a browser (benchmarks, stress runs). It implements the 
+// NPNetscapeFuncs table that plugin_common/npn_gate.cpp calls into, loads 
+// the (statically linked) plugin through its entry points and acts as the 
+// browser's main thread: calls posted with NPN_PluginThreadAsyncCall run 
+// when the thread that called |Load| runs |RunPending| / |RunUntil|.
+//
+// NPAPI functions carry no context, so there is one browser per process.
+class FakeBrowser {
+public:
+  struct MemoryStats {
+    LONGLONG live_bytes; // allocated with NPN_MemAlloc and not freed yet
+    LONGLONG peak_bytes;
+    LONGLONG allocations;
+    LONG live_objects; // NPObjects that weren't released yet
+  };
+
+  FakeBrowser();
+  virtual ~FakeBrowser();
+
+  // the browser that was created last (nullptr if none)
+  static FakeBrowser* Get();
+
+public:
+  // NP_Initialize + NPP_New + the scriptable object of the plugin
+  bool Load();
+  void Unload();
+
+  NPP npp();
+  NPObject* plugin() const;
+
+  // what script does: plugin().method(args...) and plugin().PROPERTY
+  bool Invoke(
+    const char* method, 
+    const NPVariant* args, 
+    uint32_t arg_count, 
+    NPVariant* result);
+  bool GetProperty(const char* name, NPVariant* result);
+
+  // runs the calls posted to the main thread, waiting up to |wait_ms| for 
+  // the first one - returns the number of calls that ran
+  size_t RunPending(DWORD wait_ms);
+
+  // runs the posted calls until |done| returns true - false if |timeout_ms|
+  // passed first
+  bool RunUntil(std::function<bool()> done, DWORD timeout_ms);
+
+  MemoryStats memory_stats();
+
+  // NPN_PluginThreadAsyncCall calls so far - the main thread wake ups
+  unsigned __int64 async_calls_count();
+
+  // starts measuring |MemoryStats::peak_bytes| from the current live bytes
+  void ResetPeakMemory();
+
+  // the last NPN_SetException message (cleared)
+  std::string TakeException();
+
+  // the name of a string identifier, or the decimal value of an int one
+  std::string IdentifierName(NPIdentifier identifier);
+
+  // resident memory of the whole process
+  static unsigned __int64 ProcessMemoryBytes();
+
+private:
+  struct Identifier {
+    bool is_string;
+    std::string name;
+    int32_t value;
+  };
+
+  struct AsyncCall {
+    void (*func)(void*);
+    void* user_data;
+  };
+
+  Identifier* GetIdentifier(
+    const std::string& name, 
+    int32_t value, 
+    bool is_string);
+
+// the NPNetscapeFuncs table
+private:
+  static void* MemAlloc(uint32_t size);
+  static void MemFree(void* ptr);
+  static uint32_t MemFlush(uint32_t size);
+  static const char* UserAgent(NPP instance);
+  static NPError GetValue(NPP instance, NPNVariable variable, void* value);
+  static NPError SetValue(NPP instance, NPPVariable variable, void* value);
+
+  static NPIdentifier GetStringIdentifier(const NPUTF8* name);
+  static void GetStringIdentifiers(
+    const NPUTF8** names, 
+    int32_t name_count, 
+    NPIdentifier* identifiers);
+  static NPIdentifier GetIntIdentifier(int32_t intid);
+  static bool IdentifierIsString(NPIdentifier identifier);
+  static NPUTF8* UTF8FromIdentifier(NPIdentifier identifier);
+  static int32_t IntFromIdentifier(NPIdentifier identifier);
+
+  static NPObject* CreateObject(NPP npp, NPClass* np_class);
+  static NPObject* RetainObject(NPObject* object);
+  static void ReleaseObject(NPObject* object);
+  static bool InvokeMethod(
+    NPP npp, 
+    NPObject* object, 
+    NPIdentifier name, 
+    const NPVariant* args, 
+    uint32_t arg_count, 
+    NPVariant* result);
+  static bool InvokeDefault(
+    NPP npp, 
+    NPObject* object, 
+    const NPVariant* args, 
+    uint32_t arg_count, 
+    NPVariant* result);
+  static bool GetObjectProperty(
+    NPP npp, 
+    NPObject* object, 
+    NPIdentifier name, 
+    NPVariant* result);
+  static bool SetObjectProperty(
+    NPP npp, 
+    NPObject* object, 
+    NPIdentifier name, 
+    const NPVariant* value);
+  static bool RemoveProperty(NPP npp, NPObject* object, NPIdentifier name);
+  static bool HasProperty(NPP npp, NPObject* object, NPIdentifier name);
+  static bool HasMethod(NPP npp, NPObject* object, NPIdentifier name);
+  static bool Enumerate(
+    NPP npp, 
+    NPObject* object, 
+    NPIdentifier** identifiers, 
+    uint32_t* count);
+  static void ReleaseVariantValue(NPVariant* variant);
+  static void SetException(NPObject* object, const NPUTF8* message);
+  static void PluginThreadAsyncCall(
+    NPP instance, 
+    void (*func)(void*), 
+    void* user_data);
+
+private:
+  static FakeBrowser* instance_;
+
+  NPNetscapeFuncs browser_funcs_;
+  NPPluginFuncs plugin_funcs_;
+  NPP_t npp_;
+  NPObject* plugin_;
+  bool loaded_;
+
+  utils::CriticalSection identifiers_critical_section_;
+  std::map<std::string, Identifier*> string_identifiers_;
+  std::map<int32_t, Identifier*> int_identifiers_;
+
+  utils::CriticalSection memory_critical_section_;
+  MemoryStats memory_stats_;
+  volatile LONG live_objects_;
+
+  utils::CriticalSection exception_critical_section_;
+  std::string exception_;
+
+  // the main thread's queue
+  utils::CriticalSection async_critical_section_;
+  std::deque<AsyncCall> async_calls_;
+  unsigned __int64 async_calls_count_;
+  utils::Event async_event_;
+};
+
+}; // namespace host
+
+#endif // HOST_FAKE_BROWSER_H_
\ No newline at end of file
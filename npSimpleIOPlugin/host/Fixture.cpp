@@ -0,0 +1,230 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#include "Fixture.h"
+#include "benchmarks/benchmark.h"
+#include "utils/Encoders.h"
+#include "utils/File.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace host;
+
+namespace {
+
+// tree/d<N>/s<N>/file_<N>.log
+const int kTreeDirectories = 8;
+const int kTreeSubDirectories = 4;
+const int kTreeFilesPerDirectory = 8;
+
+const char kTreeNeedle[] = "ERROR simpleio host needle";
+
+FILE* OpenFile(const std::string& path, const char* mode) {
+#ifdef _WIN32
+  return _wfopen(
+    utils::Encoders::utf8_decode(path).c_str(), 
+    utils::Encoders::utf8_decode(mode).c_str());
+#else
+  return fopen(path.c_str(), mode);
+#endif
+}
+
+bool WriteContent(
+  const std::string& path, 
+  const std::string& content, 
+  const char* mode) {
+
+  FILE* file = OpenFile(path, mode);
+  if (nullptr == file) {
+    return false;
+  }
+
+  bool status = 
+    content.empty() || (1 == fwrite(content.c_str(), content.size(), 1, file));
+  fclose(file);
+  return status;
+}
+
+}; // namespace
+
+Fixture::Fixture() {
+}
+
+Fixture::~Fixture() {
+  if (!root_.empty()) {
+    RemoveTree(utils::Encoders::utf8_decode(root_));
+  }
+}
+
+bool Fixture::Create(bool quick) {
+  char name[64];
+  sprintf(name, "simpleio_host_%u", (unsigned int)time(nullptr));
+
+#ifdef _WIN32
+  wchar_t temp_path[MAX_PATH + 1];
+  if (0 == GetTempPathW(MAX_PATH + 1, temp_path)) {
+    return false;
+  }
+
+  root_ = utils::Encoders::utf8_encode(temp_path) + name;
+#else
+  const char* temp_path = getenv("TMPDIR");
+  root_ = (nullptr != temp_path) ? temp_path : "/tmp";
+  root_ += '/';
+  root_ += name;
+#endif
+
+  if (!utils::File::CreateDirectories(utils::Encoders::utf8_decode(root_)) ||
+      !MakeDirectory("appdata") ||
+      !MakeDirectory("watch")) {
+    return false;
+  }
+
+#ifndef _WIN32
+  setenv("XDG_DATA_HOME", Path("appdata").c_str(), 1);
+#endif
+
+  size_t line_count = 0;
+  if (!WriteFile("small.txt", benchmarks::GenerateText(4 * 1024, true)) ||
+      !WriteFile(
+        "large.txt", 
+        benchmarks::GenerateLines(
+          (quick ? 1 : 8) * 1024 * 1024, 
+          benchmarks::LINES_MIXED, 
+          true, 
+          line_count)) ||
+      !WriteFile("binary.bin", benchmarks::GenerateBytes(64 * 1024)) ||
+      !WriteFile("log.txt", "")) {
+    return false;
+  }
+
+  // a few hundred small logs for the directory and search methods
+  char relative[64];
+  std::string lines = benchmarks::GenerateLines(
+    4 * 1024, 
+    benchmarks::LINES_SHORT, 
+    false, 
+    line_count);
+
+  for (int directory = 0; directory < kTreeDirectories; directory++) {
+    for (int sub = 0; sub < kTreeSubDirectories; sub++) {
+      sprintf(relative, "tree/d%d/s%d", directory, sub);
+      if (!MakeDirectory(relative)) {
+        return false;
+      }
+
+      for (int file = 0; file < kTreeFilesPerDirectory; file++) {
+        sprintf(relative, "tree/d%d/s%d/file_%d.log", directory, sub, file);
+
+        std::string content(lines, 0, lines.size() / 2);
+        content += kTreeNeedle;
+        content += '\n';
+        content.append(lines, lines.size() / 2, std::string::npos);
+
+        if (!WriteFile(relative, content)) {
+          return false;
+        }
+
+        tree_files_.push_back(relative);
+      }
+    }
+  }
+
+  return true;
+}
+
+const std::string& Fixture::root() const {
+  return root_;
+}
+
+std::string Fixture::Path(const std::string& relative) const {
+  std::string path(root_);
+  path += (char)utils::File::kPathSeparator;
+
+  for (size_t i = 0; i < relative.size(); i++) {
+    path += ('/' == relative[i]) ? (char)utils::File::kPathSeparator : 
+                                   relative[i];
+  }
+
+  return path;
+}
+
+bool Fixture::WriteFile(
+  const std::string& relative, 
+  const std::string& content) {
+  return WriteContent(Path(relative), content, "wb");
+}
+
+bool Fixture::AppendFile(
+  const std::string& relative, 
+  const std::string& content) {
+  return WriteContent(Path(relative), content, "ab");
+}
+
+bool Fixture::MakeDirectory(const std::string& relative) {
+  return utils::File::CreateDirectories(
+    utils::Encoders::utf8_decode(Path(relative)));
+}
+
+bool Fixture::RemoveFile(const std::string& relative) {
+#ifdef _WIN32
+  return (0 == _wunlink(utils::Encoders::utf8_decode(Path(relative)).c_str()));
+#else
+  return (0 == unlink(Path(relative).c_str()));
+#endif
+}
+
+const std::vector<std::string>& Fixture::tree_files() const {
+  return tree_files_;
+}
+
+// static
+const char* Fixture::tree_needle() {
+  return kTreeNeedle;
+}
+
+// static
+void Fixture::RemoveTree(const std::wstring& directory) {
+  utils::File::DirectoryEntries entries;
+  utils::File::ListDirectory(
+    directory, 
+    L"*", 
+    1024, 
+    [&entries](const utils::File::DirectoryEntries& page, bool /*last*/) {
+      entries.insert(entries.end(), page.begin(), page.end());
+      return true;
+    });
+
+  utils::File::DirectoryEntries::const_iterator iter = entries.begin();
+  for (; iter != entries.end(); ++iter) {
+    std::wstring path = 
+      directory + utils::File::kPathSeparator + 
+      utils::Encoders::utf8_decode(iter->name);
+
+    if (iter->is_directory && !iter->is_link) {
+      RemoveTree(path);
+      continue;
+    }
+
+#ifdef _WIN32
+    _wunlink(path.c_str());
+#else
+    unlink(utils::Encoders::utf8_encode(path).c_str());
+#endif
+  }
+
+#ifdef _WIN32
+  _wrmdir(directory.c_str());
+#else
+  rmdir(utils::Encoders::utf8_encode(directory).c_str());
+#endif
+}
\ No newline at end of file
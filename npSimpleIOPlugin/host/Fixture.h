@@ -0,0 +1,55 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef HOST_FIXTURE_H_
+#define HOST_FIXTURE_H_
+
+#include <string>
+#include <vector>
+#include "utils/Platform.h"
+
+namespace host {
+
+// The files the end to end scenarios work on - created under a new temp 
+// directory and removed (with whatever the plugin wrote there) on 
+// destruction. On POSIX, XDG_DATA_HOME is pointed into it as well so 
+// writeLocalAppDataFile and readLines' index stay out of the user's files.
+//
+// Paths are UTF8 with the native separator (what script passes).
+class Fixture {
+public:
+  Fixture();
+  virtual ~Fixture();
+
+public:
+  // call before |FakeBrowser::Load| (the plugin reads its folders once)
+  bool Create(bool quick);
+
+  const std::string& root() const;
+
+  // |relative| uses '/'
+  std::string Path(const std::string& relative) const;
+
+  bool WriteFile(const std::string& relative, const std::string& content);
+  bool AppendFile(const std::string& relative, const std::string& content);
+  bool MakeDirectory(const std::string& relative);
+  bool RemoveFile(const std::string& relative);
+
+  // the files of the "tree" directory (relative to root)
+  const std::vector<std::string>& tree_files() const;
+  
+  // a line that appears once in every file of the tree
+  static const char* tree_needle();
+
+private:
+  static void RemoveTree(const std::wstring& directory);
+
+private:
+  std::string root_;
+  std::vector<std::string> tree_files_;
+};
+
+}; // namespace host
+
+#endif // HOST_FIXTURE_H_
\ No newline at end of file
@@ -0,0 +1,217 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#include "ScriptObjects.h"
+#include "FakeBrowser.h"
+#include "benchmarks/benchmark.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+
+using namespace host;
+
+namespace {
+
+std::string VariantToString(const NPVariant& variant) {
+  char buffer[64];
+
+  switch (variant.type) {
+  case NPVariantType_Bool:
+    return NPVARIANT_TO_BOOLEAN(variant) ? "true" : "false";
+  case NPVariantType_Int32:
+    sprintf(buffer, "%d", (int)NPVARIANT_TO_INT32(variant));
+    return buffer;
+  case NPVariantType_Double:
+    sprintf(buffer, "%.17g", NPVARIANT_TO_DOUBLE(variant));
+    return buffer;
+  case NPVariantType_String:
+    return std::string(
+      NPVARIANT_TO_STRING(variant).UTF8Characters, 
+      std::min<size_t>(
+        NPVARIANT_TO_STRING(variant).UTF8Length, 
+        RecordingCallback::kMaxRecordedLength));
+  case NPVariantType_Null:
+    return "null";
+  default:
+    return "";
+  }
+}
+
+}; // namespace
+
+DECLARE_NPOBJECT_CLASS_WITH_BASE(
+  RecordingCallback, 
+  AllocateNpObject<RecordingCallback>);
+
+DECLARE_NPOBJECT_CLASS_WITH_BASE(
+  ScriptObject, 
+  AllocateNpObject<ScriptObject>);
+
+//-----------------------------------------------------------------------------
+RecordingCallback::RecordingCallback(NPP npp) :
+  nsScriptableObjectBase(npp),
+  completed_(false) {
+}
+
+RecordingCallback::~RecordingCallback() {
+}
+
+// static
+RecordingCallback* RecordingCallback::Create(NPP npp) {
+  return static_cast<RecordingCallback*>(
+    NPN_CreateObject(npp, GET_NPOBJECT_CLASS(RecordingCallback)));
+}
+
+// virtual
+bool RecordingCallback::InvokeDefault(
+  const NPVariant *args, 
+  uint32_t argCount,
+  NPVariant *result) {
+
+  Call call;
+  call.time = benchmarks::Stopwatch::Now();
+  call.bytes = 0;
+  call.newlines = 0;
+  for (uint32_t i = 0; i < argCount; i++) {
+    call.args.push_back(VariantToString(args[i]));
+
+    if (NPVARIANT_IS_STRING(args[i])) {
+      const NPString& value = NPVARIANT_TO_STRING(args[i]);
+      call.bytes += value.UTF8Length;
+      call.newlines += std::count(
+        value.UTF8Characters, 
+        value.UTF8Characters + value.UTF8Length, 
+        '\n');
+    }
+  }
+
+  bool failed = 
+    (argCount > 0) && NPVARIANT_IS_BOOLEAN(args[0]) && 
+    !NPVARIANT_TO_BOOLEAN(args[0]);
+  bool done = 
+    (argCount < 3) || 
+    (NPVARIANT_IS_BOOLEAN(args[2]) && NPVARIANT_TO_BOOLEAN(args[2]));
+
+  utils::CriticalSectionLock lock(critical_section_);
+  calls_.push_back(call);
+  completed_ = completed_ || failed || done;
+
+  VOID_TO_NPVARIANT(*result);
+  return true;
+}
+
+size_t RecordingCallback::calls_count() {
+  utils::CriticalSectionLock lock(critical_section_);
+  return calls_.size();
+}
+
+RecordingCallback::Call RecordingCallback::call(size_t index) {
+  utils::CriticalSectionLock lock(critical_section_);
+  return calls_[index];
+}
+
+void RecordingCallback::Clear() {
+  utils::CriticalSectionLock lock(critical_section_);
+  calls_.clear();
+  completed_ = false;
+}
+
+bool RecordingCallback::completed() {
+  utils::CriticalSectionLock lock(critical_section_);
+  return completed_;
+}
+
+//-----------------------------------------------------------------------------
+ScriptObject::ScriptObject(NPP npp) : nsScriptableObjectBase(npp) {
+}
+
+ScriptObject::~ScriptObject() {
+}
+
+// static
+ScriptObject* ScriptObject::Create(NPP npp) {
+  return static_cast<ScriptObject*>(
+    NPN_CreateObject(npp, GET_NPOBJECT_CLASS(ScriptObject)));
+}
+
+// static
+ScriptObject* ScriptObject::CreateArray(
+  NPP npp, 
+  const std::vector<std::string>& items) {
+
+  ScriptObject* array = Create(npp);
+  if (nullptr == array) {
+    return nullptr;
+  }
+
+  char index[16];
+  for (size_t i = 0; i < items.size(); i++) {
+    sprintf(index, "%u", (unsigned int)i);
+    array->SetString(index, items[i]);
+  }
+
+  array->SetNumber("length", (double)items.size());
+  return array;
+}
+
+void ScriptObject::SetString(
+  const std::string& name, 
+  const std::string& value) {
+
+  Value& ref_value = properties_[name];
+  ref_value.type = NPVariantType_String;
+  ref_value.string = value;
+}
+
+void ScriptObject::SetNumber(const std::string& name, double value) {
+  Value& ref_value = properties_[name];
+  ref_value.type = NPVariantType_Double;
+  ref_value.number = value;
+}
+
+void ScriptObject::SetBool(const std::string& name, bool value) {
+  Value& ref_value = properties_[name];
+  ref_value.type = NPVariantType_Bool;
+  ref_value.boolean = value;
+}
+
+// virtual
+bool ScriptObject::HasProperty(NPIdentifier name) {
+  std::string property_name = FakeBrowser::Get()->IdentifierName(name);
+  return properties_.end() != properties_.find(property_name);
+}
+
+// virtual
+bool ScriptObject::GetProperty(NPIdentifier name, NPVariant *result) {
+  std::string property_name = FakeBrowser::Get()->IdentifierName(name);
+  std::map<std::string, Value>::const_iterator iter = 
+    properties_.find(property_name);
+  if (properties_.end() == iter) {
+    VOID_TO_NPVARIANT(*result);
+    return false;
+  }
+
+  const Value& value = iter->second;
+  switch (value.type) {
+  case NPVariantType_String: {
+    // the caller frees it with NPN_ReleaseVariantValue
+    NPUTF8* copy = (NPUTF8*)NPN_MemAlloc((uint32_t)value.string.size() + 1);
+    memcpy(copy, value.string.c_str(), value.string.size() + 1);
+    STRINGN_TO_NPVARIANT(copy, (uint32_t)value.string.size(), *result);
+    break;
+  }
+  case NPVariantType_Double:
+    DOUBLE_TO_NPVARIANT(value.number, *result);
+    break;
+  case NPVariantType_Bool:
+    BOOLEAN_TO_NPVARIANT(value.boolean, *result);
+    break;
+  default:
+    VOID_TO_NPVARIANT(*result);
+    break;
+  }
+
+  return true;
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef HOST_SCRIPT_OBJECTS_H_
+#define HOST_SCRIPT_OBJECTS_H_
+
+#include <map>
+#include <string>
+#include <vector>
+#include "nsScriptableObjectBase.h"
+#include "utils/CriticalSectionLock.h"
+
+namespace host {
+
+// The script side of a call: a function passed as a callback that records 
+// every call it gets (on the main thread)
+class RecordingCallback : public nsScriptableObjectBase {
+public:
+  struct Call {
+    double time; // benchmarks::Stopwatch::Now()
+
+    // strings/numbers/booleans as text - strings are cut after 
+    // |kMaxRecordedLength| bytes (results may be megabytes)
+    std::vector<std::string> args;
+    size_t bytes; // of all the string arguments, in full
+    size_t newlines; // in all the string arguments, in full
+  };
+
+  static const size_t kMaxRecordedLength = 256;
+
+  RecordingCallback(NPP npp);
+  virtual ~RecordingCallback();
+
+  // a new callback with a reference count of 1 (release with 
+  // NPN_ReleaseObject)
+  static RecordingCallback* Create(NPP npp);
+
+public:
+  virtual bool InvokeDefault(
+    const NPVariant *args, 
+    uint32_t argCount,
+    NPVariant *result);
+
+  size_t calls_count();
+  Call call(size_t index);
+  void Clear();
+
+  // a result was delivered in full: the call was a failure, or it had no 
+  // |done| argument (single callback methods), or |done| was true (paged 
+  // methods like listDirectory)
+  bool completed();
+
+private:
+  utils::CriticalSection critical_section_;
+  std::vector<Call> calls_;
+  bool completed_;
+};
+
+// A plain script object ({...} or [...]) for options and array arguments
+class ScriptObject : public nsScriptableObjectBase {
+public:
+  ScriptObject(NPP npp);
+  virtual ~ScriptObject();
+
+  static ScriptObject* Create(NPP npp);
+  static ScriptObject* CreateArray(
+    NPP npp, 
+    const std::vector<std::string>& items);
+
+public:
+  void SetString(const std::string& name, const std::string& value);
+  void SetNumber(const std::string& name, double value);
+  void SetBool(const std::string& name, bool value);
+
+  virtual bool HasProperty(NPIdentifier name);
+  virtual bool GetProperty(NPIdentifier name, NPVariant *result);
+
+private:
+  struct Value {
+    NPVariantType type;
+    std::string string;
+    double number;
+    bool boolean;
+  };
+
+  std::map<std::string, Value> properties_;
+};
+
+}; // namespace host
+
+#endif // HOST_SCRIPT_OBJECTS_H_
\ No newline at end of file
@@ -0,0 +1,1358 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#include "host_benchmarks.h"
+#include "FakeBrowser.h"
+#include "Fixture.h"
+#include "ScriptObjects.h"
+#include "utils/Encoders.h"
+#include "utils/File.h"
+
+#include <algorithm>
+#include <deque>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+using namespace benchmarks;
+using namespace host;
+
+namespace {
+
+// see |RegisterHostBenchmarks|
+FakeBrowser* current_browser = nullptr;
+Fixture* current_fixture = nullptr;
+
+const size_t kConcurrentCalls = 32;
+const size_t kStressConcurrentCalls = 64;
+
+// calls still pending after this long without any completing are stuck
+const double kStuckSeconds = 60;
+
+// the main thread's wait for posted calls (per loop iteration)
+const DWORD kRunPendingWaitMs = 5;
+
+const char kLocalAppDataFile[] = "simpleio_host_bench.txt";
+
+// The arguments of a single call - owns the strings and the objects it 
+// creates (released on destruction, after the call returned)
+class CallArgs {
+public:
+  CallArgs() {
+  }
+
+  ~CallArgs() {
+    for (size_t i = 0; i < objects_.size(); i++) {
+      NPN_ReleaseObject(objects_[i]);
+    }
+  }
+
+  void AddString(const std::string& value) {
+    strings_.push_back(value);
+
+    NPVariant variant;
+    STRINGN_TO_NPVARIANT(
+      strings_.back().c_str(), 
+      (uint32_t)strings_.back().size(), 
+      variant);
+    args_.push_back(variant);
+  }
+
+  void AddNumber(double value) {
+    NPVariant variant;
+    DOUBLE_TO_NPVARIANT(value, variant);
+    args_.push_back(variant);
+  }
+
+  void AddBool(bool value) {
+    NPVariant variant;
+    BOOLEAN_TO_NPVARIANT(value, variant);
+    args_.push_back(variant);
+  }
+
+  void AddNull() {
+    NPVariant variant;
+    NULL_TO_NPVARIANT(variant);
+    args_.push_back(variant);
+  }
+
+  // not owned (e.g. the callback)
+  void AddObject(NPObject* object) {
+    NPVariant variant;
+    OBJECT_TO_NPVARIANT(object, variant);
+    args_.push_back(variant);
+  }
+
+  ScriptObject* AddOptions() {
+    ScriptObject* options = ScriptObject::Create(current_browser->npp());
+    objects_.push_back(options);
+    AddObject(options);
+    return options;
+  }
+
+  void AddArray(const std::vector<std::string>& items) {
+    ScriptObject* array = 
+      ScriptObject::CreateArray(current_browser->npp(), items);
+    objects_.push_back(array);
+    AddObject(array);
+  }
+
+  const NPVariant* args() const {
+    return args_.empty() ? nullptr : &args_[0];
+  }
+
+  uint32_t count() const {
+    return (uint32_t)args_.size();
+  }
+
+private:
+  std::deque<std::string> strings_;
+  std::vector<NPVariant> args_;
+  std::vector<NPObject*> objects_;
+};
+
+typedef void (*BuildArgsFunc)(CallArgs& ref_args, NPObject* callback);
+
+struct Scenario {
+  const char* method;
+  const char* variant;
+  size_t calls; // see |Runner::Scale|
+  BuildArgsFunc build;
+};
+
+//-----------------------------------------------------------------------------
+void BuildFileExists(CallArgs& ref_args, NPObject* callback) {
+  ref_args.AddString(current_fixture->Path("small.txt"));
+  ref_args.AddObject(callback);
+}
+
+void BuildIsDirectory(CallArgs& ref_args, NPObject* callback) {
+  ref_args.AddString(current_fixture->Path("tree"));
+  ref_args.AddObject(callback);
+}
+
+void BuildGetTextFileSmall(CallArgs& ref_args, NPObject* callback) {
+  ref_args.AddString(current_fixture->Path("small.txt"));
+  ref_args.AddBool(false);
+  ref_args.AddObject(callback);
+}
+
+void BuildGetTextFileLarge(CallArgs& ref_args, NPObject* callback) {
+  ref_args.AddString(current_fixture->Path("large.txt"));
+  ref_args.AddBool(false);
+  ref_args.AddObject(callback);
+}
+
+void BuildGetBinaryFile(CallArgs& ref_args, NPObject* callback) {
+  ref_args.AddString(current_fixture->Path("binary.bin"));
+  ref_args.AddNumber(-1);
+  ref_args.AddObject(callback);
+}
+
+void BuildGetLastLines(CallArgs& ref_args, NPObject* callback) {
+  ref_args.AddString(current_fixture->Path("large.txt"));
+  ref_args.AddNumber(200);
+  ref_args.AddObject(callback);
+}
+
+void BuildReadLines(CallArgs& ref_args, NPObject* callback) {
+  // spread over the first few thousand lines (the index is built once)
+  static unsigned int call = 0;
+  call++;
+
+  ref_args.AddString(current_fixture->Path("large.txt"));
+  ref_args.AddNumber(1 + (call * 7919) % 4000);
+  ref_args.AddNumber(100);
+  ref_args.AddObject(callback);
+}
+
+void BuildWriteLocalAppDataFile(CallArgs& ref_args, NPObject* callback) {
+  static const std::string content = GenerateText(4 * 1024, true);
+
+  ref_args.AddString(kLocalAppDataFile);
+  ref_args.AddString(content);
+  ref_args.AddObject(callback);
+}
+
+void BuildListDirectory(CallArgs& ref_args, NPObject* callback) {
+  ref_args.AddString(current_fixture->Path("tree/d0/s0"));
+  ref_args.AddNull();
+  ref_args.AddObject(callback);
+}
+
+void BuildListDirectoryPaged(CallArgs& ref_args, NPObject* callback) {
+  ref_args.AddString(current_fixture->Path("tree/d0/s0"));
+  ScriptObject* options = ref_args.AddOptions();
+  options->SetString("filter", "*.log");
+  options->SetNumber("pageSize", 2);
+  ref_args.AddObject(callback);
+}
+
+void BuildFindFiles(CallArgs& ref_args, NPObject* callback) {
+  std::vector<std::string> globs;
+  globs.push_back("*.log");
+
+  ref_args.AddString(current_fixture->Path("tree"));
+  ref_args.AddArray(globs);
+  ref_args.AddNumber(-1);
+  ref_args.AddObject(callback);
+}
+
+void BuildSearchFiles(CallArgs& ref_args, NPObject* callback) {
+  ref_args.AddString(current_fixture->Path("tree"));
+  ref_args.AddString(Fixture::tree_needle());
+  ScriptObject* options = ref_args.AddOptions();
+  options->SetString("glob", "*.log");
+  ref_args.AddObject(callback);
+}
+
+void BuildHashFile(CallArgs& ref_args, NPObject* callback) {
+  ref_args.AddString(current_fixture->Path("large.txt"));
+  ref_args.AddString("xxh64");
+  ref_args.AddObject(callback);
+}
+
+void BuildHashFileSha256(CallArgs& ref_args, NPObject* callback) {
+  ref_args.AddString(current_fixture->Path("small.txt"));
+  ref_args.AddString("sha256");
+  ref_args.AddObject(callback);
+}
+
+void BuildHashFiles(CallArgs& ref_args, NPObject* callback) {
+  const std::vector<std::string>& tree_files = current_fixture->tree_files();
+
+  std::vector<std::string> paths;
+  for (size_t i = 0; (i < tree_files.size()) && (i < 32); i++) {
+    paths.push_back(current_fixture->Path(tree_files[i]));
+  }
+
+  ref_args.AddArray(paths);
+  ref_args.AddString("crc32c");
+  ref_args.AddObject(callback);
+}
+
+const Scenario kScenarios[] = {
+  { "fileExists", "exists", 20000, BuildFileExists },
+  { "isDirectory", "directory", 20000, BuildIsDirectory },
+  { "getTextFile", "4kb", 5000, BuildGetTextFileSmall },
+  { "getTextFile", "large", 40, BuildGetTextFileLarge },
+  { "getBinaryFile", "64kb", 400, BuildGetBinaryFile },
+  { "getLastLines", "200_lines", 2000, BuildGetLastLines },
+  { "readLines", "100_lines", 2000, BuildReadLines },
+  { "writeLocalAppDataFile", "4kb", 2000, BuildWriteLocalAppDataFile },
+  { "listDirectory", "8_entries", 2000, BuildListDirectory },
+  { "listDirectory", "paged", 2000, BuildListDirectoryPaged },
+  { "findFiles", "256_files", 400, BuildFindFiles },
+  { "searchFiles", "256_files", 200, BuildSearchFiles },
+  { "hashFile", "xxh64_large", 40, BuildHashFile },
+  { "hashFile", "sha256_4kb", 2000, BuildHashFileSha256 },
+  { "hashFiles", "crc32c_32_files", 400, BuildHashFiles }
+};
+
+const size_t kScenariosCount = sizeof(kScenarios) / sizeof(kScenarios[0]);
+
+//-----------------------------------------------------------------------------
+struct MemorySnapshot {
+  FakeBrowser::MemoryStats npn;
+  unsigned __int64 rss;
+};
+
+MemorySnapshot TakeMemorySnapshot() {
+  MemorySnapshot snapshot;
+  snapshot.npn = current_browser->memory_stats();
+  snapshot.rss = FakeBrowser::ProcessMemoryBytes();
+  return snapshot;
+}
+
+// what the calls since |before| left behind - NPN memory and objects should
+// go back to where they were once every callback ran
+void AddMemoryMetrics(
+  const MemorySnapshot& before, 
+  size_t calls, 
+  Result& ref_result) {
+
+  MemorySnapshot after = TakeMemorySnapshot();
+  double per_call = (calls > 0) ? (1.0 / calls) : 0;
+
+  ref_result.metrics.push_back(std::make_pair(
+    "npn_allocs_per_call", 
+    (after.npn.allocations - before.npn.allocations) * per_call));
+  ref_result.metrics.push_back(std::make_pair(
+    "npn_peak_kb", 
+    after.npn.peak_bytes / 1024.0));
+  ref_result.metrics.push_back(std::make_pair(
+    "npn_leaked_bytes", 
+    (double)(after.npn.live_bytes - before.npn.live_bytes)));
+  ref_result.metrics.push_back(std::make_pair(
+    "leaked_objects", 
+    (double)(after.npn.live_objects - before.npn.live_objects)));
+  ref_result.metrics.push_back(std::make_pair(
+    "rss_delta_kb", 
+    ((double)after.rss - (double)before.rss) / 1024.0));
+}
+
+struct DriveStats {
+  DriveStats() :
+    calls(0),
+    failures(0),
+    exceptions(0),
+    stuck(0),
+    callbacks(0),
+    async_calls(0),
+    bytes(0) {
+  }
+
+  size_t calls;
+  size_t failures; // status false
+  size_t exceptions; // invoke failed (NPN_SetException)
+  size_t stuck; // never got their final callback
+  size_t callbacks;
+  unsigned __int64 async_calls; // main thread wake ups
+  unsigned __int64 bytes; // of results
+
+  // call to final callback
+  std::vector<double> latencies_us;
+};
+
+// Issues the calls |next| returns (until it returns nullptr) with up to 
+// |window| of them in flight, running the main thread until all completed
+void Drive(
+  const std::function<const Scenario*()>& next, 
+  size_t window, 
+  DriveStats& ref_stats) {
+
+  struct Pending {
+    RecordingCallback* callback;
+    double start;
+  };
+
+  std::vector<Pending> pending;
+  bool issuing = true;
+  Stopwatch since_completion;
+  unsigned __int64 async_calls_start = current_browser->async_calls_count();
+
+  while (issuing || !pending.empty()) {
+    while (issuing && (pending.size() < window)) {
+      const Scenario* scenario = next();
+      if (nullptr == scenario) {
+        issuing = false;
+        break;
+      }
+
+      RecordingCallback* callback = 
+        RecordingCallback::Create(current_browser->npp());
+      CallArgs args;
+      scenario->build(args, callback);
+
+      Pending call;
+      call.callback = callback;
+      call.start = Stopwatch::Now();
+      ref_stats.calls++;
+
+      NPVariant result;
+      if (!current_browser->Invoke(
+            scenario->method, 
+            args.args(), 
+            args.count(), 
+            &result)) {
+        std::string exception = current_browser->TakeException();
+        if (0 == ref_stats.exceptions++) {
+          fprintf(stderr, "%s threw: %s\n", scenario->method, 
+                  exception.c_str());
+        }
+
+        NPN_ReleaseObject(callback);
+        continue;
+      }
+
+      NPN_ReleaseVariantValue(&result);
+      pending.push_back(call);
+    }
+
+    current_browser->RunPending(kRunPendingWaitMs);
+
+    for (size_t i = 0; i < pending.size(); ) {
+      RecordingCallback* callback = pending[i].callback;
+      if (!callback->completed()) {
+        i++;
+        continue;
+      }
+
+      size_t calls_count = callback->calls_count();
+      for (size_t call = 0; call < calls_count; call++) {
+        ref_stats.bytes += callback->call(call).bytes;
+      }
+
+      RecordingCallback::Call last = callback->call(calls_count - 1);
+      ref_stats.latencies_us.push_back((last.time - pending[i].start) * 1e6);
+      ref_stats.callbacks += calls_count;
+      if (last.args.empty() || ("true" != last.args[0])) {
+        ref_stats.failures++;
+      }
+
+      NPN_ReleaseObject(callback);
+      pending[i] = pending.back();
+      pending.pop_back();
+
+      since_completion.Restart();
+    }
+
+    if (!pending.empty() && (since_completion.Elapsed() > kStuckSeconds)) {
+      // the plugin may still call them - so they're left alive
+      ref_stats.stuck += pending.size();
+      break;
+    }
+  }
+
+  ref_stats.async_calls += 
+    current_browser->async_calls_count() - async_calls_start;
+}
+
+void AddDriveMetrics(const DriveStats& stats, Result& ref_result) {
+  size_t completed = stats.latencies_us.size();
+
+  ref_result.metrics.push_back(std::make_pair(
+    "failures", 
+    (double)stats.failures));
+  ref_result.metrics.push_back(std::make_pair(
+    "exceptions", 
+    (double)stats.exceptions));
+  ref_result.metrics.push_back(std::make_pair(
+    "stuck", 
+    (double)stats.stuck));
+  ref_result.metrics.push_back(std::make_pair(
+    "callbacks_per_call", 
+    (completed > 0) ? ((double)stats.callbacks / completed) : 0));
+  ref_result.metrics.push_back(std::make_pair(
+    "wakeups_per_call", 
+    (completed > 0) ? ((double)stats.async_calls / completed) : 0));
+}
+
+void RunScenario(Runner& runner, const Scenario& scenario, size_t window) {
+  size_t count = std::max<size_t>(runner.Scale(scenario.calls), 1);
+  size_t issued = 0;
+
+  current_browser->ResetPeakMemory();
+  MemorySnapshot before = TakeMemorySnapshot();
+
+  DriveStats stats;
+  Stopwatch stopwatch;
+  Drive(
+    [&]() -> const Scenario* {
+      return (issued++ < count) ? &scenario : nullptr;
+    }, 
+    window, 
+    stats);
+
+  Result result;
+  result.seconds = stopwatch.Elapsed();
+  result.benchmark = std::string("e2e_") + scenario.method;
+
+  char variant[64];
+  sprintf(variant, "%s_x%u", scenario.variant, (unsigned int)window);
+  result.variant = variant;
+
+  result.items = stats.calls;
+  result.bytes = stats.bytes;
+  AddDriveMetrics(stats, result);
+  result.latencies_us.swap(stats.latencies_us);
+  AddMemoryMetrics(before, stats.calls, result);
+
+  runner.Report(result);
+}
+
+// all the scenarios of |method|, one call at a time and then concurrently
+void RunMethodScenarios(Runner& runner, const std::string& method) {
+  for (size_t i = 0; i < kScenariosCount; i++) {
+    if (method != kScenarios[i].method) {
+      continue;
+    }
+
+    RunScenario(runner, kScenarios[i], 1);
+    RunScenario(runner, kScenarios[i], kConcurrentCalls);
+  }
+
+  if (method == "writeLocalAppDataFile") {
+    std::wstring path = 
+      utils::File::GetSpecialFolderWide(CSIDL_LOCAL_APPDATA) + 
+      utils::File::kPathSeparator + 
+      utils::Encoders::utf8_decode(kLocalAppDataFile);
+#ifdef _WIN32
+    _wunlink(path.c_str());
+#else
+    unlink(utils::Encoders::utf8_encode(path).c_str());
+#endif
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Synchronous methods - what a call costs the (blocked) main thread
+void RunSyncCalls(
+  Runner& runner, 
+  const char* method, 
+  const char* variant, 
+  size_t calls) {
+
+  size_t count = std::max<size_t>(runner.Scale(calls), 1);
+
+  Result result;
+  result.benchmark = std::string("e2e_") + method;
+  result.variant = variant;
+  result.latencies_us.reserve(count);
+
+  current_browser->ResetPeakMemory();
+  MemorySnapshot before = TakeMemorySnapshot();
+
+  Stopwatch total;
+  for (size_t i = 0; i < count; i++) {
+    NPVariant value;
+    Stopwatch stopwatch;
+    if (!current_browser->Invoke(method, nullptr, 0, &value)) {
+      fprintf(stderr, "%s threw: %s\n", method, 
+              current_browser->TakeException().c_str());
+      return;
+    }
+    result.latencies_us.push_back(stopwatch.Elapsed() * 1e6);
+
+    if (NPVARIANT_IS_STRING(value)) {
+      result.bytes += NPVARIANT_TO_STRING(value).UTF8Length;
+    }
+    NPN_ReleaseVariantValue(&value);
+  }
+  result.seconds = total.Elapsed();
+  result.items = count;
+
+  AddMemoryMetrics(before, count, result);
+  runner.Report(result);
+}
+
+void BenchmarkGetStats(Runner& runner) {
+  RunSyncCalls(runner, "getStats", "all_methods", 20000);
+}
+
+// what the browser does for every call from script before the method runs:
+// hasMethod + invoke (the identifiers are resolved up front, as browsers
+// cache them) - "has_method" looks up every method in turn, "sync_method" 
+// calls one that does (next to) nothing
+void BenchmarkDispatch(Runner& runner) {
+  const char* kMethods[] = { 
+    "fileExists", "getTextFile", "readLines", "hashFiles", "listenOnFile", 
+    "stopFileListen", "watchDirectory", "getStats", "stopTracing" 
+  };
+  const size_t kMethodsCount = sizeof(kMethods) / sizeof(kMethods[0]);
+
+  NPObject* plugin = current_browser->plugin();
+  std::vector<NPIdentifier> identifiers;
+  for (size_t i = 0; i < kMethodsCount; i++) {
+    identifiers.push_back(NPN_GetStringIdentifier(kMethods[i]));
+  }
+
+  size_t count = runner.Scale(2000000);
+
+  for (int variant = 0; variant < 2; variant++) {
+    Result result;
+    result.benchmark = "e2e_dispatch";
+    result.variant = (0 == variant) ? "has_method" : "sync_method";
+    result.items = count;
+
+    NPIdentifier stop_tracing = identifiers.back();
+    size_t found = 0;
+    Stopwatch stopwatch;
+    for (size_t i = 0; i < count; i++) {
+      if (0 == variant) {
+        found += plugin->_class->hasMethod(
+          plugin, identifiers[i % kMethodsCount]) ? 1 : 0;
+        continue;
+      }
+
+      NPVariant value;
+      if (plugin->_class->hasMethod(plugin, stop_tracing) &&
+          plugin->_class->invoke(plugin, stop_tracing, nullptr, 0, &value)) {
+        found++;
+        NPN_ReleaseVariantValue(&value);
+      }
+    }
+    result.seconds = stopwatch.Elapsed();
+
+    if (found != count) {
+      fprintf(stderr, "dispatch: %u of %u calls failed\n", 
+              (unsigned int)(count - found), (unsigned int)count);
+      return;
+    }
+
+    runner.Report(result);
+  }
+}
+
+// getTrace of a trace full of fileExists spans
+void BenchmarkGetTrace(Runner& runner) {
+  NPVariant value;
+  if (!current_browser->Invoke("startTracing", nullptr, 0, &value)) {
+    return;
+  }
+  NPN_ReleaseVariantValue(&value);
+
+  size_t count = runner.Scale(4000);
+  size_t issued = 0;
+  DriveStats stats;
+  Drive(
+    [&]() -> const Scenario* {
+      return (issued++ < count) ? &kScenarios[0] : nullptr;
+    }, 
+    kConcurrentCalls, 
+    stats);
+
+  current_browser->Invoke("stopTracing", nullptr, 0, &value);
+  NPN_ReleaseVariantValue(&value);
+
+  char variant[64];
+  sprintf(variant, "%u_calls", (unsigned int)count);
+  RunSyncCalls(runner, "getTrace", variant, 400);
+}
+
+//-----------------------------------------------------------------------------
+// getTextFile calls of the large file, cancelled right after they were made
+// - |window| of them at a time (the rest of a window is still queued when
+// it's cancelled). The latency is the first call to the callback of a 
+// fileExists made after the cancels - when the worker thread is free again.
+void RunCancel(Runner& runner, const char* variant, size_t window) {
+  struct Call {
+    RecordingCallback* callback;
+    bool cancelled; // cancel returned true
+  };
+
+  size_t rounds = std::max<size_t>(runner.Scale(40), 1);
+
+  current_browser->ResetPeakMemory();
+  MemorySnapshot before = TakeMemorySnapshot();
+  unsigned __int64 async_calls_start = current_browser->async_calls_count();
+
+  Result result;
+  result.benchmark = "e2e_cancel";
+  result.variant = variant;
+
+  std::vector<Call> calls;
+  size_t exceptions = 0;
+  size_t stuck = 0;
+  Stopwatch stopwatch;
+  for (size_t round = 0; round < rounds; round++) {
+    double start = Stopwatch::Now();
+
+    std::vector<NPVariant> ids;
+    for (size_t i = 0; i < window; i++) {
+      Call call;
+      call.callback = RecordingCallback::Create(current_browser->npp());
+      call.cancelled = false;
+
+      CallArgs args;
+      BuildGetTextFileLarge(args, call.callback);
+
+      NPVariant id;
+      if (!current_browser->Invoke("getTextFile", args.args(), args.count(), 
+                                   &id)) {
+        current_browser->TakeException();
+        exceptions++;
+        NPN_ReleaseObject(call.callback);
+        continue;
+      }
+
+      calls.push_back(call);
+      ids.push_back(id);
+    }
+
+    for (size_t i = 0; i < ids.size(); i++) {
+      NPVariant value;
+      if (!current_browser->Invoke("cancel", &ids[i], 1, &value)) {
+        current_browser->TakeException();
+        exceptions++;
+        continue;
+      }
+
+      calls[calls.size() - ids.size() + i].cancelled = 
+        NPVARIANT_IS_BOOLEAN(value) && NPVARIANT_TO_BOOLEAN(value);
+      NPN_ReleaseVariantValue(&value);
+    }
+
+    RecordingCallback* barrier = 
+      RecordingCallback::Create(current_browser->npp());
+    CallArgs args;
+    BuildFileExists(args, barrier);
+
+    NPVariant id;
+    if (current_browser->Invoke("fileExists", args.args(), args.count(), 
+                                &id)) {
+      NPN_ReleaseVariantValue(&id);
+
+      if (current_browser->RunUntil(
+            [&]() {
+              return barrier->completed();
+            }, 
+            10000)) {
+        result.latencies_us.push_back((Stopwatch::Now() - start) * 1e6);
+      } else {
+        stuck++;
+      }
+    } else {
+      current_browser->TakeException();
+      exceptions++;
+    }
+
+    NPN_ReleaseObject(barrier);
+  }
+  result.seconds = stopwatch.Elapsed();
+  result.items = calls.size();
+
+  // a cancelled call never calls back
+  size_t cancelled = 0;
+  size_t cancelled_callbacks = 0;
+  for (size_t i = 0; i < calls.size(); i++) {
+    if (calls[i].cancelled) {
+      cancelled++;
+      cancelled_callbacks += calls[i].callback->calls_count();
+    }
+    NPN_ReleaseObject(calls[i].callback);
+  }
+
+  result.metrics.push_back(std::make_pair("cancelled", (double)cancelled));
+  result.metrics.push_back(std::make_pair(
+    "cancelled_callbacks", 
+    (double)cancelled_callbacks));
+  result.metrics.push_back(std::make_pair("exceptions", (double)exceptions));
+  result.metrics.push_back(std::make_pair("stuck", (double)stuck));
+  result.metrics.push_back(std::make_pair(
+    "wakeups_per_round", 
+    (double)(current_browser->async_calls_count() - async_calls_start) / 
+      rounds));
+
+  AddMemoryMetrics(before, calls.size(), result);
+  runner.Report(result);
+}
+
+void BenchmarkCancel(Runner& runner) {
+  RunCancel(runner, "single", 1);
+
+  char variant[64];
+  sprintf(variant, "queued_x%u", (unsigned int)kConcurrentCalls);
+  RunCancel(runner, variant, kConcurrentCalls);
+}
+
+//-----------------------------------------------------------------------------
+// stopFileListen, and our reference to |callback| - the plugin lets go of its
+// own once the lines before the stop were delivered (and the objects are 
+// back to |before|)
+void StopFileListen(RecordingCallback* callback, const MemorySnapshot& before) {
+  NPVariant value;
+  current_browser->Invoke("stopFileListen", nullptr, 0, &value);
+  NPN_ReleaseVariantValue(&value);
+
+  NPN_ReleaseObject(callback);
+
+  current_browser->RunUntil(
+    [&]() {
+      return (current_browser->memory_stats().live_objects <= 
+              before.npn.live_objects);
+    }, 
+    1000);
+}
+
+// A log written in batches while listened on - lines/s and write to 
+// callback latency (per line). |interval_ms| > 0 paces the deliveries 
+// (deliveryIntervalMs) - lines are then joined into one callback per interval.
+void RunListenOnFile(Runner& runner, const char* variant, double interval_ms) {
+  const size_t kLinesPerBatch = 50;
+  size_t batches = runner.Scale(400);
+
+  if (!current_fixture->WriteFile("log.txt", "")) {
+    return;
+  }
+
+  // taken before the callback exists - the plugin has to let go of it once
+  // the listen is stopped
+  current_browser->ResetPeakMemory();
+  MemorySnapshot before = TakeMemorySnapshot();
+
+  RecordingCallback* callback = 
+    RecordingCallback::Create(current_browser->npp());
+
+  // the options object goes with |args|
+  {
+    CallArgs args;
+    args.AddString(current_fixture->Path("log.txt"));
+    args.AddBool(false);
+    args.AddObject(callback);
+    if (interval_ms > 0) {
+      args.AddOptions()->SetNumber("deliveryIntervalMs", interval_ms);
+    }
+
+    NPVariant value;
+    if (!current_browser->Invoke("listenOnFile", args.args(), args.count(), 
+                                 &value)) {
+      fprintf(stderr, "listenOnFile threw: %s\n", 
+              current_browser->TakeException().c_str());
+      NPN_ReleaseObject(callback);
+      return;
+    }
+    NPN_ReleaseVariantValue(&value);
+  }
+
+  std::string padding(80, 'x');
+  std::vector<double> written;
+  unsigned __int64 bytes = 0;
+
+  Stopwatch stopwatch;
+  for (size_t batch = 0; batch < batches; batch++) {
+    std::string lines;
+    char prefix[64];
+    for (size_t line = 0; line < kLinesPerBatch; line++) {
+      sprintf(prefix, "batch %u line %u ", (unsigned int)batch, 
+              (unsigned int)line);
+      lines += prefix;
+      lines += padding;
+      lines += '\n';
+    }
+
+    written.push_back(Stopwatch::Now());
+    current_fixture->AppendFile("log.txt", lines);
+    bytes += lines.size();
+
+    // ~200 batches/s (and whatever the main thread has to do)
+    current_browser->RunPending(kRunPendingWaitMs);
+  }
+
+  // every callback has a line more than it has '\n's
+  size_t lines = 0;
+  size_t counted_calls = 0;
+  auto count_lines = [&]() -> size_t {
+    for (; counted_calls < callback->calls_count(); counted_calls++) {
+      lines += callback->call(counted_calls).newlines + 1;
+    }
+    return lines;
+  };
+
+  size_t expected = batches * kLinesPerBatch;
+  bool completed = current_browser->RunUntil(
+    [&]() {
+      return count_lines() >= expected;
+    }, 
+    10000);
+
+  Result result;
+  result.seconds = stopwatch.Elapsed();
+  result.benchmark = "e2e_listenOnFile";
+  result.variant = variant;
+  result.bytes = bytes;
+  result.items = count_lines();
+
+  // the lag of the first line of every callback
+  for (size_t i = 0; i < callback->calls_count(); i++) {
+    RecordingCallback::Call call = callback->call(i);
+    unsigned int batch = 0;
+    if ((call.args.size() < 2) || 
+        (1 != sscanf(call.args[1].c_str(), "batch %u", &batch)) ||
+        (batch >= written.size())) {
+      continue;
+    }
+
+    result.latencies_us.push_back((call.time - written[batch]) * 1e6);
+  }
+
+  result.metrics.push_back(std::make_pair(
+    "lost_lines", 
+    completed ? 0.0 : (double)(expected - count_lines())));
+  result.metrics.push_back(std::make_pair(
+    "callbacks_per_s", 
+    callback->calls_count() / result.seconds));
+
+  StopFileListen(callback, before);
+
+  AddMemoryMetrics(before, expected, result);
+  runner.Report(result);
+}
+
+// A backlog script starts out far behind (a log listened on from its start)
+// - the time until the listener reports it caught up (lagBytes and 
+// pendingLines of 0), with |catch_up| "none", "batch" or "skip".
+void RunListenOnFileCatchUp(Runner& runner, const char* catch_up) {
+  const double kMaxLagBytes = 1024 * 1024;
+  size_t lines_count = runner.Scale(400000);
+
+  std::string content;
+  std::string padding(80, 'x');
+  char prefix[64];
+  for (size_t line = 0; line < lines_count; line++) {
+    sprintf(prefix, "line %u ", (unsigned int)line);
+    content += prefix;
+    content += padding;
+    content += '\n';
+  }
+
+  if (!current_fixture->WriteFile("backlog.txt", content)) {
+    return;
+  }
+
+  current_browser->ResetPeakMemory();
+  MemorySnapshot before = TakeMemorySnapshot();
+
+  RecordingCallback* callback = 
+    RecordingCallback::Create(current_browser->npp());
+
+  Stopwatch stopwatch;
+
+  // the options object goes with |args|
+  {
+    CallArgs args;
+    args.AddString(current_fixture->Path("backlog.txt"));
+    args.AddBool(false);
+    args.AddObject(callback);
+    ScriptObject* options = args.AddOptions();
+    options->SetString("catchUp", catch_up);
+    options->SetNumber("maxLagBytes", kMaxLagBytes);
+
+    NPVariant value;
+    if (!current_browser->Invoke("listenOnFile", args.args(), args.count(), 
+                                 &value)) {
+      fprintf(stderr, "listenOnFile threw: %s\n", 
+              current_browser->TakeException().c_str());
+      NPN_ReleaseObject(callback);
+      return;
+    }
+    NPN_ReleaseVariantValue(&value);
+  }
+
+  // lines (a line more than '\n's per callback), gaps and the peak lag
+  size_t lines = 0;
+  double skipped_bytes = 0;
+  double max_lag = 0;
+  size_t counted_calls = 0;
+  bool caught_up = false;
+  auto count_calls = [&]() {
+    for (; counted_calls < callback->calls_count(); counted_calls++) {
+      RecordingCallback::Call call = callback->call(counted_calls);
+      if (call.args.size() < 4) {
+        continue;
+      }
+
+      long skipped = 0;
+      if (call.args[0] == "false") {
+        if (1 == sscanf(call.args[1].c_str(), "skipped %ld", &skipped)) {
+          skipped_bytes += skipped;
+        }
+      } else {
+        lines += call.newlines + 1;
+      }
+
+      double lag = atof(call.args[2].c_str());
+      max_lag = std::max(max_lag, lag);
+      caught_up = 
+        (0 == lag) && (call.args[3] == "0") && 
+        ((lines >= lines_count) || (skipped_bytes > 0));
+    }
+    return caught_up;
+  };
+
+  current_browser->RunUntil(count_calls, 60000);
+
+  Result result;
+  result.seconds = stopwatch.Elapsed();
+  result.benchmark = "e2e_listenOnFile_catch_up";
+  result.variant = catch_up;
+  result.bytes = content.size();
+  result.items = lines;
+  result.metrics.push_back(std::make_pair(
+    "caught_up", 
+    caught_up ? 1.0 : 0.0));
+  result.metrics.push_back(std::make_pair(
+    "skipped_bytes", 
+    skipped_bytes));
+  result.metrics.push_back(std::make_pair(
+    "max_lag_kb", 
+    max_lag / 1024.0));
+  result.metrics.push_back(std::make_pair(
+    "callbacks", 
+    (double)callback->calls_count()));
+
+  StopFileListen(callback, before);
+
+  AddMemoryMetrics(before, lines_count, result);
+  runner.Report(result);
+}
+
+void BenchmarkListenOnFile(Runner& runner) {
+  RunListenOnFile(runner, "batches_of_50", 0);
+  RunListenOnFile(runner, "batches_of_50_paced_16ms", 16);
+  RunListenOnFileCatchUp(runner, "none");
+  RunListenOnFileCatchUp(runner, "batch");
+  RunListenOnFileCatchUp(runner, "skip");
+}
+
+// Files created in batches in a watched directory - change to callback 
+// latency (per batch, including the debounce)
+void BenchmarkWatchDirectory(Runner& runner) {
+  const size_t kFilesPerBatch = 10;
+  const double kDebounceMs = 10;
+  size_t batches = runner.Scale(80);
+
+  // taken before the callback exists - the plugin has to let go of it once
+  // the watch is stopped
+  current_browser->ResetPeakMemory();
+  MemorySnapshot before = TakeMemorySnapshot();
+
+  RecordingCallback* callback = 
+    RecordingCallback::Create(current_browser->npp());
+
+  CallArgs args;
+  args.AddString(current_fixture->Path("watch"));
+  args.AddBool(false);
+  args.AddNull();
+  args.AddNumber(kDebounceMs);
+  args.AddObject(callback);
+
+  NPVariant watch_id;
+  if (!current_browser->Invoke("watchDirectory", args.args(), args.count(), 
+                               &watch_id)) {
+    fprintf(stderr, "watchDirectory threw: %s\n", 
+            current_browser->TakeException().c_str());
+    NPN_ReleaseObject(callback);
+    return;
+  }
+
+  Result result;
+  result.benchmark = "e2e_watchDirectory";
+  result.variant = "batches_of_10";
+
+  size_t missed = 0;
+  char relative[64];
+  Stopwatch stopwatch;
+  for (size_t batch = 0; batch < batches; batch++) {
+    size_t calls_before = callback->calls_count();
+
+    double start = Stopwatch::Now();
+    for (size_t file = 0; file < kFilesPerBatch; file++) {
+      sprintf(relative, "watch/file_%u_%u.txt", (unsigned int)batch, 
+              (unsigned int)file);
+      current_fixture->WriteFile(relative, "change");
+    }
+
+    bool reported = current_browser->RunUntil(
+      [&]() {
+        return callback->calls_count() > calls_before;
+      }, 
+      2000);
+    if (!reported) {
+      missed++;
+      continue;
+    }
+
+    RecordingCallback::Call call = callback->call(calls_before);
+    result.latencies_us.push_back((call.time - start) * 1e6);
+
+    // the rest of the batch may come in a second report
+    current_browser->RunPending((DWORD)(kDebounceMs * 2));
+  }
+  result.seconds = stopwatch.Elapsed();
+  result.items = batches * kFilesPerBatch;
+  result.metrics.push_back(std::make_pair("missed_batches", (double)missed));
+
+  NPVariant value;
+  current_browser->Invoke("stopDirectoryWatch", &watch_id, 1, &value);
+  NPN_ReleaseVariantValue(&value);
+  NPN_ReleaseVariantValue(&watch_id);
+
+  // the final (status false) callback
+  current_browser->RunPending(kRunPendingWaitMs);
+
+  NPN_ReleaseObject(callback);
+
+  AddMemoryMetrics(before, batches, result);
+  runner.Report(result);
+
+  for (size_t batch = 0; batch < batches; batch++) {
+    for (size_t file = 0; file < kFilesPerBatch; file++) {
+      sprintf(relative, "watch/file_%u_%u.txt", (unsigned int)batch, 
+              (unsigned int)file);
+      current_fixture->RemoveFile(relative);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+// The SSE2 fast paths of the UTF8 / UTF-16 conversions against the scalar
+// path (see |Encoders::set_sse2_enabled|) - the conversions on their own and
+// getTextFile of a UTF-16 file, which the worker thread transcodes. The SSE2
+// results carry the "speedup" over the scalar ones.
+std::vector<uint16_t> ToUtf16(const std::wstring& wide) {
+  std::vector<uint16_t> units;
+  units.reserve(wide.size());
+  for (size_t i = 0; i < wide.size(); i++) {
+    unsigned int code_point = (unsigned int)wide[i];
+    if (code_point >= 0x10000) { // 4 byte wchar_t
+      code_point -= 0x10000;
+      units.push_back((uint16_t)(0xD800 + (code_point >> 10)));
+      units.push_back((uint16_t)(0xDC00 + (code_point & 0x3FF)));
+    } else {
+      units.push_back((uint16_t)code_point);
+    }
+  }
+  return units;
+}
+
+void BuildGetTextFileUtf16(CallArgs& ref_args, NPObject* callback) {
+  ref_args.AddString(current_fixture->Path("utf16.txt"));
+  ref_args.AddBool(false);
+  ref_args.AddObject(callback);
+}
+
+// reports the fastest of |runner.repetitions()| runs of |func| with the
+// scalar path (<variant>_scalar) and with SSE2 (<variant>_sse2)
+template<typename Func>
+void CompareConversion(
+  Runner& runner, 
+  const std::string& variant, 
+  size_t bytes, 
+  Func func) {
+
+  double seconds[2] = { 0, 0 };
+  for (int sse2 = 0; sse2 < 2; sse2++) {
+    bool previous = utils::Encoders::set_sse2_enabled(1 == sse2);
+    for (int repetition = 0; repetition < runner.repetitions(); repetition++) {
+      Stopwatch stopwatch;
+      func();
+      double elapsed = stopwatch.Elapsed();
+      if ((0 == repetition) || (elapsed < seconds[sse2])) {
+        seconds[sse2] = elapsed;
+      }
+    }
+    utils::Encoders::set_sse2_enabled(previous);
+  }
+
+  Result scalar;
+  scalar.benchmark = "e2e_encoders";
+  scalar.variant = variant + "_scalar";
+  scalar.bytes = bytes;
+  scalar.seconds = seconds[0];
+  runner.Report(scalar);
+
+  Result result;
+  result.benchmark = "e2e_encoders";
+  result.variant = variant + "_sse2";
+  result.bytes = bytes;
+  result.seconds = seconds[1];
+  result.metrics.push_back(std::make_pair(
+    "speedup", 
+    (seconds[1] > 0) ? (seconds[0] / seconds[1]) : 0));
+  runner.Report(result);
+}
+
+void BenchmarkEncoders(Runner& runner) {
+  for (int ascii_only = 1; ascii_only >= 0; ascii_only--) {
+    std::string text = ascii_only ? "ascii" : "mixed";
+
+    std::string utf8 = GenerateText(runner.Scale(4 * 1024 * 1024), 
+                                    (0 != ascii_only));
+    std::wstring wide = utils::Encoders::utf8_decode(utf8);
+    std::vector<uint16_t> units = ToUtf16(wide);
+
+    // throughput is always in UTF8 bytes so the numbers compare
+    CompareConversion(runner, "utf8_decode_" + text, utf8.size(), [&]() {
+      std::wstring output = utils::Encoders::utf8_decode(utf8);
+      DoNotOptimize(output.c_str());
+    });
+
+    CompareConversion(runner, "utf8_encode_" + text, utf8.size(), [&]() {
+      std::string output = utils::Encoders::utf8_encode(wide);
+      DoNotOptimize(output.c_str());
+    });
+
+    CompareConversion(runner, "utf16_append_utf8_" + text, utf8.size(), 
+      [&]() {
+        std::string output;
+        utils::Encoders::utf16_append_utf8(
+          &units[0], 
+          units.size(), 
+          output, 
+          true);
+        DoNotOptimize(output.c_str());
+      });
+
+    // the same text as a UTF-16LE file (with a BOM)
+    std::string content("\xFF\xFE", 2);
+    content.reserve(2 + units.size() * 2);
+    for (size_t i = 0; i < units.size(); i++) {
+      content += (char)(units[i] & 0xFF);
+      content += (char)(units[i] >> 8);
+    }
+    if (!current_fixture->WriteFile("utf16.txt", content)) {
+      fprintf(stderr, "couldn't write utf16.txt\n");
+      return;
+    }
+
+    for (int sse2 = 0; sse2 < 2; sse2++) {
+      std::string variant = "utf16_" + text + (sse2 ? "_sse2" : "_scalar");
+      Scenario scenario = {
+        "getTextFile", 
+        variant.c_str(), 
+        40, 
+        BuildGetTextFileUtf16
+      };
+
+      bool previous = utils::Encoders::set_sse2_enabled(1 == sse2);
+      RunScenario(runner, scenario, 1);
+      utils::Encoders::set_sse2_enabled(previous);
+    }
+  }
+
+  current_fixture->RemoveFile("utf16.txt");
+}
+
+}; // namespace
+
+//-----------------------------------------------------------------------------
+void host::RegisterHostBenchmarks(
+  Runner& runner, 
+  FakeBrowser* browser, 
+  Fixture* fixture) {
+
+  current_browser = browser;
+  current_fixture = fixture;
+
+  // a benchmark per method (the filter matches its name)
+  std::vector<std::string> methods;
+  for (size_t i = 0; i < kScenariosCount; i++) {
+    std::string method = kScenarios[i].method;
+    if (methods.end() == std::find(methods.begin(), methods.end(), method)) {
+      methods.push_back(method);
+    }
+  }
+
+  for (size_t i = 0; i < methods.size(); i++) {
+    std::string method = methods[i];
+    runner.Add(
+      ("e2e_" + method).c_str(), 
+      [method](Runner& method_runner) {
+        RunMethodScenarios(method_runner, method);
+      });
+  }
+
+  runner.Add("e2e_listenOnFile", BenchmarkListenOnFile);
+  runner.Add("e2e_watchDirectory", BenchmarkWatchDirectory);
+  runner.Add("e2e_getStats", BenchmarkGetStats);
+  runner.Add("e2e_dispatch", BenchmarkDispatch);
+  runner.Add("e2e_getTrace", BenchmarkGetTrace);
+  runner.Add("e2e_cancel", BenchmarkCancel);
+  runner.Add("e2e_encoders", BenchmarkEncoders);
+}
+
+bool host::RunStress(
+  Runner& runner, 
+  FakeBrowser* browser, 
+  Fixture* fixture, 
+  double seconds) {
+
+  current_browser = browser;
+  current_fixture = fixture;
+
+  if (!fixture->WriteFile("stress.log", "")) {
+    return false;
+  }
+
+  RecordingCallback* listener = RecordingCallback::Create(browser->npp());
+
+  CallArgs args;
+  args.AddString(fixture->Path("stress.log"));
+  args.AddBool(false);
+  args.AddObject(listener);
+
+  NPVariant value;
+  if (!browser->Invoke("listenOnFile", args.args(), args.count(), &value)) {
+    fprintf(stderr, "listenOnFile threw: %s\n", 
+            browser->TakeException().c_str());
+    NPN_ReleaseObject(listener);
+    return false;
+  }
+  NPN_ReleaseVariantValue(&value);
+
+  browser->ResetPeakMemory();
+  MemorySnapshot before = TakeMemorySnapshot();
+
+  // deterministic, so a failing mix can be replayed
+  unsigned int seed = 0x5EED;
+  size_t lines_written = 0;
+  size_t issued = 0;
+  size_t sync_exceptions = 0;
+  char line[64];
+
+  DriveStats stats;
+  Stopwatch stopwatch;
+  Drive(
+    [&]() -> const Scenario* {
+      if (stopwatch.Elapsed() >= seconds) {
+        return nullptr;
+      }
+
+      issued++;
+
+      // a log line every 8 calls and a (synchronous) getStats every 256
+      if (0 == (issued % 8)) {
+        sprintf(line, "stress line %u\n", (unsigned int)lines_written++);
+        fixture->AppendFile("stress.log", line);
+      }
+
+      if (0 == (issued % 256)) {
+        NPVariant stats_value;
+        if (browser->Invoke("getStats", nullptr, 0, &stats_value)) {
+          NPN_ReleaseVariantValue(&stats_value);
+        } else {
+          sync_exceptions++;
+        }
+      }
+
+      seed = seed * 1103515245 + 12345;
+      return &kScenarios[(seed >> 16) % kScenariosCount];
+    }, 
+    kStressConcurrentCalls, 
+    stats);
+
+  browser->RunUntil(
+    [&]() {
+      return listener->calls_count() >= lines_written;
+    }, 
+    10000);
+
+  Result result;
+  result.seconds = stopwatch.Elapsed();
+  result.benchmark = "stress";
+  result.variant = "mixed";
+  result.items = stats.calls;
+  result.bytes = stats.bytes;
+  AddDriveMetrics(stats, result);
+  result.latencies_us.swap(stats.latencies_us);
+
+  size_t lost_lines = 
+    (listener->calls_count() < lines_written) ? 
+    (lines_written - listener->calls_count()) : 
+    0;
+  result.metrics.push_back(std::make_pair(
+    "listened_lines", 
+    (double)lines_written));
+  result.metrics.push_back(std::make_pair("lost_lines", (double)lost_lines));
+  result.metrics.push_back(std::make_pair(
+    "sync_exceptions", 
+    (double)sync_exceptions));
+
+  browser->Invoke("stopFileListen", nullptr, 0, &value);
+  NPN_ReleaseVariantValue(&value);
+
+  AddMemoryMetrics(before, stats.calls, result);
+  runner.Report(result);
+
+  NPN_ReleaseObject(listener);
+
+  // failures (status false) are fine - e.g. a read of the log while it's
+  // being written - calls that never complete or throw aren't
+  return (0 == stats.stuck) && (0 == stats.exceptions) && 
+         (0 == sync_exceptions) && (0 == lost_lines);
+}
\ No newline at end of file
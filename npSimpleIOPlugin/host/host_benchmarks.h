@@ -0,0 +1,35 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef HOST_HOST_BENCHMARKS_H_
+#define HOST_HOST_BENCHMARKS_H_
+
+#include "benchmarks/benchmark.h"
+
+namespace host {
+
+class FakeBrowser;
+class Fixture;
+
+// End to end benchmarks - every scripted method called the way script calls
+// it, through a loaded plugin (e2e_<method>). Each scenario runs one call at 
+// a time (latency: call to final callback) and 32 calls in flight 
+// (throughput), and reports the browser side memory it left behind.
+void RegisterHostBenchmarks(
+  benchmarks::Runner& runner, 
+  FakeBrowser* browser, 
+  Fixture* fixture);
+
+// Calls a random mix of the methods with 64 calls in flight for |seconds|,
+// while a log is written and listened on. Returns false if calls didn't 
+// complete, threw or listened lines were lost.
+bool RunStress(
+  benchmarks::Runner& runner, 
+  FakeBrowser* browser, 
+  Fixture* fixture, 
+  double seconds);
+
+}; // namespace host
+
+#endif // HOST_HOST_BENCHMARKS_H_
\ No newline at end of file
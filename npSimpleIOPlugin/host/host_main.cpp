@@ -0,0 +1,67 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#include "FakeBrowser.h"
+#include "Fixture.h"
+#include "host_benchmarks.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// npSimpleIOHost [--quick] [--stress seconds] [filter]
+//
+// Loads the plugin into a fake browser (see |host::FakeBrowser|) and runs
+// the end to end benchmarks - or, with --stress, a random mix of calls for
+// |seconds| (exits with 1 if calls got stuck, threw or lines were lost).
+// Results go to stdout as JSON lines, like npSimpleIOBench.
+int main(int argc, char* argv[]) {
+  benchmarks::Runner runner;
+  std::string filter;
+  double stress_seconds = 0;
+
+  for (int i = 1; i < argc; i++) {
+    if (0 == strcmp(argv[i], "--quick")) {
+      runner.set_quick(true);
+    } else if ((0 == strcmp(argv[i], "--stress")) && (i + 1 < argc)) {
+      stress_seconds = atof(argv[++i]);
+    } else if ('-' == argv[i][0]) {
+      fprintf(stderr, "usage: %s [--quick] [--stress seconds] [filter]\n", 
+              argv[0]);
+      return 1;
+    } else {
+      filter = argv[i];
+    }
+  }
+
+  // before the plugin is loaded - it reads its folders once
+  host::Fixture fixture;
+  if (!fixture.Create(runner.quick())) {
+    fprintf(stderr, "couldn't create the test files\n");
+    return 1;
+  }
+
+  host::FakeBrowser browser;
+  if (!browser.Load()) {
+    fprintf(stderr, "couldn't load the plugin\n");
+    return 1;
+  }
+
+  int status = 0;
+  if (stress_seconds > 0) {
+    fprintf(stderr, "stress for %.0f seconds...\n", stress_seconds);
+    if (!host::RunStress(runner, &browser, &fixture, stress_seconds)) {
+      status = 1;
+    }
+  } else {
+    host::RegisterHostBenchmarks(runner, &browser, &fixture);
+    if (0 == runner.Run(filter)) {
+      fprintf(stderr, "no benchmark matches '%s'\n", filter.c_str());
+      status = 1;
+    }
+  }
+
+  browser.Unload();
+  return status;
+}
\ No newline at end of file
@@ -55,6 +55,7 @@
     You can also use other ways, like a ::MessageBox or DebugBreak();
 */
 #include "nsPluginInstanceSimpleIO.h"
+#include "utils/BufferPool.h"
 
 // this defines the mime-type when using <object> or <embed>
 // NOTE: this is actually really declared in the Version resource of the dll
@@ -69,6 +70,8 @@ NPError NS_PluginInitialize() {
 }
 
 void NS_PluginShutdown() {
+  // the listeners are gone with their instances - their buffers aren't
+  utils::BufferPool::Trim();
 }
 
 /////////////////////////////////////////////////////////////
@@ -10,6 +10,11 @@
 // open for optimization reasons - we don't want it
 int nsPluginInstanceSimpleIO::ref_count_ = 0;
 
+// declare our NPObject-derived scriptable object class
+DECLARE_NPOBJECT_CLASS_WITH_BASE(
+  nsScriptableObjectSimpleIO, 
+  AllocateNpObject<nsScriptableObjectSimpleIO>);
+
 ////////////////////////////////////////
 //
 // nsPluginInstanceSimpleIO class implementation
@@ -26,9 +31,11 @@ nsPluginInstanceSimpleIO::nsPluginInstanceSimpleIO(NPP instance) :
 nsPluginInstanceSimpleIO::~nsPluginInstanceSimpleIO() {
   nsPluginInstanceSimpleIO::ref_count_--;
 
+#ifdef _WIN32
   if (0 == nsPluginInstanceSimpleIO::ref_count_) {
     PostQuitMessage(0);
   }
+#endif
 }
 
 // NOTE:
@@ -37,7 +44,7 @@ nsPluginInstanceSimpleIO::~nsPluginInstanceSimpleIO() {
 // probably be removed in the near feature and will be changed
 // by a different method that will only support non-visual
 // plugins
-NPBool nsPluginInstanceSimpleIO::init(NPWindow* window) {
+NPBool nsPluginInstanceSimpleIO::init(NPWindow* /*window*/) {
   // no GUI to init in windowless case
   initialized_ = TRUE;
   return TRUE;
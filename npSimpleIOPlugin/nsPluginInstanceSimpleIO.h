@@ -6,7 +6,7 @@
 #define NSPLUGININSTANCESIMPLEIO_H
 
 #include <memory> // smart ptrs
-#include <windows.h> // required for pluginbase.h
+#include "utils/Platform.h" // required for pluginbase.h
 #include "plugin_common/pluginbase.h" // nsPluginInstanceBase
 
 class nsPluginInstanceSimpleIO : public nsPluginInstanceBase {
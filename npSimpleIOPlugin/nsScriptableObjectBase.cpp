@@ -14,28 +14,28 @@ nsScriptableObjectBase::~nsScriptableObjectBase() {
 void nsScriptableObjectBase::Invalidate() {
 }
 
-bool nsScriptableObjectBase::HasMethod(NPIdentifier name) {
+bool nsScriptableObjectBase::HasMethod(NPIdentifier /*name*/) {
    return false;
 }
 
 bool nsScriptableObjectBase::Invoke(
-  NPIdentifier name, 
-  const NPVariant *args, 
-  uint32_t argCount, 
-  NPVariant *result) {
+  NPIdentifier /*name*/, 
+  const NPVariant* /*args*/, 
+  uint32_t /*argCount*/, 
+  NPVariant* /*result*/) {
 
   return false;
 }
 
 bool nsScriptableObjectBase::InvokeDefault(
-  const NPVariant *args,
-  uint32_t argCount, 
-  NPVariant *result) {
+  const NPVariant* /*args*/,
+  uint32_t /*argCount*/, 
+  NPVariant* /*result*/) {
 
   return false;
 }
 
-bool nsScriptableObjectBase::HasProperty(NPIdentifier name) {
+bool nsScriptableObjectBase::HasProperty(NPIdentifier /*name*/) {
 #ifdef _DEBUG
   NPUTF8* utf8_name = NPN_UTF8FromIdentifier(name);
   NPN_MemFree((void*)utf8_name);
@@ -44,18 +44,18 @@ bool nsScriptableObjectBase::HasProperty(NPIdentifier name) {
 }
 
 bool nsScriptableObjectBase::GetProperty(
-  NPIdentifier name, NPVariant *result) {
+  NPIdentifier /*name*/, NPVariant* /*result*/) {
 
   return false;
 }
 
 bool nsScriptableObjectBase::SetProperty(
-  NPIdentifier name, const NPVariant *value) {
+  NPIdentifier /*name*/, const NPVariant* /*value*/) {
   
   return false;
 }
 
-bool nsScriptableObjectBase::RemoveProperty(NPIdentifier name) {
+bool nsScriptableObjectBase::RemoveProperty(NPIdentifier /*name*/) {
   return false;
 }
 
@@ -5,7 +5,7 @@
 #ifndef NSSCRIPTABLEOBJECTBASE_H_
 #define NSSCRIPTABLEOBJECTBASE_H_
 
-#include <windows.h>
+#include "utils/Platform.h"
 
 //#include "plugin_common/npplat.h"
 #include "plugin_common/pluginbase.h"
@@ -79,7 +79,9 @@ static NPClass s##_class##_NPClass = {                   \
   nsScriptableObjectBase::_HasProperty,       \
   nsScriptableObjectBase::_GetProperty,       \
   nsScriptableObjectBase::_SetProperty,       \
-  nsScriptableObjectBase::_RemoveProperty     \
+  nsScriptableObjectBase::_RemoveProperty,    \
+  nullptr, /* enumerate */                    \
+  nullptr  /* construct */                    \
 }
 
 #define GET_NPOBJECT_CLASS(_class) &s##_class##_NPClass
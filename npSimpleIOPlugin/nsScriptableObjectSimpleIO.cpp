@@ -4,31 +4,107 @@
 */
 #include "nsScriptableObjectSimpleIO.h"
 #include "utils/Thread.h"
+#include "utils/ThreadPool.h"
 #include "utils/File.h"
 #include "utils/TxtFileStream.h"
+#include "utils/Clock.h"
+#include "utils/RequestStats.h"
+#include "utils/Trace.h"
+#include "utils/BufferPool.h"
+
+#include <stdio.h>
+#include <string.h>
 
-#include "plugin_methods/plugin_method.h"
 #include "plugin_methods/plugin_method_file_exists.h"
 #include "plugin_methods/plugin_method_is_directory.h"
 #include "plugin_methods/plugin_method_get_text_file.h"
 #include "plugin_methods/plugin_method_get_binary_file.h"
+#include "plugin_methods/plugin_method_get_last_lines.h"
+#include "plugin_methods/plugin_method_read_lines.h"
 #include "plugin_methods/plugin_method_write_localappdata_file.h"
+#include "plugin_methods/plugin_method_list_directory.h"
+#include "plugin_methods/plugin_method_find_files.h"
+#include "plugin_methods/plugin_method_search_files.h"
+#include "plugin_methods/plugin_method_hash_file.h"
+#include "plugin_methods/plugin_method_hash_files.h"
 
 #include "plugin_methods/plugin_method_listen_on_file.h"
+#include "plugin_methods/plugin_method_watch_directory.h"
 
-#define REGISTER_METHOD(name, class) { \
-  methods_[NPN_GetStringIdentifier(name)] = \
-    new class(this, npp_); \
-}
+namespace {
+
+// how long a single drain of |completions_| may run callbacks for - half a 
+// 60fps frame, the rest is left for the page
+const unsigned int kCallbacksBudgetUs = 8000;
+
+}; // namespace
+
+// a one-shot method - |params| describe its |class|::Signature
+#define ONE_SHOT_METHOD(name, class, params) \
+  { name, &class::Create, class::Signature::kCount, params, nullptr }
+
+#define SYNC_METHOD(name, method) \
+  { name, nullptr, 0, nullptr, &nsScriptableObjectSimpleIO::method }
 
 #define REGISTER_GET_PROPERTY(name, csidl) { \
   properties_[NPN_GetStringIdentifier(name)] = \
     utils::File::GetSpecialFolderUtf8(csidl); \
 }
 
+#pragma region public methods
+const nsScriptableObjectSimpleIO::MethodInfo 
+nsScriptableObjectSimpleIO::kMethods[] = {
+  ONE_SHOT_METHOD("fileExists", PluginMethodFileExists, 
+    "filename, callback(status)"),
+  ONE_SHOT_METHOD("isDirectory", PluginMethodIsDirectory, 
+    "path, callback(status)"),
+  ONE_SHOT_METHOD("getTextFile", PluginMethodGetTextFile, 
+    "filename, widechars, callback(status, data)"),
+  ONE_SHOT_METHOD("getBinaryFile", PluginMethodGetBinaryFile, 
+    "filename, limit, callback(status, data)"),
+  ONE_SHOT_METHOD("getLastLines", PluginMethodGetLastLines, 
+    "filename, count, callback(status, lines)"),
+  ONE_SHOT_METHOD("readLines", PluginMethodReadLines, 
+    "filename, startLine, count, callback(status, result)"),
+  ONE_SHOT_METHOD("writeLocalAppDataFile", PluginMethodWriteLocalAppDataFile, 
+    "filename, content, callback(status, message)"),
+  ONE_SHOT_METHOD("listDirectory", PluginMethodListDirectory, 
+    "path, options, callback(status, entries, done)"),
+  ONE_SHOT_METHOD("findFiles", PluginMethodFindFiles, 
+    "root, globs, maxDepth, callback(status, files, done)"),
+  ONE_SHOT_METHOD("searchFiles", PluginMethodSearchFiles, 
+    "directory or files, pattern, options, "
+    "callback(status, matches, done)"),
+  ONE_SHOT_METHOD("hashFile", PluginMethodHashFile, 
+    "filename, algorithm (xxh64, crc32c or sha256), "
+    "callback(status, digest)"),
+  ONE_SHOT_METHOD("hashFiles", PluginMethodHashFiles, 
+    "filenames, algorithm (xxh64, crc32c or sha256), "
+    "callback(status, digests)"),
+
+  SYNC_METHOD("cancel", Cancel),
+
+  SYNC_METHOD("listenOnFile", ListenOnFile),
+  SYNC_METHOD("stopFileListen", StopFileListen),
+  SYNC_METHOD("watchDirectory", WatchDirectory),
+  SYNC_METHOD("stopDirectoryWatch", StopDirectoryWatch),
+
+  SYNC_METHOD("getStats", GetStats),
+  SYNC_METHOD("startTracing", StartTracing),
+  SYNC_METHOD("stopTracing", StopTracing),
+  SYNC_METHOD("getTrace", GetTrace)
+};
+#pragma endregion public methods
+
 nsScriptableObjectSimpleIO::nsScriptableObjectSimpleIO(NPP npp) :
   nsScriptableObjectBase(npp),
-  shutting_down_(false) {
+  created_us_(utils::Clock::NowMicroseconds()),
+  next_request_id_(0),
+  has_cancelled_requests_(0),
+  shutting_down_(false),
+  drain_handle_(new DrainHandle) {
+  drain_handle_->owner = this;
+  drain_handle_->refs = 1;
 }
 
 nsScriptableObjectSimpleIO::~nsScriptableObjectSimpleIO(void) {
@@ -38,22 +114,73 @@ nsScriptableObjectSimpleIO::~nsScriptableObjectSimpleIO(void) {
     thread_->Stop();
   }
 
+  if (worker_pool_.get()) {
+    worker_pool_->Stop();
+  }
+
+  ReapCancelledRequests(true);
+
+  // the requests that never made it back - still queued on |thread_| or in
+  // |completions_| (which won't be drained anymore)
+  RequestsMap requests;
+  {
+    utils::CriticalSectionLock lock(requests_critical_section_);
+    requests.swap(requests_);
+  }
+
+  RequestsMap::iterator request_iter = requests.begin();
+  for (; request_iter != requests.end(); ++request_iter) {
+    delete request_iter->second->method;
+    delete request_iter->second;
+  }
+
+  drain_handle_->owner = nullptr;
+  ReleaseDrainHandle(drain_handle_);
+
   if (nullptr != listen_on_file_method_.get()) {
     listen_on_file_method_->Terminate();
     listen_on_file_method_.reset();
   }
+
+  if (nullptr != watch_directory_method_.get()) {
+    watch_directory_method_->Terminate();
+    watch_directory_method_.reset();
+  }
+
+  StatsList::iterator iter = stats_.begin();
+  for (; iter != stats_.end(); ++iter) {
+    delete *iter;
+  }
+  stats_.clear();
 }
 
 bool nsScriptableObjectSimpleIO::Init() {
-#pragma region public methods
-  REGISTER_METHOD("fileExists", PluginMethodFileExists);
-  REGISTER_METHOD("isDirectory", PluginMethodIsDirectory);
-  REGISTER_METHOD("getTextFile", PluginMethodGetTextFile);
-  REGISTER_METHOD("getBinaryFile", PluginMethodGetBinaryFile);
-  REGISTER_METHOD("writeLocalAppDataFile", PluginMethodWriteLocalAppDataFile);
+  worker_pool_.reset(new utils::ThreadPool());
+
+  completions_.reset(new utils::CompletionQueue(
+    [this]() {
+      InterlockedIncrement(&drain_handle_->refs);
+      NPN_PluginThreadAsyncCall(
+        npp_, 
+        nsScriptableObjectSimpleIO::DrainCompletions, 
+        drain_handle_);
+    },
+    kCallbacksBudgetUs));
 
   listen_on_file_method_.reset(new PluginMethodListenOnFile(this, npp_));
-#pragma endregion public methods
+  watch_directory_method_.reset(new PluginMethodWatchDirectory(this, npp_));
+
+  const size_t methods_count = sizeof(kMethods) / sizeof(kMethods[0]);
+  for (size_t i = 0; i < methods_count; i++) {
+    MethodEntry entry;
+    entry.info = &kMethods[i];
+    if (nullptr != kMethods[i].create) {
+      entry.stats = new utils::RequestStats(kMethods[i].name);
+      stats_.push_back(entry.stats);
+    }
+
+    methods_.Insert(NPN_GetStringIdentifier(kMethods[i].name), entry);
+  }
 
 #pragma region read-only properties
   REGISTER_GET_PROPERTY("PROGRAMFILES", CSIDL_PROGRAM_FILES);
@@ -89,13 +216,8 @@ bool nsScriptableObjectSimpleIO::HasMethod(NPIdentifier name) {
   NPN_MemFree((void*)name_utf8);
 #endif
 
-  // listenOnFile
-  if (listen_on_file_method_->HasMethod(name)) {
-    return true;
-  }
-
   // does the method exist?
-  return (methods_.find(name) != methods_.end());
+  return (nullptr != methods_.Find(name));
 }
 
 bool nsScriptableObjectSimpleIO::Invoke(
@@ -108,37 +230,72 @@ bool nsScriptableObjectSimpleIO::Invoke(
       NPN_MemFree((void*)szName);
 #endif
 
-  // handle listenOnFile
-  if (listen_on_file_method_->HasMethod(name)) {
-    return listen_on_file_method_->Execute(name, args, argCount, result);
-  }
-
   // dispatch method to appropriate handler
-  MethodsMap::iterator iter = methods_.find(name);
-  
-  if (iter == methods_.end()) {
+  const MethodEntry* entry = methods_.Find(name);
+  if (nullptr == entry) {
     // should never reach here
     NPN_SetException(this, "bad function called??");
     return false;
   }
 
-  PluginMethod* plugin_method = 
-    iter->second->Clone(this, npp_, args, argCount, result);
+  ReapCancelledRequests(false);
+
+  const MethodInfo* info = entry->info;
+  if (nullptr != info->sync) {
+    return (this->*(info->sync))(args, argCount, result);
+  }
+
+  unsigned __int64 invoked_us = utils::Clock::NowMicroseconds();
 
+  PluginMethod* plugin_method = info->create(this, npp_, args, argCount);
   if (nullptr == plugin_method) {
+    char message[512];
+    sprintf(
+      message, 
+      "invalid params passed to function - expecting %u params: %s",
+      info->params_count,
+      info->params);
+    NPN_SetException(this, message);
     return false;
   }
 
+  unsigned int id = (unsigned int)InterlockedIncrement(&next_request_id_);
+
+  Request* request = new Request;
+  request->owner = this;
+  request->method = plugin_method;
+  request->stats = entry->stats;
+  request->id = id;
+  request->invoked_us = invoked_us;
+  request->started_us = 0;
+  request->executed_us = 0;
+  request->callback_started_us = 0;
+
+  {
+    utils::CriticalSectionLock lock(requests_critical_section_);
+    requests_[id] = request;
+  }
+
+  request->stats->OnQueued();
+
   // post to separate thread so that we are responsive
-  return thread_->PostTask(
+  if (!thread_->PostTask(
     std::bind(
     &nsScriptableObjectSimpleIO::ExecuteMethod, 
     this,
-    plugin_method));
+    request))) {
+    request->stats->OnStarted();
+    ReleaseRequest(request);
+    return false;
+  }
+
+  // |request| may be gone already - return the id we kept
+  INT32_TO_NPVARIANT((int32_t)id, *result);
+  return true;
 }
 
 /************************************************************************/
-/* Public properties
+/* Public properties                                                    */
 /************************************************************************/
 bool nsScriptableObjectSimpleIO::HasProperty(NPIdentifier name) {
 #ifdef _DEBUG
@@ -171,44 +328,342 @@ bool nsScriptableObjectSimpleIO::GetProperty(
 }
 
 bool nsScriptableObjectSimpleIO::SetProperty(
-  NPIdentifier name, const NPVariant *value) {
+  NPIdentifier /*name*/, const NPVariant* /*value*/) {
   NPN_SetException(this, "this property is read-only!");
   return true;
 }
 
 /************************************************************************/
-/*
+/*                                                                      */
 /************************************************************************/
-void nsScriptableObjectSimpleIO::ExecuteMethod(PluginMethod* method) {
-  if (shutting_down_) {
+void nsScriptableObjectSimpleIO::ExecuteMethod(Request* request) {
+  if (nullptr == request) {
     return;
   }
 
-  if (nullptr == method) {
+  // left in |requests_| - the destructor releases it (on the browser thread)
+  // once |thread_| stopped
+  if (shutting_down_) {
     return;
   }
 
-  method->Execute();
+  request->stats->OnStarted();
+  request->started_us = utils::Clock::NowMicroseconds();
+
+  PluginMethod* method = request->method;
+
+  // cancelled while still queued - dropped without running
+  if (!method->IsCancelled()) {
+    method->Execute();
+  }
+
+  request->executed_us = utils::Clock::NowMicroseconds();
+
+  utils::Trace::AddSpan(
+    request->stats->name().c_str(), 
+    "execute", 
+    request->started_us, 
+    request->executed_us);
+
+  if (method->IsCancelled()) {
+    DropRequest(request);
+    return;
+  }
 
   if (!method->HasCallback()) {
-    delete method;
+    CompleteRequest(request);
     return;
   }
 
-  NPN_PluginThreadAsyncCall(
-    npp_, 
+  PostCallback(
+    &request->completion,
     nsScriptableObjectSimpleIO::ExecuteCallback, 
-    method);
+    request);
+}
+
+utils::ThreadPool* nsScriptableObjectSimpleIO::worker_pool() {
+  return worker_pool_.get();
+}
+
+void nsScriptableObjectSimpleIO::PostCallback(
+  utils::CompletionQueue::Entry* entry,
+  utils::CompletionQueue::Callback callback,
+  void* param) {
+  completions_->Push(entry, callback, param);
+}
+
+//static
+void nsScriptableObjectSimpleIO::DrainCompletions(void* handle) {
+  if (nullptr == handle) {
+    return;
+  }
+
+  DrainHandle* drain_handle = reinterpret_cast<DrainHandle*>(handle);
+  nsScriptableObjectSimpleIO* simple_io = drain_handle->owner;
+  if (nullptr != simple_io) {
+    // a script callback may release the last reference to us (e.g. by 
+    // removing the plugin) - we're done with |simple_io| before it goes
+    NPN_RetainObject(simple_io);
+    simple_io->completions_->Drain();
+    simple_io->ReapCancelledRequests(false);
+    NPN_ReleaseObject(simple_io);
+  }
+
+  ReleaseDrainHandle(drain_handle);
+}
+
+//static
+void nsScriptableObjectSimpleIO::ReleaseDrainHandle(DrainHandle* handle) {
+  if (0 == InterlockedDecrement(&handle->refs)) {
+    delete handle;
+  }
 }
 
 //static
-void nsScriptableObjectSimpleIO::ExecuteCallback(void* method) {
-  if (nullptr == method) {
+void nsScriptableObjectSimpleIO::ExecuteCallback(void* request) {
+  if (nullptr == request) {
+    return;
+  }
+
+  Request* plugin_request = reinterpret_cast<Request*>(request);
+
+  // cancelled on its way back - the result isn't marshalled
+  if (plugin_request->method->IsCancelled()) {
+    plugin_request->stats->OnCancelled();
+    plugin_request->owner->ReleaseRequest(plugin_request);
     return;
   }
 
-  PluginMethod* plugin_method = reinterpret_cast<PluginMethod*>(method);
-  plugin_method->TriggerCallback();
+  plugin_request->callback_started_us = utils::Clock::NowMicroseconds();
+  plugin_request->method->TriggerCallback();
+
+  plugin_request->owner->CompleteRequest(plugin_request);
+}
+
+void nsScriptableObjectSimpleIO::CompleteRequest(Request* request) {
+  unsigned __int64 completed_us = utils::Clock::NowMicroseconds();
+
+  unsigned __int64 durations_us[utils::RequestStats::STAGES_COUNT];
+  durations_us[utils::RequestStats::STAGE_QUEUE] = 
+    request->started_us - request->invoked_us;
+  durations_us[utils::RequestStats::STAGE_EXECUTE] = 
+    request->executed_us - request->started_us;
+  durations_us[utils::RequestStats::STAGE_CALLBACK] = 
+    completed_us - request->executed_us;
+  durations_us[utils::RequestStats::STAGE_TOTAL] = 
+    completed_us - request->invoked_us;
+
+  request->stats->OnCompleted(
+    request->method->Succeeded(),
+    request->method->ResultSize(),
+    durations_us);
+
+  if (utils::Trace::IsEnabled()) {
+    const char* name = request->stats->name().c_str();
+
+    utils::Trace::AddAsyncSpan(
+      name, "queue", request->invoked_us, request->started_us, request->id);
+
+    // marshalling the result and running the script callback
+    if (0 != request->callback_started_us) {
+      utils::Trace::AddAsyncSpan(
+        name, 
+        "callback wait", 
+        request->executed_us, 
+        request->callback_started_us, 
+        request->id);
+
+      utils::Trace::AddSpan(
+        name, "callback", request->callback_started_us, completed_us);
+    }
+  }
+
+  ReleaseRequest(request);
+}
+
+void nsScriptableObjectSimpleIO::ReleaseRequest(Request* request) {
+  {
+    utils::CriticalSectionLock lock(requests_critical_section_);
+    requests_.erase(request->id);
+  }
+
+  delete request->method;
+  delete request;
+}
+
+void nsScriptableObjectSimpleIO::DropRequest(Request* request) {
+  request->stats->OnCancelled();
+
+  if (!request->method->HasCallback()) {
+    ReleaseRequest(request);
+    return;
+  }
+
+  utils::CriticalSectionLock lock(requests_critical_section_);
+  requests_.erase(request->id);
+  cancelled_requests_.push_back(request);
+  InterlockedExchange(&has_cancelled_requests_, 1);
+}
+
+void nsScriptableObjectSimpleIO::ReapCancelledRequests(bool all) {
+  // the common case - a single read, no lock
+  if (0 == has_cancelled_requests_) {
+    return;
+  }
+
+  RequestsList reaped;
+  {
+    utils::CriticalSectionLock lock(requests_critical_section_);
+    RequestsList::iterator iter = cancelled_requests_.begin();
+    while (iter != cancelled_requests_.end()) {
+      if (!all && (*iter)->method->HasPendingPartialResults()) {
+        ++iter;
+        continue;
+      }
+
+      reaped.push_back(*iter);
+      iter = cancelled_requests_.erase(iter);
+    }
+
+    if (cancelled_requests_.empty()) {
+      InterlockedExchange(&has_cancelled_requests_, 0);
+    }
+  }
+
+  // releases the callbacks (script objects) and whatever the methods held
+  RequestsList::iterator iter = reaped.begin();
+  for (; iter != reaped.end(); ++iter) {
+    delete (*iter)->method;
+    delete *iter;
+  }
+}
+
+bool nsScriptableObjectSimpleIO::Cancel(
+  const NPVariant *args, uint32_t argCount, NPVariant *result) {
+  unsigned int id = 0;
+  if ((argCount > 0) && NPVARIANT_IS_INT32(args[0])) {
+    id = (unsigned int)NPVARIANT_TO_INT32(args[0]);
+  } else if ((argCount > 0) && NPVARIANT_IS_DOUBLE(args[0])) {
+    id = (unsigned int)NPVARIANT_TO_DOUBLE(args[0]);
+  } else {
+    NPN_SetException(this, "invalid params passed to function");
+    return true;
+  }
+
+  bool found = false;
+  {
+    utils::CriticalSectionLock lock(requests_critical_section_);
+    RequestsMap::iterator iter = requests_.find(id);
+    if (iter != requests_.end()) {
+      iter->second->method->Cancel();
+      found = true;
+    }
+  }
+
+  BOOLEAN_TO_NPVARIANT(found, *result);
+  return true;
+}
+
+bool nsScriptableObjectSimpleIO::GetStats(
+  const NPVariant* /*args*/, uint32_t /*argCount*/, NPVariant *result) {
+  LONG queued = 0;
+  StatsList::const_iterator iter = stats_.begin();
+  for (; iter != stats_.end(); ++iter) {
+    queued += (*iter)->queued();
+  }
+
+  char header[320];
+  sprintf(
+    header, 
+    "{\"uptimeMs\":%.0f,\"queueDepth\":%d,"
+    "\"callbackDrains\":%" FORMAT_UINT64 ",\"callbacks\":%" FORMAT_UINT64 ","
+    "\"readBuffersKB\":%.0f,\"pooledBuffersKB\":%.0f,"
+    "\"methods\":{",
+    (double)(utils::Clock::NowMicroseconds() - created_us_) / 1000,
+    (int)queued,
+    completions_->drains(),
+    completions_->callbacks(),
+    (double)utils::BufferPool::in_use_bytes() / 1024,
+    (double)utils::BufferPool::pooled_bytes() / 1024);
+
+  std::string output(header);
+  for (iter = stats_.begin(); iter != stats_.end(); ++iter) {
+    if (iter != stats_.begin()) {
+      output += ',';
+    }
+    (*iter)->AppendJson(output);
+  }
+  output += "}}";
+
+  SetStringResult(output, result);
+  return true;
+}
+
+bool nsScriptableObjectSimpleIO::StartTracing(
+  const NPVariant *args, uint32_t argCount, NPVariant *result) {
+  // enough for a few seconds of a busy page
+  size_t capacity = 64 * 1024;
+
+  if (argCount > 0) {
+    if (NPVARIANT_IS_INT32(args[0]) && (NPVARIANT_TO_INT32(args[0]) > 0)) {
+      capacity = (size_t)NPVARIANT_TO_INT32(args[0]);
+    } else if (NPVARIANT_IS_DOUBLE(args[0]) && 
+               (NPVARIANT_TO_DOUBLE(args[0]) > 0)) {
+      capacity = (size_t)NPVARIANT_TO_DOUBLE(args[0]);
+    } else {
+      NPN_SetException(this, "invalid params passed to function");
+      return true;
+    }
+  }
+
+  BOOLEAN_TO_NPVARIANT(utils::Trace::Enable(capacity), *result);
+  return true;
+}
+
+bool nsScriptableObjectSimpleIO::StopTracing(
+  const NPVariant* /*args*/, uint32_t /*argCount*/, NPVariant *result) {
+  utils::Trace::Disable();
+  VOID_TO_NPVARIANT(*result);
+  return true;
+}
+
+bool nsScriptableObjectSimpleIO::GetTrace(
+  const NPVariant* /*args*/, uint32_t /*argCount*/, NPVariant *result) {
+  std::string output;
+  utils::Trace::Dump(output);
+
+  SetStringResult(output, result);
+  return true;
+}
+
+bool nsScriptableObjectSimpleIO::ListenOnFile(
+  const NPVariant *args, uint32_t argCount, NPVariant *result) {
+  return listen_on_file_method_->ExecuteListenOnFile(args, argCount, result);
+}
+
+bool nsScriptableObjectSimpleIO::StopFileListen(
+  const NPVariant *args, uint32_t argCount, NPVariant *result) {
+  return listen_on_file_method_->ExecuteStopFileListen(
+    args, argCount, result);
+}
+
+bool nsScriptableObjectSimpleIO::WatchDirectory(
+  const NPVariant *args, uint32_t argCount, NPVariant *result) {
+  return watch_directory_method_->ExecuteWatchDirectory(
+    args, argCount, result);
+}
+
+bool nsScriptableObjectSimpleIO::StopDirectoryWatch(
+  const NPVariant *args, uint32_t argCount, NPVariant *result) {
+  return watch_directory_method_->ExecuteStopDirectoryWatch(
+    args, argCount, result);
+}
+
+//static
+void nsScriptableObjectSimpleIO::SetStringResult(
+  const std::string& value, NPVariant *result) {
+  char *resultString = (char*)NPN_MemAlloc(value.size());
+  memcpy(resultString, value.c_str(), value.size());
 
-  delete plugin_method;
+  STRINGN_TO_NPVARIANT(resultString, value.size(), *result);
 }
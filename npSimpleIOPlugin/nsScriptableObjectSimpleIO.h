@@ -6,14 +6,24 @@
 #define NNSSCRIPTABLEOBJECTSIMPLEIO_H_
 
 #include "nsScriptableObjectBase.h"
+#include "plugin_methods/plugin_method.h"
+#include "utils/CompletionQueue.h"
+#include "utils/CriticalSectionLock.h"
+#include "utils/FlatPointerMap.h"
+#include "utils/ObjectPool.h"
 #include <map>
+#include <memory>
+#include <string>
+#include <vector>
 
 namespace utils {
 class Thread; // forward declaration
+class ThreadPool;
+class RequestStats;
 }
 
-class PluginMethod;
 class PluginMethodListenOnFile;
+class PluginMethodWatchDirectory;
 
 class nsScriptableObjectSimpleIO : public nsScriptableObjectBase {
 public:
@@ -35,16 +45,152 @@ public:
   virtual bool GetProperty(NPIdentifier name, NPVariant *result);
   virtual bool SetProperty(NPIdentifier name, const NPVariant *value);
 
+public:
+  // runs |callback|(|param|) on the browser thread - batched with the other
+  // completions (see utils::CompletionQueue). |entry| must stay alive until
+  // the callback runs.
+  void PostCallback(
+    utils::CompletionQueue::Entry* entry,
+    utils::CompletionQueue::Callback callback,
+    void* param);
+
+  // for methods that split their work between threads (started on demand)
+  utils::ThreadPool* worker_pool();
+
 private:
-  void ExecuteMethod(PluginMethod* method);
-  static void ExecuteCallback(void* method);
+  // a method call on its way through the worker thread and back (from a 
+  // free list, like the method clones)
+  struct Request : public utils::Pooled<Request> {
+    nsScriptableObjectSimpleIO* owner;
+    PluginMethod* method;
+    utils::RequestStats* stats;
+    unsigned int id; // returned to script (for cancel) and groups the
+                     // trace spans of the request
+    unsigned __int64 invoked_us;
+    unsigned __int64 started_us;
+    unsigned __int64 executed_us;
+    unsigned __int64 callback_started_us;
+    utils::CompletionQueue::Entry completion;
+  };
+
+  void ExecuteMethod(Request* request);
+  static void ExecuteCallback(void* request);
+  void CompleteRequest(Request* request);
+  void ReleaseRequest(Request* request);
+
+  // what a scheduled |DrainCompletions| gets instead of |this| - the browser
+  // may run it after we're gone (e.g. the last script reference was released
+  // in the meantime), so the destructor only clears |owner| and whoever 
+  // drops the last reference deletes it
+  struct DrainHandle {
+    nsScriptableObjectSimpleIO* owner;
+    volatile LONG refs; // ours + one per scheduled drain
+  };
+
+  static void DrainCompletions(void* handle);
+  static void ReleaseDrainHandle(DrainHandle* handle);
+
+  // a request that was cancelled by the time its |Execute| returned - 
+  // released right away, unless it holds a script callback (that one waits
+  // for |ReapCancelledRequests|)
+  void DropRequest(Request* request);
+
+  // releases the dropped requests on the browser thread - piggybacks on the
+  // next call into the plugin or drain of |completions_|, so cancelling 
+  // never schedules a browser call of its own. Requests whose partial 
+  // results are still queued wait for them, unless |all|.
+  void ReapCancelledRequests(bool all);
+
+  // methods that return their result right away (they don't queue behind
+  // the requests they report on)
+  typedef bool (nsScriptableObjectSimpleIO::*SyncMethod)(
+    const NPVariant *args, 
+    uint32_t argCount, 
+    NPVariant *result);
+
+  // cancel(id) - cancels a one-shot method call by the id it returned: 
+  // dropped if still queued, stopped early if it supports it (e.g. long 
+  // reads stop at their next chunk) and its callback is never called.
+  // Returns false when there's no such call in flight (already completed)
+  bool Cancel(const NPVariant *args, uint32_t argCount, NPVariant *result);
+
+  // getStats() - returns the statistics of all methods as JSON
+  bool GetStats(const NPVariant *args, uint32_t argCount, NPVariant *result);
+
+  // startTracing([capacity]) - starts recording spans (see utils::Trace)
+  bool StartTracing(
+    const NPVariant *args, uint32_t argCount, NPVariant *result);
+
+  // stopTracing()
+  bool StopTracing(
+    const NPVariant *args, uint32_t argCount, NPVariant *result);
+
+  // getTrace() - returns the recorded spans as Chrome trace event JSON
+  bool GetTrace(const NPVariant *args, uint32_t argCount, NPVariant *result);
+
+  // listenOnFile/stopFileListen and watchDirectory/stopDirectoryWatch - 
+  // handled by the long lived |listen_on_file_method_| and 
+  // |watch_directory_method_|
+  bool ListenOnFile(
+    const NPVariant *args, uint32_t argCount, NPVariant *result);
+  bool StopFileListen(
+    const NPVariant *args, uint32_t argCount, NPVariant *result);
+  bool WatchDirectory(
+    const NPVariant *args, uint32_t argCount, NPVariant *result);
+  bool StopDirectoryWatch(
+    const NPVariant *args, uint32_t argCount, NPVariant *result);
+
+  // the public methods - a row per method (see kMethods), either:
+  // - a one-shot method: created per call by |create| (which unmarshals the
+  //   arguments by the method's signature) and run on |thread_|
+  // - a sync method, run on the browser thread
+  struct MethodInfo {
+    const char* name;
+    PluginMethod::Factory create;
+    // the expected arguments - for the exception when they don't match
+    uint32_t params_count;
+    const char* params;
+    SyncMethod sync;
+  };
+
+  static const MethodInfo kMethods[];
+
+  struct MethodEntry {
+    MethodEntry() : info(nullptr), stats(nullptr) {
+    }
+
+    const MethodInfo* info;
+    utils::RequestStats* stats; // one-shot methods
+  };
+
+  static void SetStringResult(const std::string& value, NPVariant *result);
 
 // member variables
 private:
-  // holds the public methods
-  typedef std::map<NPIdentifier, PluginMethod*> MethodsMap;
+  // holds the public methods (of |kMethods|) by their identifiers - looked
+  // up on every call
+  typedef utils::FlatPointerMap<MethodEntry> MethodsMap;
   MethodsMap methods_;
 
+  // the statistics of the one-shot methods (in |kMethods| order)
+  typedef std::vector<utils::RequestStats*> StatsList;
+  StatsList stats_;
+  unsigned __int64 created_us_;
+  volatile LONG next_request_id_;
+
+  // the one-shot calls in flight, by their ids (for cancel) - added on the
+  // browser thread, removed on either thread
+  typedef std::map<unsigned int, Request*> RequestsMap;
+  RequestsMap requests_;
+
+  // see |DropRequest|
+  typedef std::vector<Request*> RequestsList;
+  RequestsList cancelled_requests_;
+  volatile LONG has_cancelled_requests_;
+
+  // guards |requests_| and |cancelled_requests_|
+  utils::CriticalSection requests_critical_section_;
+
   // holds the public methods
   typedef std::map<NPIdentifier, std::string> PropertiesMap;
   PropertiesMap properties_;
@@ -56,14 +202,18 @@ private:
   // main browser thread - to be more responsive
   std::auto_ptr<utils::Thread> thread_;
 
-  // listenOnFile method (a little hacky)
-  std::auto_ptr<PluginMethodListenOnFile> listen_on_file_method_;
-};
+  // for methods that split their work between threads (started on demand)
+  std::auto_ptr<utils::ThreadPool> worker_pool_;
+
+  // callbacks on their way to the browser thread
+  std::auto_ptr<utils::CompletionQueue> completions_;
+  DrainHandle* drain_handle_;
 
-// declare our NPObject-derived scriptable object class
-DECLARE_NPOBJECT_CLASS_WITH_BASE(
-  nsScriptableObjectSimpleIO, 
-  AllocateNpObject<nsScriptableObjectSimpleIO>);
+  // listenOnFile method
+  std::auto_ptr<PluginMethodListenOnFile> listen_on_file_method_;
 
+  // watchDirectory method (same as listenOnFile)
+  std::auto_ptr<PluginMethodWatchDirectory> watch_directory_method_;
+};
 
 #endif // NNSSCRIPTABLEOBJECTSIMPLEIO_H_
\ No newline at end of file
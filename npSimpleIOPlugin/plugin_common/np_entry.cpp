@@ -3,11 +3,14 @@
 // Main plugin entry point implementation -- exports from the 
 // plugin library
 //
+#ifdef _WIN32
 #include <Windows.h>
+#endif
 #include <stddef.h>
 
 #include "npapi.h"
 #include "npfunctions.h"
+#include "pluginbase.h"
 
 #ifndef HIBYTE
 #define HIBYTE(x) ((((uint32_t)(x)) & 0xff00) >> 8)
@@ -143,7 +146,7 @@ NP_Initialize(NPNetscapeFuncs* pFuncs
   pluginFuncs->getvalue   = (NPP_GetValueProcPtr)(NPP_GetValue);
   pluginFuncs->javaClass  = NULL;
 
-  NPP_Initialize();
+  return NS_PluginInitialize();
 #endif
 
   return NPERR_NO_ERROR;
@@ -151,5 +154,6 @@ NP_Initialize(NPNetscapeFuncs* pFuncs
 
 NPError OSCALL NP_Shutdown()
 {
+   NS_PluginShutdown();
    return NPERR_NO_ERROR;
 }
@@ -2,12 +2,22 @@
 //
 // Implementation of Netscape entry points (NPN_*)
 //
+#ifdef _WIN32
 #include <windows.h>
+#endif
 #include <stdint.h>
 #include <npapi.h>
 #include <npfunctions.h>
 //#include "npplat.h"
 
+#ifndef HIBYTE
+#define HIBYTE(x) ((((uint32_t)(x)) & 0xff00) >> 8)
+#endif
+
+#ifndef LOBYTE
+#define LOBYTE(W) ((W) & 0xFF)
+#endif
+
 extern NPNetscapeFuncs NPNFuncs;
 
 void NPN_Version(int* plugin_major, int* plugin_minor, int* netscape_major, int* netscape_minor)
@@ -165,6 +175,11 @@ NPIdentifier NPN_GetStringIdentifier(const NPUTF8 *name)
    return (*NPNFuncs.getstringidentifier)(name);
 }
 
+NPIdentifier NPN_GetIntIdentifier(int32_t intid)
+{
+   return (*NPNFuncs.getintidentifier)(intid);
+}
+
 bool NPN_Enumerate(NPP npp, NPObject *npobj, NPIdentifier **identifier,
                            uint32_t *count)
 {
@@ -2,7 +2,9 @@
 //
 // Implementation of plugin entry points (NPP_*)
 //
+#ifdef _WIN32
 #include <windows.h>
+#endif
 #include <stdint.h>
 
 #include "pluginbase.h"
@@ -37,7 +39,7 @@ NPError NPP_New(NPMIMEType pluginType, NPP instance, uint16_t mode, int16_t argc
 }
 
 // here is the place to clean up and destroy the nsPluginInstance object
-NPError NPP_Destroy (NPP instance, NPSavedData** save)
+NPError NPP_Destroy (NPP instance, NPSavedData** /*save*/)
 {
   if (!instance)
     return NPERR_INVALID_INSTANCE_ERROR;
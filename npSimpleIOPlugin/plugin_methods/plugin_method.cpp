@@ -1,10 +1,253 @@
 #include "plugin_method.h"
 
+#include "nsScriptableObjectSimpleIO.h"
+#include "utils/ThreadPool.h"
+
+// a partial result that is delivered before the method completes
+struct PluginMethod::PartialResult : 
+  public utils::Pooled<PluginMethod::PartialResult> {
+  PluginMethod* method;
+  NPP npp;
+  NPObject* callback;
+  std::string data;
+  utils::CompletionQueue::Entry completion;
+};
+
 PluginMethod::PluginMethod(NPObject* object, NPP npp) : 
   object_(object),
-  npp_(npp) {
+  npp_(npp),
+  pending_partial_results_(0) {
 }
 
 PluginMethod::~PluginMethod() {
 
 }
+
+// virtual
+bool PluginMethod::Succeeded() {
+  return true;
+}
+
+// virtual
+size_t PluginMethod::ResultSize() {
+  return 0;
+}
+
+void PluginMethod::Cancel() {
+  cancellation_.Cancel();
+}
+
+bool PluginMethod::IsCancelled() const {
+  return cancellation_.IsCancelled();
+}
+
+bool PluginMethod::HasPendingPartialResults() const {
+  return (0 != pending_partial_results_);
+}
+
+bool PluginMethod::GetOptionString(
+  NPObject* options, 
+  const char* name, 
+  std::string& ref_value) {
+
+  if (nullptr == options) {
+    return false;
+  }
+
+  NPIdentifier id = NPN_GetStringIdentifier(name);
+  NPVariant value;
+  if (!NPN_HasProperty(npp_, options, id) ||
+      !NPN_GetProperty(npp_, options, id, &value)) {
+    return false;
+  }
+
+  bool status = NPVARIANT_IS_STRING(value);
+  if (status) {
+    ref_value.assign(
+      NPVARIANT_TO_STRING(value).UTF8Characters,
+      NPVARIANT_TO_STRING(value).UTF8Length);
+  }
+
+  NPN_ReleaseVariantValue(&value);
+  return status;
+}
+
+bool PluginMethod::GetOptionNumber(
+  NPObject* options, 
+  const char* name, 
+  double& ref_value) {
+
+  if (nullptr == options) {
+    return false;
+  }
+
+  NPIdentifier id = NPN_GetStringIdentifier(name);
+  NPVariant value;
+  if (!NPN_HasProperty(npp_, options, id) ||
+      !NPN_GetProperty(npp_, options, id, &value)) {
+    return false;
+  }
+
+  // browsers differ in how they pass whole numbers
+  bool status = true;
+  if (NPVARIANT_IS_DOUBLE(value)) {
+    ref_value = NPVARIANT_TO_DOUBLE(value);
+  } else if (NPVARIANT_IS_INT32(value)) {
+    ref_value = NPVARIANT_TO_INT32(value);
+  } else {
+    status = false;
+  }
+
+  NPN_ReleaseVariantValue(&value);
+  return status;
+}
+
+bool PluginMethod::GetOptionBool(
+  NPObject* options, 
+  const char* name, 
+  bool& ref_value) {
+
+  if (nullptr == options) {
+    return false;
+  }
+
+  NPIdentifier id = NPN_GetStringIdentifier(name);
+  NPVariant value;
+  if (!NPN_HasProperty(npp_, options, id) ||
+      !NPN_GetProperty(npp_, options, id, &value)) {
+    return false;
+  }
+
+  bool status = NPVARIANT_IS_BOOLEAN(value);
+  if (status) {
+    ref_value = NPVARIANT_TO_BOOLEAN(value);
+  }
+
+  NPN_ReleaseVariantValue(&value);
+  return status;
+}
+
+bool PluginMethod::GetStringArray(
+  const NPVariant& value, 
+  std::vector<std::string>& ref_values) {
+
+  ref_values.clear();
+
+  if (NPVARIANT_IS_STRING(value)) {
+    ref_values.push_back(std::string(
+      NPVARIANT_TO_STRING(value).UTF8Characters,
+      NPVARIANT_TO_STRING(value).UTF8Length));
+    return true;
+  }
+
+  if (!NPVARIANT_IS_OBJECT(value)) {
+    return false;
+  }
+
+  NPObject* array = NPVARIANT_TO_OBJECT(value);
+  double length = 0;
+  if (!GetOptionNumber(array, "length", length)) {
+    return false;
+  }
+
+  for (int i = 0; i < (int)length; i++) {
+    NPVariant item;
+    if (!NPN_GetProperty(npp_, array, NPN_GetIntIdentifier(i), &item)) {
+      return false;
+    }
+
+    bool is_string = NPVARIANT_IS_STRING(item);
+    if (is_string) {
+      ref_values.push_back(std::string(
+        NPVARIANT_TO_STRING(item).UTF8Characters,
+        NPVARIANT_TO_STRING(item).UTF8Length));
+    }
+
+    NPN_ReleaseVariantValue(&item);
+
+    if (!is_string) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void PluginMethod::PostPartialResult(NPObject* callback, std::string& ref_data) {
+  if (cancellation_.IsCancelled()) {
+    ref_data.clear();
+    return;
+  }
+
+  InterlockedIncrement(&pending_partial_results_);
+
+  PartialResult* partial = new PartialResult;
+  partial->method = this;
+  partial->npp = npp_;
+  partial->callback = callback;
+  partial->data.swap(ref_data);
+
+  PostCallback(&partial->completion, TriggerPartialResultCallback, partial);
+}
+
+// static
+void PluginMethod::TriggerPartialResultCallback(void* param) {
+  PartialResult* partial = reinterpret_cast<PartialResult*>(param);
+  PluginMethod* method = partial->method;
+
+  if (method->IsCancelled()) {
+    InterlockedDecrement(&method->pending_partial_results_);
+    delete partial;
+    return;
+  }
+
+  NPVariant args[3];
+  NPVariant ret_val;
+
+  BOOLEAN_TO_NPVARIANT(
+    true,
+    args[0]);
+
+  STRINGN_TO_NPVARIANT(
+    partial->data.c_str(),
+    partial->data.size(),
+    args[1]);
+
+  BOOLEAN_TO_NPVARIANT(
+    false, // more to come
+    args[2]);
+
+  // fire callback
+  NPN_InvokeDefault(
+    partial->npp, 
+    partial->callback, 
+    args, 
+    3, 
+    &ret_val);
+
+  NPN_ReleaseVariantValue(&ret_val);
+
+  InterlockedDecrement(&method->pending_partial_results_);
+  delete partial;
+}
+
+void PluginMethod::PostCallback(
+  utils::CompletionQueue::Entry* entry,
+  utils::CompletionQueue::Callback callback,
+  void* param) {
+  static_cast<nsScriptableObjectSimpleIO*>(object_)->PostCallback(
+    entry, 
+    callback, 
+    param);
+}
+
+utils::ThreadPool* PluginMethod::worker_pool() {
+  return static_cast<nsScriptableObjectSimpleIO*>(object_)->worker_pool();
+}
+
+bool PluginMethod::EnsureWorkerPool() {
+  // methods are executed one at a time (on the plugin's thread), so there's
+  // no need to lock
+  utils::ThreadPool* pool = worker_pool();
+  return (nullptr != pool) && ((pool->size() > 0) || pool->Start());
+}
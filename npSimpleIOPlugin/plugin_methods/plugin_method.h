@@ -6,6 +6,17 @@
 #define PLUGIN_METHODS_PLUGIN_METHOD_H_
 
 #include <nsScriptableObjectBase.h>
+#include <plugin_methods/plugin_method_args.h>
+#include <utils/Arena.h>
+#include <utils/CancellationToken.h>
+#include <utils/CompletionQueue.h>
+#include <utils/ObjectPool.h>
+#include <string>
+#include <vector>
+
+namespace utils {
+class ThreadPool;
+}
 
 class PluginMethod {
 public:
@@ -13,19 +24,159 @@ public:
   virtual ~PluginMethod();
 
 public:
-  virtual PluginMethod* Clone(
+  // creates a method for a call from script - nullptr if the arguments 
+  // don't match (see PluginMethodImpl::Create)
+  typedef PluginMethod* (*Factory)(
     NPObject* object, 
     NPP npp, 
     const NPVariant *args, 
-    uint32_t argCount, 
-    NPVariant *result) = 0;
+    uint32_t argCount);
+
   virtual bool HasCallback() = 0;
   virtual void Execute() = 0;
   virtual void TriggerCallback() = 0;
 
+  // for getStats() - called after |Execute|: whether the method failed and
+  // the size (in bytes) of the result it hands to script
+  virtual bool Succeeded();
+  virtual size_t ResultSize();
+
+  // cancel(id) - can be called from any thread, at any time. Long running
+  // methods poll |cancellation_| and stop early; the partial results that
+  // are still on their way aren't handed to script.
+  void Cancel();
+  bool IsCancelled() const;
+
+  // partial results posted but not delivered yet (browser thread) - the
+  // method has to outlive them
+  bool HasPendingPartialResults() const;
+
+protected:
+  // helpers for reading the properties of an optional |options| object
+  // passed from script - return false if the property is missing or of a
+  // different type (|ref_value| is then left untouched)
+  bool GetOptionString(
+    NPObject* options, 
+    const char* name, 
+    std::string& ref_value);
+  bool GetOptionNumber(NPObject* options, const char* name, double& ref_value);
+  bool GetOptionBool(NPObject* options, const char* name, bool& ref_value);
+
+  // reads a script array of strings - a single string is also accepted
+  bool GetStringArray(
+    const NPVariant& value, 
+    std::vector<std::string>& ref_values);
+
+  // Posts callback(true, |ref_data|, false) to the browser thread - for
+  // methods that deliver results in parts before their |TriggerCallback|
+  // (parts share the completion queue with it, so they arrive in order and
+  // before it). Dropped once the method is cancelled.
+  // |ref_data| is swapped out, not copied.
+  void PostPartialResult(NPObject* callback, std::string& ref_data);
+
+  // runs |callback|(|param|) on the browser thread, in order with the other
+  // completions (see nsScriptableObjectSimpleIO::PostCallback)
+  void PostCallback(
+    utils::CompletionQueue::Entry* entry,
+    utils::CompletionQueue::Callback callback,
+    void* param);
+
+  // the worker pool of the plugin object - for methods that split their 
+  // work between threads. Not started until |EnsureWorkerPool|.
+  utils::ThreadPool* worker_pool();
+
+  // Starts the worker pool the first time a method needs it. Call it from 
+  // |Execute| and fail the call if it returns false.
+  bool EnsureWorkerPool();
+
+private:
+  struct PartialResult;
+  static void TriggerPartialResultCallback(void* param);
+
 protected:
   NPObject* object_;
   NPP npp_;
+
+  // the transient buffers of a clone - released with it, in one go
+  utils::Arena arena_;
+
+  utils::CancellationToken cancellation_;
+
+private:
+  volatile LONG pending_partial_results_;
+};
+
+// The base of the methods that are created per call (see 
+// nsScriptableObjectSimpleIO's method table). |Create| unmarshals the 
+// script arguments by |TSignature| and hands them to T::Init, which copies
+// what Execute needs - the arguments are only valid during the call:
+//
+//   class PluginMethodFileExists : 
+//     public PluginMethodImpl<
+//       PluginMethodFileExists, 
+//       MethodSignature<ArgString, ArgCallback> > {
+//   public:
+//     bool Init(const Args& args);
+//
+// The |ArgCallback| argument ends up in |callback_|, retained for as long 
+// as the method lives.
+template <class T, class TSignature>
+class PluginMethodImpl : 
+  public PluginMethod,
+  public utils::Pooled<T> {
+public:
+  typedef TSignature Signature;
+  typedef typename TSignature::Args Args;
+
+  PluginMethodImpl(NPObject* object, NPP npp) : 
+    PluginMethod(object, npp),
+    callback_(nullptr) {
+  }
+
+  virtual ~PluginMethodImpl() {
+    if (nullptr != callback_) {
+      NPN_ReleaseObject(callback_);
+    }
+  }
+
+public:
+  // a |PluginMethod::Factory|
+  static PluginMethod* Create(
+    NPObject* object, 
+    NPP npp, 
+    const NPVariant *args, 
+    uint32_t argCount) {
+
+    Args method_args;
+    if (!TSignature::Unmarshal(args, argCount, method_args)) {
+      return nullptr;
+    }
+
+    T* method = nullptr;
+    try {
+      method = new T(object, npp);
+      if (method->Init(method_args)) {
+        method->callback_ = TSignature::GetCallback(method_args);
+        if (nullptr != method->callback_) {
+          // add ref count to callback object so it won't delete
+          NPN_RetainObject(method->callback_);
+        }
+        return method;
+      }
+    } catch(...) {
+
+    }
+
+    delete method;
+    return nullptr;
+  }
+
+  virtual bool HasCallback() {
+    return (nullptr != callback_);
+  }
+
+protected:
+  NPObject* callback_;
 };
 
 #endif // PLUGIN_METHODS_PLUGIN_METHOD_H_
\ No newline at end of file
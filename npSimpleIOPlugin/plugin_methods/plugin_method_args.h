@@ -0,0 +1,238 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef PLUGIN_METHODS_PLUGIN_METHOD_ARGS_H_
+#define PLUGIN_METHODS_PLUGIN_METHOD_ARGS_H_
+
+#include <nsScriptableObjectBase.h>
+#include <utils/StringView.h>
+
+// The argument kinds a method signature is made of (see |MethodSignature|).
+// Each kind checks the type of an NPVariant and unmarshals it into |Type| 
+// without copying - strings are views of the caller's NPString, valid for 
+// the duration of the call only (copy what the task keeps, e.g. into the
+// method's arena).
+
+// a string
+struct ArgString {
+  typedef utils::StringView Type;
+
+  static bool Unmarshal(const NPVariant& value, Type& ref_value) {
+    if (!NPVARIANT_IS_STRING(value)) {
+      return false;
+    }
+
+    ref_value = utils::StringView(
+      NPVARIANT_TO_STRING(value).UTF8Characters,
+      NPVARIANT_TO_STRING(value).UTF8Length);
+    return true;
+  }
+};
+
+struct ArgBool {
+  typedef bool Type;
+
+  static bool Unmarshal(const NPVariant& value, Type& ref_value) {
+    if (!NPVARIANT_IS_BOOLEAN(value)) {
+      return false;
+    }
+
+    ref_value = NPVARIANT_TO_BOOLEAN(value);
+    return true;
+  }
+};
+
+// browsers differ in how they pass whole numbers - int32 or double
+struct ArgNumber {
+  typedef double Type;
+
+  static bool Unmarshal(const NPVariant& value, Type& ref_value) {
+    if (NPVARIANT_IS_INT32(value)) {
+      ref_value = NPVARIANT_TO_INT32(value);
+    } else if (NPVARIANT_IS_DOUBLE(value)) {
+      ref_value = NPVARIANT_TO_DOUBLE(value);
+    } else {
+      return false;
+    }
+
+    return true;
+  }
+
+  // a count from script - NaN and negative numbers are 0, anything too 
+  // large for size_t (e.g. Infinity, for "all") is the largest size_t
+  static size_t ToCount(Type value) {
+    const size_t kMaxCount = (size_t)-1;
+    if (!(value > 0)) {
+      return 0;
+    }
+    return (value >= (double)kMaxCount) ? kMaxCount : (size_t)value;
+  }
+};
+
+// an options object - null and undefined are accepted (nullptr)
+struct ArgOptions {
+  typedef NPObject* Type;
+
+  static bool Unmarshal(const NPVariant& value, Type& ref_value) {
+    if (NPVARIANT_IS_OBJECT(value)) {
+      ref_value = NPVARIANT_TO_OBJECT(value);
+    } else if (NPVARIANT_IS_NULL(value) || NPVARIANT_IS_VOID(value)) {
+      ref_value = nullptr;
+    } else {
+      return false;
+    }
+
+    return true;
+  }
+};
+
+// the function called with the result - retained by the method
+struct ArgCallback {
+  typedef NPObject* Type;
+
+  static bool Unmarshal(const NPVariant& value, Type& ref_value) {
+    if (!NPVARIANT_IS_OBJECT(value)) {
+      return false;
+    }
+
+    ref_value = NPVARIANT_TO_OBJECT(value);
+    return true;
+  }
+};
+
+// anything - for arguments of more than one type (e.g. a string or an array
+// of strings), checked by the method itself
+struct ArgVariant {
+  typedef const NPVariant* Type;
+
+  static bool Unmarshal(const NPVariant& value, Type& ref_value) {
+    ref_value = &value;
+    return true;
+  }
+};
+
+// an unused slot of |MethodSignature|
+struct NoArg {
+  typedef int Type;
+};
+
+namespace internal {
+
+template <class TArg>
+struct ArgSlot {
+  enum { kCount = 1 };
+
+  static bool Unmarshal(
+    const NPVariant* args, 
+    uint32_t index, 
+    typename TArg::Type& ref_value) {
+    return TArg::Unmarshal(args[index], ref_value);
+  }
+
+  static void GetCallback(
+    const typename TArg::Type& /*value*/, 
+    NPObject*& /*ref_callback*/) {
+  }
+};
+
+template <>
+struct ArgSlot<ArgCallback> {
+  enum { kCount = 1 };
+
+  static bool Unmarshal(
+    const NPVariant* args, 
+    uint32_t index, 
+    ArgCallback::Type& ref_value) {
+    return ArgCallback::Unmarshal(args[index], ref_value);
+  }
+
+  static void GetCallback(
+    const ArgCallback::Type& value, 
+    NPObject*& ref_callback) {
+    ref_callback = value;
+  }
+};
+
+template <>
+struct ArgSlot<NoArg> {
+  enum { kCount = 0 };
+
+  static bool Unmarshal(
+    const NPVariant* /*args*/, 
+    uint32_t /*index*/, 
+    NoArg::Type& /*ref_value*/) {
+    return true;
+  }
+
+  static void GetCallback(
+    const NoArg::Type& /*value*/, 
+    NPObject*& /*ref_callback*/) {
+  }
+};
+
+}; // namespace internal
+
+// The arguments a method expects, in order - e.g. 
+//
+//   typedef MethodSignature<ArgString, ArgNumber, ArgCallback> Signature;
+//
+// for getLastLines( filename, count, callback ). |Unmarshal| checks the 
+// count and the types of the script arguments and fills |Args| (a0, a1, ..)
+// - trailing arguments beyond the signature are ignored.
+// (fixed arity, with |NoArg| for the unused slots - no variadic templates in
+// VS2010)
+template <
+  class TArg0 = NoArg, 
+  class TArg1 = NoArg, 
+  class TArg2 = NoArg, 
+  class TArg3 = NoArg,
+  class TArg4 = NoArg>
+struct MethodSignature {
+  enum { 
+    kCount = 
+      internal::ArgSlot<TArg0>::kCount + 
+      internal::ArgSlot<TArg1>::kCount + 
+      internal::ArgSlot<TArg2>::kCount + 
+      internal::ArgSlot<TArg3>::kCount + 
+      internal::ArgSlot<TArg4>::kCount
+  };
+
+  struct Args {
+    typename TArg0::Type a0;
+    typename TArg1::Type a1;
+    typename TArg2::Type a2;
+    typename TArg3::Type a3;
+    typename TArg4::Type a4;
+  };
+
+  static bool Unmarshal(
+    const NPVariant* args, 
+    uint32_t argCount, 
+    Args& ref_args) {
+
+    if (argCount < kCount) {
+      return false;
+    }
+
+    return 
+      internal::ArgSlot<TArg0>::Unmarshal(args, 0, ref_args.a0) &&
+      internal::ArgSlot<TArg1>::Unmarshal(args, 1, ref_args.a1) &&
+      internal::ArgSlot<TArg2>::Unmarshal(args, 2, ref_args.a2) &&
+      internal::ArgSlot<TArg3>::Unmarshal(args, 3, ref_args.a3) &&
+      internal::ArgSlot<TArg4>::Unmarshal(args, 4, ref_args.a4);
+  }
+
+  // the |ArgCallback| argument (nullptr if there is none)
+  static NPObject* GetCallback(const Args& args) {
+    NPObject* callback = nullptr;
+    internal::ArgSlot<TArg0>::GetCallback(args.a0, callback);
+    internal::ArgSlot<TArg1>::GetCallback(args.a1, callback);
+    internal::ArgSlot<TArg2>::GetCallback(args.a2, callback);
+    internal::ArgSlot<TArg3>::GetCallback(args.a3, callback);
+    internal::ArgSlot<TArg4>::GetCallback(args.a4, callback);
+    return callback;
+  }
+};
+
+#endif // PLUGIN_METHODS_PLUGIN_METHOD_ARGS_H_
\ No newline at end of file
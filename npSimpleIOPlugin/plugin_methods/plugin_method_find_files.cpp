@@ -0,0 +1,155 @@
+#include "plugin_method_find_files.h"
+
+#include "utils/Encoders.h"
+#include "utils/DirectoryWalker.h"
+#include "utils/Glob.h"
+#include "utils/ThreadPool.h"
+
+#include <stdio.h>
+
+const size_t kBatchSize = 500;
+
+// findFiles( root, globs, maxDepth, callback(status, files, done) )
+//
+// globs: an array of glob patterns (or a single pattern) - patterns starting
+//        with '!' exclude files and prune whole directories, 
+//        e.g. ["*.esp", "*.esm", "!**/backup"]
+// maxDepth: number of directory levels to descend (-1 for no limit)
+//
+// files is a JSON array of:
+// { path, size, modified } (path relative to root, time in ms since 1970)
+PluginMethodFindFiles::PluginMethodFindFiles(
+  NPObject* object, NPP npp) : 
+  PluginMethodImpl(object, npp),
+  pool_(worker_pool()) {
+}
+
+bool PluginMethodFindFiles::Init(const Args& args) {
+  if (!GetStringArray(*args.a1, globs_)) {
+    return false;
+  }
+
+  root_.assign(args.a0.data, args.a0.size);
+  max_depth_ = (int)args.a2;
+  return true;
+}
+
+// virtual
+void PluginMethodFindFiles::Execute() {
+  output_.clear();
+  status_ = false;
+
+  try {
+    utils::GlobSet globs;
+    if (!globs.Compile(globs_)) {
+      output_ = "[]";
+      return;
+    }
+
+    if (!EnsureWorkerPool()) {
+      output_ = "[]";
+      return;
+    }
+
+    utils::DirectoryWalker walker;
+    status_ = walker.Walk(
+      pool_,
+      utils::Encoders::utf8_decode(root_),
+      globs,
+      max_depth_,
+      kBatchSize,
+      std::bind(
+        &PluginMethodFindFiles::OnBatch, 
+        this, 
+        std::placeholders::_1));
+  } catch(...) {
+    status_ = false;
+  }
+
+  output_ = "[]";
+}
+
+// virtual
+void PluginMethodFindFiles::TriggerCallback() {
+  NPVariant args[3];
+  NPVariant ret_val;
+
+  BOOLEAN_TO_NPVARIANT(
+    status_,
+    args[0]);
+
+  STRINGN_TO_NPVARIANT(
+    output_.c_str(),
+    output_.size(),
+    args[1]);
+
+  BOOLEAN_TO_NPVARIANT(
+    true, // done
+    args[2]);
+
+  // fire callback
+  NPN_InvokeDefault(
+    npp_, 
+    callback_, 
+    args, 
+    3, 
+    &ret_val);
+
+  NPN_ReleaseVariantValue(&ret_val);
+}
+
+bool PluginMethodFindFiles::OnBatch(
+  const utils::File::DirectoryEntries& batch) {
+
+  if (cancellation_.IsCancelled()) {
+    return false;
+  }
+
+  std::string data;
+  FormatBatch(batch, data);
+  PostPartialResult(callback_, data);
+  return true;
+}
+
+// static
+void PluginMethodFindFiles::FormatBatch(
+  const utils::File::DirectoryEntries& batch, 
+  std::string& ref_output) {
+
+  ref_output.clear();
+  ref_output.reserve(batch.size() * 128);
+  ref_output += '[';
+
+  char numbers[64];
+  utils::File::DirectoryEntries::const_iterator iter = batch.begin();
+  for (; iter != batch.end(); ++iter) {
+    if (iter != batch.begin()) {
+      ref_output += ',';
+    }
+
+    ref_output += "{\"path\":";
+    utils::Encoders::json_append_string(
+      iter->name.c_str(), 
+      iter->name.size(), 
+      ref_output);
+
+    sprintf_s(
+      numbers,
+      ",\"size\":%" FORMAT_UINT64 ",\"modified\":%" FORMAT_INT64 "}",
+      iter->size,
+      utils::File::FileTimeToJsTime(iter->last_write_time));
+    ref_output += numbers;
+  }
+
+  ref_output += ']';
+}
+
+// virtual
+bool PluginMethodFindFiles::Succeeded() {
+  return status_;
+}
+
+// virtual
+size_t PluginMethodFindFiles::ResultSize() {
+  return output_.size();
+}
\ No newline at end of file
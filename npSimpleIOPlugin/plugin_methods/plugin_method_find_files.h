@@ -0,0 +1,54 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef PLUGIN_METHODS_PLUGIN_METHOD_FIND_FILES_H_
+#define PLUGIN_METHODS_PLUGIN_METHOD_FIND_FILES_H_
+
+#include "plugin_method.h"
+#include <string>
+#include <vector>
+#include <utils/File.h>
+
+namespace utils {
+class ThreadPool;
+}
+
+// Recursively searches a directory tree for files matching a set of globs -
+// the tree is walked in parallel on the worker pool and matches are 
+// delivered (as JSON arrays) in batches
+class PluginMethodFindFiles : 
+  public PluginMethodImpl<
+    PluginMethodFindFiles, 
+    MethodSignature<ArgString, ArgVariant, ArgNumber, ArgCallback> > {
+public:
+  PluginMethodFindFiles(NPObject* object, NPP npp);
+
+public:
+  bool Init(const Args& args);
+  virtual void Execute();
+  virtual void TriggerCallback();
+  virtual bool Succeeded();
+  virtual size_t ResultSize();
+
+private:
+  bool OnBatch(const utils::File::DirectoryEntries& batch);
+
+  static void FormatBatch(
+    const utils::File::DirectoryEntries& batch, 
+    std::string& ref_output);
+
+protected:
+  utils::ThreadPool* pool_;
+
+  std::string root_;
+  std::vector<std::string> globs_;
+  int max_depth_;
+
+  // callback
+  bool status_;
+  std::string output_;
+};
+
+
+#endif // PLUGIN_METHODS_PLUGIN_METHOD_FIND_FILES_H_
\ No newline at end of file
@@ -2,80 +2,38 @@
 
 #include "utils/File.h"
 #include "utils/Encoders.h"
-
-#include <sstream>
+#include "utils/Trace.h"
 
 // getBinaryFile( filename, size_limit, callback(status, data) )
 PluginMethodGetBinaryFile::PluginMethodGetBinaryFile(NPObject* object, NPP npp) : 
-  PluginMethod(object, npp) {
-}
-
-//virtual 
-PluginMethod* PluginMethodGetBinaryFile::Clone(
-  NPObject* object, 
-  NPP npp, 
-  const NPVariant *args, 
-  uint32_t argCount, 
-  NPVariant *result) {
-
-  PluginMethodGetBinaryFile* clone = 
-    new PluginMethodGetBinaryFile(object, npp);
-
-  try {
-    if (argCount < 3 ||
-      !NPVARIANT_IS_STRING(args[0]) ||
-      !NPVARIANT_IS_DOUBLE(args[1]) ||
-      !NPVARIANT_IS_OBJECT(args[2])) {
-      NPN_SetException(
-        __super::object_, 
-        "invalid params passed to function");
-      delete clone;
-      return nullptr;
-    }
-
-    clone->callback_ = NPVARIANT_TO_OBJECT(args[2]);
-    // add ref count to callback object so it won't delete
-    NPN_RetainObject(clone->callback_);
-
-    clone->limit_ = (int)NPVARIANT_TO_DOUBLE(args[1]);
-
-    
-    clone->filename_.append(
-      NPVARIANT_TO_STRING(args[0]).UTF8Characters,
-      NPVARIANT_TO_STRING(args[0]).UTF8Length);
-
-    return clone;
-  } catch(...) {
-  }
-
-  delete clone;
-  return nullptr;
+  PluginMethodImpl(object, npp) {
 }
 
-// virtual
-bool PluginMethodGetBinaryFile::HasCallback() {
-  return (nullptr != callback_);
+bool PluginMethodGetBinaryFile::Init(const Args& args) {
+  filename_ = arena_.CopyString(args.a0.data, args.a0.size);
+  limit_ = (int)args.a1;
+  return true;
 }
 
 // virtual
 void PluginMethodGetBinaryFile::Execute() {
-  std::wstring wide_filename = utils::Encoders::utf8_decode(filename_);
-
-  status_ = utils::File::GetTextFile(wide_filename, output_, limit_);
-
-  if (!status_) {
+  std::wstring wide_filename = 
+    utils::Encoders::utf8_decode(filename_.data, filename_.size);
+
+  status_ = utils::File::GetTextFile(
+    wide_filename, 
+    output_, 
+    limit_, 
+    &cancellation_);
+
+  // a cancel that lands after the read still skips the encoding
+  if (!status_ || cancellation_.IsCancelled()) {
+    std::string().swap(output_);
     return;
   }
 
-  std::ostringstream str;
-  if (output_.size() > 0) {
-    str << (int)output_[0];
-  }
-  for (size_t i = 1; i < output_.size(); ++i) {
-    str << "," << (int)output_[i];
-  }
-
-  output_ = str.str();
+  utils::TraceScope trace("byte list", "marshal");
+  output_ = utils::Encoders::byte_list_encode(output_);
 }
 
 // virtual
@@ -94,11 +52,21 @@ void PluginMethodGetBinaryFile::TriggerCallback() {
 
   // fire callback
   NPN_InvokeDefault(
-    __super::npp_, 
+    npp_, 
     callback_, 
     args, 
     2, 
     &ret_val);
 
   NPN_ReleaseVariantValue(&ret_val);
+}
+
+// virtual
+bool PluginMethodGetBinaryFile::Succeeded() {
+  return status_;
+}
+
+// virtual
+size_t PluginMethodGetBinaryFile::ResultSize() {
+  return output_.size();
 }
\ No newline at end of file
@@ -8,25 +8,23 @@
 #include "plugin_method.h"
 #include <string>
 
-class PluginMethodGetBinaryFile : public PluginMethod {
+class PluginMethodGetBinaryFile : 
+  public PluginMethodImpl<
+    PluginMethodGetBinaryFile, 
+    MethodSignature<ArgString, ArgNumber, ArgCallback> > {
 public:
   PluginMethodGetBinaryFile(NPObject* object, NPP npp);
 
 public:
-  virtual PluginMethod* Clone(
-    NPObject* object, 
-    NPP npp, 
-    const NPVariant *args, 
-    uint32_t argCount, 
-    NPVariant *result);
-  virtual bool HasCallback();
+  bool Init(const Args& args);
   virtual void Execute();
   virtual void TriggerCallback();
+  virtual bool Succeeded();
+  virtual size_t ResultSize();
 
 protected:
-  std::string filename_;
+  utils::StringView filename_;
   int limit_;
-  NPObject* callback_;
 
   // callack
   bool status_;
@@ -8,30 +8,26 @@
 #include "plugin_method.h"
 #include <string>
 
-class PluginMethodGetFileTimes : public PluginMethod {
+class PluginMethodGetFileTimes : 
+  public PluginMethodImpl<
+    PluginMethodGetFileTimes, 
+    MethodSignature<ArgString, ArgCallback> > {
 public:
   PluginMethodGetFileTimes(NPObject* object, NPP npp);
 
 public:
-  virtual PluginMethod* Clone(
-    NPObject* object, 
-    NPP npp, 
-    const NPVariant *args, 
-    uint32_t argCount, 
-    NPVariant *result);
-  virtual bool HasCallback();
+  bool Init(const Args& args);
   virtual void Execute();
   virtual void TriggerCallback();
 
 protected:
-  std::string filename_;
-  NPObject* callback_;
+  utils::StringView filename_;
 
   // callack
   bool status_;
-  FILETIME creation_time_;
-  FILETIME last_access_time_;
-  FILETIME last_write_time_;
+  __int64 creation_time_; // FILETIME
+  __int64 last_access_time_; // FILETIME
+  __int64 last_write_time_; // FILETIME
 };
 
 
@@ -0,0 +1,93 @@
+#include "plugin_method_get_last_lines.h"
+
+#include "utils/File.h"
+#include "utils/Encoders.h"
+
+// getLastLines( filename, count, callback(status, lines) )
+//
+// lines is a JSON array of strings (oldest first)
+PluginMethodGetLastLines::PluginMethodGetLastLines(NPObject* object, NPP npp) : 
+  PluginMethodImpl(object, npp) {
+}
+
+bool PluginMethodGetLastLines::Init(const Args& args) {
+  filename_ = arena_.CopyString(args.a0.data, args.a0.size);
+  count_ = ArgNumber::ToCount(args.a1);
+  return true;
+}
+
+// virtual
+void PluginMethodGetLastLines::Execute() {
+  output_ = "[]";
+  status_ = false;
+
+  try {
+    std::vector<std::string> lines;
+    status_ = utils::File::GetLastLines(
+      utils::Encoders::utf8_decode(filename_.data, filename_.size), 
+      count_, 
+      lines);
+
+    if (!status_) {
+      return;
+    }
+
+    size_t output_size = 2;
+    for (size_t i = 0; i < lines.size(); i++) {
+      output_size += lines[i].size() + 3;
+    }
+
+    output_.clear();
+    output_.reserve(output_size);
+    output_ += '[';
+    for (size_t i = 0; i < lines.size(); i++) {
+      if (i > 0) {
+        output_ += ',';
+      }
+
+      utils::Encoders::json_append_string(
+        lines[i].c_str(), 
+        lines[i].size(), 
+        output_);
+    }
+    output_ += ']';
+  } catch(...) {
+    output_ = "[]";
+    status_ = false;
+  }
+}
+
+// virtual
+void PluginMethodGetLastLines::TriggerCallback() {
+  NPVariant args[2];
+  NPVariant ret_val;
+
+  BOOLEAN_TO_NPVARIANT(
+    status_,
+    args[0]);
+
+  STRINGN_TO_NPVARIANT(
+    output_.c_str(),
+    output_.size(),
+    args[1]);
+
+  // fire callback
+  NPN_InvokeDefault(
+    npp_, 
+    callback_, 
+    args, 
+    2, 
+    &ret_val);
+
+  NPN_ReleaseVariantValue(&ret_val);
+}
+
+// virtual
+bool PluginMethodGetLastLines::Succeeded() {
+  return status_;
+}
+
+// virtual
+size_t PluginMethodGetLastLines::ResultSize() {
+  return output_.size();
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef PLUGIN_METHODS_PLUGIN_METHOD_GET_LAST_LINES_H_
+#define PLUGIN_METHODS_PLUGIN_METHOD_GET_LAST_LINES_H_
+
+#include "plugin_method.h"
+#include <string>
+
+class PluginMethodGetLastLines : 
+  public PluginMethodImpl<
+    PluginMethodGetLastLines, 
+    MethodSignature<ArgString, ArgNumber, ArgCallback> > {
+public:
+  PluginMethodGetLastLines(NPObject* object, NPP npp);
+
+public:
+  bool Init(const Args& args);
+  virtual void Execute();
+  virtual void TriggerCallback();
+  virtual bool Succeeded();
+  virtual size_t ResultSize();
+
+protected:
+  utils::StringView filename_;
+  size_t count_;
+
+  // callback
+  bool status_;
+  std::string output_;
+};
+
+
+#endif // PLUGIN_METHODS_PLUGIN_METHOD_GET_LAST_LINES_H_
\ No newline at end of file
@@ -5,71 +5,30 @@
 
 // getTextFile( filename, widechar, callback(status, data) )
 PluginMethodGetTextFile::PluginMethodGetTextFile(NPObject* object, NPP npp) : 
-  PluginMethod(object, npp) {
+  PluginMethodImpl(object, npp) {
 }
 
-//virtual 
-PluginMethod* PluginMethodGetTextFile::Clone(
-  NPObject* object, 
-  NPP npp, 
-  const NPVariant *args, 
-  uint32_t argCount, 
-  NPVariant *result) {
-
-  PluginMethodGetTextFile* clone = 
-    new PluginMethodGetTextFile(object, npp);
-
-  try {
-    if (argCount < 3 ||
-      !NPVARIANT_IS_STRING(args[0]) ||
-      !NPVARIANT_IS_BOOLEAN(args[1]) ||
-      !NPVARIANT_IS_OBJECT(args[2])) {
-      NPN_SetException(
-        __super::object_, 
-        "invalid params passed to function");
-      delete clone;
-      return nullptr;
-    }
-
-    clone->callback_ = NPVARIANT_TO_OBJECT(args[2]);
-    // add ref count to callback object so it won't delete
-    NPN_RetainObject(clone->callback_);
-
-    clone->widechars_ = NPVARIANT_TO_BOOLEAN(args[1]);
-
-    clone->filename_.append(
-      NPVARIANT_TO_STRING(args[0]).UTF8Characters,
-      NPVARIANT_TO_STRING(args[0]).UTF8Length);
-  
-    return clone;
-  } catch(...) {
-
-  }
-
-  delete clone;
-  return nullptr;
-}
-
-// virtual
-bool PluginMethodGetTextFile::HasCallback() {
-  return (nullptr != callback_);
+bool PluginMethodGetTextFile::Init(const Args& args) {
+  filename_ = arena_.CopyString(args.a0.data, args.a0.size);
+  widechars_ = args.a1;
+  return true;
 }
 
 // virtual
 void PluginMethodGetTextFile::Execute() {
-  std::wstring wide_filename = utils::Encoders::utf8_decode(filename_);
-
-  status_ = utils::File::GetTextFile(wide_filename, output_, -1);
+  std::wstring wide_filename = 
+    utils::Encoders::utf8_decode(filename_.data, filename_.size);
 
-  if (status_ && widechars_) {
-    try {
-      std::wstring wstr((wchar_t*)output_.c_str(), output_.size()/2);
-      const wchar_t* b = wstr.c_str();
-      output_ = utils::Encoders::utf8_encode(wstr);
-      const char* debug = output_.c_str();
-    } catch(...) {
-      status_ = false;
-    }
+  try {
+    // |widechars_| is only a hint for files without a BOM
+    status_ = utils::File::GetTextFileUtf8(
+      wide_filename, 
+      output_, 
+      widechars_,
+      &cancellation_);
+  } catch(...) {
+    output_.clear();
+    status_ = false;
   }
 }
 
@@ -89,11 +48,21 @@ void PluginMethodGetTextFile::TriggerCallback() {
 
   // fire callback
   NPN_InvokeDefault(
-    __super::npp_, 
+    npp_, 
     callback_, 
     args, 
     2, 
     &ret_val);
 
   NPN_ReleaseVariantValue(&ret_val);
+}
+
+// virtual
+bool PluginMethodGetTextFile::Succeeded() {
+  return status_;
+}
+
+// virtual
+size_t PluginMethodGetTextFile::ResultSize() {
+  return output_.size();
 }
\ No newline at end of file
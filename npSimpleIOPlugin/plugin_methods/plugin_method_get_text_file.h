@@ -8,25 +8,23 @@
 #include "plugin_method.h"
 #include <string>
 
-class PluginMethodGetTextFile : public PluginMethod {
+class PluginMethodGetTextFile : 
+  public PluginMethodImpl<
+    PluginMethodGetTextFile, 
+    MethodSignature<ArgString, ArgBool, ArgCallback> > {
 public:
   PluginMethodGetTextFile(NPObject* object, NPP npp);
 
 public:
-  virtual PluginMethod* Clone(
-    NPObject* object, 
-    NPP npp, 
-    const NPVariant *args, 
-    uint32_t argCount, 
-    NPVariant *result);
-  virtual bool HasCallback();
+  bool Init(const Args& args);
   virtual void Execute();
   virtual void TriggerCallback();
+  virtual bool Succeeded();
+  virtual size_t ResultSize();
 
 protected:
-  std::string filename_;
+  utils::StringView filename_;
   bool widechars_;
-  NPObject* callback_;
 
   // callack
   bool status_;
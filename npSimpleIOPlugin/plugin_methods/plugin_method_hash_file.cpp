@@ -0,0 +1,85 @@
+#include "plugin_method_hash_file.h"
+
+#include "utils/Encoders.h"
+#include "utils/FileHash.h"
+#include "utils/ThreadPool.h"
+
+// hashFile( filename, algorithm, callback(status, digest) )
+//
+// algorithm: "xxh64", "crc32c" or "sha256"
+// digest: lower case hex
+PluginMethodHashFile::PluginMethodHashFile(
+  NPObject* object, NPP npp) : 
+  PluginMethodImpl(object, npp),
+  pool_(worker_pool()) {
+}
+
+bool PluginMethodHashFile::Init(const Args& args) {
+  if (!utils::Hasher::ParseAlgorithm(args.a1.str(), algorithm_)) {
+    return false;
+  }
+
+  filename_ = arena_.CopyString(args.a0.data, args.a0.size);
+  return true;
+}
+
+// virtual
+void PluginMethodHashFile::Execute() {
+  output_.clear();
+  status_ = false;
+
+  try {
+    if (!EnsureWorkerPool()) {
+      return;
+    }
+
+    std::string digest;
+    status_ = utils::FileHash::HashParallel(
+      pool_,
+      utils::Encoders::utf8_decode(filename_.data, filename_.size), 
+      algorithm_, 
+      digest);
+
+    if (status_) {
+      utils::Hasher::ToHex(digest, output_);
+    }
+  } catch(...) {
+    output_.clear();
+    status_ = false;
+  }
+}
+
+// virtual
+void PluginMethodHashFile::TriggerCallback() {
+  NPVariant args[2];
+  NPVariant ret_val;
+
+  BOOLEAN_TO_NPVARIANT(
+    status_,
+    args[0]);
+
+  STRINGN_TO_NPVARIANT(
+    output_.c_str(),
+    output_.size(),
+    args[1]);
+
+  // fire callback
+  NPN_InvokeDefault(
+    npp_, 
+    callback_, 
+    args, 
+    2, 
+    &ret_val);
+
+  NPN_ReleaseVariantValue(&ret_val);
+}
+
+// virtual
+bool PluginMethodHashFile::Succeeded() {
+  return status_;
+}
+
+// virtual
+size_t PluginMethodHashFile::ResultSize() {
+  return output_.size();
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef PLUGIN_METHODS_PLUGIN_METHOD_HASH_FILE_H_
+#define PLUGIN_METHODS_PLUGIN_METHOD_HASH_FILE_H_
+
+#include "plugin_method.h"
+#include <string>
+#include <utils/Hasher.h>
+
+namespace utils {
+class ThreadPool;
+}
+
+// Hashes a file (see |utils::FileHash|) - only the digest is returned
+class PluginMethodHashFile : 
+  public PluginMethodImpl<
+    PluginMethodHashFile, 
+    MethodSignature<ArgString, ArgString, ArgCallback> > {
+public:
+  PluginMethodHashFile(NPObject* object, NPP npp);
+
+public:
+  bool Init(const Args& args);
+  virtual void Execute();
+  virtual void TriggerCallback();
+  virtual bool Succeeded();
+  virtual size_t ResultSize();
+
+protected:
+  utils::ThreadPool* pool_;
+
+  utils::StringView filename_;
+  utils::Hasher::Algorithm algorithm_;
+
+  // callback
+  bool status_;
+  std::string output_;
+};
+
+
+#endif // PLUGIN_METHODS_PLUGIN_METHOD_HASH_FILE_H_
\ No newline at end of file
@@ -0,0 +1,115 @@
+#include "plugin_method_hash_files.h"
+
+#include "utils/Encoders.h"
+#include "utils/FileHash.h"
+#include "utils/ThreadPool.h"
+
+// hashFiles( filenames, algorithm, callback(status, digests) )
+//
+// algorithm: "xxh64", "crc32c" or "sha256"
+// digests is a JSON array of:
+// { path, digest } (digest is lower case hex, or null if the file couldn't
+// be read)
+PluginMethodHashFiles::PluginMethodHashFiles(
+  NPObject* object, NPP npp) : 
+  PluginMethodImpl(object, npp),
+  pool_(worker_pool()) {
+}
+
+bool PluginMethodHashFiles::Init(const Args& args) {
+  return 
+    GetStringArray(*args.a0, filenames_) &&
+    utils::Hasher::ParseAlgorithm(args.a1.str(), algorithm_);
+}
+
+// virtual
+void PluginMethodHashFiles::Execute() {
+  output_ = "[]";
+  status_ = false;
+
+  try {
+    if (!EnsureWorkerPool()) {
+      return;
+    }
+
+    std::vector<std::wstring> filenames;
+    std::vector<std::string>::const_iterator iter = filenames_.begin();
+    for (; iter != filenames_.end(); ++iter) {
+      filenames.push_back(utils::Encoders::utf8_decode(*iter));
+    }
+
+    std::vector<std::string> digests;
+    status_ = utils::FileHash::HashFiles(
+      pool_, 
+      filenames, 
+      algorithm_, 
+      digests);
+
+    if (!status_) {
+      return;
+    }
+
+    std::string hex;
+    output_ = "[";
+    for (size_t i = 0; i < filenames_.size(); i++) {
+      if (i > 0) {
+        output_ += ',';
+      }
+
+      output_ += "{\"path\":";
+      utils::Encoders::json_append_string(
+        filenames_[i].c_str(), 
+        filenames_[i].size(), 
+        output_);
+
+      if (digests[i].empty()) {
+        output_ += ",\"digest\":null}";
+        continue;
+      }
+
+      utils::Hasher::ToHex(digests[i], hex);
+      output_ += ",\"digest\":\"";
+      output_ += hex;
+      output_ += "\"}";
+    }
+    output_ += ']';
+  } catch(...) {
+    output_ = "[]";
+    status_ = false;
+  }
+}
+
+// virtual
+void PluginMethodHashFiles::TriggerCallback() {
+  NPVariant args[2];
+  NPVariant ret_val;
+
+  BOOLEAN_TO_NPVARIANT(
+    status_,
+    args[0]);
+
+  STRINGN_TO_NPVARIANT(
+    output_.c_str(),
+    output_.size(),
+    args[1]);
+
+  // fire callback
+  NPN_InvokeDefault(
+    npp_, 
+    callback_, 
+    args, 
+    2, 
+    &ret_val);
+
+  NPN_ReleaseVariantValue(&ret_val);
+}
+
+// virtual
+bool PluginMethodHashFiles::Succeeded() {
+  return status_;
+}
+
+// virtual
+size_t PluginMethodHashFiles::ResultSize() {
+  return output_.size();
+}
\ No newline at end of file
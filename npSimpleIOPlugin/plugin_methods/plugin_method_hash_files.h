@@ -0,0 +1,45 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef PLUGIN_METHODS_PLUGIN_METHOD_HASH_FILES_H_
+#define PLUGIN_METHODS_PLUGIN_METHOD_HASH_FILES_H_
+
+#include "plugin_method.h"
+#include <string>
+#include <vector>
+#include <utils/Hasher.h>
+
+namespace utils {
+class ThreadPool;
+}
+
+// Hashes a list of files in parallel (see |utils::FileHash|) - the digests
+// are returned as a JSON array
+class PluginMethodHashFiles : 
+  public PluginMethodImpl<
+    PluginMethodHashFiles, 
+    MethodSignature<ArgVariant, ArgString, ArgCallback> > {
+public:
+  PluginMethodHashFiles(NPObject* object, NPP npp);
+
+public:
+  bool Init(const Args& args);
+  virtual void Execute();
+  virtual void TriggerCallback();
+  virtual bool Succeeded();
+  virtual size_t ResultSize();
+
+protected:
+  utils::ThreadPool* pool_;
+
+  std::vector<std::string> filenames_;
+  utils::Hasher::Algorithm algorithm_;
+
+  // callback
+  bool status_;
+  std::string output_;
+};
+
+
+#endif // PLUGIN_METHODS_PLUGIN_METHOD_HASH_FILES_H_
\ No newline at end of file
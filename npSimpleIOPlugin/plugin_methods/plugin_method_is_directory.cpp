@@ -5,58 +5,18 @@
 
 // isDirectory( filename, callback(status) )
 PluginMethodIsDirectory::PluginMethodIsDirectory(NPObject* object, NPP npp) : 
-  PluginMethod(object, npp) {
+  PluginMethodImpl(object, npp) {
 }
 
-//virtual 
-PluginMethod* PluginMethodIsDirectory::Clone(
-  NPObject* object, 
-  NPP npp, 
-  const NPVariant *args, 
-  uint32_t argCount, 
-  NPVariant *result) {
-
-  PluginMethodIsDirectory* clone = 
-    new PluginMethodIsDirectory(object, npp);
-
-  try {
-    if (argCount < 2 ||
-      !NPVARIANT_IS_STRING(args[0]) ||
-      !NPVARIANT_IS_OBJECT(args[1])) {
-        NPN_SetException(
-          __super::object_, 
-          "invalid params passed to function");
-        delete clone;
-        return nullptr;
-    }
-
-    clone->callback_ = NPVARIANT_TO_OBJECT(args[1]);
-    // add ref count to callback object so it won't delete
-    NPN_RetainObject(clone->callback_);
-
-    // convert into std::string
-    clone->filename_.append(
-      NPVARIANT_TO_STRING(args[0]).UTF8Characters,
-      NPVARIANT_TO_STRING(args[0]).UTF8Length);
-
-    return clone;
-  } catch(...) {
-
-  }
-
-
-  delete clone;
-  return nullptr;
-}
-
-// virtual
-bool PluginMethodIsDirectory::HasCallback() {
-  return (nullptr != callback_);
+bool PluginMethodIsDirectory::Init(const Args& args) {
+  filename_ = arena_.CopyString(args.a0.data, args.a0.size);
+  return true;
 }
 
 // virtual
 void PluginMethodIsDirectory::Execute() {
-  std::wstring wide_filename = utils::Encoders::utf8_decode(filename_);
+  std::wstring wide_filename = 
+    utils::Encoders::utf8_decode(filename_.data, filename_.size);
 
   directory_ = utils::File::IsDirectory(wide_filename);
 }
@@ -72,7 +32,7 @@ void PluginMethodIsDirectory::TriggerCallback() {
 
   // fire callback
   NPN_InvokeDefault(
-    __super::npp_, 
+    npp_, 
     callback_, 
     &arg, 
     1, 
@@ -8,24 +8,20 @@
 #include "plugin_method.h"
 #include <string>
 
-class PluginMethodIsDirectory: public PluginMethod {
+class PluginMethodIsDirectory : 
+  public PluginMethodImpl<
+    PluginMethodIsDirectory, 
+    MethodSignature<ArgString, ArgCallback> > {
 public:
   PluginMethodIsDirectory(NPObject* object, NPP npp);
 
 public:
-  virtual PluginMethod* Clone(
-    NPObject* object, 
-    NPP npp, 
-    const NPVariant *args, 
-    uint32_t argCount, 
-    NPVariant *result);
-  virtual bool HasCallback();
+  bool Init(const Args& args);
   virtual void Execute();
   virtual void TriggerCallback();
 
 protected:
-  std::string filename_;
-  NPObject* callback_;
+  utils::StringView filename_;
 
   // callack
   bool directory_;
@@ -0,0 +1,153 @@
+#include "plugin_method_list_directory.h"
+
+#include "utils/Encoders.h"
+
+#include <stdio.h>
+
+const size_t kDefaultPageSize = 1000;
+
+// listDirectory( path, options, callback(status, entries, done) )
+//
+// options (optional - pass null):
+// {
+//   filter: wildcard pattern, e.g. "*.log" (default: "*"),
+//   pageSize: max number of entries per callback (default: 1000)
+// }
+//
+// entries is a JSON array of:
+// { name, directory, size, created, modified } (times in ms since 1970)
+PluginMethodListDirectory::PluginMethodListDirectory(
+  NPObject* object, NPP npp) : 
+  PluginMethodImpl(object, npp) {
+}
+
+bool PluginMethodListDirectory::Init(const Args& args) {
+  directory_.assign(args.a0.data, args.a0.size);
+
+  double page_size = kDefaultPageSize;
+  if (nullptr != args.a1) {
+    GetOptionString(args.a1, "filter", filter_);
+    GetOptionNumber(args.a1, "pageSize", page_size);
+  }
+
+  page_size_ = (page_size >= 1) ? (size_t)page_size : 1;
+  return true;
+}
+
+// virtual
+void PluginMethodListDirectory::Execute() {
+  output_.clear();
+
+  try {
+    status_ = utils::File::ListDirectory(
+      utils::Encoders::utf8_decode(directory_),
+      utils::Encoders::utf8_decode(filter_),
+      page_size_,
+      std::bind(
+        &PluginMethodListDirectory::OnPage, 
+        this, 
+        std::placeholders::_1, 
+        std::placeholders::_2));
+  } catch(...) {
+    status_ = false;
+  }
+
+  if (!status_) {
+    output_ = "[]";
+  }
+}
+
+// virtual
+void PluginMethodListDirectory::TriggerCallback() {
+  NPVariant args[3];
+  NPVariant ret_val;
+
+  BOOLEAN_TO_NPVARIANT(
+    status_,
+    args[0]);
+
+  STRINGN_TO_NPVARIANT(
+    output_.c_str(),
+    output_.size(),
+    args[1]);
+
+  BOOLEAN_TO_NPVARIANT(
+    true, // done
+    args[2]);
+
+  // fire callback
+  NPN_InvokeDefault(
+    npp_, 
+    callback_, 
+    args, 
+    3, 
+    &ret_val);
+
+  NPN_ReleaseVariantValue(&ret_val);
+}
+
+bool PluginMethodListDirectory::OnPage(
+  const utils::File::DirectoryEntries& page, 
+  bool last) {
+
+  if (cancellation_.IsCancelled()) {
+    return false;
+  }
+
+  // the last page is delivered by |TriggerCallback|
+  if (last) {
+    FormatPage(page, output_);
+    return true;
+  }
+
+  std::string data;
+  FormatPage(page, data);
+  PostPartialResult(callback_, data);
+  return true;
+}
+
+// static
+void PluginMethodListDirectory::FormatPage(
+  const utils::File::DirectoryEntries& page, 
+  std::string& ref_output) {
+
+  ref_output.clear();
+  ref_output.reserve(page.size() * 128);
+  ref_output += '[';
+
+  char numbers[128];
+  utils::File::DirectoryEntries::const_iterator iter = page.begin();
+  for (; iter != page.end(); ++iter) {
+    if (iter != page.begin()) {
+      ref_output += ',';
+    }
+
+    ref_output += "{\"name\":";
+    utils::Encoders::json_append_string(
+      iter->name.c_str(), 
+      iter->name.size(), 
+      ref_output);
+
+    sprintf_s(
+      numbers,
+      ",\"directory\":%s,\"size\":%" FORMAT_UINT64 
+      ",\"created\":%" FORMAT_INT64 ",\"modified\":%" FORMAT_INT64 "}",
+      iter->is_directory ? "true" : "false",
+      iter->size,
+      utils::File::FileTimeToJsTime(iter->creation_time),
+      utils::File::FileTimeToJsTime(iter->last_write_time));
+    ref_output += numbers;
+  }
+
+  ref_output += ']';
+}
+
+// virtual
+bool PluginMethodListDirectory::Succeeded() {
+  return status_;
+}
+
+// virtual
+size_t PluginMethodListDirectory::ResultSize() {
+  return output_.size();
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef PLUGIN_METHODS_PLUGIN_METHOD_LIST_DIRECTORY_H_
+#define PLUGIN_METHODS_PLUGIN_METHOD_LIST_DIRECTORY_H_
+
+#include "plugin_method.h"
+#include <string>
+#include <utils/File.h>
+
+// Enumerates a directory and delivers its entries (as a JSON array) in pages
+// - every page but the last one is posted to the browser thread as soon as
+// it is ready
+class PluginMethodListDirectory : 
+  public PluginMethodImpl<
+    PluginMethodListDirectory, 
+    MethodSignature<ArgString, ArgOptions, ArgCallback> > {
+public:
+  PluginMethodListDirectory(NPObject* object, NPP npp);
+
+public:
+  bool Init(const Args& args);
+  virtual void Execute();
+  virtual void TriggerCallback();
+  virtual bool Succeeded();
+  virtual size_t ResultSize();
+
+private:
+  bool OnPage(const utils::File::DirectoryEntries& page, bool last);
+
+  static void FormatPage(
+    const utils::File::DirectoryEntries& page, 
+    std::string& ref_output);
+
+protected:
+  std::string directory_;
+  std::string filter_;
+  size_t page_size_;
+
+  // callback (last page)
+  bool status_;
+  std::string output_;
+};
+
+
+#endif // PLUGIN_METHODS_PLUGIN_METHOD_LIST_DIRECTORY_H_
\ No newline at end of file
@@ -4,29 +4,77 @@
 #include <utils/Encoders.h>
 #include <utils/Thread.h>
 
-const char kListenOnFileMethodName[] = "listenOnFile";
-const char kStopFileListenMethodName[] = "stopFileListen";
-
-// listenOnFile( filename, skipToEnd, callback(status, data) )
+#include <algorithm>
+#include <stdio.h>
+
+// default time to wait for more lines of a multi-line record
+const unsigned int kDefaultRecordTimeoutMS = 1000;
+
+// lines read but not yet handed to script - beyond that the overflow policy
+// kicks in
+const size_t kLinesQueueSize = 4096;
+
+// lines handed to script per browser thread call - the rest wait for the 
+// next call, so other callbacks aren't starved
+const size_t kMaxLinesPerDelivery = 1000;
+
+// the default cap of a paced delivery - lines beyond it are carried over to
+// the next one
+const size_t kDefaultMaxDeliveryBytes = 256 * 1024;
+
+// the default lag (bytes of the file not yet handed to script) at which
+// catch-up starts
+const double kDefaultMaxLagBytes = 4 * 1024 * 1024;
+
+// the least a catch-up delivery joins into a single callback
+const size_t kCatchUpDeliveryBytes = 1024 * 1024;
+
+const char kInfoSkippedFormat[] = 
+  "skipped %ld bytes to catch up with the file";
+
+// listenOnFile( filename, 
+//               skipToEnd, 
+//               callback(status, data, lagBytes, pendingLines) 
+//               [, options] )
+//
+// |lagBytes| - how far behind the file script is after this callback (bytes
+// not read yet plus the lines read but not handed to script), 
+// |pendingLines| - how many of those lines are queued.
+//
+// options (optional):
+// {
+//   recordStart: regex matched at the beginning of a line that starts a
+//                multi-line record (e.g. a timestamp prefix),
+//   recordTimeout: ms of silence after which a pending record is delivered,
+//   encoding: "auto" (BOM detection - default), "utf8" or "utf16le",
+//   overflow: what to do when script falls |kLinesQueueSize| lines behind -
+//             "block" (stop reading until it catches up - default), 
+//             "dropOldest" or "coalesce" (join the lines that don't fit 
+//             into a single callback),
+//   deliveryIntervalMs: deliver at most once per interval (e.g. 16 for a
+//                       60fps overlay) - the lines read in between are 
+//                       joined ('\n') into a single callback,
+//   maxDeliveryBytes: the most a paced callback delivers (at least a line) -
+//                     the rest is carried over to the next interval,
+//   catchUp: what to do when the lag passes maxLagBytes - "batch" (join 
+//            the queued lines into large callbacks until the lag is halved)
+//            or "skip" (the same, and jump over the unread part of the file
+//            - a false status "skipped <n> bytes..." callback marks the gap,
+//            the listener goes on). Off by default.
+//   maxLagBytes: the catchUp threshold (default 4MB)
+// }
 PluginMethodListenOnFile::PluginMethodListenOnFile(NPObject* object, NPP npp) :
-  PluginMethod(object, npp) {
-
-  id_listen_on_file_ =
-    NPN_GetStringIdentifier(kListenOnFileMethodName);
-
-  id_stop_file_listen_ =
-    NPN_GetStringIdentifier(kStopFileListenMethodName);
-
-}
-
-//virtual 
-PluginMethod* PluginMethodListenOnFile::Clone(
-  NPObject* object, 
-  NPP npp, 
-  const NPVariant *args, 
-  uint32_t argCount, 
-  NPVariant *result) {
-  return nullptr;
+  PluginMethod(object, npp),
+  last_listen_(nullptr),
+  reader_listen_(nullptr),
+  delivery_scheduled_(0),
+  carry_listen_(nullptr),
+  delivery_interval_ms_(0),
+  max_delivery_bytes_(kDefaultMaxDeliveryBytes),
+  last_delivery_ms_(0),
+  catch_up_mode_(CATCH_UP_NONE),
+  max_lag_bytes_(kDefaultMaxLagBytes),
+  catching_up_(false) {
 }
 
 // virtual
@@ -45,103 +93,349 @@ void PluginMethodListenOnFile::TriggerCallback() {
 
 //virtual 
 void PluginMethodListenOnFile::OnNewLine(const char* line, unsigned int len) {
-  NPVariant args[2];
-  NPVariant ret_val;
+  if (lines_.Push(line, len, false, reader_listen_)) {
+    ScheduleDelivery();
+  }
+}
 
-  BOOLEAN_TO_NPVARIANT(
-    true,
-    args[0]);
+//virtual 
+void PluginMethodListenOnFile::OnError(const char* message, unsigned int len) {
+  if (lines_.Push(message, len, true, reader_listen_)) {
+    ScheduleDelivery();
+  }
+}
 
-  STRINGN_TO_NPVARIANT(
-    line,
-    len,
-    args[1]);
+//virtual 
+void PluginMethodListenOnFile::OnIdle() {
+  if (lines_.FlushCoalesced()) {
+    ScheduleDelivery();
+  }
+}
 
-  // fire callback
-  NPN_InvokeDefault(
-    npp_,
-    callback_,
-    args,
-    2,
-    &ret_val);
+//virtual 
+void PluginMethodListenOnFile::OnSkipped(long bytes) {
+  char message[sizeof(kInfoSkippedFormat) + 32];
+  int len = sprintf(message, kInfoSkippedFormat, bytes);
 
-  NPN_ReleaseVariantValue(&ret_val);
+  if (lines_.Push(message, len, true, reader_listen_)) {
+    ScheduleDelivery();
+  }
 }
 
-//virtual 
-void PluginMethodListenOnFile::OnError(const char* message, unsigned int len) {
-  NPVariant args[2];
-  NPVariant ret_val;
+void PluginMethodListenOnFile::ScheduleDelivery() {
+  // a single delivery outstanding at a time - it takes whatever is ready
+  if (0 == InterlockedCompareExchange(&delivery_scheduled_, 1, 0)) {
+    PostDelivery();
+  }
+}
 
-  BOOLEAN_TO_NPVARIANT(
-    false,
-    args[0]);
+void PluginMethodListenOnFile::PostDelivery() {
+  if (0 != delivery_interval_ms_) {
+    pace_event_.Signal();
+    return;
+  }
 
-  STRINGN_TO_NPVARIANT(
-    message,
-    len,
-    args[1]);
+  PostCallback(&delivery_, DeliverLinesCallback, this);
+}
 
-  // fire callback
-  NPN_InvokeDefault(
-    npp_,
-    callback_,
-    args,
-    2,
-    &ret_val);
+// static
+void PluginMethodListenOnFile::DeliverLinesCallback(void* param) {
+  reinterpret_cast<PluginMethodListenOnFile*>(param)->DeliverLines();
+}
 
-  NPN_ReleaseVariantValue(&ret_val);
+void PluginMethodListenOnFile::DeliverLines() {
+  UpdateCatchUp();
+
+  bool more = false;
+  if (catching_up_) {
+    more = DeliverBatch(std::max(max_delivery_bytes_, kCatchUpDeliveryBytes));
+  } else if (0 == delivery_interval_ms_) {
+    more = DeliverEachLine();
+  } else {
+    more = DeliverBatch(max_delivery_bytes_);
+  }
+
+  ReleaseListensBefore(last_listen_);
+
+  if (more) {
+    PostDelivery();
+    return;
+  }
+
+  InterlockedExchange(&delivery_scheduled_, 0);
+
+  // lines pushed since we found the ring empty didn't schedule
+  if ((0 != lines_.size()) &&
+      (0 == InterlockedCompareExchange(&delivery_scheduled_, 1, 0))) {
+    PostDelivery();
+  }
 }
 
+bool PluginMethodListenOnFile::PopLine(
+  bool& ref_is_error, 
+  Listen*& ref_listen) {
 
-bool PluginMethodListenOnFile::HasMethod(NPIdentifier name) {
-  if (name == id_listen_on_file_) {
-    return true;
+  void* tag = nullptr;
+  for (;;) {
+    if (!lines_.Pop(line_, ref_is_error, tag)) {
+      return false;
+    }
+
+    ref_listen = reinterpret_cast<Listen*>(tag);
+    last_listen_ = ref_listen;
+
+    if (nullptr != ref_listen->callback) {
+      return true;
+    }
   }
+}
 
-  if (name == id_stop_file_listen_) {
-    return true;
+void PluginMethodListenOnFile::ReleaseListensBefore(Listen* listen) {
+  if (nullptr == listen) {
+    return;
   }
 
-  return false;
+  // the current listen stays, whatever |listen| is
+  while ((listens_.size() > 1) && (listens_.front() != listen)) {
+    if (nullptr != listens_.front()->callback) {
+      NPN_ReleaseObject(listens_.front()->callback);
+    }
+    delete listens_.front();
+    listens_.pop_front();
+  }
 }
 
-bool PluginMethodListenOnFile::Execute(
-  NPIdentifier name,
-  const NPVariant *args,
-  uint32_t argCount,
-  NPVariant *result) {
+bool PluginMethodListenOnFile::DeliverEachLine() {
+  bool is_error = false;
+  Listen* listen = nullptr;
 
-  if (name == id_listen_on_file_) {
-    return ExecuteListenOnFile(args, argCount, result);
+  // left over from a paced listen
+  if (!carry_.empty()) {
+    InvokeCallback(carry_listen_->callback, true, carry_);
+    carry_.clear();
   }
 
-  if (name == id_stop_file_listen_) {
-    return ExecuteStopFileListen(args, argCount, result);
+  for (size_t i = 0; i < kMaxLinesPerDelivery; i++) {
+    if (!PopLine(is_error, listen)) {
+      return false;
+    }
+
+    InvokeCallback(listen->callback, !is_error, line_);
   }
 
-  return false;
+  return true;
+}
+
+bool PluginMethodListenOnFile::DeliverBatch(size_t max_bytes) {
+  InterlockedExchange(&last_delivery_ms_, (LONG)GetTickCount());
+
+  batch_.clear();
+  batch_.swap(carry_);
+  Listen* batch_listen = carry_listen_;
+
+  bool is_error = false;
+  Listen* listen = nullptr;
+  while (batch_.size() < max_bytes) {
+    if (!PopLine(is_error, listen)) {
+      break;
+    }
+
+    // errors aren't joined - they follow the lines before them
+    if (is_error) {
+      if (!batch_.empty()) {
+        InvokeCallback(batch_listen->callback, true, batch_);
+        batch_.clear();
+      }
+      InvokeCallback(listen->callback, false, line_);
+      break;
+    }
+
+    // lines of the next listen (or too many bytes) wait for the next batch
+    if (!batch_.empty() && 
+        ((listen != batch_listen) ||
+         (batch_.size() + 1 + line_.size() > max_bytes))) {
+      carry_.swap(line_);
+      carry_listen_ = listen;
+      break;
+    }
+
+    batch_listen = listen;
+
+    if (!batch_.empty()) {
+      batch_.append(1, '\n');
+    }
+    batch_.append(line_);
+  }
+
+  if (!batch_.empty()) {
+    InvokeCallback(batch_listen->callback, true, batch_);
+  }
+
+  return (!carry_.empty() || (0 != lines_.size()));
+}
+
+double PluginMethodListenOnFile::GetLagBytes() const {
+  return (double)file_stream_.unread_bytes() + 
+         (double)lines_.bytes() + 
+         (double)carry_.size();
+}
+
+void PluginMethodListenOnFile::UpdateCatchUp() {
+  if (CATCH_UP_NONE == catch_up_mode_) {
+    return;
+  }
+
+  double lag = GetLagBytes();
+  if (lag <= max_lag_bytes_ / 2) {
+    catching_up_ = false;
+    return;
+  }
+
+  if (lag <= max_lag_bytes_) {
+    return;
+  }
+
+  catching_up_ = true;
+
+  // a gap is only worth it if most of the lag wasn't read yet - the queued
+  // lines are delivered (in large batches) either way
+  if ((CATCH_UP_SKIP == catch_up_mode_) && 
+      (file_stream_.unread_bytes() > max_lag_bytes_ / 2)) {
+    file_stream_.SkipToEnd();
+  }
 }
 
+bool PluginMethodListenOnFile::StartPacer() {
+  if (nullptr != pacer_.get()) {
+    return true;
+  }
+
+  if (!pace_event_.Create(false, false) || 
+      !pacer_exit_event_.Create(true, false)) {
+    return false;
+  }
+
+  pacer_.reset(new utils::Thread);
+  if (!pacer_->Start()) {
+    return false;
+  }
+
+  return pacer_->PostTask(std::bind(&PluginMethodListenOnFile::Pace, this));
+}
+
+void PluginMethodListenOnFile::Pace() {
+  for (;;) {
+    pace_event_.Wait();
+
+    DWORD since_last_ms = GetTickCount() - (DWORD)last_delivery_ms_;
+    DWORD wait_ms = (since_last_ms < delivery_interval_ms_) ? 
+      (delivery_interval_ms_ - since_last_ms) : 0;
+
+    if (pacer_exit_event_.Wait(wait_ms)) {
+      return;
+    }
+
+    PostCallback(&delivery_, DeliverLinesCallback, this);
+  }
+}
+
+void PluginMethodListenOnFile::InvokeCallback(
+  NPObject* callback,
+  bool status, 
+  const std::string& data) {
+
+  NPVariant args[4];
+  NPVariant ret_val;
+
+  BOOLEAN_TO_NPVARIANT(
+    status,
+    args[0]);
+
+  STRINGN_TO_NPVARIANT(
+    data.c_str(),
+    data.size(),
+    args[1]);
+
+  DOUBLE_TO_NPVARIANT(
+    GetLagBytes(),
+    args[2]);
+
+  INT32_TO_NPVARIANT(
+    (int32_t)(lines_.size() + (carry_.empty() ? 0 : 1)),
+    args[3]);
+
+  // fire callback
+  NPN_InvokeDefault(
+    npp_,
+    callback,
+    args,
+    4,
+    &ret_val);
+
+  NPN_ReleaseVariantValue(&ret_val);
+}
+
+
 bool PluginMethodListenOnFile::Terminate() {
+  // a reader waiting for room would hold the stream's lock
+  lines_.Close();
   file_stream_.StopListening();
 
   if (nullptr != thread_.get()) {
     thread_->Stop();
   }
+
+  if (nullptr != pacer_.get()) {
+    pacer_exit_event_.Signal();
+    pace_event_.Signal();
+    pacer_->Stop();
+  }
+
+  // no more deliveries - the queued lines are dropped with us
+  Listens::iterator iter = listens_.begin();
+  for (; iter != listens_.end(); ++iter) {
+    if (nullptr != (*iter)->callback) {
+      NPN_ReleaseObject((*iter)->callback);
+    }
+    delete *iter;
+  }
+  listens_.clear();
+  last_listen_ = nullptr;
+  carry_listen_ = nullptr;
+
   return true;
 }
 
-void PluginMethodListenOnFile::StartListening() {
+void PluginMethodListenOnFile::StartListening(Listen* listen) {
+  reader_listen_ = listen;
   file_stream_.StartListening();
 }
 
+void PluginMethodListenOnFile::EndListening(Listen* end) {
+  // the stopped listen's |StartListening| returned - nothing follows its 
+  // lines but this. Lost if the ring is full (the callback then waits for
+  // the next listen or |Terminate|).
+  reader_listen_ = end;
+  if (lines_.Push("", 0, false, end)) {
+    ScheduleDelivery();
+  }
+}
+
 bool PluginMethodListenOnFile::ExecuteListenOnFile(
   const NPVariant *args,
   uint32_t argCount,
-  NPVariant *result) {
+  NPVariant* /*result*/) {
   std::string filename;
+  NPObject* callback = nullptr;
   bool skip_to_end = false;
+  std::string record_start;
+  double record_timeout = kDefaultRecordTimeoutMS;
+  std::string encoding;
+  std::string overflow;
+  double delivery_interval = 0;
+  double max_delivery_bytes = kDefaultMaxDeliveryBytes;
+  std::string catch_up;
+  double max_lag_bytes = kDefaultMaxLagBytes;
 
   try {
     if (argCount < 3 ||
@@ -155,48 +449,185 @@ bool PluginMethodListenOnFile::ExecuteListenOnFile(
       return false;
     }
 
-    callback_ = NPVARIANT_TO_OBJECT(args[2]);
+    callback = NPVARIANT_TO_OBJECT(args[2]);
     skip_to_end = NPVARIANT_TO_BOOLEAN(args[1]);
 
-    // add ref count to callback object so it won't delete
-    NPN_RetainObject(callback_);
-
     filename.append(
       NPVARIANT_TO_STRING(args[0]).UTF8Characters,
       NPVARIANT_TO_STRING(args[0]).UTF8Length);  
+
+    if ((argCount > 3) && NPVARIANT_IS_OBJECT(args[3])) {
+      NPObject* options = NPVARIANT_TO_OBJECT(args[3]);
+      GetOptionString(options, "recordStart", record_start);
+      GetOptionNumber(options, "recordTimeout", record_timeout);
+      GetOptionString(options, "encoding", encoding);
+      GetOptionString(options, "overflow", overflow);
+      GetOptionNumber(options, "deliveryIntervalMs", delivery_interval);
+      GetOptionNumber(options, "maxDeliveryBytes", max_delivery_bytes);
+      GetOptionString(options, "catchUp", catch_up);
+      GetOptionNumber(options, "maxLagBytes", max_lag_bytes);
+    }
   } catch(...) {
 
   }
 
+  // all the options are validated before the running listener (if any) is
+  // touched - a bad call leaves it as it was
+  utils::LineRing::OverflowPolicy overflow_policy = 
+    utils::LineRing::OVERFLOW_BLOCK;
+  if (overflow == "dropOldest") {
+    overflow_policy = utils::LineRing::OVERFLOW_DROP_OLDEST;
+  } else if (overflow == "coalesce") {
+    overflow_policy = utils::LineRing::OVERFLOW_COALESCE;
+  } else if (!overflow.empty() && (overflow != "block")) {
+    NPN_SetException(
+      object_,
+      "invalid overflow passed to function - expecting block, dropOldest or "
+      "coalesce");
+    return false;
+  }
+
+  utils::TxtFileStream::Encoding stream_encoding = 
+    utils::TxtFileStream::ENCODING_AUTO;
+  if (encoding == "utf16le") {
+    stream_encoding = utils::TxtFileStream::ENCODING_UTF16LE;
+  } else if (encoding == "utf8") {
+    stream_encoding = utils::TxtFileStream::ENCODING_UTF8;
+  } else if (!encoding.empty() && (encoding != "auto")) {
+    NPN_SetException(
+      object_,
+      "invalid encoding passed to function - expecting auto, utf8 or utf16le");
+    return false;
+  }
+
+  if (!record_start.empty()) {
+    if (record_timeout < 0) {
+      record_timeout = 0;
+    }
+
+    try {
+      std::regex pattern(record_start, std::regex_constants::ECMAScript);
+    } catch(...) {
+      NPN_SetException(
+        object_,
+        "invalid recordStart pattern passed to function");
+      return false;
+    }
+  }
+
+  if ((delivery_interval < 0) || (max_delivery_bytes < 1)) {
+    NPN_SetException(
+      object_,
+      "invalid deliveryIntervalMs or maxDeliveryBytes passed to function");
+    return false;
+  }
+
+  CatchUpMode catch_up_mode = CATCH_UP_NONE;
+  if (catch_up == "batch") {
+    catch_up_mode = CATCH_UP_BATCH;
+  } else if (catch_up == "skip") {
+    catch_up_mode = CATCH_UP_SKIP;
+  } else if (!catch_up.empty() && (catch_up != "none")) {
+    NPN_SetException(
+      object_,
+      "invalid catchUp passed to function - expecting none, batch or skip");
+    return false;
+  }
+
+  if (max_lag_bytes < 1) {
+    NPN_SetException(
+      object_,
+      "invalid maxLagBytes passed to function");
+    return false;
+  }
+
   if (nullptr == thread_.get()) {
     thread_.reset(new utils::Thread);
-    if (!thread_->Start()) {
+    if (!lines_.Create(kLinesQueueSize, overflow_policy) || 
+        !thread_->Start()) {
       NPN_SetException(
-        __super::object_,
+        object_,
         "an unexpected error occurred - couldn't start file listening thread");
       return false;
     }
   }
 
+  if ((delivery_interval > 0) && !StartPacer()) {
+    NPN_SetException(
+      object_,
+      "an unexpected error occurred - couldn't start delivery thread");
+    return false;
+  }
+
   std::wstring wide_filename = utils::Encoders::utf8_decode(filename);
 
+  // a reader waiting for room in a full ring holds the stream's lock, and 
+  // only this (browser) thread makes room - let it go before |Initialize| 
+  // stops it (the ring is opened again below)
+  lines_.Close();
+
   if (!file_stream_.Initialize(wide_filename.c_str(), this, skip_to_end)) {
     NPN_SetException(
-      __super::object_,
+      object_,
       "an unexpected error occurred - couldn't open the file for read access");
     return false;
   }
 
+  file_stream_.SetEncoding(stream_encoding);
+
+  if (!record_start.empty()) {
+    file_stream_.SetRecordMode(
+      record_start.c_str(), 
+      (unsigned int)record_timeout);
+  }
+
+  // add ref count to callback object so it won't delete (before the lines
+  // of this listen were delivered)
+  Listen* listen = new Listen;
+  listen->callback = callback;
+  NPN_RetainObject(listen->callback);
+  listens_.push_back(listen);
+
+  delivery_interval_ms_ = (unsigned int)delivery_interval;
+  max_delivery_bytes_ = (size_t)max_delivery_bytes;
+  catch_up_mode_ = catch_up_mode;
+  max_lag_bytes_ = max_lag_bytes;
+  catching_up_ = false;
+
+  lines_.set_overflow_policy(overflow_policy);
+  lines_.Open();
+
   return thread_->PostTask(
     std::bind(
     &PluginMethodListenOnFile::StartListening,
-    this));
+    this,
+    listen));
 }
 
 bool PluginMethodListenOnFile::ExecuteStopFileListen(
-  const NPVariant *args,
-  uint32_t argCount,
-  NPVariant *result) {
+  const NPVariant* /*args*/,
+  uint32_t /*argCount*/,
+  NPVariant* /*result*/) {
+
+  lines_.Close();
+  if (!file_stream_.StopListening()) {
+    return false;
+  }
 
-  return file_stream_.StopListening();
+  // not listening (or stopped already)
+  if (listens_.empty() || (nullptr == listens_.back()->callback)) {
+    return true;
+  }
+
+  // the stopped listen's callback is released once its last lines were 
+  // delivered - queued after them by |thread_| (see |EndListening|)
+  Listen* end = new Listen;
+  end->callback = nullptr;
+  listens_.push_back(end);
+
+  return thread_->PostTask(
+    std::bind(
+    &PluginMethodListenOnFile::EndListening,
+    this,
+    end));
 }
@@ -6,8 +6,10 @@
 #define PLUGIN_METHODS_PLUGIN_METHOD_LISTEN_ON_FILE_H_
 
 #include "plugin_method.h"
+#include <deque>
 #include <memory>
 #include <string>
+#include <utils/LineRing.h>
 #include <utils/TxtFileStream.h>
 
 namespace utils {
@@ -21,12 +23,6 @@ public:
 
 // PluginMethod
 public:
-  virtual PluginMethod* Clone(
-    NPObject* object, 
-    NPP npp, 
-    const NPVariant *args, 
-    uint32_t argCount, 
-    NPVariant *result);
   virtual bool HasCallback();
   virtual void Execute();
   virtual void TriggerCallback();
@@ -35,20 +31,12 @@ public:
 public:
   virtual void OnNewLine(const char* line, unsigned int len);
   virtual void OnError(const char* message, unsigned int len);
+  virtual void OnIdle();
+  virtual void OnSkipped(long bytes);
 
 public:
-  bool HasMethod(NPIdentifier name);
-  bool Execute(
-    NPIdentifier name,
-    const NPVariant *args,
-    uint32_t argCount,
-    NPVariant *result);
-
-  bool Terminate();
-
-private:
-  void StartListening();
-
+  // listenOnFile/stopFileListen (see nsScriptableObjectSimpleIO's method 
+  // table)
   bool ExecuteListenOnFile(
     const NPVariant *args,
     uint32_t argCount,
@@ -58,14 +46,95 @@ private:
     uint32_t argCount,
     NPVariant *result);
 
+  bool Terminate();
+
+private:
+  // a listenOnFile call - its lines are tagged with it, so a replaced 
+  // listen's last lines still go to its own callback (retained until 
+  // they're delivered). A stopFileListen call is a listen without a 
+  // callback, whose only line (an end marker) isn't delivered.
+  struct Listen {
+    NPObject* callback;
+  };
+  typedef std::deque<Listen*> Listens;
+
+  void StartListening(Listen* listen);
+  void EndListening(Listen* end);
+
+  // the lines are read on |thread_| and handed to script on the browser 
+  // thread - through |lines_|, so neither waits for the other
+  void ScheduleDelivery();
+  void PostDelivery();
+  static void DeliverLinesCallback(void* param);
+  void DeliverLines();
+  void InvokeCallback(
+    NPObject* callback, 
+    bool status, 
+    const std::string& data);
+
+  // pops the next line into |line_| (and notes its listen) - end markers 
+  // are skipped
+  bool PopLine(bool& ref_is_error, Listen*& ref_listen);
+
+  // the lines are queued in order - once a line of |listen| was delivered,
+  // the listens before it have nothing left to deliver
+  void ReleaseListensBefore(Listen* listen);
+
+  // both return true if there are more lines than they delivered
+  bool DeliverEachLine();
+  bool DeliverBatch(size_t max_bytes);
+
+  // lag - the bytes of the file not yet handed to script (unread or queued)
+  // - against |max_lag_bytes_|: enters/leaves catch-up and asks the reader
+  // to skip ahead (catchUp: "skip")
+  double GetLagBytes() const;
+  void UpdateCatchUp();
+
+  // paced delivery (deliveryIntervalMs) - runs on |pacer_| and posts the
+  // next delivery once |delivery_interval_ms_| passed since the last one
+  bool StartPacer();
+  void Pace();
+
 protected:
-  NPObject* callback_;
+  // browser thread only - oldest first, the last one is the current listen.
+  // The others wait for their last lines (see |ReleaseListensBefore|) or 
+  // |Terminate|.
+  Listens listens_;
+  Listen* last_listen_; // of the last line popped
+
+  // the listen |thread_| is running - lines are tagged with it
+  Listen* reader_listen_;
 
   std::auto_ptr<utils::Thread> thread_;
   utils::TxtFileStream file_stream_;
 
-  NPIdentifier id_listen_on_file_;
-  NPIdentifier id_stop_file_listen_;
+  utils::LineRing lines_;
+  volatile LONG delivery_scheduled_;
+  utils::CompletionQueue::Entry delivery_;
+
+  // browser thread only
+  std::string line_;
+  std::string batch_;
+  std::string carry_; // the line that didn't fit in the last batch
+  Listen* carry_listen_;
+
+  unsigned int delivery_interval_ms_; // 0 = every line right away
+  size_t max_delivery_bytes_;
+  volatile LONG last_delivery_ms_; // GetTickCount()
+
+  enum CatchUpMode {
+    CATCH_UP_NONE = 0,
+    CATCH_UP_BATCH, // large batches until the lag is halved
+    CATCH_UP_SKIP // as above, and the unread bytes are skipped
+  };
+
+  CatchUpMode catch_up_mode_;
+  double max_lag_bytes_;
+  bool catching_up_;
+
+  std::auto_ptr<utils::Thread> pacer_;
+  utils::Event pace_event_; // a delivery is due
+  utils::Event pacer_exit_event_;
 };
 
 #endif // PLUGIN_METHODS_PLUGIN_METHOD_LISTEN_ON_FILE_H_
\ No newline at end of file
@@ -0,0 +1,114 @@
+#include "plugin_method_read_lines.h"
+
+#include "utils/Encoders.h"
+#include "utils/LineIndex.h"
+
+#include <stdio.h>
+
+// readLines( filename, startLine, count, callback(status, result) )
+//
+// startLine is 1-based. Lines are found through a sparse line index (see
+// utils::LineIndex) that is built the first time a file is read and only
+// extended afterwards.
+//
+// result is a JSON object:
+// { totalLines, lines } (lines is an array of strings)
+PluginMethodReadLines::PluginMethodReadLines(NPObject* object, NPP npp) : 
+  PluginMethodImpl(object, npp) {
+}
+
+bool PluginMethodReadLines::Init(const Args& args) {
+  filename_ = arena_.CopyString(args.a0.data, args.a0.size);
+
+  // 2^53 is past the last line of any file and still converts exactly
+  const double kMaxStartLine = 9007199254740992.0;
+  start_line_ = (args.a1 >= 1) ? args.a1 : 1;
+  if (start_line_ > kMaxStartLine) {
+    start_line_ = kMaxStartLine;
+  }
+
+  count_ = ArgNumber::ToCount(args.a2);
+  return true;
+}
+
+// virtual
+void PluginMethodReadLines::Execute() {
+  output_ = "{\"totalLines\":0,\"lines\":[]}";
+  status_ = false;
+
+  try {
+    utils::LineIndex index;
+    std::wstring wide_filename = 
+      utils::Encoders::utf8_decode(filename_.data, filename_.size);
+    if (!index.Open(wide_filename)) {
+      return;
+    }
+
+    std::vector<std::string> lines;
+    if (!index.ReadLines(
+          (unsigned __int64)start_line_ - 1, 
+          count_, 
+          lines)) {
+      return;
+    }
+
+    char total_lines[64];
+    sprintf_s(
+      total_lines, 
+      "{\"totalLines\":%" FORMAT_UINT64 ",\"lines\":[", 
+      index.line_count());
+
+    output_ = total_lines;
+    for (size_t i = 0; i < lines.size(); i++) {
+      if (i > 0) {
+        output_ += ',';
+      }
+
+      utils::Encoders::json_append_string(
+        lines[i].c_str(), 
+        lines[i].size(), 
+        output_);
+    }
+    output_ += "]}";
+
+    status_ = true;
+  } catch(...) {
+    output_ = "{\"totalLines\":0,\"lines\":[]}";
+    status_ = false;
+  }
+}
+
+// virtual
+void PluginMethodReadLines::TriggerCallback() {
+  NPVariant args[2];
+  NPVariant ret_val;
+
+  BOOLEAN_TO_NPVARIANT(
+    status_,
+    args[0]);
+
+  STRINGN_TO_NPVARIANT(
+    output_.c_str(),
+    output_.size(),
+    args[1]);
+
+  // fire callback
+  NPN_InvokeDefault(
+    npp_, 
+    callback_, 
+    args, 
+    2, 
+    &ret_val);
+
+  NPN_ReleaseVariantValue(&ret_val);
+}
+
+// virtual
+bool PluginMethodReadLines::Succeeded() {
+  return status_;
+}
+
+// virtual
+size_t PluginMethodReadLines::ResultSize() {
+  return output_.size();
+}
\ No newline at end of file
@@ -0,0 +1,250 @@
+#include "plugin_method_search_files.h"
+
+#include "utils/Encoders.h"
+#include "utils/DirectoryWalker.h"
+#include "utils/Glob.h"
+#include "utils/ThreadPool.h"
+
+#include <stdio.h>
+
+const size_t kBatchSize = 200;
+const size_t kDefaultMaxResults = 1000;
+const size_t kDefaultContextLength = 200;
+
+// searchFiles( target, pattern, options, callback(status, matches, done) )
+//
+// target: a directory to search recursively, or an array of files
+// options (optional - pass null):
+// {
+//   glob: glob(s) for files under the directory, see findFiles 
+//         (default: "*"),
+//   maxDepth: see findFiles (default: -1),
+//   regex: |pattern| is an ECMAScript regular expression, matched against
+//          the first 4KB of every line (default: false),
+//   ignoreCase: (default: false),
+//   maxResults: stop after this many matches, 0 for no limit (default: 1000),
+//   contextLength: max bytes of the matching line to return (default: 200)
+// }
+//
+// matches is a JSON array of:
+// { file, offset, line, context } (file as passed or relative to the 
+// directory, offset in bytes, line is 1-based)
+PluginMethodSearchFiles::PluginMethodSearchFiles(
+  NPObject* object, NPP npp) : 
+  PluginMethodImpl(object, npp),
+  pool_(worker_pool()),
+  max_depth_(-1) {
+}
+
+bool PluginMethodSearchFiles::Init(const Args& args) {
+  // a directory or an array of files
+  if (NPVARIANT_IS_STRING(*args.a0)) {
+    root_.assign(
+      NPVARIANT_TO_STRING(*args.a0).UTF8Characters,
+      NPVARIANT_TO_STRING(*args.a0).UTF8Length);
+  } else if (!NPVARIANT_IS_OBJECT(*args.a0) || 
+             !GetStringArray(*args.a0, files_)) {
+    return false;
+  }
+
+  pattern_.assign(args.a1.data, args.a1.size);
+
+  double max_depth = -1;
+  double max_results = kDefaultMaxResults;
+  double context_length = kDefaultContextLength;
+  NPObject* options = args.a2;
+  if (nullptr != options) {
+    NPVariant globs;
+    NULL_TO_NPVARIANT(globs);
+    if (NPN_GetProperty(npp_, options, NPN_GetStringIdentifier("glob"), 
+                        &globs)) {
+      GetStringArray(globs, globs_);
+      NPN_ReleaseVariantValue(&globs);
+    }
+
+    GetOptionNumber(options, "maxDepth", max_depth);
+    GetOptionBool(options, "regex", options_.regex);
+    GetOptionBool(options, "ignoreCase", options_.ignore_case);
+    GetOptionNumber(options, "maxResults", max_results);
+    GetOptionNumber(options, "contextLength", context_length);
+  }
+
+  if (globs_.empty()) {
+    globs_.push_back("*");
+  }
+
+  max_depth_ = (int)max_depth;
+  options_.max_results = (max_results >= 1) ? (size_t)max_results : 0;
+  options_.context_length = 
+    (context_length >= 0) ? (size_t)context_length : 0;
+  return true;
+}
+
+// virtual
+void PluginMethodSearchFiles::Execute() {
+  output_ = "[]";
+  status_ = false;
+
+  try {
+    if (!EnsureWorkerPool()) {
+      return;
+    }
+
+    utils::FileSearch::Targets targets;
+    if (!CollectTargets(targets)) {
+      return;
+    }
+
+    utils::FileSearch search;
+    status_ = search.Search(
+      pool_,
+      targets,
+      pattern_,
+      options_,
+      kBatchSize,
+      std::bind(
+        &PluginMethodSearchFiles::OnBatch, 
+        this, 
+        std::placeholders::_1));
+  } catch(...) {
+    status_ = false;
+  }
+}
+
+// virtual
+void PluginMethodSearchFiles::TriggerCallback() {
+  NPVariant args[3];
+  NPVariant ret_val;
+
+  BOOLEAN_TO_NPVARIANT(
+    status_,
+    args[0]);
+
+  STRINGN_TO_NPVARIANT(
+    output_.c_str(),
+    output_.size(),
+    args[1]);
+
+  BOOLEAN_TO_NPVARIANT(
+    true, // done
+    args[2]);
+
+  // fire callback
+  NPN_InvokeDefault(
+    npp_, 
+    callback_, 
+    args, 
+    3, 
+    &ret_val);
+
+  NPN_ReleaseVariantValue(&ret_val);
+}
+
+bool PluginMethodSearchFiles::CollectTargets(
+  utils::FileSearch::Targets& ref_targets) {
+
+  if (root_.empty()) {
+    std::vector<std::string>::const_iterator iter = files_.begin();
+    for (; iter != files_.end(); ++iter) {
+      utils::FileSearch::Target target;
+      target.path = utils::Encoders::utf8_decode(*iter);
+      target.name = *iter;
+      ref_targets.push_back(target);
+    }
+
+    return true;
+  }
+
+  utils::GlobSet globs;
+  if (!globs.Compile(globs_)) {
+    return false;
+  }
+
+  std::wstring root = utils::Encoders::utf8_decode(root_);
+
+  // the walk delivers its batches one at a time - no need to lock. Only
+  // the paths are used, so the entries aren't stat-ed for their details.
+  utils::DirectoryWalker walker;
+  return walker.Walk(
+    pool_,
+    root,
+    globs,
+    max_depth_,
+    kBatchSize,
+    [&](const utils::File::DirectoryEntries& batch) -> bool {
+      utils::File::DirectoryEntries::const_iterator iter = batch.begin();
+      for (; iter != batch.end(); ++iter) {
+        utils::FileSearch::Target target;
+        target.path = root + utils::File::kPathSeparator + 
+                      utils::Encoders::utf8_decode(iter->name);
+        target.name = iter->name;
+        ref_targets.push_back(target);
+      }
+      return true;
+    },
+    false);
+}
+
+bool PluginMethodSearchFiles::OnBatch(
+  const utils::FileSearch::Matches& batch) {
+
+  if (cancellation_.IsCancelled()) {
+    return false;
+  }
+
+  std::string data;
+  FormatBatch(batch, data);
+  PostPartialResult(callback_, data);
+  return true;
+}
+
+// static
+void PluginMethodSearchFiles::FormatBatch(
+  const utils::FileSearch::Matches& batch, 
+  std::string& ref_output) {
+
+  ref_output.clear();
+  ref_output.reserve(batch.size() * 256);
+  ref_output += '[';
+
+  char numbers[64];
+  utils::FileSearch::Matches::const_iterator iter = batch.begin();
+  for (; iter != batch.end(); ++iter) {
+    if (iter != batch.begin()) {
+      ref_output += ',';
+    }
+
+    ref_output += "{\"file\":";
+    utils::Encoders::json_append_string(
+      iter->file.c_str(), 
+      iter->file.size(), 
+      ref_output);
+
+    sprintf_s(
+      numbers,
+      ",\"offset\":%" FORMAT_UINT64 ",\"line\":%" FORMAT_UINT64 
+      ",\"context\":",
+      iter->offset,
+      iter->line);
+    ref_output += numbers;
+
+    utils::Encoders::json_append_string(
+      iter->context.c_str(), 
+      iter->context.size(), 
+      ref_output);
+
+    ref_output += '}';
+  }
+
+  ref_output += ']';
+}
+
+// virtual
+bool PluginMethodSearchFiles::Succeeded() {
+  return status_;
+}
+
+// virtual
+size_t PluginMethodSearchFiles::ResultSize() {
+  return output_.size();
+}
\ No newline at end of file
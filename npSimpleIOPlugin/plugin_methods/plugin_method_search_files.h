@@ -0,0 +1,61 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef PLUGIN_METHODS_PLUGIN_METHOD_SEARCH_FILES_H_
+#define PLUGIN_METHODS_PLUGIN_METHOD_SEARCH_FILES_H_
+
+#include "plugin_method.h"
+#include <string>
+#include <vector>
+#include <utils/File.h>
+#include <utils/FileSearch.h>
+
+namespace utils {
+class ThreadPool;
+}
+
+// Searches the contents of files (a list of files or a directory tree) for a
+// string or a regular expression - files are searched in parallel on the
+// worker pool and only the matches are delivered (as JSON arrays) in batches
+class PluginMethodSearchFiles : 
+  public PluginMethodImpl<
+    PluginMethodSearchFiles, 
+    MethodSignature<ArgVariant, ArgString, ArgOptions, ArgCallback> > {
+public:
+  PluginMethodSearchFiles(NPObject* object, NPP npp);
+
+public:
+  bool Init(const Args& args);
+  virtual void Execute();
+  virtual void TriggerCallback();
+  virtual bool Succeeded();
+  virtual size_t ResultSize();
+
+private:
+  bool CollectTargets(utils::FileSearch::Targets& ref_targets);
+  bool OnBatch(const utils::FileSearch::Matches& batch);
+
+  static void FormatBatch(
+    const utils::FileSearch::Matches& batch, 
+    std::string& ref_output);
+
+protected:
+  utils::ThreadPool* pool_;
+
+  // either |root_| (with |globs_| and |max_depth_|) or |files_|
+  std::string root_;
+  std::vector<std::string> globs_;
+  int max_depth_;
+  std::vector<std::string> files_;
+
+  std::string pattern_;
+  utils::FileSearch::Options options_;
+
+  // callback
+  bool status_;
+  std::string output_;
+};
+
+
+#endif // PLUGIN_METHODS_PLUGIN_METHOD_SEARCH_FILES_H_
\ No newline at end of file
@@ -0,0 +1,271 @@
+#include "plugin_method_watch_directory.h"
+
+#include <utils/Encoders.h>
+
+// watchDirectory( path, recursive, filters, debounceMs, 
+//                 callback(status, changes) ) -> watch id
+// stopDirectoryWatch( id )
+//
+// filters: glob(s) the changed paths have to match (see findFiles) - null or
+//          an empty array for everything
+// debounceMs: changes are collected for this long after the first one and
+//             then delivered together
+//
+// changes is a JSON array of:
+// { type, path [, oldPath] } - type is "added", "removed", "modified", 
+// "renamed" (with oldPath) or "overflow" (changes were lost - rescan).
+// status is false once if the watch failed (e.g. the directory was removed).
+struct PluginMethodWatchDirectory::PendingChanges : 
+  public utils::Pooled<PluginMethodWatchDirectory::PendingChanges> {
+  NPP npp;
+  Watch* watch;
+  bool status;
+  std::string data;
+  utils::CompletionQueue::Entry completion;
+};
+
+PluginMethodWatchDirectory::PluginMethodWatchDirectory(
+  NPObject* object, NPP npp) :
+  PluginMethod(object, npp),
+  next_watch_id_(1) {}
+
+PluginMethodWatchDirectory::~PluginMethodWatchDirectory() {
+  Terminate();
+}
+
+// virtual
+bool PluginMethodWatchDirectory::HasCallback() {
+  return false;
+}
+
+// virtual
+void PluginMethodWatchDirectory::Execute() {
+}
+
+// virtual
+void PluginMethodWatchDirectory::TriggerCallback() {
+}
+
+bool PluginMethodWatchDirectory::Terminate() {
+  // the plugin is going away and the change sets still queued are never 
+  // delivered - no waiting for them
+  Watches::iterator iter = watches_.begin();
+  for (; iter != watches_.end(); ++iter) {
+    iter->second->watcher.Stop();
+    ReleaseWatch(iter->second);
+  }
+
+  watches_.clear();
+  return true;
+}
+
+bool PluginMethodWatchDirectory::ExecuteWatchDirectory(
+  const NPVariant *args,
+  uint32_t argCount,
+  NPVariant *result) {
+
+  std::string directory;
+  std::vector<std::string> filters;
+  double debounce_ms = 0;
+
+  if (argCount < 5 ||
+    !NPVARIANT_IS_STRING(args[0]) ||
+    !NPVARIANT_IS_BOOLEAN(args[1]) ||
+    !(NPVARIANT_IS_NULL(args[2]) || 
+      NPVARIANT_IS_VOID(args[2]) ||
+      GetStringArray(args[2], filters)) ||
+    !(NPVARIANT_IS_DOUBLE(args[3]) || NPVARIANT_IS_INT32(args[3])) ||
+    !NPVARIANT_IS_OBJECT(args[4])) {
+    NPN_SetException(
+      object_, 
+      "invalid or missing params passed to function - expecting 5 params: "
+      "path, recursive, filters, debounceMs, callback(status, changes)");
+    return false;
+  }
+
+  directory.append(
+    NPVARIANT_TO_STRING(args[0]).UTF8Characters,
+    NPVARIANT_TO_STRING(args[0]).UTF8Length);
+
+  debounce_ms = NPVARIANT_IS_INT32(args[3]) ?
+    NPVARIANT_TO_INT32(args[3]) :
+    NPVARIANT_TO_DOUBLE(args[3]);
+  if (debounce_ms < 0) {
+    debounce_ms = 0;
+  }
+
+  Watch* watch = new Watch;
+  watch->callback = NPVARIANT_TO_OBJECT(args[4]);
+  watch->stopped = false;
+  watch->pending_changes = 0;
+
+  // add ref count to callback object so it won't delete (before the 
+  // watcher thread may post a change set for it)
+  NPN_RetainObject(watch->callback);
+
+  bool started = watch->watcher.Start(
+    utils::Encoders::utf8_decode(directory),
+    NPVARIANT_TO_BOOLEAN(args[1]),
+    filters,
+    (unsigned int)debounce_ms,
+    std::bind(
+      &PluginMethodWatchDirectory::OnChanges,
+      this,
+      watch,
+      std::placeholders::_1,
+      std::placeholders::_2));
+
+  if (!started) {
+    ReleaseWatch(watch);
+    NPN_SetException(
+      object_,
+      "couldn't watch the directory - it doesn't exist or the filters are "
+      "invalid");
+    return false;
+  }
+
+  int id = next_watch_id_++;
+  watches_[id] = watch;
+
+  INT32_TO_NPVARIANT(id, *result);
+  return true;
+}
+
+bool PluginMethodWatchDirectory::ExecuteStopDirectoryWatch(
+  const NPVariant *args,
+  uint32_t argCount,
+  NPVariant* /*result*/) {
+
+  if (argCount < 1 ||
+    !(NPVARIANT_IS_DOUBLE(args[0]) || NPVARIANT_IS_INT32(args[0]))) {
+    NPN_SetException(
+      object_, 
+      "invalid or missing params passed to function - expecting 1 param: id");
+    return false;
+  }
+
+  int id = NPVARIANT_IS_INT32(args[0]) ?
+    NPVARIANT_TO_INT32(args[0]) :
+    (int)NPVARIANT_TO_DOUBLE(args[0]);
+
+  Watches::iterator iter = watches_.find(id);
+  if (iter == watches_.end()) {
+    return false;
+  }
+
+  StopWatch(iter->second);
+  watches_.erase(iter);
+  return true;
+}
+
+void PluginMethodWatchDirectory::OnChanges(
+  Watch* watch, 
+  bool status, 
+  const utils::DirectoryWatcher::Changes& changes) {
+
+  InterlockedIncrement(&watch->pending_changes);
+
+  PendingChanges* pending = new PendingChanges;
+  pending->npp = npp_;
+  pending->watch = watch;
+  pending->status = status;
+  FormatChanges(changes, pending->data);
+
+  PostCallback(&pending->completion, DeliverChanges, pending);
+}
+
+// static
+void PluginMethodWatchDirectory::DeliverChanges(void* param) {
+  PendingChanges* pending = reinterpret_cast<PendingChanges*>(param);
+  Watch* watch = pending->watch;
+
+  // dropped once the watch is stopped
+  if (!watch->stopped) {
+    NPVariant args[2];
+    NPVariant ret_val;
+
+    BOOLEAN_TO_NPVARIANT(
+      pending->status,
+      args[0]);
+
+    STRINGN_TO_NPVARIANT(
+      pending->data.c_str(),
+      pending->data.size(),
+      args[1]);
+
+    // fire callback
+    NPN_InvokeDefault(
+      pending->npp, 
+      watch->callback, 
+      args, 
+      2, 
+      &ret_val);
+
+    NPN_ReleaseVariantValue(&ret_val);
+  }
+
+  delete pending;
+
+  if ((0 == InterlockedDecrement(&watch->pending_changes)) && 
+      watch->stopped) {
+    ReleaseWatch(watch);
+  }
+}
+
+// static
+void PluginMethodWatchDirectory::StopWatch(Watch* watch) {
+  // no change sets are posted once the watcher thread is gone
+  watch->watcher.Stop();
+  watch->stopped = true;
+
+  if (0 == watch->pending_changes) {
+    ReleaseWatch(watch);
+  }
+}
+
+// static
+void PluginMethodWatchDirectory::ReleaseWatch(Watch* watch) {
+  NPN_ReleaseObject(watch->callback);
+  delete watch;
+}
+
+// static
+void PluginMethodWatchDirectory::FormatChanges(
+  const utils::DirectoryWatcher::Changes& changes,
+  std::string& ref_output) {
+
+  static const char* kChangeTypes[] = {
+    "added", "removed", "modified", "renamed", "overflow"
+  };
+
+  ref_output.clear();
+  ref_output.reserve(changes.size() * 64);
+  ref_output += '[';
+
+  utils::DirectoryWatcher::Changes::const_iterator iter = changes.begin();
+  for (; iter != changes.end(); ++iter) {
+    if (iter != changes.begin()) {
+      ref_output += ',';
+    }
+
+    ref_output += "{\"type\":\"";
+    ref_output += kChangeTypes[iter->type];
+    ref_output += "\",\"path\":";
+    utils::Encoders::json_append_string(
+      iter->path.c_str(), 
+      iter->path.size(), 
+      ref_output);
+
+    if (utils::DirectoryWatcher::CHANGE_RENAMED == iter->type) {
+      ref_output += ",\"oldPath\":";
+      utils::Encoders::json_append_string(
+        iter->old_path.c_str(), 
+        iter->old_path.size(), 
+        ref_output);
+    }
+
+    ref_output += '}';
+  }
+
+  ref_output += ']';
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef PLUGIN_METHODS_PLUGIN_METHOD_WATCH_DIRECTORY_H_
+#define PLUGIN_METHODS_PLUGIN_METHOD_WATCH_DIRECTORY_H_
+
+#include "plugin_method.h"
+#include <map>
+#include <string>
+#include <utils/DirectoryWatcher.h>
+
+// watchDirectory/stopDirectoryWatch - like listenOnFile, these aren't
+// one-shot methods: every watch keeps delivering change sets until stopped
+class PluginMethodWatchDirectory : public PluginMethod {
+public:
+  PluginMethodWatchDirectory(NPObject* object, NPP npp);
+  virtual ~PluginMethodWatchDirectory();
+
+// PluginMethod
+public:
+  virtual bool HasCallback();
+  virtual void Execute();
+  virtual void TriggerCallback();
+
+public:
+  // watchDirectory/stopDirectoryWatch
+  bool ExecuteWatchDirectory(
+    const NPVariant *args,
+    uint32_t argCount,
+    NPVariant *result);
+  bool ExecuteStopDirectoryWatch(
+    const NPVariant *args,
+    uint32_t argCount,
+    NPVariant *result);
+
+  bool Terminate();
+
+private:
+  // the callback (retained) is released once the watch is stopped and the
+  // change sets it already posted were dropped
+  struct Watch {
+    utils::DirectoryWatcher watcher;
+    NPObject* callback;
+    bool stopped; // browser thread
+    volatile LONG pending_changes; // posted, not delivered yet
+  };
+  typedef std::map<int, Watch*> Watches;
+
+  // a change set on its way to the browser thread
+  struct PendingChanges;
+
+  void OnChanges(
+    Watch* watch, 
+    bool status, 
+    const utils::DirectoryWatcher::Changes& changes);
+  static void DeliverChanges(void* param);
+
+  // stops |watch| - it's released right away or by the last 
+  // |DeliverChanges| of it
+  static void StopWatch(Watch* watch);
+  static void ReleaseWatch(Watch* watch);
+
+  static void FormatChanges(
+    const utils::DirectoryWatcher::Changes& changes,
+    std::string& ref_output);
+
+protected:
+  // only accessed from the browser thread
+  Watches watches_;
+  int next_watch_id_;
+};
+
+#endif // PLUGIN_METHODS_PLUGIN_METHOD_WATCH_DIRECTORY_H_
\ No newline at end of file
@@ -6,64 +6,21 @@
 // writeLocalAppDataFile( filename, content, callback(status, message) )
 PluginMethodWriteLocalAppDataFile::PluginMethodWriteLocalAppDataFile(
   NPObject* object, NPP npp) :
-  PluginMethod(object, npp) {
+  PluginMethodImpl(object, npp) {
 }
 
-//virtual 
-PluginMethod* PluginMethodWriteLocalAppDataFile::Clone(
-  NPObject* object, 
-  NPP npp, 
-  const NPVariant *args, 
-  uint32_t argCount, 
-  NPVariant *result) {
-
-  PluginMethodWriteLocalAppDataFile* clone =
-    new PluginMethodWriteLocalAppDataFile(object, npp);
-
-  try {
-    if (argCount < 3 ||
-      !NPVARIANT_IS_STRING(args[0]) ||
-      !NPVARIANT_IS_STRING(args[1]) ||
-      !NPVARIANT_IS_OBJECT(args[2])) {
-      NPN_SetException(
-        __super::object_, 
-        "invalid params passed to function");
-      delete clone;
-      return nullptr;
-    }
-
-    clone->callback_ = NPVARIANT_TO_OBJECT(args[2]);
-    // add ref count to callback object so it won't delete
-    NPN_RetainObject(clone->callback_);
-
-    // convert into std::string
-    clone->filename_.append(
-      NPVARIANT_TO_STRING(args[0]).UTF8Characters,
-      NPVARIANT_TO_STRING(args[0]).UTF8Length);
-
-    clone->content_.append(
-      NPVARIANT_TO_STRING(args[1]).UTF8Characters,
-      NPVARIANT_TO_STRING(args[1]).UTF8Length);
-
-    return clone;
-  } catch(...) {
-
-  }
-
-  delete clone;
-  return nullptr;
-}
-
-// virtual
-bool PluginMethodWriteLocalAppDataFile::HasCallback() {
-  return (nullptr != callback_);
+bool PluginMethodWriteLocalAppDataFile::Init(const Args& args) {
+  filename_ = arena_.CopyString(args.a0.data, args.a0.size);
+  content_ = arena_.CopyString(args.a1.data, args.a1.size);
+  return true;
 }
 
 // virtual
 void PluginMethodWriteLocalAppDataFile::Execute() {
   message_.clear();
   
-  std::wstring wide_filename = utils::Encoders::utf8_decode(filename_);
+  std::wstring wide_filename = 
+    utils::Encoders::utf8_decode(filename_.data, filename_.size);
 
   // make sure there are no .. tricks
   if (std::wstring::npos != wide_filename.find(L"..")) {
@@ -73,10 +30,13 @@ void PluginMethodWriteLocalAppDataFile::Execute() {
   }
 
   std::wstring path = utils::File::GetSpecialFolderWide(CSIDL_LOCAL_APPDATA);
-  std::wstring filename = path + L"\\" + wide_filename;
+  std::wstring filename = path + utils::File::kPathSeparator + wide_filename;
 
   try {
-    status_ = utils::File::WriteTextFile(filename, content_);
+    status_ = utils::File::WriteTextFile(
+      filename, 
+      content_.data, 
+      content_.size);
   } catch(...) {
     status_ = false;
   }
@@ -110,4 +70,14 @@ void PluginMethodWriteLocalAppDataFile::TriggerCallback() {
     &ret_val);
 
   NPN_ReleaseVariantValue(&ret_val);
+}
+
+// virtual
+bool PluginMethodWriteLocalAppDataFile::Succeeded() {
+  return status_;
+}
+
+// virtual
+size_t PluginMethodWriteLocalAppDataFile::ResultSize() {
+  return content_.size;
 }
\ No newline at end of file
@@ -10,26 +10,23 @@ Copyright (c) 2015 Overwolf Ltd.
 
 // Create a file on the local filesystem with given text content
 // For security reasons, we only allow to write to the local-app-data folder
-class PluginMethodWriteLocalAppDataFile : public PluginMethod {
+class PluginMethodWriteLocalAppDataFile : 
+  public PluginMethodImpl<
+    PluginMethodWriteLocalAppDataFile, 
+    MethodSignature<ArgString, ArgString, ArgCallback> > {
 public:
   PluginMethodWriteLocalAppDataFile(NPObject* object, NPP npp);
 
 public:
-  virtual PluginMethod* Clone(
-    NPObject* object,
-    NPP npp,
-    const NPVariant *args,
-    uint32_t argCount,
-    NPVariant *result);
-  virtual bool HasCallback();
+  bool Init(const Args& args);
   virtual void Execute();
   virtual void TriggerCallback();
+  virtual bool Succeeded();
+  virtual size_t ResultSize();
 
 protected:
-  std::string filename_;
-  std::string content_;
-
-  NPObject* callback_;
+  utils::StringView filename_;
+  utils::StringView content_;
 
   // callback values
   bool status_;
@@ -0,0 +1,522 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#include "utils/Encoders.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// Round trips of the UTF8 <-> UTF-16 conversions with the SSE2 fast paths on
+// and off. Valid text is checked against a plain code point reference,
+// invalid text against the scalar path (the fast paths may only differ in
+// speed). Exits with 1 if anything failed.
+
+using utils::Encoders;
+
+namespace {
+
+typedef std::vector<unsigned int> CodePoints;
+typedef std::vector<uint16_t> Utf16;
+
+int failures = 0;
+int checks = 0;
+
+std::string Hex(const std::string& bytes) {
+  std::string hex;
+  char digits[4];
+  for (size_t i = 0; (i < bytes.size()) && (i < 48); i++) {
+    sprintf(digits, "%02X ", (unsigned char)bytes[i]);
+    hex += digits;
+  }
+  return (bytes.size() > 48) ? (hex + "...") : hex;
+}
+
+void Expect(
+  bool ok,
+  const char* what,
+  const char* test,
+  const std::string& input) {
+  checks++;
+  if (!ok) {
+    failures++;
+    fprintf(stderr, "FAILED %s: %s (input %s)\n", test, what,
+            Hex(input).c_str());
+  }
+}
+
+// deterministic, so failures reproduce
+class Random {
+public:
+  explicit Random(unsigned int seed) : state_(seed) {
+  }
+
+  unsigned int Next(unsigned int range) {
+    state_ = state_ * 1103515245 + 12345;
+    return (state_ >> 8) % range;
+  }
+
+private:
+  unsigned int state_;
+};
+
+//-----------------------------------------------------------------------------
+// the reference - one code point at a time, straight from the definitions
+std::string ReferenceUtf8(const CodePoints& code_points) {
+  std::string utf8;
+  for (size_t i = 0; i < code_points.size(); i++) {
+    unsigned int c = code_points[i];
+    if (c < 0x80) {
+      utf8 += (char)c;
+    } else if (c < 0x800) {
+      utf8 += (char)(0xC0 | (c >> 6));
+      utf8 += (char)(0x80 | (c & 0x3F));
+    } else if (c < 0x10000) {
+      utf8 += (char)(0xE0 | (c >> 12));
+      utf8 += (char)(0x80 | ((c >> 6) & 0x3F));
+      utf8 += (char)(0x80 | (c & 0x3F));
+    } else {
+      utf8 += (char)(0xF0 | (c >> 18));
+      utf8 += (char)(0x80 | ((c >> 12) & 0x3F));
+      utf8 += (char)(0x80 | ((c >> 6) & 0x3F));
+      utf8 += (char)(0x80 | (c & 0x3F));
+    }
+  }
+  return utf8;
+}
+
+Utf16 ReferenceUtf16(const CodePoints& code_points) {
+  Utf16 units;
+  for (size_t i = 0; i < code_points.size(); i++) {
+    unsigned int c = code_points[i];
+    if (c >= 0x10000) {
+      units.push_back((uint16_t)(0xD800 + ((c - 0x10000) >> 10)));
+      units.push_back((uint16_t)(0xDC00 + ((c - 0x10000) & 0x3FF)));
+    } else {
+      units.push_back((uint16_t)c);
+    }
+  }
+  return units;
+}
+
+std::wstring ReferenceWide(const CodePoints& code_points) {
+  std::wstring wide;
+  if (sizeof(wchar_t) == 2) {
+    Utf16 units = ReferenceUtf16(code_points);
+    wide.assign(units.begin(), units.end());
+  } else {
+    wide.assign(code_points.begin(), code_points.end());
+  }
+  return wide;
+}
+
+//-----------------------------------------------------------------------------
+// Everything a conversion of |utf8| / |wide| / |units| produces
+struct Conversions {
+  std::wstring decoded;
+  size_t wide_length;
+  std::string encoded;
+  size_t utf8_length;
+  std::string from_utf16;
+  std::string from_wide;
+
+  bool operator==(const Conversions& other) const {
+    return (decoded == other.decoded) &&
+           (wide_length == other.wide_length) &&
+           (encoded == other.encoded) &&
+           (utf8_length == other.utf8_length) &&
+           (from_utf16 == other.from_utf16) &&
+           (from_wide == other.from_wide);
+  }
+};
+
+Conversions Convert(
+  const std::string& utf8,
+  const std::wstring& wide,
+  const Utf16& units) {
+
+  Conversions result;
+  result.decoded = Encoders::utf8_decode(utf8);
+  result.wide_length = Encoders::wide_length(utf8.c_str(), utf8.size());
+  result.encoded = Encoders::utf8_encode(wide);
+  result.utf8_length = Encoders::utf8_length(wide.c_str(), wide.size());
+  result.from_utf16.clear();
+  if (!units.empty()) {
+    Encoders::utf16_append_utf8(
+      &units[0], units.size(), result.from_utf16, true);
+  }
+  Encoders::utf16_append_utf8(wide.c_str(), wide.size(), result.from_wide);
+  return result;
+}
+
+// the same conversions with the SSE2 fast paths and with the scalar path
+void ConvertBoth(
+  const std::string& utf8,
+  const std::wstring& wide,
+  const Utf16& units,
+  Conversions& ref_sse2,
+  Conversions& ref_scalar) {
+
+  bool previous = Encoders::set_sse2_enabled(true);
+  ref_sse2 = Convert(utf8, wide, units);
+  Encoders::set_sse2_enabled(false);
+  ref_scalar = Convert(utf8, wide, units);
+  Encoders::set_sse2_enabled(previous);
+}
+
+// valid text - both paths must produce the reference
+void ExpectRoundTrip(const char* test, const CodePoints& code_points) {
+  std::string utf8 = ReferenceUtf8(code_points);
+  std::wstring wide = ReferenceWide(code_points);
+  Utf16 units = ReferenceUtf16(code_points);
+
+  Conversions sse2;
+  Conversions scalar;
+  ConvertBoth(utf8, wide, units, sse2, scalar);
+
+  const Conversions* paths[] = { &sse2, &scalar };
+  for (size_t i = 0; i < 2; i++) {
+    const Conversions& conversions = *paths[i];
+    Expect(conversions.decoded == wide, "utf8_decode", test, utf8);
+    Expect(conversions.wide_length == wide.size(), "wide_length", test, utf8);
+    Expect(conversions.encoded == utf8, "utf8_encode", test, utf8);
+    Expect(conversions.utf8_length == utf8.size(), "utf8_length", test, utf8);
+    Expect(conversions.from_utf16 == utf8, "utf16_append_utf8 (units)",
+           test, utf8);
+    Expect(conversions.from_wide == utf8, "utf16_append_utf8 (wchar_t)",
+           test, utf8);
+  }
+}
+
+void AppendAscii(size_t count, CodePoints& ref_code_points) {
+  for (size_t i = 0; i < count; i++) {
+    ref_code_points.push_back('a' + (i % 26));
+  }
+}
+
+unsigned int RandomCodePoint(Random& random, size_t utf8_size) {
+  switch (utf8_size) {
+  case 1:
+    return 0x20 + random.Next(0x5F);
+  case 2:
+    return 0x80 + random.Next(0x800 - 0x80);
+  case 3: {
+    // no surrogates
+    unsigned int c = 0x800 + random.Next(0x10000 - 0x800 - 0x800);
+    return (c >= 0xD800) ? (c + 0x800) : c;
+  }
+  default:
+    return 0x10000 + random.Next(0x110000 - 0x10000);
+  }
+}
+
+//-----------------------------------------------------------------------------
+// ASCII runs of every length at every offset in the 16 byte blocks, between
+// 2, 3 and 4 byte characters
+void TestAsciiRuns() {
+  const unsigned int kSeparators[] = { 0xE9, 0x4E2D, 0x1F600, 0x7F, 0x80 };
+
+  for (size_t prefix = 0; prefix < 20; prefix++) {
+    for (size_t run = 0; run < 72; run++) {
+      for (size_t s = 0; s < 5; s++) {
+        CodePoints code_points;
+        AppendAscii(prefix, code_points);
+        code_points.push_back(kSeparators[s]);
+        AppendAscii(run, code_points);
+        code_points.push_back(kSeparators[(s + 1) % 5]);
+        AppendAscii(run % 17, code_points);
+        ExpectRoundTrip("ascii runs", code_points);
+      }
+    }
+  }
+}
+
+// random mixes of 1, 2, 3 and 4 byte sequences
+void TestMixedSequences() {
+  Random random(2015);
+
+  for (int text = 0; text < 3000; text++) {
+    CodePoints code_points;
+    size_t characters = random.Next(96);
+    while (code_points.size() < characters) {
+      size_t utf8_size = 1 + random.Next(4);
+      // mostly short runs, sometimes a run that fills a block
+      size_t run = (0 == random.Next(4)) ? random.Next(40) : 1;
+      for (size_t i = 0; i < run; i++) {
+        code_points.push_back(RandomCodePoint(random, utf8_size));
+      }
+    }
+    ExpectRoundTrip("mixed sequences", code_points);
+  }
+
+  // the extremes of every size
+  const unsigned int kEdges[] = {
+    0x0, 0x7F, 0x80, 0x7FF, 0x800, 0xD7FF, 0xE000, 0xFFFD, 0xFFFF,
+    0x10000, 0x10FFFF
+  };
+  for (size_t prefix = 0; prefix < 18; prefix++) {
+    CodePoints code_points;
+    AppendAscii(prefix, code_points);
+    code_points.insert(code_points.end(), kEdges, kEdges + 11);
+    AppendAscii(17, code_points);
+    ExpectRoundTrip("edges", code_points);
+  }
+}
+
+// UTF-16 streamed in chunks of every size - a chunk that ends between a
+// high and a low surrogate leaves the high one for the next chunk (the way
+// GetTextFileUtf8 and TxtFileStream read UTF-16 files)
+std::string Stream(const Utf16& units, size_t chunk_size, bool& ref_ok) {
+  std::string output;
+  Utf16 buffer;
+  size_t offset = 0;
+
+  while (offset < units.size()) {
+    size_t len = std::min(chunk_size, units.size() - offset);
+    buffer.insert(buffer.end(), &units[offset], &units[offset] + len);
+    offset += len;
+
+    size_t consumed =
+      Encoders::utf16_append_utf8(&buffer[0], buffer.size(), output);
+
+    uint16_t last = buffer.back();
+    bool dangling = (last >= 0xD800) && (last <= 0xDBFF);
+    if (consumed != buffer.size() - (dangling ? 1 : 0)) {
+      ref_ok = false;
+    }
+    buffer.erase(buffer.begin(), buffer.begin() + consumed);
+  }
+
+  if (!buffer.empty()) {
+    Encoders::utf16_append_utf8(&buffer[0], buffer.size(), output, true);
+  }
+  return output;
+}
+
+std::string StreamWide(const std::wstring& wide, size_t chunk_size) {
+  std::string output;
+  std::wstring buffer;
+
+  for (size_t offset = 0; offset < wide.size(); offset += chunk_size) {
+    buffer.append(wide, offset, chunk_size);
+    size_t consumed =
+      Encoders::utf16_append_utf8(buffer.c_str(), buffer.size(), output);
+    buffer.erase(0, consumed);
+  }
+  return output;
+}
+
+void TestSplitSurrogates() {
+  Random random(37);
+
+  for (int text = 0; text < 40; text++) {
+    CodePoints code_points;
+    size_t characters = 1 + random.Next(120);
+    while (code_points.size() < characters) {
+      // mostly 4 byte characters (surrogate pairs) with some ASCII runs
+      size_t kind = random.Next(6);
+      if (0 == kind) {
+        AppendAscii(random.Next(24), code_points);
+      } else {
+        code_points.push_back(RandomCodePoint(random, (1 == kind) ? 3 : 4));
+      }
+    }
+
+    std::string utf8 = ReferenceUtf8(code_points);
+    Utf16 units = ReferenceUtf16(code_points);
+    std::wstring wide = ReferenceWide(code_points);
+
+    for (int sse2 = 1; sse2 >= 0; sse2--) {
+      bool previous = Encoders::set_sse2_enabled(0 != sse2);
+      for (size_t chunk_size = 1; chunk_size <= 40; chunk_size++) {
+        bool ok = true;
+        Expect(Stream(units, chunk_size, ok) == utf8,
+               "streamed units", "split surrogates", utf8);
+        Expect(ok, "consumed units", "split surrogates", utf8);
+        Expect(StreamWide(wide, chunk_size) == utf8,
+               "streamed wchar_t", "split surrogates", utf8);
+      }
+      Encoders::set_sse2_enabled(previous);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+struct InvalidUtf8 {
+  const char* bytes;
+  CodePoints expected;
+};
+
+const unsigned int R = 0xFFFD;
+
+// a few hand checked cases (at every block offset) and random bytes, where
+// the fast paths have to agree with the scalar path
+void TestInvalidUtf8() {
+  const InvalidUtf8 kCases[] = {
+    { "\xC3", CodePoints(1, R) }, // truncated 2 byte sequence
+    { "\xE2\x82", CodePoints(1, R) }, // truncated 3 byte sequence
+    { "\xF0\x9F\x98", CodePoints(1, R) }, // truncated 4 byte sequence
+    { "\xC0\xAF", CodePoints(2, R) }, // overlong
+    { "\xE0\x80\xAF", CodePoints(3, R) }, // overlong
+    { "\xED\xA0\x80", CodePoints(3, R) }, // a surrogate
+    { "\xF4\x90\x80\x80", CodePoints(4, R) }, // > U+10FFFF
+    { "\x80\xBF", CodePoints(2, R) }, // continuation bytes
+    { "\xFE\xFF", CodePoints(2, R) }
+  };
+
+  for (size_t c = 0; c < sizeof(kCases) / sizeof(kCases[0]); c++) {
+    for (size_t prefix = 0; prefix < 20; prefix++) {
+      CodePoints expected;
+      AppendAscii(prefix, expected);
+      std::string utf8 = ReferenceUtf8(expected);
+
+      utf8 += kCases[c].bytes;
+      expected.insert(
+        expected.end(), kCases[c].expected.begin(), kCases[c].expected.end());
+
+      // at the very end, then again after an ASCII run that crosses a block
+      for (int tail = 0; tail < 2; tail++) {
+        std::wstring wide = ReferenceWide(expected);
+        Conversions sse2;
+        Conversions scalar;
+        ConvertBoth(utf8, wide, Utf16(), sse2, scalar);
+
+        Expect(sse2.decoded == wide, "utf8_decode (sse2)", "invalid", utf8);
+        Expect(scalar.decoded == wide, "utf8_decode (scalar)", "invalid",
+               utf8);
+        Expect(sse2.wide_length == wide.size(), "wide_length", "invalid",
+               utf8);
+
+        CodePoints ascii;
+        AppendAscii(18, ascii);
+        utf8 += ReferenceUtf8(ascii);
+        expected.insert(expected.end(), ascii.begin(), ascii.end());
+        if (0 == tail) {
+          utf8 += kCases[c].bytes;
+          expected.insert(expected.end(), kCases[c].expected.begin(),
+                          kCases[c].expected.end());
+        }
+      }
+    }
+  }
+
+  Random random(1);
+  for (int text = 0; text < 5000; text++) {
+    std::string utf8;
+    size_t len = random.Next(100);
+    while (utf8.size() < len) {
+      if (0 == random.Next(3)) {
+        utf8.append(random.Next(20), 'x');
+      } else {
+        utf8 += (char)(0x80 + random.Next(0x80));
+      }
+    }
+
+    std::wstring wide = Encoders::utf8_decode(utf8);
+    Conversions sse2;
+    Conversions scalar;
+    ConvertBoth(utf8, wide, Utf16(), sse2, scalar);
+    Expect(sse2 == scalar, "sse2 == scalar", "random bytes", utf8);
+    Expect(sse2.wide_length == sse2.decoded.size(), "wide_length",
+           "random bytes", utf8);
+    Expect(sse2.utf8_length == sse2.encoded.size(), "utf8_length",
+           "random bytes", utf8);
+  }
+}
+
+// unpaired surrogates become U+FFFD, a trailing high surrogate is left for
+// the next chunk unless it's the final one
+void TestInvalidUtf16() {
+  std::string replacement = ReferenceUtf8(CodePoints(1, R));
+
+  for (size_t prefix = 0; prefix < 20; prefix++) {
+    CodePoints ascii;
+    AppendAscii(prefix, ascii);
+    std::string ascii_utf8 = ReferenceUtf8(ascii);
+
+    for (int sse2 = 1; sse2 >= 0; sse2--) {
+      bool previous = Encoders::set_sse2_enabled(0 != sse2);
+
+      Utf16 lone_low = ReferenceUtf16(ascii);
+      lone_low.push_back(0xDC00);
+      lone_low.push_back('b');
+      std::string output;
+      Encoders::utf16_append_utf8(&lone_low[0], lone_low.size(), output);
+      Expect(output == ascii_utf8 + replacement + "b", "lone low surrogate",
+             "invalid utf16", ascii_utf8);
+
+      Utf16 unpaired = ReferenceUtf16(ascii);
+      unpaired.push_back(0xD800);
+      unpaired.push_back('b');
+      output.clear();
+      Encoders::utf16_append_utf8(&unpaired[0], unpaired.size(), output);
+      Expect(output == ascii_utf8 + replacement + "b", "unpaired high",
+             "invalid utf16", ascii_utf8);
+
+      Utf16 dangling = ReferenceUtf16(ascii);
+      dangling.push_back(0xDBFF);
+      output.clear();
+      size_t consumed =
+        Encoders::utf16_append_utf8(&dangling[0], dangling.size(), output);
+      Expect((consumed == prefix) && (output == ascii_utf8),
+             "dangling high (not final)", "invalid utf16", ascii_utf8);
+      output.clear();
+      consumed = Encoders::utf16_append_utf8(
+        &dangling[0], dangling.size(), output, true);
+      Expect((consumed == dangling.size()) &&
+             (output == ascii_utf8 + replacement),
+             "dangling high (final)", "invalid utf16", ascii_utf8);
+
+      Encoders::set_sse2_enabled(previous);
+    }
+  }
+
+  // random units, surrogates included
+  Random random(16);
+  for (int text = 0; text < 5000; text++) {
+    Utf16 units;
+    std::wstring wide;
+    size_t len = 1 + random.Next(64);
+    while (units.size() < len) {
+      uint16_t unit;
+      switch (random.Next(3)) {
+      case 0:
+        unit = (uint16_t)('a' + random.Next(26));
+        break;
+      case 1:
+        unit = (uint16_t)(0xD800 + random.Next(0x800));
+        break;
+      default:
+        unit = (uint16_t)random.Next(0x10000);
+        break;
+      }
+      units.push_back(unit);
+      wide += (wchar_t)unit;
+    }
+
+    Conversions sse2;
+    Conversions scalar;
+    ConvertBoth(std::string(), wide, units, sse2, scalar);
+    Expect(sse2 == scalar, "sse2 == scalar", "random units",
+           sse2.from_utf16);
+    Expect(sse2.utf8_length == sse2.encoded.size(), "utf8_length",
+           "random units", sse2.encoded);
+  }
+}
+
+}; // namespace
+
+int main() {
+  TestAsciiRuns();
+  TestMixedSequences();
+  TestSplitSurrogates();
+  TestInvalidUtf8();
+  TestInvalidUtf16();
+
+  bool sse2 = Encoders::set_sse2_enabled(true);
+  printf("encoders: %d checks, %d failed%s\n", checks, failures,
+         sse2 ? "" : " (no SSE2 in this build - scalar only)");
+  return (0 == failures) ? 0 : 1;
+}
@@ -0,0 +1,92 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#include "Arena.h"
+
+#include <new>
+#include <string.h>
+
+using namespace utils;
+
+namespace {
+
+const size_t kAlignment = sizeof(double);
+
+size_t Align(size_t size) {
+  return (size + kAlignment - 1) & ~(kAlignment - 1);
+}
+
+}; // namespace
+
+Arena::Arena() :
+  cursor_(inline_),
+  end_(inline_ + kInlineSize),
+  blocks_(nullptr),
+  heap_bytes_(0) {
+}
+
+Arena::~Arena() {
+  Reset();
+}
+
+void* Arena::Allocate(size_t size) {
+  size = Align((0 == size) ? 1 : size);
+
+  if ((size_t)(end_ - cursor_) >= size) {
+    void* block = cursor_;
+    cursor_ += size;
+    return block;
+  }
+
+  // large buffers get a block of their own, so the current one (and what's
+  // left of it) stays in use
+  if (size > kBlockSize / 2) {
+    return AllocateBlock(size, false);
+  }
+
+  void* block = AllocateBlock(kBlockSize, true);
+  cursor_ += size;
+  return block;
+}
+
+StringView Arena::CopyString(const char* data, size_t size) {
+  char* copy = static_cast<char*>(Allocate(size + 1));
+  if (size > 0) {
+    memcpy(copy, data, size);
+  }
+  copy[size] = 0;
+  return StringView(copy, size);
+}
+
+void Arena::Reset() {
+  while (nullptr != blocks_) {
+    Block* next = blocks_->next;
+    ::operator delete(blocks_);
+    blocks_ = next;
+  }
+
+  cursor_ = inline_;
+  end_ = inline_ + kInlineSize;
+  heap_bytes_ = 0;
+}
+
+size_t Arena::heap_bytes() const {
+  return heap_bytes_;
+}
+
+void* Arena::AllocateBlock(size_t size, bool make_current) {
+  size_t header = Align(sizeof(Block));
+  Block* block = static_cast<Block*>(::operator new(header + size));
+  block->next = blocks_;
+  block->size = size;
+  blocks_ = block;
+  heap_bytes_ += header + size;
+
+  char* data = reinterpret_cast<char*>(block) + header;
+  if (make_current) {
+    cursor_ = data;
+    end_ = data + size;
+  }
+  return data;
+}
\ No newline at end of file
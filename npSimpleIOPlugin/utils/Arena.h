@@ -0,0 +1,64 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef UTILS_ARENA_H_
+#define UTILS_ARENA_H_
+
+#include "StringView.h"
+
+namespace utils {
+
+// A bump allocator for the buffers of a single request (e.g. the copies of 
+// its arguments). Allocations are carved out of a block inside the arena 
+// itself, then out of heap blocks once it's used up, and are all released
+// together by |Reset| or the destructor - there's no freeing one by one.
+// Not thread safe (a request is on one thread at a time).
+class Arena {
+public:
+  static const size_t kInlineSize = 256;
+  static const size_t kBlockSize = 4096;
+
+  Arena();
+  virtual ~Arena();
+
+public:
+  // aligned for any type - throws std::bad_alloc
+  void* Allocate(size_t size);
+
+  // a NUL terminated copy of |data|
+  StringView CopyString(const char* data, size_t size);
+
+  // releases everything but the inline block
+  void Reset();
+
+  // taken from the heap so far (the inline block isn't counted)
+  size_t heap_bytes() const;
+
+private:
+  struct Block {
+    Block* next;
+    size_t size;
+  };
+
+  void* AllocateBlock(size_t size, bool make_current);
+
+  // no copies - views would point into the wrong arena
+  Arena(const Arena&);
+  Arena& operator=(const Arena&);
+
+private:
+  char* cursor_;
+  char* end_;
+  Block* blocks_;
+  size_t heap_bytes_;
+
+  union {
+    char inline_[kInlineSize];
+    double align_;
+  };
+};
+
+}; // namespace utils
+
+#endif // UTILS_ARENA_H_
\ No newline at end of file
@@ -0,0 +1,127 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#include "BufferPool.h"
+#include "CriticalSectionLock.h"
+
+#include <new>
+#include <vector>
+
+using namespace utils;
+
+namespace {
+
+// 16KB, 32KB ... 2MB
+const size_t kClassesCount = 8;
+
+CriticalSection g_critical_section;
+std::vector<char*> g_free_buffers[kClassesCount];
+size_t g_in_use_bytes = 0;
+size_t g_pooled_bytes = 0;
+unsigned __int64 g_allocations = 0;
+
+size_t ClassOf(size_t size) {
+  size_t index = 0;
+  size_t capacity = BufferPool::kMinBufferSize;
+  while ((capacity < size) && (index + 1 < kClassesCount)) {
+    capacity <<= 1;
+    index++;
+  }
+  return index;
+}
+
+size_t ClassCapacity(size_t index) {
+  return BufferPool::kMinBufferSize << index;
+}
+
+}; // namespace
+
+// static
+char* BufferPool::Acquire(size_t size, size_t& ref_capacity) {
+  size_t index = ClassOf(size);
+  ref_capacity = ClassCapacity(index);
+
+  {
+    CriticalSectionLock lock(g_critical_section);
+    g_in_use_bytes += ref_capacity;
+
+    if (!g_free_buffers[index].empty()) {
+      char* buffer = g_free_buffers[index].back();
+      g_free_buffers[index].pop_back();
+      g_pooled_bytes -= ref_capacity;
+      return buffer;
+    }
+
+    g_allocations++;
+  }
+
+  char* buffer = new (std::nothrow) char[ref_capacity];
+  if (nullptr == buffer) {
+    CriticalSectionLock lock(g_critical_section);
+    g_in_use_bytes -= ref_capacity;
+  }
+  return buffer;
+}
+
+// static
+void BufferPool::Release(char* buffer, size_t capacity) {
+  if (nullptr == buffer) {
+    return;
+  }
+
+  {
+    CriticalSectionLock lock(g_critical_section);
+    g_in_use_bytes -= capacity;
+
+    if (g_pooled_bytes + capacity <= kMaxPooledBytes) {
+      try {
+        g_free_buffers[ClassOf(capacity)].push_back(buffer);
+        g_pooled_bytes += capacity;
+        return;
+      } catch(...) {
+      }
+    }
+  }
+
+  delete[] buffer;
+}
+
+// static
+void BufferPool::Trim() {
+  std::vector<char*> buffers;
+
+  {
+    CriticalSectionLock lock(g_critical_section);
+    for (size_t index = 0; index < kClassesCount; index++) {
+      buffers.insert(
+        buffers.end(), 
+        g_free_buffers[index].begin(), 
+        g_free_buffers[index].end());
+      std::vector<char*>().swap(g_free_buffers[index]);
+    }
+    g_pooled_bytes = 0;
+  }
+
+  for (size_t i = 0; i < buffers.size(); i++) {
+    delete[] buffers[i];
+  }
+}
+
+// static
+size_t BufferPool::in_use_bytes() {
+  CriticalSectionLock lock(g_critical_section);
+  return g_in_use_bytes;
+}
+
+// static
+size_t BufferPool::pooled_bytes() {
+  CriticalSectionLock lock(g_critical_section);
+  return g_pooled_bytes;
+}
+
+// static
+unsigned __int64 BufferPool::allocations() {
+  CriticalSectionLock lock(g_critical_section);
+  return g_allocations;
+}
\ No newline at end of file
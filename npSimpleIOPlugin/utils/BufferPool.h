@@ -0,0 +1,41 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef UTILS_BUFFER_POOL_H_
+#define UTILS_BUFFER_POOL_H_
+
+#include "Platform.h"
+
+namespace utils {
+
+// A process-wide pool of read buffers in power of 2 size classes, from 
+// |kMinBufferSize| to |kMaxBufferSize|. Released buffers are kept (up to 
+// |kMaxPooledBytes| in all) for the next |Acquire| of their class - so 
+// listeners that restart, or resize their buffer, don't go back to the heap.
+class BufferPool {
+public:
+  static const size_t kMinBufferSize = 16 * 1024;
+  static const size_t kMaxBufferSize = 2 * 1024 * 1024;
+  static const size_t kMaxPooledBytes = 1024 * 1024;
+
+  // a buffer of at least |size| bytes (at most |kMaxBufferSize|) - 
+  // |ref_capacity| is the size of its class. nullptr when out of memory.
+  static char* Acquire(size_t size, size_t& ref_capacity);
+
+  // |capacity| as returned by |Acquire|
+  static void Release(char* buffer, size_t capacity);
+
+  // frees the pooled buffers (the ones in use aren't affected)
+  static void Trim();
+
+  static size_t in_use_bytes();
+  static size_t pooled_bytes();
+
+  // heap allocations made so far - a pool hit doesn't count
+  static unsigned __int64 allocations();
+};
+
+}; // namespace utils
+
+#endif // UTILS_BUFFER_POOL_H_
\ No newline at end of file
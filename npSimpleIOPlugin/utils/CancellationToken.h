@@ -0,0 +1,40 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef UTILS_CANCELLATION_TOKEN_H_
+#define UTILS_CANCELLATION_TOKEN_H_
+
+#include "Platform.h"
+
+namespace utils {
+
+// Set from one thread (e.g. cancel() on the browser thread), polled by the
+// thread doing the work - long operations check it at their chunk 
+// boundaries and stop early. Once cancelled it stays cancelled.
+class CancellationToken {
+public:
+  CancellationToken() : cancelled_(0) {
+  }
+
+public:
+  void Cancel() {
+    InterlockedExchange(&cancelled_, 1);
+  }
+
+  bool IsCancelled() const {
+    return (0 != cancelled_);
+  }
+
+  // for functions that take an optional token
+  static bool IsCancelled(const CancellationToken* token) {
+    return (nullptr != token) && token->IsCancelled();
+  }
+
+private:
+  volatile LONG cancelled_;
+};
+
+}; // namespace utils
+
+#endif // UTILS_CANCELLATION_TOKEN_H_
\ No newline at end of file
@@ -0,0 +1,29 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#include "Clock.h"
+
+using namespace utils;
+
+// static
+unsigned __int64 Clock::NowMicroseconds() {
+#ifdef _WIN32
+  static LARGE_INTEGER frequency = { 0 };
+  if (0 == frequency.QuadPart) {
+    QueryPerformanceFrequency(&frequency);
+  }
+
+  LARGE_INTEGER now;
+  QueryPerformanceCounter(&now);
+
+  // split to avoid overflowing on machines with a high frequency counter
+  unsigned __int64 seconds = now.QuadPart / frequency.QuadPart;
+  unsigned __int64 remainder = now.QuadPart % frequency.QuadPart;
+  return (seconds * 1000000) + (remainder * 1000000 / frequency.QuadPart);
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return ((unsigned __int64)now.tv_sec * 1000000) + (now.tv_nsec / 1000);
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,21 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef UTILS_CLOCK_H_
+#define UTILS_CLOCK_H_
+
+#include "Platform.h"
+
+namespace utils {
+
+// A monotonic high resolution clock (QueryPerformanceCounter on Windows) -
+// for measuring, not for telling the time
+class Clock {
+public:
+  static unsigned __int64 NowMicroseconds();
+};
+
+}; // namespace utils
+
+#endif // UTILS_CLOCK_H_
\ No newline at end of file
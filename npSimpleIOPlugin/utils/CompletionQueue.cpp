@@ -0,0 +1,121 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#include "CompletionQueue.h"
+#include "Clock.h"
+
+using namespace utils;
+
+CompletionQueue::CompletionQueue(
+  ScheduleFunc schedule, 
+  unsigned int budget_us) :
+  schedule_(schedule),
+  budget_us_(budget_us),
+  pushed_(nullptr),
+  pending_head_(nullptr),
+  pending_tail_(nullptr),
+  drain_scheduled_(0),
+  drains_(0),
+  callbacks_(0) {
+}
+
+CompletionQueue::~CompletionQueue() {
+}
+
+void CompletionQueue::Push(Entry* entry, Callback callback, void* param) {
+  entry->callback = callback;
+  entry->param = param;
+
+  Entry* head;
+  do {
+    head = pushed_;
+    entry->next = head;
+  } while (InterlockedCompareExchangePointer(
+    (void* volatile*)&pushed_, 
+    entry, 
+    head) != head);
+
+  // the first push after a drain finished schedules the next one
+  if (0 == InterlockedCompareExchange(&drain_scheduled_, 1, 0)) {
+    schedule_();
+  }
+}
+
+void CompletionQueue::Drain() {
+  drains_++;
+
+  unsigned __int64 start_us = Clock::NowMicroseconds();
+  TakePushed();
+
+  // at least one callback per drain, so we always make progress
+  while (nullptr != pending_head_) {
+    Entry* entry = pending_head_;
+    pending_head_ = entry->next;
+    if (nullptr == pending_head_) {
+      pending_tail_ = nullptr;
+    }
+
+    // |entry| may be freed by its callback
+    entry->callback(entry->param);
+    callbacks_++;
+
+    if ((nullptr == pending_head_) && !TakePushed()) {
+      break;
+    }
+
+    if (Clock::NowMicroseconds() - start_us >= budget_us_) {
+      break;
+    }
+  }
+
+  if (nullptr != pending_head_) {
+    // out of budget - let the browser breathe and continue on the next drain
+    schedule_();
+    return;
+  }
+
+  InterlockedExchange(&drain_scheduled_, 0);
+
+  // pushes that saw the flag still set didn't schedule
+  if ((nullptr != pushed_) && 
+      (0 == InterlockedCompareExchange(&drain_scheduled_, 1, 0))) {
+    schedule_();
+  }
+}
+
+unsigned __int64 CompletionQueue::drains() const {
+  return drains_;
+}
+
+unsigned __int64 CompletionQueue::callbacks() const {
+  return callbacks_;
+}
+
+bool CompletionQueue::TakePushed() {
+  Entry* entry = (Entry*)InterlockedExchangePointer(
+    (void* volatile*)&pushed_, 
+    nullptr);
+  if (nullptr == entry) {
+    return false;
+  }
+
+  // newest first -> oldest first
+  Entry* reversed = nullptr;
+  Entry* tail = entry;
+  while (nullptr != entry) {
+    Entry* next = entry->next;
+    entry->next = reversed;
+    reversed = entry;
+    entry = next;
+  }
+
+  if (nullptr == pending_tail_) {
+    pending_head_ = reversed;
+  } else {
+    pending_tail_->next = reversed;
+  }
+  pending_tail_ = tail;
+
+  return true;
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef UTILS_COMPLETION_QUEUE_H_
+#define UTILS_COMPLETION_QUEUE_H_
+
+#include <functional>
+#include "Platform.h"
+
+namespace utils {
+
+// Hands callbacks from any thread to a single consumer thread (the browser's
+// main thread) in batches: |Push| is lock free, and only the first push into
+// an idle queue asks for a |Drain| (via |schedule|) - so there is at most one
+// drain outstanding, however many callbacks are ready.
+//
+// |Drain| runs the ready callbacks in the order they were pushed (per 
+// pushing thread) until |budget_us| is used up, and schedules itself again 
+// for the rest - a burst of completions doesn't hold the main thread for more
+// than a frame.
+class CompletionQueue {
+public:
+  typedef void (*Callback)(void* param);
+
+  // intrusive, so pushing doesn't allocate - the owner of the entry keeps it
+  // alive until its callback runs
+  struct Entry {
+    Callback callback;
+    void* param;
+    Entry* next;
+  };
+
+  typedef std::function<void()> ScheduleFunc;
+
+  CompletionQueue(ScheduleFunc schedule, unsigned int budget_us);
+  virtual ~CompletionQueue();
+
+public:
+  // any thread
+  void Push(Entry* entry, Callback callback, void* param);
+
+  // the consumer thread only
+  void Drain();
+
+  // for getStats(): the drains that ran and the callbacks they ran
+  unsigned __int64 drains() const;
+  unsigned __int64 callbacks() const;
+
+private:
+  // moves whatever was pushed since the last call to the end of |pending_|
+  bool TakePushed();
+
+private:
+  ScheduleFunc schedule_;
+  unsigned int budget_us_;
+
+  // LIFO stack of pushed entries (newest first)
+  Entry* volatile pushed_;
+
+  // FIFO of entries taken from |pushed_| - only touched by |Drain|
+  Entry* pending_head_;
+  Entry* pending_tail_;
+
+  // 1 while a drain is scheduled or running
+  volatile LONG drain_scheduled_;
+
+  unsigned __int64 drains_;
+  unsigned __int64 callbacks_;
+};
+
+}; // namespace utils
+
+#endif // UTILS_COMPLETION_QUEUE_H_
\ No newline at end of file
@@ -6,6 +6,8 @@
 
 using namespace utils;
 
+// see posix/CriticalSectionLockPosix.cpp for other platforms
+#ifdef _WIN32
 CriticalSection::CriticalSection() {
   InitializeCriticalSection(&critical_section_);
 }
@@ -21,6 +23,7 @@ void CriticalSection::lock() {
 void CriticalSection::unlock() {
   LeaveCriticalSection(&critical_section_);
 }
+#endif // _WIN32
 
 
 
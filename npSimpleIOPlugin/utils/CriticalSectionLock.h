@@ -5,7 +5,11 @@
 #ifndef UTILS_CRITICAL_SECTION_LOCK_H_
 #define UTILS_CRITICAL_SECTION_LOCK_H_
 
-#include <Windows.h>
+#include "Platform.h"
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
 
 namespace utils {
 
@@ -17,7 +21,11 @@ public:
     void lock();
     void unlock();
 private:
+#ifdef _WIN32
     CRITICAL_SECTION critical_section_;
+#else
+    pthread_mutex_t mutex_;
+#endif
 }; // class CriticalSectionLock
 
 
@@ -0,0 +1,224 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#include "DirectoryWalker.h"
+#include "ThreadPool.h"
+#include "Encoders.h"
+
+using namespace utils;
+
+// idle workers re-check the queue at least this often
+const DWORD kIdleWaitMS = 10;
+const size_t kListPageSize = 1024;
+
+DirectoryWalker::DirectoryWalker() :
+  globs_(nullptr),
+  max_depth_(-1),
+  batch_size_(1),
+  details_(true),
+  busy_workers_(0),
+  running_workers_(0),
+  root_listed_(false),
+  stopping_(false) {
+}
+
+DirectoryWalker::~DirectoryWalker() {
+  work_event_.Destroy();
+  done_event_.Destroy();
+}
+
+bool DirectoryWalker::Walk(
+  ThreadPool* pool,
+  const std::wstring& root,
+  const GlobSet& globs,
+  int max_depth,
+  size_t batch_size,
+  BatchCallback callback,
+  bool details) {
+
+  if ((nullptr == pool) || (0 == pool->size())) {
+    return false;
+  }
+
+  if (!work_event_.IsCreated() && !work_event_.Create(false, false)) {
+    return false;
+  }
+
+  if (!done_event_.IsCreated() && !done_event_.Create(true, false)) {
+    return false;
+  }
+
+  done_event_.Reset();
+
+  globs_ = &globs;
+  max_depth_ = max_depth;
+  batch_size_ = (batch_size > 0) ? batch_size : 1;
+  details_ = details;
+  callback_ = callback;
+
+  PendingDirectory root_directory;
+  root_directory.path = root;
+  root_directory.depth = 0;
+
+  {
+    CriticalSectionLock lock(queue_critical_section_);
+    queue_.clear();
+    queue_.push_back(root_directory);
+    busy_workers_ = 0;
+    running_workers_ = pool->size();
+    root_listed_ = false;
+    stopping_ = false;
+  }
+
+  size_t started_workers = 0;
+  for (size_t i = 0; i < pool->size(); i++) {
+    if (pool->PostTask(std::bind(&DirectoryWalker::WorkerLoop, this))) {
+      started_workers++;
+    } else {
+      CriticalSectionLock lock(queue_critical_section_);
+      running_workers_--;
+    }
+  }
+
+  if (0 == started_workers) {
+    return false;
+  }
+
+  done_event_.Wait();
+  return root_listed_;
+}
+
+void DirectoryWalker::WorkerLoop() {
+  File::DirectoryEntries batch;
+
+  while (true) {
+    PendingDirectory directory;
+    bool has_work = false;
+
+    {
+      CriticalSectionLock lock(queue_critical_section_);
+
+      if (!stopping_ && !queue_.empty()) {
+        directory = queue_.front();
+        queue_.pop_front();
+        busy_workers_++;
+        has_work = true;
+      } else if (stopping_ || (0 == busy_workers_)) {
+        // nothing left and no one is going to add more
+        break;
+      }
+    }
+
+    if (!has_work) {
+      work_event_.Wait(kIdleWaitMS);
+      continue;
+    }
+
+    ListDirectory(directory, batch);
+
+    {
+      CriticalSectionLock lock(queue_critical_section_);
+      busy_workers_--;
+    }
+
+    // wake up an idle worker - either to take new work or to quit
+    work_event_.Signal();
+  }
+
+  if (!batch.empty()) {
+    DeliverBatch(batch);
+  }
+
+  bool last_worker = false;
+  {
+    CriticalSectionLock lock(queue_critical_section_);
+    running_workers_--;
+    last_worker = (0 == running_workers_);
+  }
+
+  work_event_.Signal();
+
+  if (last_worker) {
+    done_event_.Signal();
+  }
+}
+
+void DirectoryWalker::ListDirectory(
+  const PendingDirectory& directory, 
+  File::DirectoryEntries& ref_batch) {
+
+  std::vector<PendingDirectory> sub_directories;
+  bool descend = (max_depth_ < 0) || (directory.depth < max_depth_);
+
+  bool status = File::ListDirectory(
+    directory.path, 
+    L"*", 
+    kListPageSize,
+    [&](const File::DirectoryEntries& page, bool /*last*/) -> bool {
+      File::DirectoryEntries::const_iterator iter = page.begin();
+      for (; iter != page.end(); ++iter) {
+        std::string relative_path = directory.relative_path.empty() ?
+          iter->name :
+          directory.relative_path + '/' + iter->name;
+
+        if (iter->is_directory) {
+          // don't follow links - they can create cycles
+          if (!descend || 
+              iter->is_link || 
+              globs_->IsExcluded(relative_path)) {
+            continue;
+          }
+
+          PendingDirectory sub_directory;
+          sub_directory.path = 
+            directory.path + File::kPathSeparator + 
+            Encoders::utf8_decode(iter->name);
+          sub_directory.relative_path = relative_path;
+          sub_directory.depth = directory.depth + 1;
+          sub_directories.push_back(sub_directory);
+          continue;
+        }
+
+        if (!globs_->IsIncluded(relative_path)) {
+          continue;
+        }
+
+        ref_batch.push_back(*iter);
+        ref_batch.back().name = relative_path;
+
+        if ((ref_batch.size() >= batch_size_) && !DeliverBatch(ref_batch)) {
+          return false;
+        }
+      }
+
+      return !stopping_;
+    },
+    details_);
+
+  if (0 == directory.depth) {
+    root_listed_ = status;
+  }
+
+  if (sub_directories.empty()) {
+    return;
+  }
+
+  {
+    CriticalSectionLock lock(queue_critical_section_);
+    queue_.insert(queue_.end(), sub_directories.begin(), sub_directories.end());
+  }
+
+  work_event_.Signal();
+}
+
+bool DirectoryWalker::DeliverBatch(File::DirectoryEntries& ref_batch) {
+  CriticalSectionLock lock(callback_critical_section_);
+
+  if (!stopping_ && !callback_(ref_batch)) {
+    stopping_ = true;
+  }
+
+  ref_batch.clear();
+  return !stopping_;
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef UTILS_DIRECTORY_WALKER_H_
+#define UTILS_DIRECTORY_WALKER_H_
+
+#include <deque>
+#include <string>
+#include "CriticalSectionLock.h"
+#include "Event.h"
+#include "File.h"
+#include "Glob.h"
+
+namespace utils {
+
+class ThreadPool;
+
+// Walks a directory tree in parallel on a |ThreadPool| - each worker lists a
+// directory at a time (see |File::ListDirectory|) and queues the
+// sub-directories it finds for the other workers. Matching files are handed
+// to the callback in batches, with |DirectoryEntry::name| set to the path
+// relative to the root ('/' separated).
+class DirectoryWalker {
+public:
+  // called from the worker threads (never concurrently) - return false to 
+  // stop the walk
+  typedef std::function<bool(const File::DirectoryEntries& batch)> 
+    BatchCallback;
+
+  DirectoryWalker();
+  virtual ~DirectoryWalker();
+
+public:
+  // Blocks until the walk is done. |max_depth| < 0 means no limit, 0 only
+  // looks at the entries of |root|. Without |details| the entries' size
+  // and times may be left 0 (see |File::ListDirectory|). Returns false if
+  // |root| couldn't be listed.
+  bool Walk(
+    ThreadPool* pool,
+    const std::wstring& root,
+    const GlobSet& globs,
+    int max_depth,
+    size_t batch_size,
+    BatchCallback callback,
+    bool details = true);
+
+private:
+  struct PendingDirectory {
+    std::wstring path;
+    std::string relative_path; // UTF8
+    int depth;
+  };
+
+  void WorkerLoop();
+  void ListDirectory(
+    const PendingDirectory& directory, 
+    File::DirectoryEntries& ref_batch);
+  bool DeliverBatch(File::DirectoryEntries& ref_batch);
+
+private:
+  const GlobSet* globs_;
+  int max_depth_;
+  size_t batch_size_;
+  bool details_;
+  BatchCallback callback_;
+
+  CriticalSection queue_critical_section_;
+  std::deque<PendingDirectory> queue_;
+  size_t busy_workers_;
+  size_t running_workers_;
+  bool root_listed_;
+  volatile bool stopping_;
+
+  // serializes |callback_|
+  CriticalSection callback_critical_section_;
+
+  Event work_event_;
+  Event done_event_;
+};
+
+}; // namespace utils
+
+#endif // UTILS_DIRECTORY_WALKER_H_
\ No newline at end of file
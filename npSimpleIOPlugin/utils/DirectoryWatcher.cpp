@@ -0,0 +1,356 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#include "DirectoryWatcher.h"
+#include "Encoders.h"
+
+#include <algorithm>
+
+using namespace utils;
+
+#ifdef _WIN32
+// must be DWORD aligned and can't exceed 64KB for network shares
+const DWORD kBufferSize = 64 * 1024;
+
+const DWORD kNotifyFilter = 
+  FILE_NOTIFY_CHANGE_FILE_NAME | 
+  FILE_NOTIFY_CHANGE_DIR_NAME |
+  FILE_NOTIFY_CHANGE_SIZE |
+  FILE_NOTIFY_CHANGE_LAST_WRITE |
+  FILE_NOTIFY_CHANGE_CREATION;
+#endif // _WIN32
+
+DirectoryWatcher::DirectoryWatcher() :
+  recursive_(false),
+  has_filters_(false),
+  debounce_ms_(0),
+  next_sequence_(0),
+  window_start_(0) {
+#ifndef _WIN32
+  inotify_ = -1;
+  stop_pipe_[0] = stop_pipe_[1] = -1;
+  rename_cookie_ = 0;
+#endif
+}
+
+DirectoryWatcher::~DirectoryWatcher() {
+  Stop();
+}
+
+// see posix/DirectoryWatcherPosix.cpp for other platforms
+#ifdef _WIN32
+bool DirectoryWatcher::Start(
+  const std::wstring& directory, 
+  bool recursive,
+  const std::vector<std::string>& filters,
+  unsigned int debounce_ms,
+  ChangesCallback callback) {
+
+  Stop();
+
+  has_filters_ = !filters.empty();
+  if (has_filters_ && !filters_.Compile(filters)) {
+    return false;
+  }
+
+  directory_.Reset(CreateFileW(
+    directory.c_str(),
+    FILE_LIST_DIRECTORY,
+    FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+    NULL,
+    OPEN_EXISTING,
+    FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+    NULL));
+
+  if (!directory_) {
+    return false;
+  }
+
+  io_event_.Reset(CreateEvent(NULL, TRUE, FALSE, NULL));
+  stop_event_.Reset(CreateEvent(NULL, TRUE, FALSE, NULL));
+  if (!io_event_ || !stop_event_) {
+    directory_.Reset();
+    return false;
+  }
+
+  recursive_ = recursive;
+  debounce_ms_ = debounce_ms;
+  callback_ = callback;
+  pending_.clear();
+  rename_old_path_.clear();
+
+  if (!thread_.Start() || 
+      !thread_.PostTask(std::bind(&DirectoryWatcher::WatchLoop, this))) {
+    Stop();
+    return false;
+  }
+
+  return true;
+}
+
+void DirectoryWatcher::Stop() {
+  if (stop_event_) {
+    SetEvent(stop_event_.Get());
+  }
+
+  thread_.Stop();
+
+  directory_.Reset();
+  io_event_.Reset();
+  stop_event_.Reset();
+}
+
+void DirectoryWatcher::WatchLoop() {
+  std::vector<DWORD> buffer(kBufferSize / sizeof(DWORD));
+
+  OVERLAPPED overlapped;
+  memset(&overlapped, 0, sizeof(overlapped));
+  overlapped.hEvent = io_event_.Get();
+
+  HANDLE handles[2] = { stop_event_.Get(), io_event_.Get() };
+  bool status = true;
+
+  while (true) {
+    ResetEvent(io_event_.Get());
+    if (!ReadDirectoryChangesW(
+          directory_.Get(),
+          &buffer[0],
+          kBufferSize,
+          recursive_ ? TRUE : FALSE,
+          kNotifyFilter,
+          NULL,
+          &overlapped,
+          NULL)) {
+      status = false;
+      break;
+    }
+
+    bool read_completed = false;
+    while (!read_completed) {
+      DWORD timeout = INFINITE;
+      if (!pending_.empty()) {
+        DWORD elapsed = GetTickCount() - window_start_;
+        timeout = (elapsed < debounce_ms_) ? (debounce_ms_ - elapsed) : 0;
+      }
+
+      DWORD result = WaitForMultipleObjects(2, handles, FALSE, timeout);
+
+      if (WAIT_TIMEOUT == result) {
+        Flush();
+        continue;
+      }
+
+      if (WAIT_OBJECT_0 + 1 != result) {
+        // stopped - let the pending read finish before its buffer goes away
+        DWORD ignored;
+        CancelIo(directory_.Get());
+        GetOverlappedResult(directory_.Get(), &overlapped, &ignored, TRUE);
+        return;
+      }
+
+      read_completed = true;
+    }
+
+    DWORD bytes = 0;
+    if (!GetOverlappedResult(directory_.Get(), &overlapped, &bytes, FALSE)) {
+      // e.g. the directory itself was removed
+      status = false;
+      break;
+    }
+
+    if (pending_.empty()) {
+      window_start_ = GetTickCount();
+    }
+
+    if (0 == bytes) {
+      // the system buffer overflowed - whatever we have is incomplete
+      pending_.clear();
+      AddChange(CHANGE_OVERFLOW, std::string());
+    } else {
+      ParseNotifications(&buffer[0]);
+    }
+
+    if (!pending_.empty() && (GetTickCount() - window_start_ >= debounce_ms_)) {
+      Flush();
+    }
+  }
+
+  Flush();
+
+  if (!status) {
+    callback_(false, Changes());
+  }
+}
+
+void DirectoryWatcher::ParseNotifications(const void* buffer) {
+  const unsigned char* position = (const unsigned char*)buffer;
+
+  while (true) {
+    const FILE_NOTIFY_INFORMATION* info = 
+      (const FILE_NOTIFY_INFORMATION*)position;
+
+    std::wstring wide_path(
+      info->FileName, 
+      info->FileNameLength / sizeof(wchar_t));
+    std::replace(wide_path.begin(), wide_path.end(), L'\\', L'/');
+    std::string path = Encoders::utf8_encode(wide_path);
+
+    switch (info->Action) {
+    case FILE_ACTION_ADDED:
+      AddChange(CHANGE_ADDED, path);
+      break;
+    case FILE_ACTION_REMOVED:
+      AddChange(CHANGE_REMOVED, path);
+      break;
+    case FILE_ACTION_MODIFIED:
+      AddChange(CHANGE_MODIFIED, path);
+      break;
+    case FILE_ACTION_RENAMED_OLD_NAME:
+      rename_old_path_ = path;
+      break;
+    case FILE_ACTION_RENAMED_NEW_NAME:
+      AddRename(rename_old_path_, path);
+      rename_old_path_.clear();
+      break;
+    }
+
+    if (0 == info->NextEntryOffset) {
+      break;
+    }
+
+    position += info->NextEntryOffset;
+  }
+}
+
+#endif // _WIN32
+
+void DirectoryWatcher::AddChange(ChangeType type, const std::string& path) {
+  if (has_filters_ && (CHANGE_OVERFLOW != type) && 
+      !filters_.IsIncluded(path)) {
+    return;
+  }
+
+  PendingChanges::iterator iter = pending_.find(path);
+  if (iter == pending_.end()) {
+    PendingChange& pending = pending_[path];
+    pending.change.type = type;
+    pending.change.path = path;
+    pending.sequence = next_sequence_++;
+    return;
+  }
+
+  Change& change = iter->second.change;
+  switch (type) {
+  case CHANGE_ADDED:
+    // removed and added back
+    if (CHANGE_REMOVED == change.type) {
+      change.type = CHANGE_MODIFIED;
+    }
+    break;
+  case CHANGE_REMOVED:
+    if (CHANGE_ADDED == change.type) {
+      // never existed as far as the listener is concerned
+      pending_.erase(iter);
+    } else if (CHANGE_RENAMED == change.type) {
+      std::string old_path = change.old_path;
+      pending_.erase(iter);
+      AddChange(CHANGE_REMOVED, old_path);
+    } else {
+      change.type = CHANGE_REMOVED;
+    }
+    break;
+  case CHANGE_MODIFIED:
+    // added/renamed + modified stays added/renamed
+    if (CHANGE_REMOVED == change.type) {
+      change.type = CHANGE_MODIFIED;
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+void DirectoryWatcher::AddRename(
+  const std::string& old_path, 
+  const std::string& new_path) {
+
+  if (old_path.empty()) {
+    AddChange(CHANGE_ADDED, new_path);
+    return;
+  }
+
+  // a filtered out file renamed to a file we care about (or vice versa) is
+  // an addition (removal)
+  if (has_filters_) {
+    bool old_included = filters_.IsIncluded(old_path);
+    bool new_included = filters_.IsIncluded(new_path);
+    if (!old_included || !new_included) {
+      if (old_included) {
+        AddChange(CHANGE_REMOVED, old_path);
+      } else if (new_included) {
+        AddChange(CHANGE_ADDED, new_path);
+      }
+      return;
+    }
+  }
+
+  Change renamed;
+  renamed.type = CHANGE_RENAMED;
+  renamed.path = new_path;
+  renamed.old_path = old_path;
+
+  unsigned int sequence = next_sequence_++;
+  PendingChanges::iterator iter = pending_.find(old_path);
+  if (iter != pending_.end()) {
+    const Change& previous = iter->second.change;
+    sequence = iter->second.sequence;
+
+    if (CHANGE_ADDED == previous.type) {
+      renamed.type = CHANGE_ADDED;
+      renamed.old_path.clear();
+    } else if (CHANGE_RENAMED == previous.type) {
+      renamed.old_path = previous.old_path;
+    }
+
+    pending_.erase(iter);
+  }
+
+  // renamed back and forth
+  if ((CHANGE_RENAMED == renamed.type) && (renamed.old_path == new_path)) {
+    renamed.type = CHANGE_MODIFIED;
+    renamed.old_path.clear();
+  }
+
+  PendingChange& pending = pending_[new_path];
+  pending.change = renamed;
+  pending.sequence = sequence;
+}
+
+void DirectoryWatcher::Flush() {
+  if (pending_.empty()) {
+    return;
+  }
+
+  std::vector<const PendingChange*> ordered;
+  ordered.reserve(pending_.size());
+  for (PendingChanges::const_iterator iter = pending_.begin(); 
+       iter != pending_.end(); 
+       ++iter) {
+    ordered.push_back(&iter->second);
+  }
+
+  std::sort(ordered.begin(), ordered.end(), 
+    [](const PendingChange* first, const PendingChange* second) {
+      return first->sequence < second->sequence;
+    });
+
+  Changes changes;
+  changes.reserve(ordered.size());
+  for (size_t i = 0; i < ordered.size(); i++) {
+    changes.push_back(ordered[i]->change);
+  }
+
+  pending_.clear();
+  callback_(true, changes);
+}
\ No newline at end of file
@@ -0,0 +1,114 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef UTILS_DIRECTORY_WATCHER_H_
+#define UTILS_DIRECTORY_WATCHER_H_
+
+#include <map>
+#include <string>
+#include <vector>
+#include <functional>
+#include "Glob.h"
+#include "Thread.h"
+
+#ifdef _WIN32
+#include "ScopedHandle.h"
+#endif
+
+namespace utils {
+
+// Watches a directory (tree) for changes with ReadDirectoryChangesW (inotify
+// on other platforms - see posix/DirectoryWatcherPosix.cpp). Bursts
+// of changes are coalesced per path (e.g. added + modified = added, 
+// added + removed = nothing) and delivered as a single change set
+// |debounce_ms| after the first change of the set.
+class DirectoryWatcher {
+public:
+  enum ChangeType {
+    CHANGE_ADDED,
+    CHANGE_REMOVED,
+    CHANGE_MODIFIED,
+    CHANGE_RENAMED,
+    // changes were lost (the system buffer overflowed) - rescan
+    CHANGE_OVERFLOW
+  };
+
+  struct Change {
+    ChangeType type;
+    std::string path; // UTF8, relative to the directory ('/' separated)
+    std::string old_path; // CHANGE_RENAMED only
+  };
+  typedef std::vector<Change> Changes;
+
+  // called from the watcher thread - |status| is false (and |changes| is 
+  // empty) when the watch failed and stopped, e.g. the directory was removed
+  typedef std::function<void(bool status, const Changes& changes)> 
+    ChangesCallback;
+
+  DirectoryWatcher();
+  virtual ~DirectoryWatcher();
+
+public:
+  // |filters| are globs (see |GlobSet|) - empty means everything
+  bool Start(
+    const std::wstring& directory, 
+    bool recursive,
+    const std::vector<std::string>& filters,
+    unsigned int debounce_ms,
+    ChangesCallback callback);
+  void Stop();
+
+private:
+  struct PendingChange {
+    Change change;
+    unsigned int sequence; // keeps the changes in the order they happened
+  };
+  typedef std::map<std::string, PendingChange> PendingChanges;
+
+  void WatchLoop();
+#ifdef _WIN32
+  void ParseNotifications(const void* buffer);
+#else
+  // returns false when the watched directory itself went away
+  bool ParseNotifications(const char* buffer, size_t length);
+  bool AddWatches(const std::string& path, bool report_existing);
+  void CloseWatches();
+#endif
+  void AddChange(ChangeType type, const std::string& path);
+  void AddRename(const std::string& old_path, const std::string& new_path);
+  void Flush();
+
+private:
+  bool recursive_;
+  GlobSet filters_;
+  bool has_filters_;
+  unsigned int debounce_ms_;
+  ChangesCallback callback_;
+
+#ifdef _WIN32
+  FileScopedHandle directory_;
+  EventScopedHandle io_event_;
+  EventScopedHandle stop_event_;
+#else
+  std::string directory_; // UTF8
+  int inotify_;
+  int stop_pipe_[2];
+
+  // watch descriptor -> directory path (relative, like |Change::path|)
+  std::map<int, std::string> watches_;
+  unsigned int rename_cookie_;
+#endif
+  Thread thread_;
+
+  PendingChanges pending_;
+  unsigned int next_sequence_;
+  DWORD window_start_;
+
+  // FILE_ACTION_RENAMED_OLD_NAME waiting for its new name
+  std::string rename_old_path_;
+};
+
+}; // namespace utils
+
+#endif // UTILS_DIRECTORY_WATCHER_H_
\ No newline at end of file
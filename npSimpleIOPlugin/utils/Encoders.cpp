@@ -4,37 +4,536 @@
 */
 #include "Encoders.h"
 
-#include <windows.h>
+#include <string.h>
+#include <sstream>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#define ENCODERS_USE_SSE2
+#include <emmintrin.h>
+#endif
 
 using namespace utils;
 
+namespace {
+
+const unsigned int kReplacementChar = 0xFFFD;
+
+// number of wchar_t handled by a single SSE2 register
+const size_t kWideBlock = 16 / sizeof(wchar_t);
+
+// see |Encoders::set_sse2_enabled|
+#ifdef ENCODERS_USE_SSE2
+bool sse2_enabled = true;
+#else
+bool sse2_enabled = false;
+#endif
+
+inline bool IsHighSurrogate(unsigned int unit) {
+  return ((unit >= 0xD800) && (unit <= 0xDBFF));
+}
+
+inline bool IsLowSurrogate(unsigned int unit) {
+  return ((unit >= 0xDC00) && (unit <= 0xDFFF));
+}
+
+// Reads a single code point starting at |src[i]| and advances |i| - |src|
+// is wchar_t or UTF-16 units (uint16_t).
+// Returns -1 (and doesn't advance) if a high surrogate is the last unit and
+// |final| is false.
+template <typename TUnit>
+inline int ReadWide(const TUnit* src, size_t len, size_t& i, bool final) {
+  unsigned int code_point = (unsigned int)src[i];
+  if (sizeof(TUnit) == 2) {
+    code_point &= 0xFFFF;
+  }
+
+  if (IsHighSurrogate(code_point)) {
+    if (i + 1 >= len) {
+      if (!final) {
+        return -1;
+      }
+      code_point = kReplacementChar;
+    } else {
+      unsigned int low = (unsigned int)src[i + 1];
+      if (sizeof(TUnit) == 2) {
+        low &= 0xFFFF;
+      }
+
+      if (IsLowSurrogate(low)) {
+        code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+        i++;
+      } else {
+        code_point = kReplacementChar;
+      }
+    }
+  } else if (IsLowSurrogate(code_point) || (code_point > 0x10FFFF)) {
+    code_point = kReplacementChar;
+  }
+
+  i++;
+  return (int)code_point;
+}
+
+inline size_t Utf8Size(unsigned int code_point) {
+  if (code_point < 0x80) {
+    return 1;
+  }
+  if (code_point < 0x800) {
+    return 2;
+  }
+  if (code_point < 0x10000) {
+    return 3;
+  }
+  return 4;
+}
+
+inline char* WriteUtf8(unsigned int code_point, char* dst) {
+  if (code_point < 0x80) {
+    *dst++ = (char)code_point;
+  } else if (code_point < 0x800) {
+    *dst++ = (char)(0xC0 | (code_point >> 6));
+    *dst++ = (char)(0x80 | (code_point & 0x3F));
+  } else if (code_point < 0x10000) {
+    *dst++ = (char)(0xE0 | (code_point >> 12));
+    *dst++ = (char)(0x80 | ((code_point >> 6) & 0x3F));
+    *dst++ = (char)(0x80 | (code_point & 0x3F));
+  } else {
+    *dst++ = (char)(0xF0 | (code_point >> 18));
+    *dst++ = (char)(0x80 | ((code_point >> 12) & 0x3F));
+    *dst++ = (char)(0x80 | ((code_point >> 6) & 0x3F));
+    *dst++ = (char)(0x80 | (code_point & 0x3F));
+  }
+  return dst;
+}
+
+// Reads a single (validated) code point starting at |src[i]| and advances
+// |i|. Invalid sequences return U+FFFD and skip the maximal invalid subpart
+// (at least one byte) - the same rule the browsers use.
+inline unsigned int ReadUtf8(const unsigned char* src, size_t len, size_t& i) {
+  unsigned char lead = src[i++];
+  if (lead < 0x80) {
+    return lead;
+  }
+
+  size_t needed = 0;
+  unsigned int code_point = 0;
+  unsigned char min_next = 0x80;
+  unsigned char max_next = 0xBF;
+
+  if ((lead >= 0xC2) && (lead <= 0xDF)) {
+    needed = 1;
+    code_point = lead & 0x1F;
+  } else if ((lead >= 0xE0) && (lead <= 0xEF)) {
+    needed = 2;
+    code_point = lead & 0x0F;
+    if (0xE0 == lead) {
+      min_next = 0xA0; // overlong
+    } else if (0xED == lead) {
+      max_next = 0x9F; // surrogates
+    }
+  } else if ((lead >= 0xF0) && (lead <= 0xF4)) {
+    needed = 3;
+    code_point = lead & 0x07;
+    if (0xF0 == lead) {
+      min_next = 0x90; // overlong
+    } else if (0xF4 == lead) {
+      max_next = 0x8F; // > U+10FFFF
+    }
+  } else {
+    return kReplacementChar;
+  }
+
+  for (size_t n = 0; n < needed; n++) {
+    if (i >= len) {
+      return kReplacementChar;
+    }
+
+    unsigned char next = src[i];
+    if ((next < min_next) || (next > max_next)) {
+      return kReplacementChar;
+    }
+
+    code_point = (code_point << 6) | (next & 0x3F);
+    min_next = 0x80;
+    max_next = 0xBF;
+    i++;
+  }
+
+  return code_point;
+}
+
+inline size_t WideSize(unsigned int code_point) {
+  return ((sizeof(wchar_t) == 2) && (code_point >= 0x10000)) ? 2 : 1;
+}
+
+inline wchar_t* WriteWide(unsigned int code_point, wchar_t* dst) {
+  if ((sizeof(wchar_t) == 2) && (code_point >= 0x10000)) {
+    code_point -= 0x10000;
+    *dst++ = (wchar_t)(0xD800 + (code_point >> 10));
+    *dst++ = (wchar_t)(0xDC00 + (code_point & 0x3FF));
+  } else {
+    *dst++ = (wchar_t)code_point;
+  }
+  return dst;
+}
+
+#ifdef ENCODERS_USE_SSE2
+
+// Loads |kWideBlock| characters as 16 bit units - returns false if any of
+// them doesn't fit (4 byte wchar_t only)
+inline bool LoadWideBlock(const wchar_t* src, __m128i& ref_units) {
+  if (sizeof(wchar_t) == 2) {
+    ref_units = _mm_loadu_si128((const __m128i*)src);
+    return true;
+  }
+
+  __m128i chars = _mm_loadu_si128((const __m128i*)src);
+  __m128i high = _mm_srli_epi32(chars, 16);
+  if (0xFFFF != _mm_movemask_epi8(
+        _mm_cmpeq_epi32(high, _mm_setzero_si128()))) {
+    return false;
+  }
+
+  // sign-safe narrowing - all values are < 0x10000 at this point
+  chars = _mm_sub_epi32(chars, _mm_set1_epi32(0x8000));
+  chars = _mm_packs_epi32(chars, chars);
+  ref_units = _mm_add_epi16(chars, _mm_set1_epi16((short)0x8000));
+  return true;
+}
+
+inline bool LoadWideBlock(const uint16_t* src, __m128i& ref_units) {
+  ref_units = _mm_loadu_si128((const __m128i*)src);
+  return true;
+}
+
+#endif // ENCODERS_USE_SSE2
+
+// Shared by the buffer and streaming conversions (of wchar_t or of UTF-16
+// units). Stops before a trailing high surrogate when |final| is false and
+// reports the consumed units.
+template <typename TUnit>
+size_t EncodeUtf8(
+  const TUnit* src,
+  size_t len,
+  char* dst,
+  bool final,
+  size_t& ref_consumed) {
+
+  char* out = dst;
+  size_t i = 0;
+#ifdef ENCODERS_USE_SSE2
+  // units handled by a single SSE2 register
+  const size_t kBlock = 16 / sizeof(TUnit);
+  const bool sse2 = sse2_enabled;
+#endif
+
+  while (i < len) {
+#ifdef ENCODERS_USE_SSE2
+    // ASCII fast path
+    if (sse2 && (i + kBlock <= len)) {
+      __m128i units;
+      if (LoadWideBlock(&src[i], units)) {
+        __m128i non_ascii =
+          _mm_and_si128(units, _mm_set1_epi16((short)0xFF80));
+        if (0xFFFF == _mm_movemask_epi8(
+              _mm_cmpeq_epi16(non_ascii, _mm_setzero_si128()))) {
+          __m128i bytes = _mm_packus_epi16(units, units);
+          if (8 == kBlock) {
+            _mm_storel_epi64((__m128i*)out, bytes);
+          } else {
+            int packed = _mm_cvtsi128_si32(bytes);
+            memcpy(out, &packed, sizeof(packed));
+          }
+          out += kBlock;
+          i += kBlock;
+          continue;
+        }
+      }
+
+      // convert the rest of the block one character at a time
+      size_t block_end = i + kBlock;
+      while (i < block_end) {
+        int code_point = ReadWide(src, len, i, final);
+        if (code_point < 0) {
+          ref_consumed = i;
+          return out - dst;
+        }
+        out = WriteUtf8((unsigned int)code_point, out);
+      }
+      continue;
+    }
+#endif // ENCODERS_USE_SSE2
+
+    int code_point = ReadWide(src, len, i, final);
+    if (code_point < 0) {
+      break;
+    }
+    out = WriteUtf8((unsigned int)code_point, out);
+  }
+
+  ref_consumed = i;
+  return out - dst;
+}
+
+}; // namespace
+
 // Convert a wide Unicode string to an UTF8 string
 // static
 std::string Encoders::utf8_encode(const std::wstring &wstr) {
-  int size_needed = WideCharToMultiByte(
-    CP_UTF8, 0, &wstr[0], (int)wstr.size(), nullptr, 0, nullptr, nullptr);
-
-  std::string strTo( size_needed, 0 );
-  WideCharToMultiByte(
-    CP_UTF8, 
-    0, 
-    &wstr[0], 
-    (int)wstr.size(), 
-    &strTo[0], 
-    size_needed, 
-    nullptr, 
-    nullptr);
-  return strTo;
+  std::string str_to(utf8_length(wstr.c_str(), wstr.size()), 0);
+  if (!str_to.empty()) {
+    utf8_encode(wstr.c_str(), wstr.size(), &str_to[0]);
+  }
+  return str_to;
 }
 
 // Convert an UTF8 string to a wide Unicode String
 // static
 std::wstring Encoders::utf8_decode(const std::string &str) {
-  int size_needed = MultiByteToWideChar(
-    CP_UTF8, 0, &str[0], (int)str.size(), nullptr, 0);
+  return utf8_decode(str.c_str(), str.size());
+}
+
+// static
+std::wstring Encoders::utf8_decode(const char* str, size_t len) {
+  std::wstring wstr_to(wide_length(str, len), 0);
+  if (!wstr_to.empty()) {
+    utf8_decode(str, len, &wstr_to[0]);
+  }
+  return wstr_to;
+}
+
+// static
+size_t Encoders::utf8_length(const wchar_t* src, size_t len) {
+  size_t length = 0;
+  size_t i = 0;
 
-  std::wstring wstrTo( size_needed, 0 );
-  MultiByteToWideChar(
-    CP_UTF8, 0, &str[0], (int)str.size(), &wstrTo[0], size_needed);
-  return wstrTo;
+#ifdef ENCODERS_USE_SSE2
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i ones = _mm_set1_epi16(1);
+  const __m128i three = _mm_set1_epi16(3);
+
+  while (sse2_enabled && (i + kWideBlock <= len)) {
+    __m128i units;
+    if (LoadWideBlock(&src[i], units)) {
+      __m128i high = _mm_and_si128(units, _mm_set1_epi16((short)0xF800));
+      __m128i surrogates =
+        _mm_cmpeq_epi16(high, _mm_set1_epi16((short)0xD800));
+
+      if (0 == _mm_movemask_epi8(surrogates)) {
+        // 3 bytes per character, minus one for each threshold not reached
+        __m128i single = _mm_cmpeq_epi16(
+          _mm_and_si128(units, _mm_set1_epi16((short)0xFF80)),
+          zero);
+        __m128i sizes = _mm_add_epi16(
+          three,
+          _mm_add_epi16(single, _mm_cmpeq_epi16(high, zero)));
+
+        // only the first |kWideBlock| lanes are valid for 4 byte wchar_t
+        if (4 == kWideBlock) {
+          sizes = _mm_unpacklo_epi64(sizes, zero);
+        }
+
+        __m128i sums = _mm_madd_epi16(sizes, ones);
+        sums = _mm_add_epi32(sums, _mm_srli_si128(sums, 8));
+        sums = _mm_add_epi32(sums, _mm_srli_si128(sums, 4));
+        length += (size_t)_mm_cvtsi128_si32(sums);
+        i += kWideBlock;
+        continue;
+      }
+    }
+
+    size_t block_end = i + kWideBlock;
+    while (i < block_end) {
+      length += Utf8Size((unsigned int)ReadWide(src, len, i, true));
+    }
+  }
+#endif // ENCODERS_USE_SSE2
+
+  while (i < len) {
+    length += Utf8Size((unsigned int)ReadWide(src, len, i, true));
+  }
+
+  return length;
+}
+
+// static
+size_t Encoders::wide_length(const char* src, size_t len) {
+  const unsigned char* bytes = (const unsigned char*)src;
+  size_t length = 0;
+  size_t i = 0;
+#ifdef ENCODERS_USE_SSE2
+  const bool sse2 = sse2_enabled;
+#endif
+
+  while (i < len) {
+#ifdef ENCODERS_USE_SSE2
+    // ASCII fast path - one character per byte
+    if (sse2 && (i + 16 <= len)) {
+      __m128i block = _mm_loadu_si128((const __m128i*)&bytes[i]);
+      if (0 == _mm_movemask_epi8(block)) {
+        length += 16;
+        i += 16;
+        continue;
+      }
+    }
+#endif // ENCODERS_USE_SSE2
+
+    length += WideSize(ReadUtf8(bytes, len, i));
+  }
+
+  return length;
+}
+
+// static
+size_t Encoders::utf8_encode(const wchar_t* src, size_t len, char* dst) {
+  size_t consumed = 0;
+  return EncodeUtf8(src, len, dst, true, consumed);
+}
+
+// static
+size_t Encoders::utf8_decode(const char* src, size_t len, wchar_t* dst) {
+  const unsigned char* bytes = (const unsigned char*)src;
+  wchar_t* out = dst;
+  size_t i = 0;
+#ifdef ENCODERS_USE_SSE2
+  const bool sse2 = sse2_enabled;
+#endif
+
+  while (i < len) {
+#ifdef ENCODERS_USE_SSE2
+    // ASCII fast path - widen 16 bytes at a time
+    if (sse2 && (i + 16 <= len)) {
+      __m128i block = _mm_loadu_si128((const __m128i*)&bytes[i]);
+      if (0 == _mm_movemask_epi8(block)) {
+        const __m128i zero = _mm_setzero_si128();
+        __m128i low = _mm_unpacklo_epi8(block, zero);
+        __m128i high = _mm_unpackhi_epi8(block, zero);
+
+        if (sizeof(wchar_t) == 2) {
+          _mm_storeu_si128((__m128i*)out, low);
+          _mm_storeu_si128((__m128i*)(out + 8), high);
+        } else {
+          _mm_storeu_si128((__m128i*)out, _mm_unpacklo_epi16(low, zero));
+          _mm_storeu_si128((__m128i*)(out + 4), _mm_unpackhi_epi16(low, zero));
+          _mm_storeu_si128((__m128i*)(out + 8), _mm_unpacklo_epi16(high, zero));
+          _mm_storeu_si128(
+            (__m128i*)(out + 12), _mm_unpackhi_epi16(high, zero));
+        }
+
+        out += 16;
+        i += 16;
+        continue;
+      }
+    }
+#endif // ENCODERS_USE_SSE2
+
+    out = WriteWide(ReadUtf8(bytes, len, i), out);
+  }
+
+  return out - dst;
+}
+
+// static
+size_t Encoders::utf16_append_utf8(
+  const wchar_t* src,
+  size_t len,
+  std::string& ref_output) {
+
+  if (0 == len) {
+    return 0;
+  }
+
+  // convert straight into the (over-allocated) tail of the output
+  size_t offset = ref_output.size();
+  ref_output.resize(offset + utf8_max_length(len));
+
+  size_t consumed = 0;
+  size_t written = EncodeUtf8(src, len, &ref_output[offset], false, consumed);
+  ref_output.resize(offset + written);
+  return consumed;
+}
+
+// static
+size_t Encoders::utf16_append_utf8(
+  const uint16_t* src,
+  size_t len,
+  std::string& ref_output,
+  bool final) {
+
+  if (0 == len) {
+    return 0;
+  }
+
+  // 3 bytes per unit at most (a surrogate pair is 4 bytes for 2 units)
+  size_t offset = ref_output.size();
+  ref_output.resize(offset + len * 3);
+
+  size_t consumed = 0;
+  size_t written = EncodeUtf8(src, len, &ref_output[offset], final, consumed);
+  ref_output.resize(offset + written);
+  return consumed;
+}
+
+// static
+void Encoders::json_append_string(
+  const char* str,
+  size_t len,
+  std::string& ref_output) {
+
+  static const char kHexDigits[] = "0123456789abcdef";
+
+  ref_output += '"';
+
+  // copy runs of characters that don't need escaping in one go
+  size_t run_start = 0;
+  for (size_t i = 0; i < len; i++) {
+    unsigned char c = (unsigned char)str[i];
+    if ((c >= 0x20) && (c != '"') && (c != '\\')) {
+      continue;
+    }
+
+    ref_output.append(str + run_start, i - run_start);
+    run_start = i + 1;
+
+    switch (c) {
+    case '"':  ref_output += "\\\""; break;
+    case '\\': ref_output += "\\\\"; break;
+    case '\n': ref_output += "\\n"; break;
+    case '\r': ref_output += "\\r"; break;
+    case '\t': ref_output += "\\t"; break;
+    default:
+      ref_output += "\\u00";
+      ref_output += kHexDigits[c >> 4];
+      ref_output += kHexDigits[c & 0xF];
+      break;
+    }
+  }
+
+  ref_output.append(str + run_start, len - run_start);
+  ref_output += '"';
 }
+
+
+// static
+bool Encoders::set_sse2_enabled(bool enabled) {
+  bool previous = sse2_enabled;
+#ifdef ENCODERS_USE_SSE2
+  sse2_enabled = enabled;
+#else
+  (void)enabled;
+#endif
+  return previous;
+}
+
+// static
+std::string Encoders::byte_list_encode(const std::string& data) {
+  std::ostringstream str;
+  if (data.size() > 0) {
+    str << (int)data[0];
+  }
+  for (size_t i = 1; i < data.size(); ++i) {
+    str << "," << (int)data[i];
+  }
+
+  return str.str();
+}
\ No newline at end of file
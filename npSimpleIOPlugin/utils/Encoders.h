@@ -5,10 +5,16 @@
 #ifndef UTILS_ENCODERS_H_
 #define UTILS_ENCODERS_H_
 
+#include <stdint.h>
 #include <string>
 
 namespace utils {
 
+// UTF8 <-> UTF-16 conversions (UTF-32 where wchar_t is 4 bytes wide).
+//
+// All conversions are single pass, validating (invalid input becomes U+FFFD)
+// and use SSE2 for runs of ASCII text, with a scalar fallback for everything
+// else - they don't depend on any OS API.
 class Encoders {
 public:
   // Convert a wide Unicode string to an UTF8 string
@@ -16,6 +22,59 @@ public:
 
   // Convert an UTF8 string to a wide Unicode String
   static std::wstring utf8_decode(const std::string& str);
+  static std::wstring utf8_decode(const char* str, size_t len);
+
+  // Worst case sizes of a conversion output - use when converting into a
+  // caller-provided buffer without calculating the exact size first
+  static size_t utf8_max_length(size_t wide_len) {
+    return wide_len * ((sizeof(wchar_t) == 2) ? 3 : 4);
+  }
+  static size_t wide_max_length(size_t utf8_len) {
+    return utf8_len;
+  }
+
+  // Exact size of a conversion output (a lot cheaper than the conversion)
+  static size_t utf8_length(const wchar_t* src, size_t len);
+  static size_t wide_length(const char* src, size_t len);
+
+  // Convert into |dst| which must be able to hold the max (or exact) length
+  // of the output. Returns the number of bytes/characters written.
+  static size_t utf8_encode(const wchar_t* src, size_t len, char* dst);
+  static size_t utf8_decode(const char* src, size_t len, wchar_t* dst);
+
+  // Convert |len| UTF-16 code units to UTF8 and append them to |ref_output|.
+  // Meant for streaming - a high surrogate at the very end of |src| is left
+  // unconverted so that it can be completed by the next chunk. Returns the 
+  // number of code units consumed. Unpaired surrogates become U+FFFD.
+  static size_t utf16_append_utf8(
+    const wchar_t* src, 
+    size_t len, 
+    std::string& ref_output);
+
+  // The same for UTF-16 code units whatever the size of wchar_t (e.g. the
+  // contents of a UTF-16LE file on POSIX, where wchar_t is 4 bytes wide).
+  // |final| converts a high surrogate at the very end (to U+FFFD) instead 
+  // of leaving it for the next chunk.
+  static size_t utf16_append_utf8(
+    const uint16_t* src, 
+    size_t len, 
+    std::string& ref_output,
+    bool final = false);
+
+  // Append |str| to |ref_output| as a quoted and escaped JSON string
+  static void json_append_string(
+    const char* str, 
+    size_t len, 
+    std::string& ref_output);
+
+  // getBinaryFile's format - the (signed) byte values separated by commas
+  static std::string byte_list_encode(const std::string& data);
+
+  // Turns the SSE2 fast paths off (or back on) so that the tests and the
+  // benchmarks can compare them against the scalar path - not thread safe,
+  // call it while no conversion runs. Returns the previous setting (always
+  // false in a build without SSE2).
+  static bool set_sse2_enabled(bool enabled);
 
 }; // class Encoders
 
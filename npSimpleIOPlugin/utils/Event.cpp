@@ -2,6 +2,9 @@
 Simple IO Plugin
 Copyright (c) 2015 Overwolf Ltd.
 */
+// see posix/EventPosix.cpp for other platforms
+#ifdef _WIN32
+
 #include "event.h"
 
 using namespace utils;
@@ -101,4 +104,6 @@ bool Event::Reset() {
   }
 
   return (TRUE == ResetEvent(event_.Get()));
-}
\ No newline at end of file
+}
+
+#endif // _WIN32
\ No newline at end of file
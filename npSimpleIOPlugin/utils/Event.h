@@ -5,7 +5,13 @@ Copyright (c) 2015 Overwolf Ltd.
 #ifndef UTILS_EVENT_H_
 #define UTILS_EVENT_H_
 
+#include "Platform.h"
+
+#ifdef _WIN32
 #include "ScopedHandle.h"
+#else
+#include <pthread.h>
+#endif
 
 namespace utils {
 
@@ -30,10 +36,21 @@ public:
   bool Reset();
 
 private:
+#ifdef _WIN32
   EventScopedHandle event_;
 
   // used to quit the Wait function when |Destroy| is called
   EventScopedHandle exit_event_;
+#else
+  pthread_mutex_t mutex_;
+  pthread_cond_t condition_;
+  bool created_;
+  bool manual_reset_;
+  bool signaled_;
+
+  // bumped by |Destroy| to quit the Wait function
+  unsigned int generation_;
+#endif
 };
 
 }; // namespace utils;
@@ -4,12 +4,75 @@
 */
 #include "File.h"
 #include "Encoders.h"
+#include "MappedFile.h"
+#include "TextScan.h"
+#include "Trace.h"
 
-#include <windows.h>
+#ifdef _WIN32
+#include "ScopedHandle.h"
 #include <shlwapi.h>
+#endif
 
 using namespace utils;
 
+// see posix/FilePosix.cpp for other platforms
+#ifdef _WIN32
+namespace {
+
+// reads |len| bytes (or up to the end of the file) in chunks of 
+// |File::kReadChunkSize| - false on errors and once |cancel| is set
+bool ReadChunks(
+  HANDLE file, 
+  char* buffer, 
+  DWORD len, 
+  DWORD& ref_read, 
+  const CancellationToken* cancel) {
+
+  ref_read = 0;
+  while (ref_read < len) {
+    if (CancellationToken::IsCancelled(cancel)) {
+      return false;
+    }
+
+    DWORD chunk_len = min(len - ref_read, (DWORD)File::kReadChunkSize);
+    DWORD chunk_read = 0;
+    if (FALSE == ReadFile(
+      file, buffer + ref_read, chunk_len, &chunk_read, nullptr)) {
+      return false;
+    }
+
+    if (0 == chunk_read) {
+      break;
+    }
+
+    ref_read += chunk_read;
+  }
+
+  return true;
+}
+
+// CopyFileEx progress routine (called for every chunk copied) - |data| is 
+// the CancellationToken of the copy, if any
+DWORD CALLBACK CopyProgressRoutine(
+  LARGE_INTEGER total_size,
+  LARGE_INTEGER total_transferred,
+  LARGE_INTEGER stream_size,
+  LARGE_INTEGER stream_transferred,
+  DWORD stream_number,
+  DWORD callback_reason,
+  HANDLE source_file,
+  HANDLE destination_file,
+  LPVOID data) {
+  
+  if (CancellationToken::IsCancelled((const CancellationToken*)data)) {
+    return PROGRESS_CANCEL;
+  }
+
+  return PROGRESS_CONTINUE;
+}
+
+}; // namespace
+
 // static
 std::wstring File::GetSpecialFolderWide(int csidl) {
   WCHAR szPath[MAX_PATH] = {0};
@@ -20,12 +83,14 @@ std::wstring File::GetSpecialFolderWide(int csidl) {
 
   return szPath;
 }
+#endif // _WIN32
 
 // static 
 std::string File::GetSpecialFolderUtf8(int csidl) {
   return Encoders::utf8_encode(File::GetSpecialFolderWide(csidl));
 }
 
+#ifdef _WIN32
 // static 
 bool File::DoesFileExist(const std::wstring& filename) {
   DWORD dwAttributes = GetFileAttributesW(filename.c_str());
@@ -48,68 +113,262 @@ bool File::IsDirectory(const std::wstring& directory) {
 bool File::GetTextFile(
   const std::wstring& filename,
   std::string& ref_output,
-  int limit) {
+  int limit,
+  const CancellationToken* cancel) {
   
-  DWORD dwSize = MAX_PATH;
-  WCHAR path[MAX_PATH] = {NULL};
-  if (0 >= GetTempPathW(dwSize, path)) {
+  std::wstring temp_file;
+  HANDLE hFile = OpenTempCopy(filename, temp_file, cancel);
+  if (INVALID_HANDLE_VALUE == hFile) {
     return false;
   }
 
-  WCHAR temp_file[MAX_PATH] = {NULL};
-  if (0 == GetTempFileNameW(path, L"IO_", 0, temp_file)) {
-    return false;
+  ref_output.clear();
+
+  bool status = false;
+  DWORD dwSize = GetFileSize(hFile, NULL);
+
+  if (dwSize > 0) {
+    if ((limit > 0) && ((DWORD)limit < dwSize)) {
+      dwSize = limit;
+    }
+
+    // read straight into the output
+    DWORD dwBytesRead = 0;
+    ref_output.resize(dwSize);
+    status = ReadChunks(hFile, &ref_output[0], dwSize, dwBytesRead, cancel);
+    ref_output.resize(status ? dwBytesRead : 0);
   }
 
-  if (FALSE == CopyFileW(filename.c_str(), temp_file, FALSE)) {
-    return false;
+  if (!status) {
+    std::string().swap(ref_output);
   }
 
-  ref_output.clear();
- 
-  HANDLE hFile = CreateFileW(
-    temp_file,
-    GENERIC_READ,          // open for reading
-    FILE_SHARE_READ,       // share for reading
-    NULL,                  // default security
-    OPEN_EXISTING,         // existing file only
-    FILE_ATTRIBUTE_NORMAL, // normal file
-    NULL);                 // no attr. template
+  CloseHandle(hFile);
+  DeleteFileW(temp_file.c_str());
+
+  return status;
+}
+
+// static
+bool File::GetTextFileUtf8(
+  const std::wstring& filename,
+  std::string& ref_output,
+  bool default_utf16,
+  const CancellationToken* cancel) {
 
+  // UTF-16 files are read in chunks of this size and transcoded on the fly
+  const DWORD kChunkSize = 64 * 1024;
+
+  // read in place (no temp copy) - every byte is read once, into the output
+  // or the transcoding chunk
+  HANDLE hFile = OpenShared(filename);
   if (INVALID_HANDLE_VALUE == hFile) {
     return false;
   }
 
-  bool status = false;
-  dwSize = GetFileSize(hFile, NULL);
+  ref_output.clear();
 
-  if (dwSize > 0) {
-    if (limit > 0) {
-      dwSize = limit;
+  DWORD dwSize = GetFileSize(hFile, NULL);
+  DWORD dwBytesRead = 0;
+  bool status = true;
+
+  // detect the encoding
+  unsigned char bom[3] = {0};
+  DWORD bom_len = 0;
+  bool utf16 = default_utf16;
+
+  if (TRUE == ReadFile(hFile, bom, min(dwSize, (DWORD)sizeof(bom)), &dwBytesRead, nullptr)) {
+    if ((dwBytesRead >= 2) && (0xFF == bom[0]) && (0xFE == bom[1])) {
+      utf16 = true;
+      bom_len = 2;
+    } else if ((dwBytesRead >= 3) && 
+               (0xEF == bom[0]) && (0xBB == bom[1]) && (0xBF == bom[2])) {
+      utf16 = false;
+      bom_len = 3;
     }
-    char* buffer = new char[dwSize];
+  } else {
+    status = false;
+  }
 
-    DWORD dwBytesReadDummy = 0; // otherwise we get a crash in win7 (a.k.a. RTFM)
+  if (status) {
+    SetFilePointer(hFile, bom_len, nullptr, FILE_BEGIN);
+    DWORD content_size = dwSize - bom_len;
 
-    status = (TRUE == ReadFile(
-      hFile, 
-      (void*)buffer, 
-      dwSize, 
-      &dwBytesReadDummy, 
-      nullptr));
+    if (!utf16) {
+      // read straight into the output
+      TraceScope trace("read", "io");
+      ref_output.resize(content_size);
+      if (content_size > 0) {
+        status = ReadChunks(
+          hFile, 
+          &ref_output[0], 
+          content_size, 
+          dwBytesRead, 
+          cancel);
+        ref_output.resize(status ? dwBytesRead : 0);
+      }
+    } else {
+      // +2 for the leftover of the previous chunk (a high surrogate and an
+      // odd byte at most)
+      const DWORD kChunkUnits = kChunkSize / sizeof(uint16_t) + 2;
+
+      // most of what we read is ASCII - one output byte per character, and
+      // the room |utf16_append_utf8| needs to convert the last chunk
+      TraceScope trace("read utf16", "transcode");
+      ref_output.reserve(content_size / sizeof(uint16_t) + 3 * kChunkUnits);
+
+      uint16_t chunk_units[kChunkUnits];
+      char* chunk = (char*)chunk_units;
+      DWORD leftover = 0;
+      DWORD remaining = content_size; // the owner may still be appending
+
+      while (status && (remaining > 0)) {
+        if (CancellationToken::IsCancelled(cancel)) {
+          status = false;
+          break;
+        }
 
-    if (status) {
-      ref_output.insert(0, buffer, dwSize);
+        status = (TRUE == ReadFile(
+          hFile, 
+          chunk + leftover, 
+          min(remaining, kChunkSize), 
+          &dwBytesRead, 
+          nullptr));
+
+        if (!status || (0 == dwBytesRead)) {
+          break;
+        }
+        remaining -= dwBytesRead;
+
+        DWORD available = leftover + dwBytesRead;
+        size_t consumed = utils::Encoders::utf16_append_utf8(
+          chunk_units,
+          available / sizeof(uint16_t),
+          ref_output);
+
+        // a split surrogate pair and/or an odd byte
+        leftover = available - (DWORD)(consumed * sizeof(uint16_t));
+        memmove(chunk, chunk + (available - leftover), leftover);
+      }
+
+      // a dangling high surrogate at the end of the file
+      if (status && (leftover >= sizeof(uint16_t))) {
+        utils::Encoders::utf16_append_utf8(chunk_units, 1, ref_output, true);
+      }
     }
+  }
 
-    delete[] buffer;
+  if (!status) {
+    std::string().swap(ref_output);
   }
 
   CloseHandle(hFile);
-
   return status;
 }
+#endif // _WIN32
+
+// static
+bool File::GetLastLines(
+  const std::wstring& filename,
+  size_t count,
+  std::vector<std::string>& ref_lines) {
+
+  const size_t kBlockSize = 256 * 1024;
+
+  ref_lines.clear();
+
+  MappedFile file;
+  if (!file.Open(filename)) {
+    return false;
+  }
+
+  if ((0 == count) || (0 == file.size())) {
+    return true;
+  }
 
+  // walk back block by block until we've passed |count| new lines - the
+  // new line that ends the file doesn't start another line
+  std::vector<std::string> blocks; // last block first
+  unsigned __int64 position = file.size();
+  size_t found = 0;
+  bool reached_start = true;
+
+  while (position > 0) {
+    size_t block_len = (position > kBlockSize) ? 
+      kBlockSize : 
+      (size_t)position;
+    position -= block_len;
+
+    const char* block = file.Map(position, block_len);
+    if (nullptr == block) {
+      return false;
+    }
+
+    const char* block_begin = block;
+    const char* search_end = block + block_len;
+    if ((position + block_len == file.size()) && 
+        ('\n' == *(search_end - 1))) {
+      search_end--;
+    }
+
+    const char* new_line;
+    while (nullptr != 
+           (new_line = TextScan::FindLastByte(block, search_end, '\n'))) {
+      if (++found == count) {
+        block_begin = new_line + 1;
+        reached_start = false;
+        break;
+      }
+
+      search_end = new_line;
+    }
+
+    blocks.push_back(std::string(block_begin, block + block_len));
+    if (!reached_start) {
+      break;
+    }
+  }
+
+  std::string text;
+  for (size_t i = blocks.size(); i > 0; i--) {
+    text += blocks[i - 1];
+  }
+
+  const char* begin = text.c_str();
+  const char* end = begin + text.size();
+
+  const unsigned char* bom = (const unsigned char*)begin;
+  if (reached_start && (text.size() >= 3) && 
+      (0xEF == bom[0]) && (0xBB == bom[1]) && (0xBF == bom[2])) {
+    begin += 3;
+  }
+
+  // |count| may well be "all" - only the lines found are reserved
+  ref_lines.reserve(found + 1);
+  while (begin < end) {
+    const char* new_line = TextScan::FindByte(begin, end, '\n');
+    const char* line_end = (nullptr == new_line) ? end : new_line;
+    const char* text_end = line_end;
+    if ((text_end > begin) && ('\r' == *(text_end - 1))) {
+      text_end--;
+    }
+
+    ref_lines.push_back(std::string(begin, text_end));
+    begin = line_end + 1;
+  }
+
+  return true;
+}
+
+// static
+__int64 File::FileTimeToJsTime(__int64 file_time) {
+  const __int64 kFileTimeToUnixEpoch = 116444736000000000LL;
+  const __int64 kFileTimeTicksPerMS = 10000;
+
+  return (file_time - kFileTimeToUnixEpoch) / kFileTimeTicksPerMS;
+}
+
+#ifdef _WIN32
 //static 
 bool File::GetFileTimes(
   const std::wstring& filename, 
@@ -123,6 +382,14 @@ bool File::GetFileTimes(
 bool File::WriteTextFile(
   const std::wstring& filename,
   const std::string& content) {
+  return WriteTextFile(filename, content.c_str(), content.size());
+}
+
+// static
+bool File::WriteTextFile(
+  const std::wstring& filename,
+  const char* content,
+  size_t size) {
 
   HANDLE hFile = CreateFileW(
     filename.c_str(),
@@ -141,8 +408,8 @@ bool File::WriteTextFile(
   bool status =
     (TRUE == WriteFile(
       hFile,
-      (void*)content.c_str(),
-      content.size(),
+      (void*)content,
+      (DWORD)size,
       &dwWrittenBytes,
       nullptr));
 
@@ -151,3 +418,172 @@ bool File::WriteTextFile(
 
   return status;
 }
+
+// static
+bool File::CreateDirectories(const std::wstring& directory) {
+  int result = SHCreateDirectoryExW(NULL, directory.c_str(), NULL);
+  return ((ERROR_SUCCESS == result) || (ERROR_ALREADY_EXISTS == result));
+}
+
+// static
+bool File::RenameFile(const std::wstring& from, const std::wstring& to) {
+  return (TRUE == MoveFileExW(
+    from.c_str(), 
+    to.c_str(), 
+    MOVEFILE_REPLACE_EXISTING));
+}
+
+// static
+bool File::ListDirectory(
+  const std::wstring& directory,
+  const std::wstring& pattern,
+  size_t page_size,
+  DirectoryPageCallback callback,
+  bool /*details*/) {
+  // (FindNextFile returns the details anyway)
+
+
+  if (0 == page_size) {
+    page_size = 1;
+  }
+
+  std::wstring search_path = directory;
+  if (!search_path.empty() &&
+      (L'\\' != search_path[search_path.size() - 1]) &&
+      (L'/' != search_path[search_path.size() - 1])) {
+    search_path += L'\\';
+  }
+  search_path += pattern.empty() ? L"*" : pattern;
+
+  // FindExInfoBasic skips the short (8.3) names and LARGE_FETCH asks for
+  // bigger batches from the file system - both matter for big directories
+  WIN32_FIND_DATAW find_data;
+  FindFileScopedHandle find_handle(FindFirstFileExW(
+    search_path.c_str(),
+    FindExInfoBasic,
+    &find_data,
+    FindExSearchNameMatch,
+    nullptr,
+    FIND_FIRST_EX_LARGE_FETCH));
+
+  DirectoryEntries page;
+
+  if (!find_handle) {
+    // a valid directory without matching entries is an empty listing
+    if ((ERROR_FILE_NOT_FOUND != GetLastError()) ||
+        !IsDirectory(directory)) {
+      return false;
+    }
+
+    callback(page, true);
+    return true;
+  }
+
+  page.reserve(page_size);
+
+  do {
+    const wchar_t* name = find_data.cFileName;
+    if ((0 == wcscmp(name, L".")) || (0 == wcscmp(name, L".."))) {
+      continue;
+    }
+
+    page.resize(page.size() + 1);
+    DirectoryEntry& entry = page.back();
+
+    size_t name_len = wcslen(name);
+    entry.name.resize(Encoders::utf8_length(name, name_len));
+    if (!entry.name.empty()) {
+      Encoders::utf8_encode(name, name_len, &entry.name[0]);
+    }
+
+    entry.is_directory = 
+      (0 != (find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY));
+    entry.is_link = 
+      (0 != (find_data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT));
+    entry.size = 
+      ((unsigned __int64)find_data.nFileSizeHigh << 32) | 
+      find_data.nFileSizeLow;
+    entry.creation_time = 
+      ((__int64)find_data.ftCreationTime.dwHighDateTime << 32) |
+      find_data.ftCreationTime.dwLowDateTime;
+    entry.last_write_time = 
+      ((__int64)find_data.ftLastWriteTime.dwHighDateTime << 32) |
+      find_data.ftLastWriteTime.dwLowDateTime;
+
+    if (page.size() >= page_size) {
+      if (!callback(page, false)) {
+        return true;
+      }
+      page.clear();
+    }
+  } while (FALSE != FindNextFileW(find_handle.Get(), &find_data));
+
+  callback(page, true);
+  return true;
+}
+
+// static
+HANDLE File::OpenShared(const std::wstring& filename) {
+  // share everything, so that we never lock the original file (which is
+  // usually still being written to by its owner)
+  return CreateFileW(
+    filename.c_str(),
+    GENERIC_READ,          // open for reading
+    FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+    NULL,                  // default security
+    OPEN_EXISTING,         // existing file only
+    FILE_FLAG_SEQUENTIAL_SCAN, // we read it once, front to back
+    NULL);                 // no attr. template
+}
+
+// static
+HANDLE File::OpenTempCopy(
+  const std::wstring& filename, 
+  std::wstring& ref_temp_file,
+  const CancellationToken* cancel) {
+
+  // we work on a copy so that we never lock the original file (which is
+  // usually still being written to by its owner)
+  DWORD dwSize = MAX_PATH;
+  WCHAR path[MAX_PATH] = {NULL};
+  if (0 >= GetTempPathW(dwSize, path)) {
+    return INVALID_HANDLE_VALUE;
+  }
+
+  WCHAR temp_file[MAX_PATH] = {NULL};
+  if (0 == GetTempFileNameW(path, L"IO_", 0, temp_file)) {
+    return INVALID_HANDLE_VALUE;
+  }
+
+  ref_temp_file = temp_file;
+
+  // (overwrites the empty file GetTempFileName created)
+  if (FALSE == CopyFileExW(
+    filename.c_str(), 
+    temp_file, 
+    CopyProgressRoutine, 
+    (LPVOID)cancel, 
+    nullptr, 
+    0)) {
+    DeleteFileW(temp_file);
+    return INVALID_HANDLE_VALUE;
+  }
+
+  HANDLE hFile = CreateFileW(
+    temp_file,
+    GENERIC_READ,          // open for reading
+    FILE_SHARE_READ,       // share for reading
+    NULL,                  // default security
+    OPEN_EXISTING,         // existing file only
+    FILE_FLAG_SEQUENTIAL_SCAN, // we read it once, front to back
+    NULL);                 // no attr. template
+
+  if (INVALID_HANDLE_VALUE == hFile) {
+    DeleteFileW(temp_file);
+  }
+
+  return hFile;
+}
+
+
+#endif // _WIN32
\ No newline at end of file
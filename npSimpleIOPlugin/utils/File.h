@@ -6,11 +6,64 @@
 #define UTILS_FILE_H_
 
 #include <string>
+#include <vector>
+#include <functional>
+#include "CancellationToken.h"
+#include "Platform.h"
+
+#ifdef _WIN32
 #include <shlobj.h>
+#else
+// the special folders we know (see File::GetSpecialFolderWide) - the rest 
+// are Windows folders that don't exist elsewhere
+#define CSIDL_DESKTOP 0x0000
+#define CSIDL_MYDOCUMENTS 0x0005
+#define CSIDL_FAVORITES 0x0006
+#define CSIDL_STARTMENU 0x000b
+#define CSIDL_MYMUSIC 0x000d
+#define CSIDL_MYVIDEO 0x000e
+#define CSIDL_FONTS 0x0014
+#define CSIDL_LOCAL_APPDATA 0x001c
+#define CSIDL_HISTORY 0x0022
+#define CSIDL_COMMON_APPDATA 0x0023
+#define CSIDL_WINDOWS 0x0024
+#define CSIDL_SYSTEM 0x0025
+#define CSIDL_PROGRAM_FILES 0x0026
+#define CSIDL_MYPICTURES 0x0027
+#define CSIDL_SYSTEMX86 0x0029
+#define CSIDL_PROGRAM_FILESX86 0x002a
+#define CSIDL_PROGRAM_FILES_COMMON 0x002b
+#define CSIDL_PROGRAM_FILES_COMMONX86 0x002c
+#define CSIDL_COMMON_DOCUMENTS 0x002e
+#endif
 
 namespace utils {
 
 class File {
+public:
+#ifdef _WIN32
+  static const wchar_t kPathSeparator = L'\\';
+#else
+  static const wchar_t kPathSeparator = L'/';
+#endif
+
+  // a single entry of a directory listing - everything comes from the
+  // enumeration itself (no per-entry stat)
+  struct DirectoryEntry {
+    std::string name; // UTF8
+    bool is_directory;
+    bool is_link; // junctions and symbolic links
+    unsigned __int64 size;
+    __int64 creation_time; // FILETIME
+    __int64 last_write_time; // FILETIME
+  };
+  typedef std::vector<DirectoryEntry> DirectoryEntries;
+
+  // called with every page of a directory listing, |last| is set for the
+  // final (possibly empty) page - return false to stop the enumeration
+  typedef std::function<bool(const DirectoryEntries& page, bool last)> 
+    DirectoryPageCallback;
+
 public:
   static std::wstring GetSpecialFolderWide(int csidl);
   static std::string GetSpecialFolderUtf8(int csidl);
@@ -18,10 +71,39 @@ public:
   static bool DoesFileExist(const std::wstring& filename);
   static bool IsDirectory(const std::wstring& directory);
 
+  // the reads of |GetTextFile| and |GetTextFileUtf8| are split into chunks
+  // of (up to) this size - |cancel| is checked between them, and a 
+  // cancelled read returns false with |ref_output| released
+  static const size_t kReadChunkSize = 1024 * 1024;
+
   static bool GetTextFile(
     const std::wstring& filename, 
     std::string& ref_output,
-    int limit);
+    int limit,
+    const CancellationToken* cancel = nullptr);
+
+  // Reads a text file and returns its content as UTF8. The encoding is
+  // detected by the BOM (which isn't returned) - files without one are
+  // treated as UTF-16LE if |default_utf16| is set and returned as-is 
+  // otherwise. UTF-16 is transcoded while reading, so only the output is
+  // ever held in memory.
+  static bool GetTextFileUtf8(
+    const std::wstring& filename,
+    std::string& ref_output,
+    bool default_utf16,
+    const CancellationToken* cancel = nullptr);
+
+  // Reads the last |count| lines of a (UTF8) text file by scanning backwards
+  // from the end - the cost depends on the size of the lines, not of the 
+  // file. Lines end with "\n" or "\r\n" (like |TxtFileStream|) and a last
+  // line without one is included.
+  static bool GetLastLines(
+    const std::wstring& filename,
+    size_t count,
+    std::vector<std::string>& ref_lines);
+
+  // FILETIME (100ns since 1601) -> javascript time (ms since 1970)
+  static __int64 FileTimeToJsTime(__int64 file_time);
 
   static bool GetFileTimes(
     const std::wstring& filename, 
@@ -32,6 +114,37 @@ public:
   static bool WriteTextFile(
     const std::wstring& filename,
     const std::string& content);
+  static bool WriteTextFile(
+    const std::wstring& filename,
+    const char* content,
+    size_t size);
+
+  // creates |directory| and any missing parent - succeeds if it exists
+  static bool CreateDirectories(const std::wstring& directory);
+
+  // replaces |to| (if it exists) in one step
+  static bool RenameFile(const std::wstring& from, const std::wstring& to);
+
+  // Lists the entries of |directory| that match |pattern| (wildcards, e.g.
+  // "*.log") in pages of up to |page_size| entries, skipping "." and "..".
+  // Without |details| the size and times of the entries may be left 0 - 
+  // POSIX then only stats the entries whose type readdir doesn't tell.
+  // Returns false if the directory couldn't be enumerated.
+  static bool ListDirectory(
+    const std::wstring& directory,
+    const std::wstring& pattern,
+    size_t page_size,
+    DirectoryPageCallback callback,
+    bool details = true);
+
+#ifdef _WIN32
+private:
+  static HANDLE OpenShared(const std::wstring& filename);
+  static HANDLE OpenTempCopy(
+    const std::wstring& filename, 
+    std::wstring& ref_temp_file,
+    const CancellationToken* cancel);
+#endif
 }; // class File
 
 }; // namespace utils;
@@ -0,0 +1,224 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#include "FileHash.h"
+#include "Event.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+
+#include <memory>
+
+using namespace utils;
+
+// the address space of the (32 bit) process is limited - never map more 
+// than this at once
+const size_t kViewSize = 4 * 1024 * 1024;
+
+// state shared by the tasks of |HashParallel| and |HashFiles|
+struct FileHash::ParallelJob {
+  const std::wstring* filename;
+  const std::vector<std::wstring>* filenames;
+  Hasher::Algorithm algorithm;
+  unsigned __int64 size;
+
+  std::vector<std::string> digests;
+  volatile LONG pending;
+  volatile bool failed;
+  Event done_event;
+};
+
+// static
+bool FileHash::Hash(
+  const std::wstring& filename, 
+  Hasher::Algorithm algorithm,
+  std::string& ref_digest) {
+
+  MappedFile file;
+  if (!file.Open(filename)) {
+    return false;
+  }
+
+  std::auto_ptr<Hasher> hasher(Hasher::Create(algorithm));
+  if (file.size() <= kChunkSize) {
+    if (!HashRange(file, 0, file.size(), hasher.get())) {
+      return false;
+    }
+
+    hasher->Final(ref_digest);
+    return true;
+  }
+
+  std::auto_ptr<Hasher> tree_hasher(Hasher::Create(algorithm));
+  std::string chunk_digest;
+  for (unsigned __int64 offset = 0; offset < file.size(); 
+       offset += kChunkSize) {
+    unsigned __int64 length = file.size() - offset;
+    if (length > kChunkSize) {
+      length = kChunkSize;
+    }
+
+    if (!HashRange(file, offset, length, hasher.get())) {
+      return false;
+    }
+
+    hasher->Final(chunk_digest);
+    tree_hasher->Update(chunk_digest.c_str(), chunk_digest.size());
+  }
+
+  tree_hasher->Final(ref_digest);
+  return true;
+}
+
+// static
+bool FileHash::HashParallel(
+  ThreadPool* pool,
+  const std::wstring& filename, 
+  Hasher::Algorithm algorithm,
+  std::string& ref_digest) {
+
+  MappedFile file;
+  if (!file.Open(filename)) {
+    return false;
+  }
+
+  unsigned __int64 size = file.size();
+  file.Close();
+
+  if ((size <= kChunkSize) || (nullptr == pool) || (pool->size() < 2)) {
+    return Hash(filename, algorithm, ref_digest);
+  }
+
+  ParallelJob job;
+  job.filename = &filename;
+  job.filenames = nullptr;
+  job.algorithm = algorithm;
+  job.size = size;
+  job.digests.resize((size_t)((size + kChunkSize - 1) / kChunkSize));
+  job.pending = (LONG)job.digests.size();
+  job.failed = false;
+
+  if (!job.done_event.Create(true, false)) {
+    return false;
+  }
+
+  for (size_t i = 0; i < job.digests.size(); i++) {
+    if (!pool->PostTask(std::bind(&FileHash::HashChunkTask, &job, i))) {
+      job.failed = true;
+      if (0 == InterlockedDecrement(&job.pending)) {
+        job.done_event.Signal();
+      }
+    }
+  }
+
+  job.done_event.Wait();
+  if (job.failed) {
+    return false;
+  }
+
+  std::auto_ptr<Hasher> tree_hasher(Hasher::Create(algorithm));
+  for (size_t i = 0; i < job.digests.size(); i++) {
+    tree_hasher->Update(job.digests[i].c_str(), job.digests[i].size());
+  }
+
+  tree_hasher->Final(ref_digest);
+  return true;
+}
+
+// static
+bool FileHash::HashFiles(
+  ThreadPool* pool,
+  const std::vector<std::wstring>& filenames, 
+  Hasher::Algorithm algorithm,
+  std::vector<std::string>& ref_digests) {
+
+  ref_digests.clear();
+  if (filenames.empty()) {
+    return true;
+  }
+
+  if ((nullptr == pool) || (0 == pool->size())) {
+    return false;
+  }
+
+  ParallelJob job;
+  job.filename = nullptr;
+  job.filenames = &filenames;
+  job.algorithm = algorithm;
+  job.size = 0;
+  job.digests.resize(filenames.size());
+  job.pending = (LONG)filenames.size();
+  job.failed = false;
+
+  if (!job.done_event.Create(true, false)) {
+    return false;
+  }
+
+  for (size_t i = 0; i < filenames.size(); i++) {
+    if (!pool->PostTask(std::bind(&FileHash::HashFileTask, &job, i)) &&
+        (0 == InterlockedDecrement(&job.pending))) {
+      job.done_event.Signal();
+    }
+  }
+
+  job.done_event.Wait();
+  ref_digests.swap(job.digests);
+  return true;
+}
+
+// static
+bool FileHash::HashRange(
+  MappedFile& file, 
+  unsigned __int64 offset,
+  unsigned __int64 length,
+  Hasher* hasher) {
+
+  while (length > 0) {
+    size_t view_length = (length > kViewSize) ? kViewSize : (size_t)length;
+    const char* view = file.Map(offset, view_length);
+    if (nullptr == view) {
+      return false;
+    }
+
+    hasher->Update(view, view_length);
+    offset += view_length;
+    length -= view_length;
+  }
+
+  return true;
+}
+
+// static
+void FileHash::HashChunkTask(ParallelJob* job, size_t chunk) {
+  if (!job->failed) {
+    MappedFile file;
+    unsigned __int64 offset = chunk * kChunkSize;
+    unsigned __int64 length = job->size - offset;
+    if (length > kChunkSize) {
+      length = kChunkSize;
+    }
+
+    std::auto_ptr<Hasher> hasher(Hasher::Create(job->algorithm));
+    if (file.Open(*job->filename) && 
+        HashRange(file, offset, length, hasher.get())) {
+      hasher->Final(job->digests[chunk]);
+    } else {
+      job->failed = true;
+    }
+  }
+
+  if (0 == InterlockedDecrement(&job->pending)) {
+    job->done_event.Signal();
+  }
+}
+
+// static
+void FileHash::HashFileTask(ParallelJob* job, size_t index) {
+  if (!Hash((*job->filenames)[index], job->algorithm, job->digests[index])) {
+    job->digests[index].clear();
+  }
+
+  if (0 == InterlockedDecrement(&job->pending)) {
+    job->done_event.Signal();
+  }
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef UTILS_FILE_HASH_H_
+#define UTILS_FILE_HASH_H_
+
+#include <string>
+#include <vector>
+#include "Hasher.h"
+#include "Platform.h"
+
+namespace utils {
+
+class MappedFile;
+class ThreadPool;
+
+// Hashes (memory mapped) files. Files larger than |kChunkSize| are hashed as
+// a tree: every chunk is hashed on its own and the digest is the hash of the
+// concatenated chunk digests - so the chunks can be hashed in parallel. The
+// digest of a file is the same no matter which function computed it.
+class FileHash {
+public:
+  static const unsigned __int64 kChunkSize = 16 * 1024 * 1024;
+
+  // on the calling thread
+  static bool Hash(
+    const std::wstring& filename, 
+    Hasher::Algorithm algorithm,
+    std::string& ref_digest);
+
+  // chunks are hashed in parallel on |pool| - must not be called from one of
+  // the |pool| threads
+  static bool HashParallel(
+    ThreadPool* pool,
+    const std::wstring& filename, 
+    Hasher::Algorithm algorithm,
+    std::string& ref_digest);
+
+  // the files are hashed in parallel on |pool| (each on a single thread) -
+  // |ref_digests| gets an empty digest for files that failed
+  static bool HashFiles(
+    ThreadPool* pool,
+    const std::vector<std::wstring>& filenames, 
+    Hasher::Algorithm algorithm,
+    std::vector<std::string>& ref_digests);
+
+private:
+  struct ParallelJob;
+
+  static bool HashRange(
+    MappedFile& file, 
+    unsigned __int64 offset,
+    unsigned __int64 length,
+    Hasher* hasher);
+  static void HashChunkTask(ParallelJob* job, size_t chunk);
+  static void HashFileTask(ParallelJob* job, size_t index);
+};
+
+}; // namespace utils
+
+#endif // UTILS_FILE_HASH_H_
\ No newline at end of file
@@ -0,0 +1,337 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#include "FileSearch.h"
+#include "MappedFile.h"
+#include "TextScan.h"
+#include "ThreadPool.h"
+
+using namespace utils;
+
+// files are mapped a window at a time - a window always ends on a line
+// boundary (unless a single line is longer than it)
+const size_t kViewSize = 32 * 1024 * 1024;
+
+// std::regex backtracks recursively - on long lines libstdc++ overflows the
+// stack and MSVC throws error_complexity / error_stack. Regular expressions
+// only see the first |kMaxRegexLineLength| bytes of a line.
+const size_t kMaxRegexLineLength = 4 * 1024;
+
+namespace {
+
+inline bool IsUtf8Continuation(const char* p) {
+  return (0x80 == ((unsigned char)*p & 0xC0));
+}
+
+}; // namespace
+
+FileSearch::Options::Options() :
+  regex(false),
+  ignore_case(false),
+  max_results(0),
+  context_length(200) {
+}
+
+FileSearch::FileSearch() :
+  targets_(nullptr),
+  batch_size_(1),
+  next_target_(0),
+  results_(0),
+  running_workers_(0),
+  stopping_(false),
+  cancelled_(false) {
+}
+
+FileSearch::~FileSearch() {
+  done_event_.Destroy();
+}
+
+bool FileSearch::Search(
+  ThreadPool* pool,
+  const Targets& targets,
+  const std::string& pattern,
+  const Options& options,
+  size_t batch_size,
+  BatchCallback callback) {
+
+  if ((nullptr == pool) || (0 == pool->size()) || pattern.empty()) {
+    return false;
+  }
+
+  if (options.regex) {
+    try {
+      regex_ = std::regex(
+        pattern, 
+        options.ignore_case ? 
+          (std::regex::ECMAScript | std::regex::icase) : 
+          std::regex::ECMAScript);
+    } catch (const std::regex_error&) {
+      return false;
+    }
+  }
+
+  if (targets.empty()) {
+    return true;
+  }
+
+  if (!done_event_.IsCreated() && !done_event_.Create(true, false)) {
+    return false;
+  }
+
+  done_event_.Reset();
+
+  targets_ = &targets;
+  pattern_ = pattern;
+  options_ = options;
+  batch_size_ = (batch_size > 0) ? batch_size : 1;
+  callback_ = callback;
+  next_target_ = 0;
+  results_ = 0;
+  stopping_ = false;
+  cancelled_ = false;
+
+  // no point in more workers than files
+  size_t workers = (pool->size() < targets.size()) ? 
+    pool->size() : 
+    targets.size();
+  running_workers_ = (LONG)workers;
+
+  size_t started_workers = 0;
+  for (size_t i = 0; i < workers; i++) {
+    if (pool->PostTask(std::bind(&FileSearch::WorkerLoop, this))) {
+      started_workers++;
+    } else if (0 == InterlockedDecrement(&running_workers_)) {
+      done_event_.Signal();
+    }
+  }
+
+  if (0 == started_workers) {
+    return false;
+  }
+
+  done_event_.Wait();
+  return true;
+}
+
+void FileSearch::WorkerLoop() {
+  Matches batch;
+
+  while (!stopping_) {
+    LONG index = InterlockedIncrement(&next_target_) - 1;
+    if ((size_t)index >= targets_->size()) {
+      break;
+    }
+
+    SearchFile((*targets_)[index], batch);
+  }
+
+  if (!batch.empty()) {
+    DeliverBatch(batch);
+  }
+
+  if (0 == InterlockedDecrement(&running_workers_)) {
+    done_event_.Signal();
+  }
+}
+
+void FileSearch::SearchFile(const Target& target, Matches& ref_batch) {
+  MappedFile file;
+  if (!file.Open(target.path)) {
+    return;
+  }
+
+  unsigned __int64 size = file.size();
+  unsigned __int64 offset = 0;
+  unsigned __int64 line = 1;
+
+  while ((offset < size) && !stopping_) {
+    size_t length = (size - offset > kViewSize) ? 
+      kViewSize : 
+      (size_t)(size - offset);
+
+    const char* view = file.Map(offset, length);
+    if (nullptr == view) {
+      return;
+    }
+
+    const char* view_end = view + length;
+
+    // leave the partial last line to the next window
+    if (offset + length < size) {
+      const char* last_new_line = 
+        TextScan::FindLastByte(view, view_end, '\n');
+      if (nullptr != last_new_line) {
+        view_end = last_new_line + 1;
+      }
+    }
+
+    line = SearchView(target, view, view_end, offset, line, ref_batch);
+    offset += view_end - view;
+  }
+}
+
+unsigned __int64 FileSearch::SearchView(
+  const Target& target, 
+  const char* view, 
+  const char* view_end,
+  unsigned __int64 view_offset, 
+  unsigned __int64 line,
+  Matches& ref_batch) {
+
+  if (options_.regex) {
+    const char* line_begin = view;
+    while ((line_begin < view_end) && !stopping_) {
+      const char* line_end = TextScan::FindByte(line_begin, view_end, '\n');
+      if (nullptr == line_end) {
+        line_end = view_end;
+      }
+
+      const char* text_end = line_end;
+      if ((text_end > line_begin) && ('\r' == *(text_end - 1))) {
+        text_end--;
+      }
+
+      const char* search_end = 
+        ((size_t)(text_end - line_begin) > kMaxRegexLineLength) ? 
+          line_begin + kMaxRegexLineLength : 
+          text_end;
+
+      // a line the engine gives up on doesn't match
+      std::cmatch match;
+      bool found = false;
+      try {
+        found = std::regex_search(line_begin, search_end, match, regex_);
+      } catch (const std::regex_error&) {
+        found = false;
+      }
+
+      if (found &&
+          !AddMatch(target, view, view_offset, line, line_begin, text_end,
+                    match[0].first, ref_batch)) {
+        break;
+      }
+
+      // a view only ends without a new line at the end of the file
+      if (line_end == view_end) {
+        break;
+      }
+
+      line++;
+      line_begin = line_end + 1;
+    }
+
+    return line;
+  }
+
+  // plain strings - scan for the pattern itself and only count the lines
+  // we skipped over
+  const char* position = view;
+  const char* counted = view;
+
+  while ((position < view_end) && !stopping_) {
+    const char* match = TextScan::FindSubstring(
+      position,
+      view_end,
+      pattern_.c_str(),
+      pattern_.size(),
+      options_.ignore_case);
+
+    if (nullptr == match) {
+      break;
+    }
+
+    line += TextScan::CountByte(counted, match, '\n');
+
+    const char* line_begin = TextScan::FindLastByte(view, match, '\n');
+    line_begin = (nullptr == line_begin) ? view : line_begin + 1;
+
+    const char* line_end = TextScan::FindByte(match, view_end, '\n');
+    if (nullptr == line_end) {
+      line_end = view_end;
+    }
+
+    const char* text_end = line_end;
+    if ((text_end > match) && ('\r' == *(text_end - 1))) {
+      text_end--;
+    }
+
+    if (!AddMatch(target, view, view_offset, line, line_begin, text_end, 
+                  match, ref_batch)) {
+      break;
+    }
+
+    // one match per line
+    counted = match;
+    position = line_end;
+  }
+
+  return line + TextScan::CountByte(counted, view_end, '\n');
+}
+
+bool FileSearch::AddMatch(
+  const Target& target,
+  const char* view,
+  unsigned __int64 view_offset,
+  unsigned __int64 line,
+  const char* line_begin,
+  const char* line_end,
+  const char* match,
+  Matches& ref_batch) {
+
+  if ((0 != options_.max_results) &&
+      ((size_t)InterlockedIncrement(&results_) > options_.max_results)) {
+    stopping_ = true;
+    return false;
+  }
+
+  // cut long lines around the match - without splitting UTF8 characters
+  const char* context_begin = line_begin;
+  const char* context_end = line_end;
+  if ((size_t)(line_end - line_begin) > options_.context_length) {
+    size_t before = options_.context_length / 2;
+    if ((size_t)(match - line_begin) > before) {
+      context_begin = match - before;
+    }
+
+    if ((size_t)(line_end - context_begin) > options_.context_length) {
+      context_end = context_begin + options_.context_length;
+    }
+
+    while ((context_begin < match) && IsUtf8Continuation(context_begin)) {
+      context_begin++;
+    }
+
+    while ((context_end < line_end) && 
+           (context_end > context_begin) &&
+           IsUtf8Continuation(context_end)) {
+      context_end--;
+    }
+  }
+
+  ref_batch.push_back(Match());
+  Match& result = ref_batch.back();
+  result.file = target.name;
+  result.offset = view_offset + (match - view);
+  result.line = line;
+  result.context.assign(context_begin, context_end);
+
+  if (ref_batch.size() >= batch_size_) {
+    return DeliverBatch(ref_batch);
+  }
+
+  return true;
+}
+
+bool FileSearch::DeliverBatch(Matches& ref_batch) {
+  CriticalSectionLock lock(callback_critical_section_);
+
+  // matches found before hitting |max_results| are still delivered
+  if (!cancelled_ && !ref_batch.empty() && !callback_(ref_batch)) {
+    cancelled_ = true;
+    stopping_ = true;
+  }
+
+  ref_batch.clear();
+  return !stopping_;
+}
\ No newline at end of file
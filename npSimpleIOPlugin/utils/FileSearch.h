@@ -0,0 +1,115 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef UTILS_FILE_SEARCH_H_
+#define UTILS_FILE_SEARCH_H_
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <regex>
+#include "CriticalSectionLock.h"
+#include "Event.h"
+
+namespace utils {
+
+class ThreadPool;
+
+// Searches the contents of files for a string (or a regular expression) in
+// parallel on a |ThreadPool|. Files are memory mapped (see |MappedFile|) and
+// scanned with |TextScan| - only the matching lines are copied out. Matching
+// is line based (like grep) so a pattern never spans lines and every line is
+// reported once, at its first match. Regular expressions only search the 
+// first 4KB of a line (std::regex recurses per character).
+class FileSearch {
+public:
+  struct Target {
+    std::wstring path;
+    std::string name; // UTF8 - reported with the matches
+  };
+  typedef std::vector<Target> Targets;
+
+  struct Match {
+    std::string file; // |Target::name|
+    unsigned __int64 offset; // in bytes, of the match
+    unsigned __int64 line; // 1-based
+    std::string context; // (part of) the matching line
+  };
+  typedef std::vector<Match> Matches;
+
+  struct Options {
+    Options();
+
+    bool regex;
+    bool ignore_case; // ASCII only for plain strings
+    size_t max_results; // 0 means no limit
+    size_t context_length; // in bytes, around the match
+  };
+
+  // called from the worker threads (never concurrently) - return false to 
+  // stop the search
+  typedef std::function<bool(const Matches& batch)> BatchCallback;
+
+  FileSearch();
+  virtual ~FileSearch();
+
+public:
+  // Blocks until all files were searched (files that can't be opened are 
+  // skipped). Returns false if the pattern is invalid.
+  bool Search(
+    ThreadPool* pool,
+    const Targets& targets,
+    const std::string& pattern,
+    const Options& options,
+    size_t batch_size,
+    BatchCallback callback);
+
+private:
+  void WorkerLoop();
+  void SearchFile(const Target& target, Matches& ref_batch);
+
+  // searches complete lines - returns the line number following the view
+  unsigned __int64 SearchView(
+    const Target& target, 
+    const char* view, 
+    const char* view_end,
+    unsigned __int64 view_offset, 
+    unsigned __int64 line,
+    Matches& ref_batch);
+
+  bool AddMatch(
+    const Target& target,
+    const char* view,
+    unsigned __int64 view_offset,
+    unsigned __int64 line,
+    const char* line_begin,
+    const char* line_end,
+    const char* match,
+    Matches& ref_batch);
+
+  bool DeliverBatch(Matches& ref_batch);
+
+private:
+  const Targets* targets_;
+  std::string pattern_;
+  std::regex regex_;
+  Options options_;
+  size_t batch_size_;
+  BatchCallback callback_;
+
+  volatile LONG next_target_;
+  volatile LONG results_;
+  volatile LONG running_workers_;
+  volatile bool stopping_;
+
+  // serializes |callback_| (and guards |cancelled_|)
+  CriticalSection callback_critical_section_;
+  bool cancelled_;
+
+  Event done_event_;
+};
+
+}; // namespace utils
+
+#endif // UTILS_FILE_SEARCH_H_
\ No newline at end of file
@@ -0,0 +1,105 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef UTILS_FLAT_POINTER_MAP_H_
+#define UTILS_FLAT_POINTER_MAP_H_
+
+#include <vector>
+#include "Platform.h"
+
+namespace utils {
+
+// An open addressing (linear probing) hash table keyed by pointers that are
+// compared by value, e.g. NPIdentifiers - a single array, so a lookup is a 
+// hash and (usually) one or two adjacent slots, with no allocations. Built 
+// once and read many times: there is no |Erase|. 
+// Not thread safe.
+template <class TValue>
+class FlatPointerMap {
+public:
+  FlatPointerMap() : count_(0) {
+    slots_.resize(kMinCapacity);
+  }
+
+public:
+  // overwrites the value of an existing |key| (|key| can't be nullptr)
+  void Insert(const void* key, const TValue& value) {
+    if ((count_ + 1) * 2 > slots_.size()) {
+      Grow();
+    }
+
+    Slot& slot = slots_[FindSlot(key)];
+    if (nullptr == slot.key) {
+      slot.key = key;
+      count_++;
+    }
+
+    slot.value = value;
+  }
+
+  // nullptr if |key| isn't in the map
+  TValue* Find(const void* key) {
+    Slot& slot = slots_[FindSlot(key)];
+    return (nullptr != slot.key) ? &slot.value : nullptr;
+  }
+
+  const TValue* Find(const void* key) const {
+    const Slot& slot = slots_[FindSlot(key)];
+    return (nullptr != slot.key) ? &slot.value : nullptr;
+  }
+
+  size_t size() const {
+    return count_;
+  }
+
+private:
+  static const size_t kMinCapacity = 16; // a power of 2
+
+  struct Slot {
+    Slot() : key(nullptr), value() {
+    }
+
+    const void* key;
+    TValue value;
+  };
+
+  // the slot of |key| or the empty slot it would go to (the table is never
+  // more than half full, so there always is one)
+  size_t FindSlot(const void* key) const {
+    size_t mask = slots_.size() - 1;
+    size_t index = Hash(key) & mask;
+    while ((nullptr != slots_[index].key) && (key != slots_[index].key)) {
+      index = (index + 1) & mask;
+    }
+
+    return index;
+  }
+
+  // pointers are aligned (low bits are 0) and often close to each other -
+  // multiplicative (Fibonacci) hashing spreads them over the table
+  static size_t Hash(const void* key) {
+    size_t value = (size_t)key;
+    value ^= (value >> 16);
+    return (size_t)((unsigned __int64)value * 0x9E3779B97F4A7C15ULL >> 32);
+  }
+
+  void Grow() {
+    std::vector<Slot> slots(slots_.size() * 2);
+    slots.swap(slots_);
+
+    for (size_t i = 0; i < slots.size(); i++) {
+      if (nullptr != slots[i].key) {
+        slots_[FindSlot(slots[i].key)] = slots[i];
+      }
+    }
+  }
+
+private:
+  std::vector<Slot> slots_;
+  size_t count_;
+};
+
+}; // namespace utils
+
+#endif // UTILS_FLAT_POINTER_MAP_H_
\ No newline at end of file
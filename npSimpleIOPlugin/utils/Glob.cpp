@@ -0,0 +1,235 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#include "Glob.h"
+
+#include <string.h>
+
+using namespace utils;
+
+namespace {
+
+inline unsigned char ToLower(unsigned char c) {
+  return ((c >= 'A') && (c <= 'Z')) ? (c + ('a' - 'A')) : c;
+}
+
+inline void SetBit(unsigned char* set, unsigned char c) {
+  set[c >> 3] |= (1 << (c & 7));
+}
+
+}; // namespace
+
+Glob::Glob() : basename_only_(false) {
+}
+
+bool Glob::Compile(const std::string& pattern) {
+  tokens_.clear();
+  basename_only_ = (std::string::npos == pattern.find('/'));
+
+  size_t i = 0;
+  while (i < pattern.size()) {
+    Token token;
+    token.type = TOKEN_LITERAL;
+    token.negate = false;
+
+    char c = pattern[i];
+    if ('*' == c) {
+      if ((i + 1 < pattern.size()) && ('*' == pattern[i + 1])) {
+        token.type = TOKEN_DOUBLE_STAR;
+        i += 2;
+
+        // "**/" also matches no directories at all
+        if ((i < pattern.size()) && ('/' == pattern[i])) {
+          i++;
+        }
+      } else {
+        token.type = TOKEN_STAR;
+        i++;
+      }
+    } else if ('?' == c) {
+      token.type = TOKEN_ANY_CHAR;
+      i++;
+    } else if ('[' == c) {
+      size_t close = pattern.find(']', i + 2);
+      if (std::string::npos == close) {
+        return false;
+      }
+
+      token.type = TOKEN_CLASS;
+      memset(token.set, 0, sizeof(token.set));
+
+      size_t j = i + 1;
+      if (('!' == pattern[j]) || ('^' == pattern[j])) {
+        token.negate = true;
+        j++;
+      }
+
+      for (; j < close; j++) {
+        unsigned char from = ToLower(pattern[j]);
+        unsigned char to = from;
+        if ((j + 2 < close) && ('-' == pattern[j + 1])) {
+          to = ToLower(pattern[j + 2]);
+          j += 2;
+        }
+
+        for (unsigned int k = from; k <= to; k++) {
+          SetBit(token.set, (unsigned char)k);
+        }
+      }
+
+      i = close + 1;
+    } else {
+      // merge consecutive literal characters
+      while ((i < pattern.size()) && 
+             (NULL == strchr("*?[", pattern[i]))) {
+        token.literal += ToLower(pattern[i]);
+        i++;
+      }
+    }
+
+    tokens_.push_back(token);
+  }
+
+  return true;
+}
+
+bool Glob::Match(const std::string& path) const {
+  const char* start = path.c_str();
+  const char* end = start + path.size();
+
+  if (basename_only_) {
+    const char* separator = strrchr(start, '/');
+    if (nullptr != separator) {
+      start = separator + 1;
+    }
+  }
+
+  return MatchFrom(0, start, end);
+}
+
+bool Glob::MatchFrom(size_t token, const char* path, const char* end) const {
+  for (; token < tokens_.size(); token++) {
+    const Token& current = tokens_[token];
+
+    switch (current.type) {
+    case TOKEN_LITERAL:
+      {
+        size_t len = current.literal.size();
+        if ((size_t)(end - path) < len) {
+          return false;
+        }
+
+        for (size_t i = 0; i < len; i++) {
+          if (ToLower(path[i]) != (unsigned char)current.literal[i]) {
+            return false;
+          }
+        }
+        path += len;
+      }
+      break;
+
+    case TOKEN_ANY_CHAR:
+      if ((path == end) || ('/' == *path)) {
+        return false;
+      }
+      path++;
+      break;
+
+    case TOKEN_CLASS:
+      if ((path == end) || 
+          ('/' == *path) ||
+          !ClassContains(current, ToLower(*path))) {
+        return false;
+      }
+      path++;
+      break;
+
+    case TOKEN_STAR:
+    case TOKEN_DOUBLE_STAR:
+      {
+        // trailing star - the rest of the path just needs to be allowed
+        if (token + 1 == tokens_.size()) {
+          return (TOKEN_DOUBLE_STAR == current.type) ||
+                 (nullptr == memchr(path, '/', end - path));
+        }
+
+        // try every possible length (shortest first)
+        for (const char* p = path; ; p++) {
+          if (MatchFrom(token + 1, p, end)) {
+            return true;
+          }
+
+          if ((p == end) || 
+              ((TOKEN_STAR == current.type) && ('/' == *p))) {
+            return false;
+          }
+        }
+      }
+    }
+  }
+
+  return (path == end);
+}
+
+// static
+bool Glob::ClassContains(const Token& token, unsigned char c) {
+  bool contains = (0 != (token.set[c >> 3] & (1 << (c & 7))));
+  return (contains != token.negate);
+}
+
+bool GlobSet::Compile(const std::vector<std::string>& patterns) {
+  includes_.clear();
+  excludes_.clear();
+
+  std::vector<std::string>::const_iterator iter = patterns.begin();
+  for (; iter != patterns.end(); ++iter) {
+    if (iter->empty()) {
+      continue;
+    }
+
+    Glob glob;
+    bool exclude = ('!' == (*iter)[0]);
+    if (!glob.Compile(exclude ? iter->substr(1) : *iter)) {
+      return false;
+    }
+
+    if (exclude) {
+      excludes_.push_back(glob);
+    } else {
+      includes_.push_back(glob);
+    }
+  }
+
+  return true;
+}
+
+bool GlobSet::IsIncluded(const std::string& path) const {
+  if (IsExcluded(path)) {
+    return false;
+  }
+
+  if (includes_.empty()) {
+    return true;
+  }
+
+  std::vector<Glob>::const_iterator iter = includes_.begin();
+  for (; iter != includes_.end(); ++iter) {
+    if (iter->Match(path)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool GlobSet::IsExcluded(const std::string& path) const {
+  std::vector<Glob>::const_iterator iter = excludes_.begin();
+  for (; iter != excludes_.end(); ++iter) {
+    if (iter->Match(path)) {
+      return true;
+    }
+  }
+
+  return false;
+}
\ No newline at end of file
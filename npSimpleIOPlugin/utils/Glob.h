@@ -0,0 +1,73 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef UTILS_GLOB_H_
+#define UTILS_GLOB_H_
+
+#include <string>
+#include <vector>
+
+namespace utils {
+
+// A glob pattern compiled once and matched against relative UTF8 paths that
+// use '/' as a separator. Matching is case insensitive (ASCII).
+//
+//   *   any run of characters except '/'
+//   **  any run of characters including '/'
+//   ?   any single character except '/'
+//   [abc], [a-z], [!abc]  character classes
+//
+// A pattern without a '/' is matched against the last path component only
+// (i.e. "*.log" matches "logs/game.log").
+class Glob {
+public:
+  Glob();
+
+public:
+  bool Compile(const std::string& pattern);
+  bool Match(const std::string& path) const;
+
+private:
+  enum TokenType {
+    TOKEN_LITERAL = 0,
+    TOKEN_ANY_CHAR,
+    TOKEN_STAR,
+    TOKEN_DOUBLE_STAR,
+    TOKEN_CLASS
+  };
+
+  struct Token {
+    TokenType type;
+    std::string literal; // lower case
+    bool negate;
+    unsigned char set[256 / 8];
+  };
+
+  bool MatchFrom(size_t token, const char* path, const char* end) const;
+  static bool ClassContains(const Token& token, unsigned char c);
+
+private:
+  std::vector<Token> tokens_;
+  bool basename_only_;
+};
+
+// A set of include patterns and exclude patterns (prefixed with '!').
+// Excluded directories are pruned from a walk as a whole.
+class GlobSet {
+public:
+  bool Compile(const std::vector<std::string>& patterns);
+
+  // a path that matches an include pattern (or any path when there are
+  // none) and doesn't match an exclude pattern
+  bool IsIncluded(const std::string& path) const;
+  bool IsExcluded(const std::string& path) const;
+
+private:
+  std::vector<Glob> includes_;
+  std::vector<Glob> excludes_;
+};
+
+}; // namespace utils;
+
+#endif // UTILS_GLOB_H_
\ No newline at end of file
@@ -0,0 +1,470 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#include "Hasher.h"
+
+#include <string.h>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE4_2__)
+#define HASHER_USE_SSE42
+#include <nmmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+typedef unsigned __int32 hash_u32;
+typedef unsigned __int64 hash_u64;
+#else
+#include <stdint.h>
+typedef uint32_t hash_u32;
+typedef uint64_t hash_u64;
+#endif
+
+using namespace utils;
+
+namespace {
+
+inline hash_u32 Read32(const unsigned char* p) {
+  hash_u32 value;
+  memcpy(&value, p, sizeof(value)); // little endian (x86)
+  return value;
+}
+
+inline hash_u64 Read64(const unsigned char* p) {
+  hash_u64 value;
+  memcpy(&value, p, sizeof(value)); // little endian (x86)
+  return value;
+}
+
+inline hash_u32 Rotr32(hash_u32 value, int bits) {
+  return (value >> bits) | (value << (32 - bits));
+}
+
+inline hash_u64 Rotl64(hash_u64 value, int bits) {
+  return (value << bits) | (value >> (64 - bits));
+}
+
+void AppendBigEndian(hash_u64 value, size_t bytes, std::string& ref_output) {
+  for (size_t i = bytes; i > 0; i--) {
+    ref_output += (char)(value >> ((i - 1) * 8));
+  }
+}
+
+//------------------------------------------------------------------------------
+// XXH64 - https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md
+class Xxh64Hasher : public Hasher {
+public:
+  Xxh64Hasher() {
+    Reset();
+  }
+
+  virtual void Update(const void* data, size_t len) {
+    const unsigned char* p = (const unsigned char*)data;
+    const unsigned char* end = p + len;
+    total_len_ += len;
+
+    if (buffered_ + len < sizeof(buffer_)) {
+      memcpy(buffer_ + buffered_, p, len);
+      buffered_ += len;
+      return;
+    }
+
+    if (buffered_ > 0) {
+      size_t fill = sizeof(buffer_) - buffered_;
+      memcpy(buffer_ + buffered_, p, fill);
+      p += fill;
+      Stripe(buffer_);
+      buffered_ = 0;
+    }
+
+    while (end - p >= 32) {
+      Stripe(p);
+      p += 32;
+    }
+
+    buffered_ = end - p;
+    memcpy(buffer_, p, buffered_);
+  }
+
+  virtual void Final(std::string& ref_digest) {
+    hash_u64 h;
+    if (total_len_ >= 32) {
+      h = Rotl64(v_[0], 1) + Rotl64(v_[1], 7) + 
+          Rotl64(v_[2], 12) + Rotl64(v_[3], 18);
+      for (int i = 0; i < 4; i++) {
+        h ^= Round(0, v_[i]);
+        h = h * kPrime1 + kPrime4;
+      }
+    } else {
+      h = kPrime5;
+    }
+
+    h += total_len_;
+
+    const unsigned char* p = buffer_;
+    const unsigned char* end = buffer_ + buffered_;
+    for (; end - p >= 8; p += 8) {
+      h ^= Round(0, Read64(p));
+      h = Rotl64(h, 27) * kPrime1 + kPrime4;
+    }
+
+    if (end - p >= 4) {
+      h ^= (hash_u64)Read32(p) * kPrime1;
+      h = Rotl64(h, 23) * kPrime2 + kPrime3;
+      p += 4;
+    }
+
+    for (; p < end; p++) {
+      h ^= (*p) * kPrime5;
+      h = Rotl64(h, 11) * kPrime1;
+    }
+
+    h ^= h >> 33;
+    h *= kPrime2;
+    h ^= h >> 29;
+    h *= kPrime3;
+    h ^= h >> 32;
+
+    ref_digest.clear();
+    AppendBigEndian(h, 8, ref_digest);
+    Reset();
+  }
+
+private:
+  static const hash_u64 kPrime1 = 11400714785074694791ULL;
+  static const hash_u64 kPrime2 = 14029467366897019727ULL;
+  static const hash_u64 kPrime3 = 1609587929392839161ULL;
+  static const hash_u64 kPrime4 = 9650029242287828579ULL;
+  static const hash_u64 kPrime5 = 2870177450012600261ULL;
+
+  static hash_u64 Round(hash_u64 acc, hash_u64 input) {
+    acc += input * kPrime2;
+    acc = Rotl64(acc, 31);
+    return acc * kPrime1;
+  }
+
+  void Stripe(const unsigned char* p) {
+    v_[0] = Round(v_[0], Read64(p));
+    v_[1] = Round(v_[1], Read64(p + 8));
+    v_[2] = Round(v_[2], Read64(p + 16));
+    v_[3] = Round(v_[3], Read64(p + 24));
+  }
+
+  void Reset() {
+    // seed 0
+    v_[0] = kPrime1 + kPrime2;
+    v_[1] = kPrime2;
+    v_[2] = 0;
+    v_[3] = 0 - kPrime1;
+    total_len_ = 0;
+    buffered_ = 0;
+  }
+
+  hash_u64 v_[4];
+  hash_u64 total_len_;
+  unsigned char buffer_[32];
+  size_t buffered_;
+};
+
+//------------------------------------------------------------------------------
+// CRC-32C - slicing-by-8 tables, or the SSE4.2 crc32 instruction
+class Crc32cHasher : public Hasher {
+public:
+  Crc32cHasher() : crc_(0xFFFFFFFF) {
+  }
+
+  virtual void Update(const void* data, size_t len) {
+#ifdef HASHER_USE_SSE42
+    if (HasSse42()) {
+      crc_ = UpdateSse42(crc_, (const unsigned char*)data, len);
+      return;
+    }
+#endif
+
+    crc_ = UpdateTables(crc_, (const unsigned char*)data, len);
+  }
+
+  virtual void Final(std::string& ref_digest) {
+    ref_digest.clear();
+    AppendBigEndian(crc_ ^ 0xFFFFFFFF, 4, ref_digest);
+    crc_ = 0xFFFFFFFF;
+  }
+
+private:
+  struct Tables {
+    Tables() {
+      for (hash_u32 i = 0; i < 256; i++) {
+        hash_u32 crc = i;
+        for (int bit = 0; bit < 8; bit++) {
+          crc = (crc >> 1) ^ ((crc & 1) ? 0x82F63B78 : 0);
+        }
+        table[0][i] = crc;
+      }
+
+      for (hash_u32 i = 0; i < 256; i++) {
+        for (int t = 1; t < 8; t++) {
+          table[t][i] = 
+            (table[t - 1][i] >> 8) ^ table[0][table[t - 1][i] & 0xFF];
+        }
+      }
+    }
+
+    hash_u32 table[8][256];
+  };
+
+  static const Tables& GetTables() {
+    static const Tables tables;
+    return tables;
+  }
+
+  static hash_u32 UpdateTables(
+    hash_u32 crc, 
+    const unsigned char* p, 
+    size_t len) {
+
+    const hash_u32 (*t)[256] = GetTables().table;
+
+    for (; len >= 8; len -= 8, p += 8) {
+      hash_u32 low = Read32(p) ^ crc;
+      hash_u32 high = Read32(p + 4);
+      crc = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^
+            t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24] ^
+            t[3][high & 0xFF] ^ t[2][(high >> 8) & 0xFF] ^
+            t[1][(high >> 16) & 0xFF] ^ t[0][high >> 24];
+    }
+
+    for (; len > 0; len--, p++) {
+      crc = (crc >> 8) ^ t[0][(crc ^ *p) & 0xFF];
+    }
+
+    return crc;
+  }
+
+#ifdef HASHER_USE_SSE42
+  static bool HasSse42() {
+    static int has_sse42 = -1;
+    if (has_sse42 < 0) {
+#ifdef _MSC_VER
+      int info[4];
+      __cpuid(info, 1);
+      has_sse42 = (0 != (info[2] & (1 << 20))) ? 1 : 0;
+#else
+      has_sse42 = __builtin_cpu_supports("sse4.2") ? 1 : 0;
+#endif
+    }
+
+    return (1 == has_sse42);
+  }
+
+#ifndef _MSC_VER
+  __attribute__((target("sse4.2")))
+#endif
+  static hash_u32 UpdateSse42(
+    hash_u32 crc, 
+    const unsigned char* p, 
+    size_t len) {
+
+#if defined(_M_X64) || defined(__x86_64__)
+    hash_u64 crc64 = crc;
+    for (; len >= 8; len -= 8, p += 8) {
+      crc64 = _mm_crc32_u64(crc64, Read64(p));
+    }
+    crc = (hash_u32)crc64;
+#endif
+
+    for (; len >= 4; len -= 4, p += 4) {
+      crc = _mm_crc32_u32(crc, Read32(p));
+    }
+
+    for (; len > 0; len--, p++) {
+      crc = _mm_crc32_u8(crc, *p);
+    }
+
+    return crc;
+  }
+#endif // HASHER_USE_SSE42
+
+  hash_u32 crc_;
+};
+
+//------------------------------------------------------------------------------
+// SHA-256 - FIPS 180-4
+class Sha256Hasher : public Hasher {
+public:
+  Sha256Hasher() {
+    Reset();
+  }
+
+  virtual void Update(const void* data, size_t len) {
+    const unsigned char* p = (const unsigned char*)data;
+    total_len_ += len;
+
+    if (buffered_ > 0) {
+      size_t fill = sizeof(buffer_) - buffered_;
+      if (len < fill) {
+        memcpy(buffer_ + buffered_, p, len);
+        buffered_ += len;
+        return;
+      }
+
+      memcpy(buffer_ + buffered_, p, fill);
+      Transform(buffer_);
+      p += fill;
+      len -= fill;
+      buffered_ = 0;
+    }
+
+    for (; len >= 64; len -= 64, p += 64) {
+      Transform(p);
+    }
+
+    memcpy(buffer_, p, len);
+    buffered_ = len;
+  }
+
+  virtual void Final(std::string& ref_digest) {
+    hash_u64 bit_len = total_len_ * 8;
+
+    unsigned char padding[72] = { 0x80 };
+    size_t padding_len = (buffered_ < 56) ? 
+      (56 - buffered_) : 
+      (120 - buffered_);
+    for (size_t i = 0; i < 8; i++) {
+      padding[padding_len + i] = (unsigned char)(bit_len >> ((7 - i) * 8));
+    }
+    Update(padding, padding_len + 8);
+
+    ref_digest.clear();
+    for (int i = 0; i < 8; i++) {
+      AppendBigEndian(state_[i], 4, ref_digest);
+    }
+
+    Reset();
+  }
+
+private:
+  void Reset() {
+    static const hash_u32 kInitialState[8] = {
+      0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+      0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+
+    memcpy(state_, kInitialState, sizeof(state_));
+    total_len_ = 0;
+    buffered_ = 0;
+  }
+
+  void Transform(const unsigned char* block) {
+    static const hash_u32 k[64] = {
+      0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 
+      0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+      0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 
+      0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+      0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 
+      0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+      0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 
+      0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+      0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 
+      0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+      0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 
+      0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+      0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 
+      0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+      0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 
+      0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+    };
+
+    hash_u32 w[64];
+    for (int i = 0; i < 16; i++) {
+      w[i] = ((hash_u32)block[i * 4] << 24) | 
+             ((hash_u32)block[i * 4 + 1] << 16) |
+             ((hash_u32)block[i * 4 + 2] << 8) | 
+             (hash_u32)block[i * 4 + 3];
+    }
+
+    for (int i = 16; i < 64; i++) {
+      hash_u32 s0 = 
+        Rotr32(w[i - 15], 7) ^ Rotr32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+      hash_u32 s1 = 
+        Rotr32(w[i - 2], 17) ^ Rotr32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+      w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    hash_u32 a = state_[0], b = state_[1], c = state_[2], d = state_[3];
+    hash_u32 e = state_[4], f = state_[5], g = state_[6], h = state_[7];
+
+    for (int i = 0; i < 64; i++) {
+      hash_u32 s1 = Rotr32(e, 6) ^ Rotr32(e, 11) ^ Rotr32(e, 25);
+      hash_u32 ch = (e & f) ^ (~e & g);
+      hash_u32 temp1 = h + s1 + ch + k[i] + w[i];
+      hash_u32 s0 = Rotr32(a, 2) ^ Rotr32(a, 13) ^ Rotr32(a, 22);
+      hash_u32 maj = (a & b) ^ (a & c) ^ (b & c);
+      hash_u32 temp2 = s0 + maj;
+
+      h = g;
+      g = f;
+      f = e;
+      e = d + temp1;
+      d = c;
+      c = b;
+      b = a;
+      a = temp1 + temp2;
+    }
+
+    state_[0] += a; state_[1] += b; state_[2] += c; state_[3] += d;
+    state_[4] += e; state_[5] += f; state_[6] += g; state_[7] += h;
+  }
+
+  hash_u32 state_[8];
+  hash_u64 total_len_;
+  unsigned char buffer_[64];
+  size_t buffered_;
+};
+
+}; // namespace
+
+// static
+Hasher* Hasher::Create(Algorithm algorithm) {
+  switch (algorithm) {
+  case ALGORITHM_XXH64:
+    return new Xxh64Hasher();
+  case ALGORITHM_CRC32C:
+    return new Crc32cHasher();
+  case ALGORITHM_SHA256:
+    return new Sha256Hasher();
+  }
+
+  return nullptr;
+}
+
+// static
+bool Hasher::ParseAlgorithm(
+  const std::string& name, 
+  Algorithm& ref_algorithm) {
+
+  if ("xxh64" == name) {
+    ref_algorithm = ALGORITHM_XXH64;
+  } else if ("crc32c" == name) {
+    ref_algorithm = ALGORITHM_CRC32C;
+  } else if ("sha256" == name) {
+    ref_algorithm = ALGORITHM_SHA256;
+  } else {
+    return false;
+  }
+
+  return true;
+}
+
+// static
+void Hasher::ToHex(const std::string& digest, std::string& ref_hex) {
+  static const char kHexDigits[] = "0123456789abcdef";
+
+  ref_hex.clear();
+  ref_hex.reserve(digest.size() * 2);
+  for (size_t i = 0; i < digest.size(); i++) {
+    unsigned char c = (unsigned char)digest[i];
+    ref_hex += kHexDigits[c >> 4];
+    ref_hex += kHexDigits[c & 0xF];
+  }
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef UTILS_HASHER_H_
+#define UTILS_HASHER_H_
+
+#include <stddef.h>
+#include <string>
+
+namespace utils {
+
+// Streaming hash functions used for change detection:
+// - xxh64: XXH64, fastest (non-cryptographic)
+// - crc32c: CRC-32C (Castagnoli), with SSE4.2 when the CPU supports it
+// - sha256: SHA-256
+class Hasher {
+public:
+  enum Algorithm {
+    ALGORITHM_XXH64,
+    ALGORITHM_CRC32C,
+    ALGORITHM_SHA256
+  };
+
+  // caller owns the result
+  static Hasher* Create(Algorithm algorithm);
+  static bool ParseAlgorithm(const std::string& name, Algorithm& ref_algorithm);
+
+  // lower case hex
+  static void ToHex(const std::string& digest, std::string& ref_hex);
+
+  virtual ~Hasher() {}
+
+public:
+  virtual void Update(const void* data, size_t len) = 0;
+
+  // the raw digest (big endian) - the hasher is reset after it
+  virtual void Final(std::string& ref_digest) = 0;
+};
+
+}; // namespace utils
+
+#endif // UTILS_HASHER_H_
\ No newline at end of file
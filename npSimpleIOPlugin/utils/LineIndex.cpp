@@ -0,0 +1,358 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#include "LineIndex.h"
+#include "Encoders.h"
+#include "File.h"
+#include "Hasher.h"
+#include "TextScan.h"
+
+#include <memory>
+#include <string.h>
+
+using namespace utils;
+
+const char kIndexMagic[8] = { 'S', 'I', 'O', 'L', 'I', 'D', 'X', '1' };
+const wchar_t kIndexDirectory[] = L"SimpleIOPlugin";
+const wchar_t kIndexSubDirectory[] = L"LineIndex";
+
+const size_t kViewSize = 32 * 1024 * 1024;
+const size_t kFingerprintLength = 4096;
+
+// the persisted index starts with this header, followed by the checkpoints
+#pragma pack(push, 1)
+struct IndexHeader {
+  char magic[8];
+  unsigned __int64 checkpoint_interval;
+  unsigned __int64 indexed_size;
+  unsigned __int64 new_lines;
+  unsigned __int64 fingerprint;
+  unsigned int fingerprint_length;
+  unsigned char ends_with_new_line;
+  unsigned __int64 checkpoint_count;
+};
+#pragma pack(pop)
+
+LineIndex::LineIndex() {
+  Reset();
+}
+
+LineIndex::~LineIndex() {
+}
+
+bool LineIndex::Open(const std::wstring& filename) {
+  Reset();
+
+  if (!file_.Open(filename)) {
+    return false;
+  }
+
+  index_filename_ = GetIndexFilename(filename);
+
+  // a missing or stale index is simply rebuilt
+  if (!Load()) {
+    Reset();
+  }
+
+  unsigned __int64 fingerprint = 0;
+  if ((indexed_size_ > file_.size()) ||
+      !GetFingerprint(fingerprint_length_, fingerprint) ||
+      (fingerprint != fingerprint_)) {
+    Reset();
+  }
+
+  if (indexed_size_ == file_.size()) {
+    return true;
+  }
+
+  if (!Update()) {
+    return false;
+  }
+
+  // not being able to persist the index only costs us time
+  Save();
+  return true;
+}
+
+bool LineIndex::ReadLines(
+  unsigned __int64 start_line, 
+  size_t count, 
+  std::vector<std::string>& ref_lines) {
+
+  ref_lines.clear();
+  if ((0 == count) || (start_line >= line_count())) {
+    return true;
+  }
+
+  // the checkpoint before |start_line| and the lines we skip from there
+  size_t checkpoint = (size_t)(start_line / kCheckpointInterval);
+  size_t skip = (size_t)(start_line % kCheckpointInterval);
+
+  unsigned __int64 offset = checkpoints_[checkpoint];
+  unsigned __int64 size = file_.size();
+
+  while ((offset < size) && (ref_lines.size() < count)) {
+    size_t length = (size - offset > kViewSize) ? 
+      kViewSize : 
+      (size_t)(size - offset);
+
+    const char* view = file_.Map(offset, length);
+    if (nullptr == view) {
+      return false;
+    }
+
+    const char* view_end = view + length;
+    bool last_view = (offset + length == size);
+    const char* position = view;
+
+    if (skip > 0) {
+      size_t found = 0;
+      const char* new_line = 
+        TextScan::FindNthByte(position, view_end, '\n', skip, found);
+      if (nullptr == new_line) {
+        skip -= found;
+        offset += length;
+        continue;
+      }
+
+      skip = 0;
+      position = new_line + 1;
+    }
+
+    while ((position < view_end) && (ref_lines.size() < count)) {
+      const char* new_line = TextScan::FindByte(position, view_end, '\n');
+      if ((nullptr == new_line) && !last_view) {
+        // continue the line in the next view
+        break;
+      }
+
+      const char* line_end = (nullptr == new_line) ? view_end : new_line;
+      const char* text_end = line_end;
+      if ((text_end > position) && ('\r' == *(text_end - 1))) {
+        text_end--;
+      }
+
+      ref_lines.push_back(std::string(position, text_end));
+      position = line_end + 1;
+    }
+
+    if ((position == view) && !last_view) {
+      // a single line longer than a view - there's nothing sensible to do
+      return false;
+    }
+
+    offset += (position > view_end ? view_end : position) - view;
+  }
+
+  return true;
+}
+
+unsigned __int64 LineIndex::line_count() const {
+  if (0 == indexed_size_) {
+    return 0;
+  }
+
+  return new_lines_ + (ends_with_new_line_ ? 0 : 1);
+}
+
+void LineIndex::Reset() {
+  indexed_size_ = 0;
+  new_lines_ = 0;
+  ends_with_new_line_ = false;
+  fingerprint_ = 0;
+  fingerprint_length_ = 0;
+  checkpoints_.clear();
+  checkpoints_.push_back(0);
+}
+
+bool LineIndex::Update() {
+  unsigned __int64 size = file_.size();
+  unsigned __int64 offset = indexed_size_;
+
+  while (offset < size) {
+    size_t length = (size - offset > kViewSize) ? 
+      kViewSize : 
+      (size_t)(size - offset);
+
+    const char* view = file_.Map(offset, length);
+    if (nullptr == view) {
+      return false;
+    }
+
+    const char* view_end = view + length;
+    const char* position = view;
+
+    // jump from checkpoint to checkpoint - only the new lines in between
+    // are counted
+    while (position < view_end) {
+      size_t needed = kCheckpointInterval - 
+        (size_t)(new_lines_ % kCheckpointInterval);
+      size_t found = 0;
+      const char* new_line = 
+        TextScan::FindNthByte(position, view_end, '\n', needed, found);
+
+      if (nullptr == new_line) {
+        new_lines_ += found;
+        break;
+      }
+
+      new_lines_ += needed;
+      position = new_line + 1;
+      checkpoints_.push_back(offset + (position - view));
+    }
+
+    ends_with_new_line_ = ('\n' == *(view_end - 1));
+    offset += length;
+  }
+
+  indexed_size_ = size;
+
+  if (fingerprint_length_ < kFingerprintLength) {
+    fingerprint_length_ = (unsigned int)((size < kFingerprintLength) ? 
+      size : 
+      kFingerprintLength);
+    return GetFingerprint(fingerprint_length_, fingerprint_);
+  }
+
+  return true;
+}
+
+bool LineIndex::Load() {
+  MappedFile index_file;
+  if (!index_file.Open(index_filename_) || 
+      (index_file.size() < sizeof(IndexHeader))) {
+    return false;
+  }
+
+  const char* data = index_file.Map(0, (size_t)index_file.size());
+  if (nullptr == data) {
+    return false;
+  }
+
+  IndexHeader header;
+  memcpy(&header, data, sizeof(header));
+
+  // a checkpoint per |kCheckpointInterval| new lines, plus line 0 - checked
+  // before the size, so that a foreign count can't overflow it
+  if ((0 != memcmp(header.magic, kIndexMagic, sizeof(kIndexMagic))) ||
+      (kCheckpointInterval != header.checkpoint_interval) ||
+      (header.checkpoint_count != 
+        header.new_lines / kCheckpointInterval + 1) ||
+      (header.fingerprint_length > kFingerprintLength) ||
+      (header.fingerprint_length > header.indexed_size) ||
+      (index_file.size() != sizeof(header) + 
+        header.checkpoint_count * sizeof(unsigned __int64))) {
+    return false;
+  }
+
+  indexed_size_ = header.indexed_size;
+  new_lines_ = header.new_lines;
+  ends_with_new_line_ = (0 != header.ends_with_new_line);
+  fingerprint_ = header.fingerprint;
+  fingerprint_length_ = header.fingerprint_length;
+
+  checkpoints_.resize((size_t)header.checkpoint_count);
+  memcpy(
+    &checkpoints_[0], 
+    data + sizeof(header), 
+    checkpoints_.size() * sizeof(unsigned __int64));
+
+  // line 0 starts the file and every checkpoint follows the one before it,
+  // inside the indexed part
+  if (0 != checkpoints_[0]) {
+    return false;
+  }
+
+  for (size_t i = 1; i < checkpoints_.size(); i++) {
+    if (checkpoints_[i] <= checkpoints_[i - 1]) {
+      return false;
+    }
+  }
+
+  return (checkpoints_.back() <= indexed_size_);
+}
+
+bool LineIndex::Save() {
+  if (!File::CreateDirectories(GetIndexDirectory())) {
+    return false;
+  }
+
+  IndexHeader header;
+  memcpy(header.magic, kIndexMagic, sizeof(kIndexMagic));
+  header.checkpoint_interval = kCheckpointInterval;
+  header.indexed_size = indexed_size_;
+  header.new_lines = new_lines_;
+  header.fingerprint = fingerprint_;
+  header.fingerprint_length = fingerprint_length_;
+  header.ends_with_new_line = ends_with_new_line_ ? 1 : 0;
+  header.checkpoint_count = checkpoints_.size();
+
+  std::string content((const char*)&header, sizeof(header));
+  content.append(
+    (const char*)&checkpoints_[0], 
+    checkpoints_.size() * sizeof(unsigned __int64));
+
+  // write aside and replace, so a reader never sees half an index
+  std::wstring temp_filename = index_filename_ + L".tmp";
+  if (!File::WriteTextFile(temp_filename, content)) {
+    return false;
+  }
+
+  return File::RenameFile(temp_filename, index_filename_);
+}
+
+bool LineIndex::GetFingerprint(
+  size_t length, 
+  unsigned __int64& ref_fingerprint) {
+
+  ref_fingerprint = 0;
+  if (0 == length) {
+    return true;
+  }
+
+  const char* data = file_.Map(0, length);
+  if (nullptr == data) {
+    return false;
+  }
+
+  std::auto_ptr<Hasher> hasher(Hasher::Create(Hasher::ALGORITHM_XXH64));
+  hasher->Update(data, length);
+
+  std::string digest;
+  hasher->Final(digest);
+  for (size_t i = 0; i < digest.size(); i++) {
+    ref_fingerprint = (ref_fingerprint << 8) | (unsigned char)digest[i];
+  }
+
+  return true;
+}
+
+// static
+std::wstring LineIndex::GetIndexFilename(const std::wstring& filename) {
+  // one index per file - named after the hash of its path (case insensitive
+  // where the file system is)
+  std::wstring lower_filename(filename);
+#ifdef _WIN32
+  CharLowerBuffW(&lower_filename[0], (DWORD)lower_filename.size());
+#endif
+  std::string utf8_filename = Encoders::utf8_encode(lower_filename);
+
+  std::auto_ptr<Hasher> hasher(Hasher::Create(Hasher::ALGORITHM_XXH64));
+  hasher->Update(utf8_filename.c_str(), utf8_filename.size());
+
+  std::string digest;
+  std::string hex;
+  hasher->Final(digest);
+  Hasher::ToHex(digest, hex);
+
+  return GetIndexDirectory() + File::kPathSeparator + 
+         Encoders::utf8_decode(hex) + L".idx";
+}
+
+// static
+std::wstring LineIndex::GetIndexDirectory() {
+  return File::GetSpecialFolderWide(CSIDL_LOCAL_APPDATA) + 
+         File::kPathSeparator + kIndexDirectory + 
+         File::kPathSeparator + kIndexSubDirectory;
+}
\ No newline at end of file
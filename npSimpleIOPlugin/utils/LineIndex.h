@@ -0,0 +1,69 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef UTILS_LINE_INDEX_H_
+#define UTILS_LINE_INDEX_H_
+
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+
+namespace utils {
+
+// A sparse index of the lines of a (large, UTF8) text file - the offset of 
+// every |kCheckpointInterval|th line - so any line can be reached by 
+// scanning at most that many lines. The index is persisted under 
+// %LOCALAPPDATA% and only the part of the file that was added since it was
+// built is scanned (files that shrunk or whose beginning changed, e.g. a
+// rotated log, are indexed again). Lines end with "\n" or "\r\n" and a last
+// line without one is included (like |File::GetLastLines|).
+class LineIndex {
+public:
+  static const size_t kCheckpointInterval = 4096;
+
+  LineIndex();
+  virtual ~LineIndex();
+
+public:
+  // Loads the persisted index of |filename| (if any) and brings it up to 
+  // date with the file
+  bool Open(const std::wstring& filename);
+
+  // |start_line| is 0-based - lines past the end are not returned
+  bool ReadLines(
+    unsigned __int64 start_line, 
+    size_t count, 
+    std::vector<std::string>& ref_lines);
+
+  unsigned __int64 line_count() const;
+
+private:
+  void Reset();
+  bool Update();
+  bool Load();
+  bool Save();
+  bool GetFingerprint(size_t length, unsigned __int64& ref_fingerprint);
+
+  static std::wstring GetIndexFilename(const std::wstring& filename);
+  static std::wstring GetIndexDirectory();
+
+private:
+  MappedFile file_;
+  std::wstring index_filename_;
+
+  unsigned __int64 indexed_size_;
+  unsigned __int64 new_lines_; // in the indexed part
+  bool ends_with_new_line_;
+
+  // hash of the first bytes of the file - to notice it was replaced
+  unsigned __int64 fingerprint_;
+  unsigned int fingerprint_length_;
+
+  // checkpoints_[i] is the offset of line (i * kCheckpointInterval)
+  std::vector<unsigned __int64> checkpoints_;
+};
+
+}; // namespace utils
+
+#endif // UTILS_LINE_INDEX_H_
\ No newline at end of file
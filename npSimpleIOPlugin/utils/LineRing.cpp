@@ -0,0 +1,256 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#include "LineRing.h"
+
+using namespace utils;
+
+namespace {
+
+// how often a blocked producer checks if the ring was closed
+const DWORD kRoomWaitMS = 100;
+
+// slot (and consumer) buffers larger than this are freed after use, so a
+// single huge line doesn't stay allocated for good
+const size_t kMaxKeptBuffer = 64 * 1024;
+
+}; // namespace
+
+LineRing::LineRing() :
+  policy_(OVERFLOW_BLOCK),
+  capacity_(0),
+  written_(0),
+  read_(0),
+  released_(0),
+  bytes_(0),
+  holding_(0),
+  is_holding_(0),
+  coalesced_tag_(nullptr),
+  closed_(0),
+  producer_waiting_(0),
+  dropped_lines_(0),
+  coalesced_lines_(0) {
+}
+
+LineRing::~LineRing() {
+}
+
+bool LineRing::Create(size_t capacity, OverflowPolicy policy) {
+  if (capacity < 2) {
+    return false;
+  }
+
+  slots_.resize(capacity);
+  capacity_ = capacity;
+  policy_ = policy;
+  return room_event_.Create(false, false);
+}
+
+bool LineRing::Push(
+  const char* data, 
+  size_t len, 
+  bool is_error, 
+  void* tag) {
+
+  // whatever was coalesced goes before this line
+  if (!coalesced_.empty() && !FlushCoalesced()) {
+    if (!is_error && (OVERFLOW_COALESCE == policy_) && 
+        (tag == coalesced_tag_)) {
+      coalesced_.append(1, '\n');
+      coalesced_.append(data, len);
+      InterlockedIncrement(&coalesced_lines_);
+      return true;
+    }
+
+    while (!FlushCoalesced()) {
+      if (!WaitForRoom()) {
+        coalesced_.clear();
+        break;
+      }
+    }
+  }
+
+  while (!HasRoom()) {
+    if (is_error || (OVERFLOW_BLOCK == policy_)) {
+      if (!WaitForRoom()) {
+        InterlockedIncrement(&dropped_lines_);
+        return false;
+      }
+      continue;
+    }
+
+    if (OVERFLOW_COALESCE == policy_) {
+      coalesced_.assign(data, len);
+      coalesced_tag_ = tag;
+      InterlockedIncrement(&coalesced_lines_);
+      return true;
+    }
+
+    // OVERFLOW_DROP_OLDEST - the consumer may be swapping the last slot we
+    // need, which takes no time
+    if (!DropOldest() && !HasRoom()) {
+      room_event_.Wait(1);
+    }
+  }
+
+  Publish(data, len, is_error, tag);
+  return true;
+}
+
+void LineRing::set_overflow_policy(OverflowPolicy policy) {
+  policy_ = policy;
+}
+
+bool LineRing::FlushCoalesced() {
+  if (coalesced_.empty() || !HasRoom()) {
+    return false;
+  }
+
+  Publish(coalesced_.c_str(), coalesced_.size(), false, coalesced_tag_);
+  coalesced_.clear();
+  return true;
+}
+
+bool LineRing::Pop(
+  std::string& ref_data, 
+  bool& ref_is_error, 
+  void*& ref_tag) {
+
+  if (ref_data.capacity() > kMaxKeptBuffer) {
+    std::string().swap(ref_data);
+  }
+
+  for (;;) {
+    LONG read = read_;
+    if (read == written_) {
+      Release();
+      return false;
+    }
+
+    // the producer may drop |read| under us (OVERFLOW_DROP_OLDEST) - but it
+    // won't reuse the slot while we hold it
+    holding_ = read;
+    InterlockedExchange(&is_holding_, 1);
+
+    if (read != InterlockedCompareExchange(&read_, read + 1, read)) {
+      InterlockedExchange(&is_holding_, 0);
+      continue;
+    }
+
+    Slot& slot = slots_[(ULONG)read % capacity_];
+    ref_data.swap(slot.data);
+    ref_is_error = slot.is_error;
+    ref_tag = slot.tag;
+
+    InterlockedExchange(&is_holding_, 0);
+    InterlockedExchangeAdd(&bytes_, -(LONG)ref_data.size());
+    break;
+  }
+
+  Release();
+
+  if (producer_waiting_) {
+    room_event_.Signal();
+  }
+
+  return true;
+}
+
+size_t LineRing::size() const {
+  return (size_t)(ULONG)(written_ - read_);
+}
+
+size_t LineRing::bytes() const {
+  LONG bytes = bytes_;
+  return (bytes > 0) ? (size_t)bytes : 0;
+}
+
+void LineRing::Close() {
+  InterlockedExchange(&closed_, 1);
+  room_event_.Signal();
+}
+
+void LineRing::Open() {
+  InterlockedExchange(&closed_, 0);
+}
+
+unsigned __int64 LineRing::dropped_lines() const {
+  return (ULONG)dropped_lines_;
+}
+
+unsigned __int64 LineRing::coalesced_lines() const {
+  return (ULONG)coalesced_lines_;
+}
+
+bool LineRing::HasRoom() const {
+  return (ULONG)(written_ - released_) < capacity_;
+}
+
+void LineRing::Publish(
+  const char* data, 
+  size_t len, 
+  bool is_error, 
+  void* tag) {
+
+  Slot& slot = slots_[(ULONG)written_ % capacity_];
+  if ((slot.data.capacity() > kMaxKeptBuffer) && (len <= kMaxKeptBuffer)) {
+    std::string().swap(slot.data);
+  }
+
+  slot.data.assign(data, len);
+  slot.is_error = is_error;
+  slot.tag = tag;
+  InterlockedExchangeAdd(&bytes_, (LONG)len);
+
+  // the slot's content must be visible before the consumer sees it
+  InterlockedIncrement(&written_);
+}
+
+bool LineRing::DropOldest() {
+  LONG read = read_;
+  if (read == written_) {
+    Release();
+    return false;
+  }
+
+  if (read != InterlockedCompareExchange(&read_, read + 1, read)) {
+    // the consumer took it
+    return false;
+  }
+
+  Slot& slot = slots_[(ULONG)read % capacity_];
+  InterlockedExchangeAdd(&bytes_, -(LONG)slot.data.size());
+  InterlockedIncrement(&dropped_lines_);
+  Release();
+  return true;
+}
+
+bool LineRing::WaitForRoom() {
+  if (closed_) {
+    return false;
+  }
+
+  InterlockedExchange(&producer_waiting_, 1);
+  if (!HasRoom()) {
+    room_event_.Wait(kRoomWaitMS);
+  }
+  InterlockedExchange(&producer_waiting_, 0);
+
+  return !closed_;
+}
+
+void LineRing::Release() {
+  for (;;) {
+    LONG released = released_;
+    if (released == read_) {
+      return;
+    }
+
+    if (is_holding_ && (holding_ == released)) {
+      return;
+    }
+
+    InterlockedCompareExchange(&released_, released + 1, released);
+  }
+}
\ No newline at end of file
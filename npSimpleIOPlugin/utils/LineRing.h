@@ -0,0 +1,116 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef UTILS_LINE_RING_H_
+#define UTILS_LINE_RING_H_
+
+#include <string>
+#include <vector>
+#include "Event.h"
+
+namespace utils {
+
+// A bounded single producer / single consumer queue of lines, between a 
+// file reader and the thread that hands the lines to script. Slots keep 
+// their buffers between lines, and |Pop| swaps a slot's buffer with the 
+// consumer's (no copy) - so neither side allocates once the buffers grew to
+// the line lengths, and the consumer never holds a slot while it works on a
+// line.
+//
+// When the ring is full the |OverflowPolicy| decides what happens to a new
+// line. Errors are never dropped or coalesced - they wait for a free slot.
+// Every line carries an opaque |tag| (e.g. who it is for) - lines of 
+// different tags aren't coalesced.
+class LineRing {
+public:
+  enum OverflowPolicy {
+    OVERFLOW_BLOCK = 0, // the producer waits for the consumer
+    OVERFLOW_DROP_OLDEST, // the oldest line not yet popped makes room
+    OVERFLOW_COALESCE // lines are joined ('\n') until a slot frees up
+  };
+
+  LineRing();
+  virtual ~LineRing();
+
+public:
+  bool Create(size_t capacity, OverflowPolicy policy);
+
+  // only while the producer isn't pushing
+  void set_overflow_policy(OverflowPolicy policy);
+
+// producer
+public:
+  // false if the line was dropped (the ring is closed)
+  bool Push(const char* data, size_t len, bool is_error, void* tag);
+
+  // publishes the coalesced lines if there's room (call when idle) - false
+  // if there was nothing to publish or no room for it
+  bool FlushCoalesced();
+
+// consumer
+public:
+  // the oldest line - swapped into |ref_data|. false if empty.
+  bool Pop(std::string& ref_data, bool& ref_is_error, void*& ref_tag);
+
+  // lines ready to pop and their total length (may be stale by the time 
+  // they return)
+  size_t size() const;
+  size_t bytes() const;
+
+// any thread
+public:
+  // from now on |Push| doesn't wait for room - lines that don't fit are 
+  // dropped (e.g. when the listener is stopped and nobody may consume)
+  void Close();
+  void Open();
+
+  unsigned __int64 dropped_lines() const;
+  unsigned __int64 coalesced_lines() const;
+
+private:
+  struct Slot {
+    std::string data;
+    bool is_error;
+    void* tag;
+  };
+
+  bool HasRoom() const;
+  void Publish(const char* data, size_t len, bool is_error, void* tag);
+  bool DropOldest();
+  bool WaitForRoom();
+
+  // moves |released_| up to |read_| - but not past the slot the consumer
+  // is swapping. Called by both sides.
+  void Release();
+
+private:
+  std::vector<Slot> slots_;
+  OverflowPolicy policy_;
+  size_t capacity_;
+
+  // running counters - the slot of line |i| is |i| % slots_.size()
+  volatile LONG written_; // published by the producer
+  volatile LONG read_; // claimed by the consumer (or dropped)
+  volatile LONG released_; // free for the producer to reuse
+  volatile LONG bytes_; // of the lines between |read_| and |written_|
+
+  // the slot |Pop| is swapping (while |is_holding_| is set)
+  volatile LONG holding_;
+  volatile LONG is_holding_;
+
+  // producer only
+  std::string coalesced_;
+  void* coalesced_tag_;
+
+  volatile LONG closed_;
+  volatile LONG producer_waiting_;
+  Event room_event_;
+
+  volatile LONG dropped_lines_;
+  volatile LONG coalesced_lines_;
+};
+
+}; // namespace utils
+
+#endif // UTILS_LINE_RING_H_
\ No newline at end of file
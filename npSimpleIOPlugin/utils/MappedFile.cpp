@@ -0,0 +1,116 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#include "MappedFile.h"
+
+using namespace utils;
+
+// see posix/MappedFilePosix.cpp for other platforms
+#ifdef _WIN32
+namespace {
+
+DWORD GetAllocationGranularity() {
+  static DWORD granularity = 0;
+  if (0 == granularity) {
+    SYSTEM_INFO system_info;
+    GetSystemInfo(&system_info);
+    granularity = system_info.dwAllocationGranularity;
+  }
+
+  return granularity;
+}
+
+}; // namespace
+
+MappedFile::MappedFile() : size_(0) {
+}
+
+MappedFile::~MappedFile() {
+  Close();
+}
+
+bool MappedFile::Open(const std::wstring& filename) {
+  Close();
+
+  file_.Reset(CreateFileW(
+    filename.c_str(),
+    GENERIC_READ,
+    FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+    NULL,
+    OPEN_EXISTING,
+    FILE_ATTRIBUTE_NORMAL,
+    NULL));
+
+  if (!file_) {
+    return false;
+  }
+
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file_.Get(), &file_size)) {
+    Close();
+    return false;
+  }
+
+  size_ = (unsigned __int64)file_size.QuadPart;
+
+  // empty files can't be mapped - there's nothing to map anyway
+  if (0 == size_) {
+    return true;
+  }
+
+  mapping_.Reset(CreateFileMappingW(
+    file_.Get(),
+    NULL,
+    PAGE_READONLY,
+    (DWORD)(size_ >> 32),
+    (DWORD)size_,
+    NULL));
+
+  if (!mapping_) {
+    Close();
+    return false;
+  }
+
+  return true;
+}
+
+void MappedFile::Close() {
+  view_.Reset();
+  mapping_.Reset();
+  file_.Reset();
+  size_ = 0;
+}
+
+const char* MappedFile::Map(unsigned __int64 offset, size_t length) {
+  view_.Reset();
+
+  if (!mapping_ || (0 == length) || (offset >= size_) || 
+      (length > size_ - offset)) {
+    return nullptr;
+  }
+
+  // views have to start on the allocation granularity
+  unsigned __int64 view_offset = 
+    offset - (offset % GetAllocationGranularity());
+  size_t delta = (size_t)(offset - view_offset);
+
+  view_.Reset(MapViewOfFile(
+    mapping_.Get(),
+    FILE_MAP_READ,
+    (DWORD)(view_offset >> 32),
+    (DWORD)view_offset,
+    length + delta));
+
+  if (!view_) {
+    return nullptr;
+  }
+
+  return (const char*)view_.Get() + delta;
+}
+
+unsigned __int64 MappedFile::size() const {
+  return size_;
+}
+
+#endif // _WIN32
\ No newline at end of file
@@ -0,0 +1,52 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef UTILS_MAPPED_FILE_H_
+#define UTILS_MAPPED_FILE_H_
+
+#include <string>
+#include "Platform.h"
+
+#ifdef _WIN32
+#include "ScopedHandle.h"
+#endif
+
+namespace utils {
+
+// Read-only memory mapping of a file, a window (view) at a time so large
+// files don't exhaust the address space of the (32 bit) process. The file is
+// opened with full sharing so files that are still being written (logs) can
+// be mapped - |size| is a snapshot taken when the file was opened.
+class MappedFile {
+public:
+  MappedFile();
+  virtual ~MappedFile();
+
+public:
+  bool Open(const std::wstring& filename);
+  void Close();
+
+  // Maps [offset, offset + length) and returns a pointer to |offset| - the 
+  // previous view is unmapped. Returns nullptr on failure or if the range is
+  // outside of the file.
+  const char* Map(unsigned __int64 offset, size_t length);
+
+  unsigned __int64 size() const;
+
+private:
+#ifdef _WIN32
+  FileScopedHandle file_;
+  MappingScopedHandle mapping_;
+  ViewOfFileScopedHandle view_;
+#else
+  int file_;
+  void* view_;
+  size_t view_length_;
+#endif
+  unsigned __int64 size_;
+};
+
+}; // namespace utils
+
+#endif // UTILS_MAPPED_FILE_H_
\ No newline at end of file
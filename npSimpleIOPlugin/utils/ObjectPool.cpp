@@ -0,0 +1,69 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#include "ObjectPool.h"
+
+#include <new>
+
+using namespace utils;
+
+ObjectPool::ObjectPool(size_t max_free) :
+  block_size_(0),
+  max_free_(max_free),
+  allocations_(0),
+  reuses_(0) {
+  free_.reserve(max_free);
+}
+
+ObjectPool::~ObjectPool() {
+  for (size_t i = 0; i < free_.size(); i++) {
+    ::operator delete(free_[i]);
+  }
+}
+
+void* ObjectPool::Allocate(size_t size) {
+  {
+    CriticalSectionLock lock(critical_section_);
+    if (0 == block_size_) {
+      block_size_ = size;
+    }
+
+    if ((size == block_size_) && !free_.empty()) {
+      void* block = free_.back();
+      free_.pop_back();
+      reuses_++;
+      return block;
+    }
+
+    allocations_++;
+  }
+
+  return ::operator new(size);
+}
+
+void ObjectPool::Free(void* block, size_t size) {
+  if (nullptr == block) {
+    return;
+  }
+
+  {
+    CriticalSectionLock lock(critical_section_);
+
+    // |free_| has room reserved - push_back doesn't allocate
+    if ((size == block_size_) && (free_.size() < max_free_)) {
+      free_.push_back(block);
+      return;
+    }
+  }
+
+  ::operator delete(block);
+}
+
+unsigned __int64 ObjectPool::allocations() const {
+  return allocations_;
+}
+
+unsigned __int64 ObjectPool::reuses() const {
+  return reuses_;
+}
\ No newline at end of file
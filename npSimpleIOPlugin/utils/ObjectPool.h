@@ -0,0 +1,74 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef UTILS_OBJECT_POOL_H_
+#define UTILS_OBJECT_POOL_H_
+
+#include <vector>
+#include "CriticalSectionLock.h"
+
+namespace utils {
+
+// A free list of same size blocks, for objects that are created and 
+// destroyed at a high rate (e.g. a method clone per script call). Freed 
+// blocks are kept (up to |max_free|) for the next |Allocate| instead of 
+// going back to the heap. See |Pooled|.
+class ObjectPool {
+public:
+  static const size_t kDefaultMaxFree = 64;
+
+  ObjectPool(size_t max_free);
+  virtual ~ObjectPool();
+
+public:
+  // throws std::bad_alloc, like operator new
+  void* Allocate(size_t size);
+  void Free(void* block, size_t size);
+
+  unsigned __int64 allocations() const; // from the heap
+  unsigned __int64 reuses() const; // from the free list
+
+private:
+  CriticalSection critical_section_;
+  std::vector<void*> free_;
+  size_t block_size_; // of the first allocation - others go to the heap
+  size_t max_free_;
+  unsigned __int64 allocations_;
+  unsigned __int64 reuses_;
+};
+
+// Derive from Pooled<T> (T being the deriving class) to allocate T from a 
+// free list of its own:
+//
+//   class PluginMethodFileExists : 
+//     public PluginMethod, 
+//     public utils::Pooled<PluginMethodFileExists> {
+//
+// Deleting through a base pointer is fine as long as the base has a virtual
+// destructor (the size passed to |operator delete| is then T's).
+template <class T>
+class Pooled {
+public:
+  static void* operator new(size_t size) {
+    return pool_.Allocate(size);
+  }
+
+  static void operator delete(void* block, size_t size) {
+    pool_.Free(block, size);
+  }
+
+  static const ObjectPool& pool() {
+    return pool_;
+  }
+
+private:
+  static ObjectPool pool_;
+};
+
+template <class T>
+ObjectPool Pooled<T>::pool_(ObjectPool::kDefaultMaxFree);
+
+}; // namespace utils
+
+#endif // UTILS_OBJECT_POOL_H_
\ No newline at end of file
@@ -0,0 +1,111 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef UTILS_PLATFORM_H_
+#define UTILS_PLATFORM_H_
+
+// The core (utils) is written against the Win32 types and the few Win32
+// functions below - on other platforms they are provided here, so only the
+// platform specific classes need a second (utils/posix) implementation.
+#ifdef _WIN32
+
+#include <Windows.h>
+
+// printf formats of (unsigned) __int64
+#define FORMAT_INT64 "I64d"
+#define FORMAT_UINT64 "I64u"
+
+#else // _WIN32
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef __int64
+#define __int64 long long
+#endif
+
+typedef uint32_t DWORD;
+typedef int32_t LONG;
+typedef int64_t LONGLONG;
+typedef uint32_t ULONG;
+typedef unsigned char BYTE;
+typedef int BOOL;
+
+#ifndef TRUE
+#define TRUE 1
+#define FALSE 0
+#endif
+
+#ifndef INFINITE
+#define INFINITE 0xFFFFFFFF
+#endif
+
+#define FORMAT_INT64 "lld"
+#define FORMAT_UINT64 "llu"
+
+// the secure CRT's array overload - |buffer| must be an array
+#define sprintf_s(buffer, ...) snprintf((buffer), sizeof(buffer), __VA_ARGS__)
+
+inline LONG InterlockedIncrement(volatile LONG* value) {
+  return __sync_add_and_fetch(value, 1);
+}
+
+inline LONG InterlockedDecrement(volatile LONG* value) {
+  return __sync_sub_and_fetch(value, 1);
+}
+
+inline LONG InterlockedExchangeAdd(volatile LONG* value, LONG add) {
+  return __sync_fetch_and_add(value, add);
+}
+
+inline LONGLONG InterlockedExchangeAdd64(volatile LONGLONG* value, 
+                                         LONGLONG add) {
+  return __sync_fetch_and_add(value, add);
+}
+
+inline LONG InterlockedCompareExchange(volatile LONG* value, 
+                                       LONG exchange, 
+                                       LONG comperand) {
+  return __sync_val_compare_and_swap(value, comperand, exchange);
+}
+
+inline LONG InterlockedExchange(volatile LONG* value, LONG exchange) {
+  __sync_synchronize();
+  return __sync_lock_test_and_set(value, exchange);
+}
+
+inline void* InterlockedCompareExchangePointer(void* volatile* value, 
+                                               void* exchange, 
+                                               void* comperand) {
+  return __sync_val_compare_and_swap(value, comperand, exchange);
+}
+
+inline void* InterlockedExchangePointer(void* volatile* value, 
+                                        void* exchange) {
+  __sync_synchronize();
+  return __sync_lock_test_and_set(value, exchange);
+}
+
+inline void MemoryBarrier() {
+  __sync_synchronize();
+}
+
+inline DWORD GetCurrentThreadId() {
+  return (DWORD)syscall(SYS_gettid);
+}
+
+// milliseconds of a monotonic clock - wraps like the Win32 one
+inline DWORD GetTickCount() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (DWORD)((uint64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000);
+}
+
+#endif // _WIN32
+
+#endif // UTILS_PLATFORM_H_
\ No newline at end of file
@@ -0,0 +1,245 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#include "RequestStats.h"
+#include "Encoders.h"
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace utils;
+
+namespace {
+
+// latencies are kept as LONGs
+const unsigned __int64 kMaxLatency = 0x7FFFFFFF;
+
+void UpdateMax(volatile LONG& ref_max, LONG value) {
+  LONG current = ref_max;
+  while (value > current) {
+    LONG previous = InterlockedCompareExchange(&ref_max, value, current);
+    if (previous == current) {
+      break;
+    }
+    current = previous;
+  }
+}
+
+void AppendNumber(
+  const char* name, 
+  double value, 
+  bool first, 
+  std::string& ref_output) {
+  char buffer[64];
+  sprintf(buffer, "%s\"%s\":%.0f", first ? "" : ",", name, value);
+  ref_output += buffer;
+}
+
+}; // namespace
+
+//-----------------------------------------------------------------------------
+LatencyHistogram::LatencyHistogram() : max_(0) {
+  memset((void*)counts_, 0, sizeof(counts_));
+}
+
+void LatencyHistogram::Record(unsigned __int64 microseconds) {
+  if (microseconds > kMaxLatency) {
+    microseconds = kMaxLatency;
+  }
+
+  InterlockedIncrement(&counts_[BucketOf(microseconds)]);
+  UpdateMax(max_, (LONG)microseconds);
+}
+
+void LatencyHistogram::Accumulate(
+  unsigned __int64* ref_counts, 
+  LONG& ref_max) const {
+
+  for (size_t i = 0; i < kBuckets; i++) {
+    ref_counts[i] += (unsigned long)counts_[i];
+  }
+
+  if (max_ > ref_max) {
+    ref_max = max_;
+  }
+}
+
+// static
+void LatencyHistogram::Summarize(
+  const unsigned __int64* counts, 
+  LONG max, 
+  Summary& ref_summary) {
+
+  memset(&ref_summary, 0, sizeof(ref_summary));
+
+  for (size_t i = 0; i < kBuckets; i++) {
+    ref_summary.count += counts[i];
+  }
+
+  if (0 == ref_summary.count) {
+    return;
+  }
+
+  const double kPercentiles[] = { 0.50, 0.90, 0.99 };
+  double* values[] = { 
+    &ref_summary.p50, 
+    &ref_summary.p90, 
+    &ref_summary.p99 
+  };
+
+  size_t percentile = 0;
+  unsigned __int64 seen = 0;
+  for (size_t i = 0; (i < kBuckets) && (percentile < 3); i++) {
+    seen += counts[i];
+    while ((percentile < 3) && 
+           (seen >= kPercentiles[percentile] * ref_summary.count)) {
+      double value = BucketMiddle(i);
+      *values[percentile++] = (value < max) ? value : max;
+    }
+  }
+
+  ref_summary.max = max;
+}
+
+// static
+size_t LatencyHistogram::BucketOf(unsigned __int64 microseconds) {
+  if (microseconds < 16) {
+    return (size_t)microseconds;
+  }
+
+  // position of the highest set bit (>= 4)
+  size_t msb = 4;
+  while ((microseconds >> (msb + 1)) != 0) {
+    msb++;
+  }
+
+  // the 3 bits below it pick the bucket within the power of two
+  size_t sub_bucket = (size_t)(microseconds >> (msb - 3)) & 7;
+  return 16 + ((msb - 4) * 8) + sub_bucket;
+}
+
+// static
+double LatencyHistogram::BucketMiddle(size_t bucket) {
+  if (bucket < 16) {
+    return (double)bucket;
+  }
+
+  size_t msb = 4 + ((bucket - 16) / 8);
+  size_t sub_bucket = (bucket - 16) % 8;
+  double width = (double)((unsigned __int64)1 << (msb - 3));
+  return (8 + sub_bucket) * width + (width / 2);
+}
+
+//-----------------------------------------------------------------------------
+RequestStats::RequestStats(const std::string& name) : 
+  name_(name),
+  queued_(0),
+  max_queued_(0) {
+  for (size_t i = 0; i < kStripes; i++) {
+    stripes_[i].calls = 0;
+    stripes_[i].errors = 0;
+    stripes_[i].cancelled = 0;
+    stripes_[i].bytes = 0;
+  }
+}
+
+void RequestStats::OnQueued() {
+  InterlockedIncrement(&CurrentStripe().calls);
+  UpdateMax(max_queued_, InterlockedIncrement(&queued_));
+}
+
+void RequestStats::OnStarted() {
+  InterlockedDecrement(&queued_);
+}
+
+void RequestStats::OnCompleted(
+  bool succeeded, 
+  unsigned __int64 bytes, 
+  const unsigned __int64* durations_us) {
+
+  Stripe& stripe = CurrentStripe();
+
+  if (!succeeded) {
+    InterlockedIncrement(&stripe.errors);
+  }
+
+  if (0 != bytes) {
+    InterlockedExchangeAdd64(&stripe.bytes, (LONGLONG)bytes);
+  }
+
+  for (size_t i = 0; i < STAGES_COUNT; i++) {
+    stripe.stages[i].Record(durations_us[i]);
+  }
+}
+
+void RequestStats::OnCancelled() {
+  InterlockedIncrement(&CurrentStripe().cancelled);
+}
+
+LONG RequestStats::queued() const {
+  return queued_;
+}
+
+const std::string& RequestStats::name() const {
+  return name_;
+}
+
+void RequestStats::AppendJson(std::string& ref_output) const {
+  static const char* kStageNames[STAGES_COUNT] = {
+    "queueUs",
+    "executeUs",
+    "callbackUs",
+    "totalUs"
+  };
+
+  double calls = 0;
+  double errors = 0;
+  double cancelled = 0;
+  double bytes = 0;
+  for (size_t i = 0; i < kStripes; i++) {
+    calls += stripes_[i].calls;
+    errors += stripes_[i].errors;
+    cancelled += stripes_[i].cancelled;
+    bytes += (double)stripes_[i].bytes;
+  }
+
+  Encoders::json_append_string(name_.c_str(), name_.size(), ref_output);
+  ref_output += ":{";
+  AppendNumber("calls", calls, true, ref_output);
+  AppendNumber("errors", errors, false, ref_output);
+  AppendNumber("cancelled", cancelled, false, ref_output);
+  AppendNumber("bytes", bytes, false, ref_output);
+  AppendNumber("queued", queued_, false, ref_output);
+  AppendNumber("maxQueued", max_queued_, false, ref_output);
+
+  for (size_t stage = 0; stage < STAGES_COUNT; stage++) {
+    unsigned __int64 counts[LatencyHistogram::kBuckets] = { 0 };
+    LONG max = 0;
+    for (size_t i = 0; i < kStripes; i++) {
+      stripes_[i].stages[stage].Accumulate(counts, max);
+    }
+
+    LatencyHistogram::Summary summary;
+    LatencyHistogram::Summarize(counts, max, summary);
+
+    ref_output += ",\"";
+    ref_output += kStageNames[stage];
+    ref_output += "\":{";
+    AppendNumber("count", (double)summary.count, true, ref_output);
+    AppendNumber("p50", summary.p50, false, ref_output);
+    AppendNumber("p90", summary.p90, false, ref_output);
+    AppendNumber("p99", summary.p99, false, ref_output);
+    AppendNumber("max", summary.max, false, ref_output);
+    ref_output += '}';
+  }
+
+  ref_output += '}';
+}
+
+RequestStats::Stripe& RequestStats::CurrentStripe() {
+  // thread ids are multiples of 4 on Windows - spread them with a 
+  // multiplicative hash
+  DWORD hash = (DWORD)(GetCurrentThreadId() * 2654435761U);
+  return stripes_[(hash >> 28) % kStripes];
+}
\ No newline at end of file
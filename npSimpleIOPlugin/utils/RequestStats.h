@@ -0,0 +1,113 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef UTILS_REQUEST_STATS_H_
+#define UTILS_REQUEST_STATS_H_
+
+#include <string>
+#include "Platform.h"
+
+namespace utils {
+
+// A log-linear histogram of latencies in microseconds - exact below 16us,
+// 8 buckets per power of two above that (at most 12.5% off) and up to
+// ~35 minutes. |Record| is lock free and can be called from any thread.
+class LatencyHistogram {
+public:
+  struct Summary {
+    unsigned __int64 count;
+    double p50;
+    double p90;
+    double p99;
+    double max;
+  };
+
+  LatencyHistogram();
+
+public:
+  void Record(unsigned __int64 microseconds);
+
+  // adds this histogram's counts to |ref_counts| (|kBuckets| long)
+  void Accumulate(unsigned __int64* ref_counts, LONG& ref_max) const;
+
+  static void Summarize(
+    const unsigned __int64* counts, 
+    LONG max, 
+    Summary& ref_summary);
+
+  static const size_t kBuckets = 16 + 28 * 8;
+
+private:
+  static size_t BucketOf(unsigned __int64 microseconds);
+  static double BucketMiddle(size_t bucket);
+
+private:
+  volatile LONG counts_[kBuckets];
+  volatile LONG max_;
+};
+
+// The statistics of a single plugin method. Every request is timestamped 
+// when it's invoked, when its task starts and ends on the worker thread and
+// when its callback ran - so its latency is split between queueing, the
+// work itself and the wait for the browser thread to run the callback.
+//
+// Counters are striped by thread (each thread mostly updates its own cache
+// lines) and updated with interlocked operations - nothing here blocks.
+class RequestStats {
+public:
+  enum Stage {
+    STAGE_QUEUE = 0, // invoke -> task started
+    STAGE_EXECUTE, // task started -> task ended
+    STAGE_CALLBACK, // task ended -> callback returned
+    STAGE_TOTAL, // invoke -> callback returned
+    STAGES_COUNT
+  };
+
+  RequestStats(const std::string& name);
+
+public:
+  // the request was posted to the worker thread
+  void OnQueued();
+  // the worker thread picked it up
+  void OnStarted();
+  // |durations_us| - one per |Stage|
+  void OnCompleted(
+    bool succeeded, 
+    unsigned __int64 bytes, 
+    const unsigned __int64* durations_us);
+  // the request was cancelled (instead of |OnCompleted| - its latencies 
+  // aren't recorded)
+  void OnCancelled();
+
+  // requests waiting in the queue right now
+  LONG queued() const;
+
+  const std::string& name() const;
+
+  // appends "name":{...} to |ref_output|
+  void AppendJson(std::string& ref_output) const;
+
+private:
+  static const size_t kStripes = 4;
+
+  struct Stripe {
+    volatile LONG calls;
+    volatile LONG errors;
+    volatile LONG cancelled;
+    volatile LONGLONG bytes;
+    LatencyHistogram stages[STAGES_COUNT];
+  };
+
+  Stripe& CurrentStripe();
+
+private:
+  std::string name_;
+  Stripe stripes_[kStripes];
+  volatile LONG queued_;
+  volatile LONG max_queued_;
+};
+
+}; // namespace utils
+
+#endif // UTILS_REQUEST_STATS_H_
\ No newline at end of file
@@ -0,0 +1,37 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef UTILS_STRING_VIEW_H_
+#define UTILS_STRING_VIEW_H_
+
+#include <string>
+
+namespace utils {
+
+// A string owned by someone else (e.g. an |Arena|) - a pointer and a length.
+// The strings |Arena| hands out are also NUL terminated.
+struct StringView {
+  StringView() : data(""), size(0) {
+  }
+
+  StringView(const char* view_data, size_t view_size) : 
+    data(view_data), 
+    size(view_size) {
+  }
+
+  bool empty() const {
+    return (0 == size);
+  }
+
+  std::string str() const {
+    return std::string(data, size);
+  }
+
+  const char* data;
+  size_t size;
+};
+
+}; // namespace utils
+
+#endif // UTILS_STRING_VIEW_H_
\ No newline at end of file
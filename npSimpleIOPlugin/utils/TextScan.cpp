@@ -0,0 +1,268 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#include "TextScan.h"
+
+#include <string.h>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#define TEXT_SCAN_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+using namespace utils;
+
+namespace {
+
+inline unsigned char ToLower(unsigned char c) {
+  return ((c >= 'A') && (c <= 'Z')) ? (c + ('a' - 'A')) : c;
+}
+
+inline bool IsLetter(unsigned char c) {
+  return (ToLower(c) >= 'a') && (ToLower(c) <= 'z');
+}
+
+inline bool EqualsIgnoreCase(const char* a, const char* b, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    if (ToLower(a[i]) != ToLower(b[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+inline unsigned int LowestBit(unsigned int mask) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return index;
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+
+inline unsigned int HighestBit(unsigned int mask) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanReverse(&index, mask);
+  return index;
+#else
+  return 31 - __builtin_clz(mask);
+#endif
+}
+
+inline unsigned int PopCount(unsigned int mask) {
+  mask = mask - ((mask >> 1) & 0x55555555);
+  mask = (mask & 0x33333333) + ((mask >> 2) & 0x33333333);
+  return (((mask + (mask >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+}
+
+#ifdef TEXT_SCAN_USE_SSE2
+
+// compares 16 bytes against |c| - with |fold| set, letters are compared
+// after setting their 0x20 bit (lower case); other bytes may then match
+// falsely, so callers must verify
+inline unsigned int MatchMask(const char* p, __m128i c, bool fold) {
+  __m128i block = _mm_loadu_si128((const __m128i*)p);
+  if (fold) {
+    block = _mm_or_si128(block, _mm_set1_epi8(0x20));
+  }
+  return (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(block, c));
+}
+
+#endif // TEXT_SCAN_USE_SSE2
+
+}; // namespace
+
+// static
+const char* TextScan::FindByte(const char* begin, const char* end, char c) {
+  if (begin >= end) {
+    return nullptr;
+  }
+
+  // the CRT version is already vectorized
+  return (const char*)memchr(begin, c, end - begin);
+}
+
+// static
+const char* TextScan::FindLastByte(
+  const char* begin, 
+  const char* end, 
+  char c) {
+
+  const char* p = end;
+
+#ifdef TEXT_SCAN_USE_SSE2
+  __m128i value = _mm_set1_epi8(c);
+  while (p - begin >= 16) {
+    p -= 16;
+    unsigned int mask = MatchMask(p, value, false);
+    if (0 != mask) {
+      return p + HighestBit(mask);
+    }
+  }
+#endif // TEXT_SCAN_USE_SSE2
+
+  while (p > begin) {
+    p--;
+    if (c == *p) {
+      return p;
+    }
+  }
+
+  return nullptr;
+}
+
+// static
+size_t TextScan::CountByte(const char* begin, const char* end, char c) {
+  size_t count = 0;
+  const char* p = begin;
+
+#ifdef TEXT_SCAN_USE_SSE2
+  __m128i value = _mm_set1_epi8(c);
+
+  while (end - p >= 16) {
+    // 8 bit counters - flush them before they can overflow
+    __m128i counters = _mm_setzero_si128();
+    size_t blocks = (size_t)(end - p) / 16;
+    if (blocks > 255) {
+      blocks = 255;
+    }
+
+    for (size_t i = 0; i < blocks; i++, p += 16) {
+      __m128i block = _mm_loadu_si128((const __m128i*)p);
+      counters = _mm_sub_epi8(counters, _mm_cmpeq_epi8(block, value));
+    }
+
+    __m128i sums = _mm_sad_epu8(counters, _mm_setzero_si128());
+    count += (size_t)_mm_cvtsi128_si32(sums) + 
+             (size_t)_mm_cvtsi128_si32(_mm_srli_si128(sums, 8));
+  }
+#endif // TEXT_SCAN_USE_SSE2
+
+  for (; p < end; p++) {
+    if (c == *p) {
+      count++;
+    }
+  }
+
+  return count;
+}
+
+// static
+const char* TextScan::FindNthByte(
+  const char* begin, 
+  const char* end, 
+  char c, 
+  size_t n, 
+  size_t& ref_found) {
+
+  ref_found = 0;
+  if (0 == n) {
+    return nullptr;
+  }
+
+  const char* p = begin;
+
+#ifdef TEXT_SCAN_USE_SSE2
+  __m128i value = _mm_set1_epi8(c);
+
+  while (end - p >= 16) {
+    unsigned int mask = MatchMask(p, value, false);
+    unsigned int found = PopCount(mask);
+
+    if (ref_found + found >= n) {
+      // it's in this block
+      while (true) {
+        unsigned int bit = LowestBit(mask);
+        if (++ref_found == n) {
+          return p + bit;
+        }
+        mask &= mask - 1;
+      }
+    }
+
+    ref_found += found;
+    p += 16;
+  }
+#endif // TEXT_SCAN_USE_SSE2
+
+  for (; p < end; p++) {
+    if ((c == *p) && (++ref_found == n)) {
+      return p;
+    }
+  }
+
+  return nullptr;
+}
+
+// static
+const char* TextScan::FindSubstring(
+  const char* begin, 
+  const char* end, 
+  const char* needle, 
+  size_t needle_len,
+  bool ignore_case) {
+
+  if (0 == needle_len) {
+    return begin;
+  }
+
+  if ((size_t)(end - begin) < needle_len) {
+    return nullptr;
+  }
+
+  if ((1 == needle_len) && 
+      (!ignore_case || !IsLetter((unsigned char)needle[0]))) {
+    return FindByte(begin, end, needle[0]);
+  }
+
+  const char* last_start = end - needle_len;
+  const char* p = begin;
+
+#ifdef TEXT_SCAN_USE_SSE2
+  // compare the first and last byte of the needle at 16 positions at once
+  // and only verify the positions where both match
+  unsigned char first = (unsigned char)needle[0];
+  unsigned char last = (unsigned char)needle[needle_len - 1];
+  bool fold_first = ignore_case && IsLetter(first);
+  bool fold_last = ignore_case && IsLetter(last);
+  __m128i first_value = _mm_set1_epi8((char)(fold_first ? ToLower(first) : first));
+  __m128i last_value = _mm_set1_epi8((char)(fold_last ? ToLower(last) : last));
+
+  while (last_start - p >= 15) {
+    unsigned int mask = 
+      MatchMask(p, first_value, fold_first) &
+      MatchMask(p + needle_len - 1, last_value, fold_last);
+
+    while (0 != mask) {
+      const char* candidate = p + LowestBit(mask);
+      bool equal = ignore_case ?
+        EqualsIgnoreCase(candidate, needle, needle_len) :
+        (0 == memcmp(candidate, needle, needle_len));
+      if (equal) {
+        return candidate;
+      }
+      mask &= mask - 1;
+    }
+
+    p += 16;
+  }
+#endif // TEXT_SCAN_USE_SSE2
+
+  for (; p <= last_start; p++) {
+    bool equal = ignore_case ?
+      EqualsIgnoreCase(p, needle, needle_len) :
+      (0 == memcmp(p, needle, needle_len));
+    if (equal) {
+      return p;
+    }
+  }
+
+  return nullptr;
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef UTILS_TEXT_SCAN_H_
+#define UTILS_TEXT_SCAN_H_
+
+#include <stddef.h>
+
+namespace utils {
+
+// Vectorized (SSE2) scanning primitives for text buffers - used to split
+// lines, count them and search within them
+class TextScan {
+public:
+  // first/last occurrence of |c| in [begin, end) - nullptr if not found
+  static const char* FindByte(const char* begin, const char* end, char c);
+  static const char* FindLastByte(const char* begin, const char* end, char c);
+
+  static size_t CountByte(const char* begin, const char* end, char c);
+
+  // Returns a pointer to the |n|th (1-based) occurrence of |c| - nullptr if
+  // there are less than |n| and then |ref_found| holds how many there are
+  static const char* FindNthByte(
+    const char* begin, 
+    const char* end, 
+    char c, 
+    size_t n, 
+    size_t& ref_found);
+
+  // first occurrence of |needle| in [begin, end) - nullptr if not found.
+  // |ignore_case| only applies to ASCII letters.
+  static const char* FindSubstring(
+    const char* begin, 
+    const char* end, 
+    const char* needle, 
+    size_t needle_len,
+    bool ignore_case);
+};
+
+}; // namespace utils
+
+#endif // UTILS_TEXT_SCAN_H_
\ No newline at end of file
@@ -6,6 +6,8 @@
 
 using namespace utils;
 
+// see posix/ThreadPosix.cpp for other platforms
+#ifdef _WIN32
 const DWORD kStopThreadTimeoutMS = 10000;
 
 Thread::Thread() : 
@@ -106,6 +108,8 @@ void Thread::DestroyEvents() {
   }
 }
 
+#endif // _WIN32
+
 void Thread::ClearQueue() {
   CriticalSectionLock lock(queue_critical_section_);
 
@@ -113,6 +117,7 @@ void Thread::ClearQueue() {
   std::swap(task_queue_, empty_queue);
 }
 
+#ifdef _WIN32
 void Thread::HandleNewTaskEvent() {
   while (!task_queue_.empty()) {
     Task task;
@@ -172,3 +177,5 @@ DWORD WINAPI Thread::ThreadProc(IN LPVOID lpParameter_) {
   
   return 0;
 }
+
+#endif // _WIN32
\ No newline at end of file
@@ -7,7 +7,7 @@
 
 #include <queue>
 #include <functional>
-#include <Windows.h>
+#include "Platform.h"
 #include "CriticalSectionLock.h"
 
 namespace utils {
@@ -25,14 +25,20 @@ public:
   bool PostTask(Task task_func);
 
 private:
+  void ClearQueue();
+
+#ifdef _WIN32
   bool CreateEvents();
   void DestroyEvents();
-  void ClearQueue();
   void HandleNewTaskEvent();
 
   static DWORD WINAPI ThreadProc(IN LPVOID lpParameter_);
+#else
+  static void* ThreadProc(void* param);
+#endif
 
 private:
+#ifdef _WIN32
   enum ThreadEvents {
     EVENT_STOP = 0,
     EVENT_NEW_TASK,
@@ -45,6 +51,15 @@ private:
 
   // thread running the server
   HANDLE thread_;
+#else
+  pthread_t thread_;
+  bool running_;
+
+  // guards |stopping_| and the queue together with |queue_critical_section_|
+  // so the thread can wait for new tasks
+  pthread_mutex_t wait_mutex_;
+  pthread_cond_t wait_condition_;
+#endif
 
   bool stopping_;
 
@@ -0,0 +1,86 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#include "ThreadPool.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+using namespace utils;
+
+// I/O bound work - more threads than this just thrash the disk
+const size_t kMaxPoolThreads = 8;
+
+ThreadPool::ThreadPool() : 
+  next_thread_(0) {
+}
+
+ThreadPool::~ThreadPool() {
+  Stop();
+}
+
+bool ThreadPool::Start(size_t count) {
+  if (!threads_.empty()) {
+    return false;
+  }
+
+  if (0 == count) {
+#ifdef _WIN32
+    SYSTEM_INFO system_info;
+    GetSystemInfo(&system_info);
+    count = system_info.dwNumberOfProcessors;
+#else
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    count = (processors > 0) ? (size_t)processors : 1;
+#endif
+  }
+
+  if (count > kMaxPoolThreads) {
+    count = kMaxPoolThreads;
+  }
+
+  if (0 == count) {
+    count = 1;
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    Thread* thread = new Thread();
+    if (!thread->Start()) {
+      delete thread;
+      Stop();
+      return false;
+    }
+
+    threads_.push_back(thread);
+  }
+
+  return true;
+}
+
+bool ThreadPool::Stop() {
+  bool ret = true;
+
+  std::vector<Thread*>::iterator iter = threads_.begin();
+  for (; iter != threads_.end(); ++iter) {
+    ret &= (*iter)->Stop();
+    delete *iter;
+  }
+
+  threads_.clear();
+  return ret;
+}
+
+bool ThreadPool::PostTask(Thread::Task task_func) {
+  if (threads_.empty()) {
+    return false;
+  }
+
+  LONG index = InterlockedIncrement(&next_thread_);
+  return threads_[(ULONG)index % threads_.size()]->PostTask(task_func);
+}
+
+size_t ThreadPool::size() const {
+  return threads_.size();
+}
\ No newline at end of file
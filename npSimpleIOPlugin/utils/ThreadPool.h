@@ -0,0 +1,34 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef UTILS_THREAD_POOL_H_
+#define UTILS_THREAD_POOL_H_
+
+#include <vector>
+#include "Thread.h"
+
+namespace utils {
+
+// A fixed number of |Thread|s - tasks are handed out round-robin
+class ThreadPool {
+public:
+  ThreadPool();
+  virtual ~ThreadPool();
+
+public:
+  // |count| == 0 means one thread per core
+  bool Start(size_t count = 0);
+  bool Stop();
+  bool PostTask(Thread::Task task_func);
+
+  size_t size() const;
+
+private:
+  std::vector<Thread*> threads_;
+  volatile LONG next_thread_;
+};
+
+}; // namespace utils
+
+#endif // UTILS_THREAD_POOL_H_
\ No newline at end of file
@@ -0,0 +1,210 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#include "Trace.h"
+#include "Clock.h"
+#include "CriticalSectionLock.h"
+#include "Encoders.h"
+
+#include <new>
+#include <stdio.h>
+#include <string.h>
+
+using namespace utils;
+
+struct Trace::Span {
+  // 0 while being written, the (1-based) write index once published
+  volatile LONG sequence;
+
+  char name[kMaxNameLength + 1];
+  const char* category;
+  unsigned __int64 start_us;
+  unsigned __int64 end_us;
+  DWORD thread_id;
+  bool async;
+  unsigned int id;
+};
+
+volatile LONG Trace::enabled_ = 0;
+volatile LONG Trace::next_ = 0;
+Trace::Span* Trace::spans_ = nullptr;
+size_t Trace::capacity_ = 0;
+
+namespace {
+
+// only guards the allocation of the ring - recording never takes it
+CriticalSection g_enable_critical_section;
+
+void AppendEvent(
+  const char* name,
+  const char* category,
+  char phase,
+  unsigned __int64 timestamp_us,
+  const unsigned __int64* duration_us,
+  DWORD thread_id,
+  const unsigned int* id,
+  std::string& ref_output) {
+
+  ref_output += "{\"name\":";
+  Encoders::json_append_string(name, strlen(name), ref_output);
+  ref_output += ",\"cat\":";
+  Encoders::json_append_string(category, strlen(category), ref_output);
+
+  char buffer[128];
+  sprintf(buffer, ",\"ph\":\"%c\",\"ts\":%.0f,\"pid\":1,\"tid\":%u", 
+          phase, (double)timestamp_us, (unsigned int)thread_id);
+  ref_output += buffer;
+
+  if (nullptr != duration_us) {
+    sprintf(buffer, ",\"dur\":%.0f", (double)*duration_us);
+    ref_output += buffer;
+  }
+
+  if (nullptr != id) {
+    sprintf(buffer, ",\"id\":%u", *id);
+    ref_output += buffer;
+  }
+
+  ref_output += '}';
+}
+
+}; // namespace
+
+// static
+bool Trace::Enable(size_t capacity) {
+  CriticalSectionLock lock(g_enable_critical_section);
+
+  if (nullptr == spans_) {
+    size_t rounded = 1024;
+    while ((rounded < capacity) && (rounded < 1024 * 1024)) {
+      rounded *= 2;
+    }
+
+    spans_ = new (std::nothrow) Span[rounded];
+    if (nullptr == spans_) {
+      return false;
+    }
+
+    memset(spans_, 0, sizeof(Span) * rounded);
+    capacity_ = rounded;
+  }
+
+  InterlockedExchange(&enabled_, 1);
+  return true;
+}
+
+// static
+void Trace::Disable() {
+  // the ring stays - a writer that saw the flag just before may still use it
+  InterlockedExchange(&enabled_, 0);
+}
+
+// static
+void Trace::AddSpan(
+  const char* name, 
+  const char* category, 
+  unsigned __int64 start_us, 
+  unsigned __int64 end_us) {
+  Add(name, category, start_us, end_us, false, 0);
+}
+
+// static
+void Trace::AddAsyncSpan(
+  const char* name, 
+  const char* category, 
+  unsigned __int64 start_us, 
+  unsigned __int64 end_us,
+  unsigned int id) {
+  Add(name, category, start_us, end_us, true, id);
+}
+
+// static
+void Trace::Add(
+  const char* name, 
+  const char* category, 
+  unsigned __int64 start_us, 
+  unsigned __int64 end_us,
+  bool async,
+  unsigned int id) {
+
+  if (!IsEnabled() || (nullptr == spans_)) {
+    return;
+  }
+
+  ULONG index = (ULONG)InterlockedIncrement(&next_);
+  Span& span = spans_[(index - 1) & (capacity_ - 1)];
+
+  InterlockedExchange(&span.sequence, 0);
+  strncpy(span.name, name, kMaxNameLength);
+  span.name[kMaxNameLength] = '\0';
+  span.category = category;
+  span.start_us = start_us;
+  span.end_us = (end_us > start_us) ? end_us : start_us;
+  span.thread_id = GetCurrentThreadId();
+  span.async = async;
+  span.id = id;
+
+  // publish (InterlockedExchange is a full barrier)
+  InterlockedExchange(&span.sequence, (LONG)index);
+}
+
+// static
+void Trace::Dump(std::string& ref_output) {
+  ref_output = "{\"traceEvents\":[";
+
+  // oldest first
+  ULONG next = (nullptr != spans_) ? (ULONG)next_ : 0;
+  ULONG count = (next < capacity_) ? next : (ULONG)capacity_;
+
+  bool first = true;
+  for (ULONG index = next - count + 1; index != next + 1; index++) {
+    const Span& slot = spans_[(index - 1) & (capacity_ - 1)];
+
+    LONG sequence = slot.sequence;
+    MemoryBarrier();
+    Span span = slot;
+    MemoryBarrier();
+
+    // being (re)written right now
+    if ((sequence != (LONG)index) || (slot.sequence != sequence)) {
+      continue;
+    }
+
+    if (!first) {
+      ref_output += ',';
+    }
+    first = false;
+
+    unsigned __int64 duration_us = span.end_us - span.start_us;
+    if (!span.async) {
+      AppendEvent(span.name, span.category, 'X', span.start_us, 
+                  &duration_us, span.thread_id, nullptr, ref_output);
+      continue;
+    }
+
+    AppendEvent(span.name, span.category, 'b', span.start_us, 
+                nullptr, span.thread_id, &span.id, ref_output);
+    ref_output += ',';
+    AppendEvent(span.name, span.category, 'e', span.end_us, 
+                nullptr, span.thread_id, &span.id, ref_output);
+  }
+
+  ref_output += "],\"displayTimeUnit\":\"ms\"}";
+}
+
+//-----------------------------------------------------------------------------
+TraceScope::TraceScope(const char* name, const char* category) :
+  name_(name),
+  category_(category),
+  start_us_(0) {
+  if (Trace::IsEnabled()) {
+    start_us_ = Clock::NowMicroseconds();
+  }
+}
+
+TraceScope::~TraceScope() {
+  if (0 != start_us_) {
+    Trace::AddSpan(name_, category_, start_us_, Clock::NowMicroseconds());
+  }
+}
\ No newline at end of file
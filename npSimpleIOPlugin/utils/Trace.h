@@ -0,0 +1,91 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef UTILS_TRACE_H_
+#define UTILS_TRACE_H_
+
+#include <string>
+#include "Platform.h"
+
+namespace utils {
+
+// Opt-in tracing of spans (queue wait, I/O, transcoding, marshalling, 
+// callbacks...) into a fixed size ring buffer, dumped as Chrome trace event
+// JSON (load it in chrome://tracing). Once the ring is full the oldest spans
+// are overwritten.
+//
+// Recording is lock free - a writer claims a slot with an interlocked 
+// increment and publishes it with a sequence number, so a dump running at
+// the same time skips (rather than waits for) slots that are being written.
+// When tracing is disabled a span costs a single flag check.
+//
+// Names are copied (up to kMaxNameLength characters) - categories must be
+// string literals (or outlive the trace) as they are stored as pointers.
+class Trace {
+public:
+  static const size_t kMaxNameLength = 31;
+
+  // |capacity| (in spans) is rounded up to a power of two - the ring is
+  // allocated by the first call and keeps its size after that
+  static bool Enable(size_t capacity);
+  static void Disable();
+
+  static bool IsEnabled() {
+    return (0 != enabled_);
+  }
+
+  // a complete span on the calling thread
+  static void AddSpan(
+    const char* name, 
+    const char* category, 
+    unsigned __int64 start_us, 
+    unsigned __int64 end_us);
+
+  // a span that isn't tied to a thread (e.g. the time a request waited in a
+  // queue) - |id| groups the spans of the same request
+  static void AddAsyncSpan(
+    const char* name, 
+    const char* category, 
+    unsigned __int64 start_us, 
+    unsigned __int64 end_us,
+    unsigned int id);
+
+  // the spans currently in the ring, oldest first, as 
+  // {"traceEvents":[...]}
+  static void Dump(std::string& ref_output);
+
+private:
+  struct Span;
+
+  static void Add(
+    const char* name, 
+    const char* category, 
+    unsigned __int64 start_us, 
+    unsigned __int64 end_us,
+    bool async,
+    unsigned int id);
+
+private:
+  static volatile LONG enabled_;
+  static volatile LONG next_;
+  static Span* spans_;
+  static size_t capacity_;
+};
+
+// Records a span from its construction to its destruction (on the calling
+// thread) - if tracing was enabled when it was constructed
+class TraceScope {
+public:
+  TraceScope(const char* name, const char* category);
+  ~TraceScope();
+
+private:
+  const char* name_;
+  const char* category_;
+  unsigned __int64 start_us_;
+};
+
+}; // namespace utils
+
+#endif // UTILS_TRACE_H_
\ No newline at end of file
@@ -3,14 +3,39 @@ Simple IO Plugin
 Copyright (c) 2015 Overwolf Ltd.
 */
 #include "TxtFileStream.h"
-#include <io.h>
+#include "BufferPool.h"
+#include "Encoders.h"
+#include "TextScan.h"
+#include "Clock.h"
+#include "Trace.h"
 #include <fcntl.h>
 #include <sys/stat.h>
 
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <errno.h>
+#include <unistd.h>
+
+// the CRT names used below
+#define _read read
+#define _close close
+#define _fstat fstat
+#define _stat stat
+
+// no SEH - C++ exceptions are the closest thing we have
+#define __try try
+#define __except(filter) catch (...)
+#endif
+
 using namespace utils;
 
-// leverage sequential blocks
-const unsigned int kBufferSize = 1024 * 1024 * 2;
+// the read buffer starts small and follows the append rate - a read that 
+// fills it doubles it (up to BufferPool::kMaxBufferSize, to leverage 
+// sequential blocks), and every |kShrinkAfterIdleReads| idle polls it's 
+// halved if no read since needed more than a quarter of it
+const size_t kInitialBufferSize = utils::BufferPool::kMinBufferSize;
+const unsigned int kShrinkAfterIdleReads = 50;
 const unsigned int kWaitTimeout = 100;
 const char kErrorFileNotAccessible[] = "file no longer accessible";
 const char kErrorFileReadRetError[] = "file read returned error";
@@ -22,7 +47,7 @@ const char kInfoListenThreadExit[] = "listener thread exited";
 namespace utils {
 
 unsigned int safe_read(int desc, void *ptr, size_t len) {
-  unsigned int n_chars;
+  int n_chars;
 
   if (len <= 0)
     return len;
@@ -37,13 +62,27 @@ unsigned int safe_read(int desc, void *ptr, size_t len) {
   return n_chars;
 }
 
+int open_file(const wchar_t* filename) {
+#ifdef _WIN32
+  return _wopen(filename, O_RDONLY);
+#else
+  return open(Encoders::utf8_encode(filename).c_str(), O_RDONLY);
+#endif
+}
+
 }; // utils
 
 TxtFileStream::TxtFileStream() :
   file_handle_(-1),
-  delegate_(nullptr),
   skip_to_end_(false),
-  listening_(false) {
+  delegate_(nullptr),
+  encoding_(ENCODING_AUTO),
+  record_mode_(false),
+  record_idle_timeout_(0),
+  last_record_line_time_(0),
+  listening_(false),
+  skip_requested_(0),
+  unread_bytes_(0) {
 }
 
 TxtFileStream::~TxtFileStream() {
@@ -79,20 +118,58 @@ bool TxtFileStream::Initialize(
 
   accumulated_line_.clear();
 
+  InterlockedExchange(&skip_requested_, 0);
+  InterlockedExchange(&unread_bytes_, 0);
+
   {
     CriticalSectionLock lock(critical_section_);
-    file_handle_ = _wopen(filename, O_RDONLY);
+    encoding_ = ENCODING_AUTO;
+    utf16_leftover_.clear();
+    record_mode_ = false;
+    record_.clear();
+    file_handle_ = open_file(filename);
   }
 
   return (-1 != file_handle_);
 }
 
+bool TxtFileStream::SetRecordMode(
+  const char* start_pattern, 
+  unsigned int idle_timeout_ms) {
+
+  if ((nullptr == start_pattern) || (0 == *start_pattern)) {
+    return false;
+  }
+
+  CriticalSectionLock lock(critical_section_);
+
+  try {
+    record_start_.assign(start_pattern, std::regex_constants::ECMAScript);
+  } catch(...) {
+    record_mode_ = false;
+    return false;
+  }
+
+  record_mode_ = true;
+  record_idle_timeout_ = idle_timeout_ms;
+  record_.clear();
+  return true;
+}
+
+
+void TxtFileStream::SetEncoding(Encoding encoding) {
+  CriticalSectionLock lock(critical_section_);
+  encoding_ = encoding;
+}
 
 bool TxtFileStream::StartListening() {
   if (listening_) {
     return false;
   }
 
+  // needs to be done while the read pointer is still at the start
+  DetectEncoding();
+
   // skip read pointer to end
   if (skip_to_end_) {
     {
@@ -105,8 +182,14 @@ bool TxtFileStream::StartListening() {
     }
   }
 
-  int buffer_size = kBufferSize;
-  char* buffer = new char[buffer_size];
+  size_t buffer_size = 0;
+  char* buffer = BufferPool::Acquire(kInitialBufferSize, buffer_size);
+  if (nullptr == buffer) {
+    return false;
+  }
+
+  unsigned int idle_reads = 0;
+  int peak_read = 0;
 
   int len = 0; 
   long current_file_len = GetFileSize();
@@ -120,7 +203,7 @@ bool TxtFileStream::StartListening() {
       if (!ReadNext(
         len, 
         buffer, 
-        buffer_size, 
+        (int)buffer_size, 
         current_file_len)) {
         // ReadNext will always trigger an error if returns false
         was_error_triggered = true;
@@ -129,8 +212,37 @@ bool TxtFileStream::StartListening() {
 
     } // CriticalSectionLock
 
+    if (len > peak_read) {
+      peak_read = len;
+    }
+
+    size_t new_size = buffer_size;
+    if ((size_t)len == buffer_size) {
+      new_size = buffer_size * 2;
+    } else if ((0 == len) && (++idle_reads >= kShrinkAfterIdleReads)) {
+      if ((size_t)peak_read <= buffer_size / 4) {
+        new_size = buffer_size / 2;
+      }
+      idle_reads = 0;
+      peak_read = 0;
+    }
+
+    if ((new_size != buffer_size) && 
+        (new_size >= BufferPool::kMinBufferSize) &&
+        (new_size <= BufferPool::kMaxBufferSize)) {
+      size_t new_capacity = 0;
+      char* new_buffer = BufferPool::Acquire(new_size, new_capacity);
+      if (nullptr != new_buffer) {
+        BufferPool::Release(buffer, buffer_size);
+        buffer = new_buffer;
+        buffer_size = new_capacity;
+      }
+    }
 
     if (0 == len) {
+      FlushIdleRecord();
+      delegate_->OnIdle();
+
       if (reset_event_.Wait(kWaitTimeout)) {
         delegate_->OnError(
           kErrorListenThreadStopped,
@@ -142,6 +254,12 @@ bool TxtFileStream::StartListening() {
   
   } // while
 
+  // deliver whatever record we were still assembling
+  {
+    CriticalSectionLock lock(critical_section_);
+    FlushRecord();
+  }
+
   // this is so that we don't trigger multiple errors
   if (!was_error_triggered) {
     delegate_->OnError(
@@ -151,7 +269,7 @@ bool TxtFileStream::StartListening() {
 
   listening_ = false;
 
-  delete[] buffer;
+  BufferPool::Release(buffer, buffer_size);
 
   return true;
 }
@@ -171,6 +289,14 @@ bool TxtFileStream::StopListening() {
   return true;
 }
 
+void TxtFileStream::SkipToEnd() {
+  InterlockedExchange(&skip_requested_, 1);
+}
+
+long TxtFileStream::unread_bytes() const {
+  return unread_bytes_;
+}
+
 bool TxtFileStream::ReadNext(
   int &len, 
   char* buffer, 
@@ -186,7 +312,20 @@ bool TxtFileStream::ReadNext(
     }
 
 
+    if (0 != InterlockedExchange(&skip_requested_, 0)) {
+      SkipUnread(current_file_len);
+    }
+
+    // no TraceScope - objects with destructors can't be used with __try
+    unsigned __int64 read_start_us = 
+      Trace::IsEnabled() ? Clock::NowMicroseconds() : 0;
+
     len = safe_read(file_handle_, buffer, buffer_size);
+
+    if ((0 != read_start_us) && (len > 0)) {
+      Trace::AddSpan("read", "io", read_start_us, Clock::NowMicroseconds());
+    }
+
     if (len < 0) {
       delegate_->OnError(
         kErrorFileReadRetError,
@@ -205,7 +344,13 @@ bool TxtFileStream::ReadNext(
 
     current_file_len = size_change;
 
-    ParseLines(buffer, len);
+    long position = lseek(file_handle_, 0, SEEK_CUR);
+    InterlockedExchange(
+      &unread_bytes_, 
+      (position >= 0) && (size_change > position) ? 
+        (size_change - position) : 0);
+
+    ParseChunk(buffer, len);
     return true;
   } __except (EXCEPTION_EXECUTE_HANDLER) {
     delegate_->OnError(
@@ -216,52 +361,175 @@ bool TxtFileStream::ReadNext(
 }
 
 
+void TxtFileStream::DetectEncoding() {
+  CriticalSectionLock lock(critical_section_);
+
+  if (-1 == file_handle_) {
+    return;
+  }
+
+  unsigned char bom[3] = {0};
+  int bom_len = 0;
+  int read_len = safe_read(file_handle_, bom, sizeof(bom));
+
+  if ((read_len >= 2) && (0xFF == bom[0]) && (0xFE == bom[1])) {
+    if (ENCODING_AUTO == encoding_) {
+      encoding_ = ENCODING_UTF16LE;
+    }
+    bom_len = 2;
+  } else if ((read_len >= 3) && 
+             (0xEF == bom[0]) && (0xBB == bom[1]) && (0xBF == bom[2])) {
+    if (ENCODING_AUTO == encoding_) {
+      encoding_ = ENCODING_UTF8;
+    }
+    bom_len = 3;
+  }
+
+  if (ENCODING_AUTO == encoding_) {
+    encoding_ = ENCODING_UTF8;
+  }
+
+  // don't deliver the BOM as part of the first line
+  lseek(file_handle_, bom_len, SEEK_SET);
+}
+
+void TxtFileStream::ParseChunk(const char* data, int len) {
+  if (ENCODING_UTF16LE != encoding_) {
+    ParseLines(data, len);
+    return;
+  }
+
+  // a character may have been split between two reads
+  const char* input = data;
+  size_t input_len = len;
+  if (!utf16_leftover_.empty()) {
+    utf16_leftover_.append(data, len);
+    input = utf16_leftover_.c_str();
+    input_len = utf16_leftover_.size();
+  }
+
+  // transcoding before splitting is safe - UTF8 never uses the '\r' and
+  // '\n' bytes inside multi-byte sequences. The units are 2 bytes whatever
+  // the size of wchar_t.
+  size_t consumed;
+  {
+    TraceScope trace("utf16 to utf8", "transcode");
+    transcoded_.clear();
+    consumed = Encoders::utf16_append_utf8(
+      (const uint16_t*)input, 
+      input_len / sizeof(uint16_t), 
+      transcoded_);
+  }
+
+  std::string leftover(
+    input + consumed * sizeof(uint16_t), 
+    input + input_len);
+  utf16_leftover_.swap(leftover);
+
+  ParseLines(transcoded_.c_str(), (int)transcoded_.size());
+}
+
 void TxtFileStream::ParseLines(const char* lines, int len) {
   if ((nullptr == lines) || (0 == len)) {
     return;
   }
 
-  const char* start_line = lines;
-  int start_line_index = 0;
+  // includes the delivery of the lines to the delegate
+  TraceScope trace("split lines", "parse");
 
-  for (int i = 0; i < len; i++) {
-    int eol_len = 0;
+  const char* position = lines;
+  const char* end = lines + len;
 
-    if ((i + 1 < len) &&
-        (lines[i] == '\r') &&
-        (lines[i+1] == '\n')) {
-      eol_len = 2;
-    } else if (lines[i] == '\n') {
-      eol_len = 1;
+  while (position < end) {
+    const char* new_line = TextScan::FindByte(position, end, '\n');
+    if (nullptr == new_line) {
+      // the rest of the line will come with the next read
+      accumulated_line_.append(position, end);
+      return;
     }
 
-    if (eol_len > 0) {
-      accumulated_line_.append(&lines[start_line_index], &lines[i]);
-      delegate_->OnNewLine(
-        accumulated_line_.c_str(),
-        accumulated_line_.size());
-      accumulated_line_.clear();
-
-      i += (eol_len-1); // we'll add +1 in the for loop
-      if (i + 1 < len) {
-        start_line = &lines[i + 1];
-        start_line_index = i + 1;
-      } else {
-        start_line = nullptr;
-      }
+    // complete lines are emitted straight from the read buffer
+    const char* line = position;
+    size_t line_len = new_line - position;
+    if (!accumulated_line_.empty()) {
+      accumulated_line_.append(position, new_line);
+      line = accumulated_line_.c_str();
+      line_len = accumulated_line_.size();
     }
-  }
 
-  // we may end up with a new line - handle it
-  if (start_line != nullptr) {
-    if (*start_line == '\n') {
-      delegate_->OnNewLine("", 0);
-    } else if (*start_line != '\r') {
-      accumulated_line_.append(start_line, &lines[len]);
+    // lines end with "\n" or "\r\n" (the "\r" may have come with the
+    // previous read)
+    if ((line_len > 0) && ('\r' == line[line_len - 1])) {
+      line_len--;
     }
+
+    EmitLine(line, (unsigned int)line_len);
+    accumulated_line_.clear();
+
+    position = new_line + 1;
   }
 }
 
+void TxtFileStream::EmitLine(const char* line, unsigned int len) {
+  if (!record_mode_) {
+    delegate_->OnNewLine(line, len);
+    return;
+  }
+
+  // a start line closes the record we've been assembling
+  if (std::regex_search(
+        line, 
+        line + len, 
+        record_start_, 
+        std::regex_constants::match_continuous)) {
+    FlushRecord();
+  } else if (!record_.empty()) {
+    record_ += '\n';
+  }
+
+  record_.append(line, len);
+  last_record_line_time_ = GetTickCount();
+}
+
+void TxtFileStream::FlushRecord() {
+  if (!record_mode_ || record_.empty()) {
+    return;
+  }
+
+  delegate_->OnNewLine(record_.c_str(), record_.size());
+  record_.clear();
+}
+
+void TxtFileStream::FlushIdleRecord() {
+  CriticalSectionLock lock(critical_section_);
+
+  if (!record_mode_ || record_.empty()) {
+    return;
+  }
+
+  if (GetTickCount() - last_record_line_time_ >= record_idle_timeout_) {
+    FlushRecord();
+  }
+}
+
+void TxtFileStream::SkipUnread(long &current_file_len) {
+  long position = lseek(file_handle_, 0, SEEK_CUR);
+  long end = lseek(file_handle_, 0, SEEK_END);
+  if ((position < 0) || (end <= position)) {
+    return;
+  }
+
+  // whatever follows the gap isn't the rest of these
+  FlushRecord();
+  accumulated_line_.clear();
+  utf16_leftover_.clear();
+
+  current_file_len = end;
+  InterlockedExchange(&unread_bytes_, 0);
+
+  delegate_->OnSkipped(end - position);
+}
+
 long TxtFileStream::GetFileSize() {
   struct _stat file_info;
   
@@ -6,6 +6,7 @@
 #define UTILS_TXT_FILE_STREAM_H_
 
 #include <string>
+#include <regex>
 #include "CriticalSectionLock.h"
 #include "Event.h"
 
@@ -16,10 +17,23 @@ class TxtFileStreamDelegate {
 public:
   virtual void OnNewLine(const char* line, unsigned int len) = 0;
   virtual void OnError(const char* message, unsigned int len) = 0;
+
+  // the reader caught up with the file and waits for more
+  virtual void OnIdle() {}
+
+  // the reader jumped |bytes| ahead to the end of the file (see 
+  // |TxtFileStream::SkipToEnd|)
+  virtual void OnSkipped(long /*bytes*/) {}
 };
 
 class TxtFileStream {
 public:
+  enum Encoding {
+    ENCODING_AUTO = 0, // detect by BOM, UTF8 otherwise
+    ENCODING_UTF8,
+    ENCODING_UTF16LE
+  };
+
   TxtFileStream();
   virtual ~TxtFileStream();
 
@@ -29,16 +43,41 @@ public:
     TxtFileStreamDelegate* delegate,
     bool skip_to_end = false);
   
+  // Multi-line record mode: a record starts on a line matching
+  // |start_pattern| (matched at the beginning of the line) and continues
+  // until the next start line or until |idle_timeout_ms| passed without new
+  // lines. Each record is delivered as a single |OnNewLine| call with its
+  // lines joined by '\n'. Must be called after |Initialize|.
+  bool SetRecordMode(const char* start_pattern, unsigned int idle_timeout_ms);
+
+  // UTF-16LE files are transcoded to UTF8 before they are split into lines.
+  // Must be called after |Initialize| (which resets it to ENCODING_AUTO).
+  void SetEncoding(Encoding encoding);
+
   bool StartListening();
   bool StopListening();
 
+  // Any thread: before its next read the reader jumps to the end of the 
+  // file - the unread bytes, the partial line and the UTF-16 leftover are 
+  // dropped (a pending record is delivered first) and |OnSkipped| is called.
+  void SkipToEnd();
+
+  // Any thread: the bytes of the file not read yet, as of the last read
+  long unread_bytes() const;
+
 private:
   bool ReadNext(
     int &len,
     char* buffer,
     int buffer_size,
     long &current_file_len);
+  void DetectEncoding();
+  void ParseChunk(const char* data, int len);
   void ParseLines(const char* lines, int len);
+  void EmitLine(const char* line, unsigned int len);
+  void FlushRecord();
+  void FlushIdleRecord();
+  void SkipUnread(long &current_file_len);
   long GetFileSize();
 
 private:
@@ -47,8 +86,24 @@ private:
   TxtFileStreamDelegate* delegate_;
   std::string accumulated_line_;
 
+  // UTF-16 files - bytes that didn't complete a character in the last read
+  // and the transcoded chunk
+  Encoding encoding_;
+  std::string utf16_leftover_;
+  std::string transcoded_;
+
+  // multi-line records
+  bool record_mode_;
+  std::regex record_start_;
+  unsigned int record_idle_timeout_;
+  std::string record_;
+  DWORD last_record_line_time_;
+
   bool listening_;
 
+  volatile LONG skip_requested_;
+  volatile LONG unread_bytes_;
+
   CriticalSection critical_section_;
 
   Event reset_event_;
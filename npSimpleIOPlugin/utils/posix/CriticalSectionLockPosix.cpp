@@ -0,0 +1,32 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef _WIN32
+
+#include "../CriticalSectionLock.h"
+
+using namespace utils;
+
+// critical sections are re-entrant - so is this mutex
+CriticalSection::CriticalSection() {
+  pthread_mutexattr_t attributes;
+  pthread_mutexattr_init(&attributes);
+  pthread_mutexattr_settype(&attributes, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init(&mutex_, &attributes);
+  pthread_mutexattr_destroy(&attributes);
+}
+
+CriticalSection::~CriticalSection() {
+  pthread_mutex_destroy(&mutex_);
+}
+
+void CriticalSection::lock() {
+  pthread_mutex_lock(&mutex_);
+}
+
+void CriticalSection::unlock() {
+  pthread_mutex_unlock(&mutex_);
+}
+
+#endif // _WIN32
\ No newline at end of file
@@ -0,0 +1,322 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef _WIN32
+
+#include "../DirectoryWatcher.h"
+#include "../Encoders.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace utils;
+
+// enough for a few hundred events per read
+const size_t kBufferSize = 64 * 1024;
+
+const uint32_t kWatchMask =
+  IN_CREATE |
+  IN_DELETE |
+  IN_MODIFY |
+  IN_MOVED_FROM |
+  IN_MOVED_TO |
+  IN_DELETE_SELF |
+  IN_MOVE_SELF;
+
+bool DirectoryWatcher::Start(
+  const std::wstring& directory, 
+  bool recursive,
+  const std::vector<std::string>& filters,
+  unsigned int debounce_ms,
+  ChangesCallback callback) {
+
+  Stop();
+
+  has_filters_ = !filters.empty();
+  if (has_filters_ && !filters_.Compile(filters)) {
+    return false;
+  }
+
+  directory_ = Encoders::utf8_encode(directory);
+  while ((directory_.size() > 1) && ('/' == directory_[directory_.size() - 1])) {
+    directory_.erase(directory_.size() - 1);
+  }
+
+  inotify_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if ((-1 == inotify_) || (0 != pipe(stop_pipe_))) {
+    CloseWatches();
+    return false;
+  }
+
+  recursive_ = recursive;
+  debounce_ms_ = debounce_ms;
+  callback_ = callback;
+  pending_.clear();
+  rename_old_path_.clear();
+
+  if (!AddWatches(std::string(), false)) {
+    CloseWatches();
+    return false;
+  }
+
+  if (!thread_.Start() || 
+      !thread_.PostTask(std::bind(&DirectoryWatcher::WatchLoop, this))) {
+    Stop();
+    return false;
+  }
+
+  return true;
+}
+
+void DirectoryWatcher::Stop() {
+  if (-1 != stop_pipe_[1]) {
+    char stop = 0;
+    ssize_t ignored = write(stop_pipe_[1], &stop, sizeof(stop));
+    (void)ignored;
+  }
+
+  thread_.Stop();
+
+  CloseWatches();
+}
+
+void DirectoryWatcher::CloseWatches() {
+  watches_.clear();
+
+  int* descriptors[] = { &inotify_, &stop_pipe_[0], &stop_pipe_[1] };
+  for (size_t i = 0; i < sizeof(descriptors) / sizeof(descriptors[0]); i++) {
+    if (-1 != *descriptors[i]) {
+      close(*descriptors[i]);
+      *descriptors[i] = -1;
+    }
+  }
+}
+
+// inotify isn't recursive - every directory in the tree gets its own watch. 
+// Directories that show up later are added as they are created, along with
+// whatever was created inside them before the watch was in place.
+bool DirectoryWatcher::AddWatches(
+  const std::string& path, 
+  bool report_existing) {
+
+  std::string full_path = directory_;
+  if (!path.empty()) {
+    full_path += '/';
+    full_path += path;
+  }
+
+  int watch = inotify_add_watch(inotify_, full_path.c_str(), kWatchMask);
+  if (-1 == watch) {
+    return false;
+  }
+
+  // an existing watch (a directory moved within the tree) gets its new path
+  watches_[watch] = path;
+
+  if (!recursive_ && !report_existing) {
+    return true;
+  }
+
+  DIR* dir = opendir(full_path.c_str());
+  if (nullptr == dir) {
+    return true;
+  }
+
+  struct dirent* entry;
+  while (nullptr != (entry = readdir(dir))) {
+    if ((0 == strcmp(entry->d_name, ".")) || 
+        (0 == strcmp(entry->d_name, ".."))) {
+      continue;
+    }
+
+    std::string entry_path = path;
+    if (!entry_path.empty()) {
+      entry_path += '/';
+    }
+    entry_path += entry->d_name;
+
+    bool is_directory = (DT_DIR == entry->d_type);
+    if (DT_UNKNOWN == entry->d_type) {
+      struct stat entry_info;
+      std::string full_entry_path = full_path + '/' + entry->d_name;
+      is_directory = (0 == lstat(full_entry_path.c_str(), &entry_info)) && 
+                     S_ISDIR(entry_info.st_mode);
+    }
+
+    if (report_existing) {
+      AddChange(CHANGE_ADDED, entry_path);
+    }
+
+    if (is_directory && recursive_) {
+      AddWatches(entry_path, report_existing);
+    }
+  }
+
+  closedir(dir);
+  return true;
+}
+
+void DirectoryWatcher::WatchLoop() {
+  std::vector<char> buffer(kBufferSize);
+
+  struct pollfd descriptors[2];
+  descriptors[0].fd = stop_pipe_[0];
+  descriptors[0].events = POLLIN;
+  descriptors[1].fd = inotify_;
+  descriptors[1].events = POLLIN;
+
+  bool status = true;
+
+  while (status) {
+    int timeout = -1;
+    if (!pending_.empty()) {
+      DWORD elapsed = GetTickCount() - window_start_;
+      timeout = (elapsed < debounce_ms_) ? (int)(debounce_ms_ - elapsed) : 0;
+    }
+
+    descriptors[0].revents = 0;
+    descriptors[1].revents = 0;
+    int result = poll(descriptors, 2, timeout);
+
+    if (0 == result) {
+      Flush();
+      continue;
+    }
+
+    if (result < 0) {
+      if (EINTR == errno) {
+        continue;
+      }
+      status = false;
+      break;
+    }
+
+    if (0 != descriptors[0].revents) {
+      // stopped
+      return;
+    }
+
+    if (pending_.empty()) {
+      window_start_ = GetTickCount();
+    }
+
+    // drain everything that is queued - it's a non blocking descriptor
+    while (true) {
+      ssize_t bytes = read(inotify_, &buffer[0], buffer.size());
+      if (bytes <= 0) {
+        break;
+      }
+
+      if (!ParseNotifications(&buffer[0], (size_t)bytes)) {
+        // e.g. the directory itself was removed
+        status = false;
+        break;
+      }
+    }
+
+    if (!pending_.empty() && (GetTickCount() - window_start_ >= debounce_ms_)) {
+      Flush();
+    }
+  }
+
+  Flush();
+
+  if (!status) {
+    callback_(false, Changes());
+  }
+}
+
+bool DirectoryWatcher::ParseNotifications(const char* buffer, size_t length) {
+  const char* position = buffer;
+  const char* end = buffer + length;
+
+  while (position < end) {
+    const struct inotify_event* event = (const struct inotify_event*)position;
+    position += sizeof(struct inotify_event) + event->len;
+
+    if (0 != (event->mask & IN_Q_OVERFLOW)) {
+      // the event queue overflowed - whatever we have is incomplete
+      pending_.clear();
+      rename_old_path_.clear();
+      AddChange(CHANGE_OVERFLOW, std::string());
+      continue;
+    }
+
+    std::map<int, std::string>::iterator watch = watches_.find(event->wd);
+    if (watch == watches_.end()) {
+      continue;
+    }
+
+    if (0 != (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED))) {
+      if (watch->second.empty()) {
+        return false;
+      }
+
+      // sub directories are reported by their parent
+      if (0 != (event->mask & IN_IGNORED)) {
+        watches_.erase(watch);
+      }
+      continue;
+    }
+
+    std::string path = watch->second;
+    if (0 != event->len) {
+      if (!path.empty()) {
+        path += '/';
+      }
+      path += event->name;
+    }
+
+    // a file moved out of the tree never gets its IN_MOVED_TO
+    bool rename_completed = (0 != (event->mask & IN_MOVED_TO)) && 
+                            (event->cookie == rename_cookie_);
+    if (!rename_old_path_.empty() && !rename_completed) {
+      AddChange(CHANGE_REMOVED, rename_old_path_);
+      rename_old_path_.clear();
+    }
+
+    bool is_directory = (0 != (event->mask & IN_ISDIR));
+
+    if (0 != (event->mask & IN_CREATE)) {
+      AddChange(CHANGE_ADDED, path);
+      if (is_directory && recursive_) {
+        AddWatches(path, true);
+      }
+    } else if (0 != (event->mask & IN_DELETE)) {
+      AddChange(CHANGE_REMOVED, path);
+    } else if (0 != (event->mask & IN_MODIFY)) {
+      AddChange(CHANGE_MODIFIED, path);
+    } else if (0 != (event->mask & IN_MOVED_FROM)) {
+      rename_old_path_ = path;
+      rename_cookie_ = event->cookie;
+    } else if (0 != (event->mask & IN_MOVED_TO)) {
+      if (rename_completed) {
+        AddRename(rename_old_path_, path);
+        rename_old_path_.clear();
+      } else {
+        AddChange(CHANGE_ADDED, path);
+      }
+
+      if (is_directory && recursive_) {
+        AddWatches(path, !rename_completed);
+      }
+    }
+  }
+
+  // the pair of a rename is always queued together
+  if (!rename_old_path_.empty()) {
+    AddChange(CHANGE_REMOVED, rename_old_path_);
+    rename_old_path_.clear();
+  }
+
+  return true;
+}
+
+#endif // _WIN32
\ No newline at end of file
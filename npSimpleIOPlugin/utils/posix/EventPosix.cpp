@@ -0,0 +1,148 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef _WIN32
+
+#include "../Event.h"
+
+#include <errno.h>
+#include <time.h>
+
+using namespace utils;
+
+//-----------------------------------------------------------------------------
+Event::Event() : 
+  created_(false),
+  manual_reset_(false),
+  signaled_(false),
+  generation_(0) {
+  pthread_condattr_t attributes;
+  pthread_condattr_init(&attributes);
+  pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+  pthread_cond_init(&condition_, &attributes);
+  pthread_condattr_destroy(&attributes);
+
+  pthread_mutex_init(&mutex_, nullptr);
+}
+
+//-----------------------------------------------------------------------------
+Event::~Event() {
+  Destroy();
+  pthread_cond_destroy(&condition_);
+  pthread_mutex_destroy(&mutex_);
+}
+
+//-----------------------------------------------------------------------------
+bool Event::Create(bool manual_reset,
+  bool initial_state,
+  const char* name /*= nullptr*/,
+  bool /*secured = true*/) {
+  // named (cross process) events aren't supported here
+  if (nullptr != name) {
+    return false;
+  }
+
+  pthread_mutex_lock(&mutex_);
+  bool ret = !created_;
+  if (ret) {
+    created_ = true;
+    manual_reset_ = manual_reset;
+    signaled_ = initial_state;
+  }
+  pthread_mutex_unlock(&mutex_);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+bool Event::Open(const char* /*name*/) {
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+void Event::Destroy() {
+  pthread_mutex_lock(&mutex_);
+  if (created_) {
+    created_ = false;
+    signaled_ = false;
+    generation_++;
+    pthread_cond_broadcast(&condition_);
+  }
+  pthread_mutex_unlock(&mutex_);
+}
+
+//-----------------------------------------------------------------------------
+bool Event::IsCreated() {
+  pthread_mutex_lock(&mutex_);
+  bool ret = created_;
+  pthread_mutex_unlock(&mutex_);
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+bool Event::Wait(DWORD timeout_in_milliseconds) {
+  struct timespec deadline;
+  if (INFINITE != timeout_in_milliseconds) {
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeout_in_milliseconds / 1000;
+    deadline.tv_nsec += (timeout_in_milliseconds % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+      deadline.tv_sec++;
+      deadline.tv_nsec -= 1000000000L;
+    }
+  }
+
+  pthread_mutex_lock(&mutex_);
+
+  bool ret = false;
+  unsigned int generation = generation_;
+  while (created_ && (generation == generation_)) {
+    if (signaled_) {
+      if (!manual_reset_) {
+        signaled_ = false;
+      }
+      ret = true;
+      break;
+    }
+
+    if (INFINITE == timeout_in_milliseconds) {
+      pthread_cond_wait(&condition_, &mutex_);
+    } else if (ETIMEDOUT == 
+               pthread_cond_timedwait(&condition_, &mutex_, &deadline)) {
+      break;
+    }
+  }
+
+  pthread_mutex_unlock(&mutex_);
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+bool Event::Signal() {
+  pthread_mutex_lock(&mutex_);
+  bool ret = created_;
+  if (ret) {
+    signaled_ = true;
+    if (manual_reset_) {
+      pthread_cond_broadcast(&condition_);
+    } else {
+      pthread_cond_signal(&condition_);
+    }
+  }
+  pthread_mutex_unlock(&mutex_);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+bool Event::Reset() {
+  pthread_mutex_lock(&mutex_);
+  bool ret = created_;
+  signaled_ = false;
+  pthread_mutex_unlock(&mutex_);
+
+  return ret;
+}
+
+#endif // _WIN32
\ No newline at end of file
@@ -0,0 +1,477 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef _WIN32
+
+#include "../File.h"
+#include "../Encoders.h"
+#include "../Glob.h"
+#include "../Trace.h"
+
+#include <algorithm>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace utils;
+
+namespace {
+
+const __int64 kFileTimeToUnixEpoch = 116444736000000000LL;
+
+// reads until |len| bytes were read or the end of the file
+bool ReadAll(int file, char* buffer, size_t len, size_t& ref_read) {
+  ref_read = 0;
+  while (ref_read < len) {
+    ssize_t result = read(file, buffer + ref_read, len - ref_read);
+    if (result < 0) {
+      if (EINTR == errno) {
+        continue;
+      }
+      return false;
+    }
+
+    if (0 == result) {
+      break;
+    }
+
+    ref_read += (size_t)result;
+  }
+
+  return true;
+}
+
+// |ReadAll| in chunks of |File::kReadChunkSize| - false once |cancel| is set
+bool ReadChunks(
+  int file, 
+  char* buffer, 
+  size_t len, 
+  size_t& ref_read, 
+  const CancellationToken* cancel) {
+
+  ref_read = 0;
+  while (ref_read < len) {
+    if (CancellationToken::IsCancelled(cancel)) {
+      return false;
+    }
+
+    size_t chunk_len = len - ref_read;
+    if (chunk_len > File::kReadChunkSize) {
+      chunk_len = File::kReadChunkSize;
+    }
+
+    size_t chunk_read = 0;
+    if (!ReadAll(file, buffer + ref_read, chunk_len, chunk_read)) {
+      return false;
+    }
+
+    ref_read += chunk_read;
+    if (chunk_read < chunk_len) {
+      break;
+    }
+  }
+
+  return true;
+}
+
+// FILETIME (100ns since 1601) - what |DirectoryEntry| holds everywhere
+__int64 ToFileTime(const struct timespec& time) {
+  return kFileTimeToUnixEpoch + 
+         (__int64)time.tv_sec * 10000000 + 
+         time.tv_nsec / 100;
+}
+
+std::wstring GetHomeFolder(const char* sub_folder) {
+  const char* home = getenv("HOME");
+  if ((nullptr == home) || ('\0' == *home)) {
+    return L"";
+  }
+
+  return Encoders::utf8_decode(std::string(home) + sub_folder);
+}
+
+}; // namespace
+
+// static
+std::wstring File::GetSpecialFolderWide(int csidl) {
+  // the XDG defaults
+  switch (csidl) {
+  case CSIDL_DESKTOP:
+    return GetHomeFolder("/Desktop");
+  case CSIDL_MYDOCUMENTS:
+    return GetHomeFolder("/Documents");
+  case CSIDL_MYMUSIC:
+    return GetHomeFolder("/Music");
+  case CSIDL_MYVIDEO:
+    return GetHomeFolder("/Videos");
+  case CSIDL_MYPICTURES:
+    return GetHomeFolder("/Pictures");
+  case CSIDL_FONTS:
+    return GetHomeFolder("/.local/share/fonts");
+  case CSIDL_LOCAL_APPDATA: {
+    const char* data_home = getenv("XDG_DATA_HOME");
+    if ((nullptr != data_home) && ('/' == *data_home)) {
+      return Encoders::utf8_decode(data_home);
+    }
+    return GetHomeFolder("/.local/share");
+  }
+  default:
+    return L"";
+  }
+}
+
+// static 
+bool File::DoesFileExist(const std::wstring& filename) {
+  struct stat file_info;
+  return (0 == stat(Encoders::utf8_encode(filename).c_str(), &file_info));
+}
+
+// static 
+bool File::IsDirectory(const std::wstring& directory) {
+  struct stat file_info;
+  if (0 != stat(Encoders::utf8_encode(directory).c_str(), &file_info)) {
+    return false;
+  }
+
+  return S_ISDIR(file_info.st_mode);
+}
+
+// static
+bool File::GetTextFile(
+  const std::wstring& filename,
+  std::string& ref_output,
+  int limit,
+  const CancellationToken* cancel) {
+
+  ref_output.clear();
+
+  // no temp copy - reading doesn't lock the file for its writer here
+  int file = open(Encoders::utf8_encode(filename).c_str(), O_RDONLY);
+  if (-1 == file) {
+    return false;
+  }
+
+  bool status = false;
+  struct stat file_info;
+  if ((0 == fstat(file, &file_info)) && (file_info.st_size > 0)) {
+    size_t size = (size_t)file_info.st_size;
+    if ((limit > 0) && ((size_t)limit < size)) {
+      size = limit;
+    }
+
+    size_t read_len = 0;
+    ref_output.resize(size);
+    status = ReadChunks(file, &ref_output[0], size, read_len, cancel);
+    ref_output.resize(status ? read_len : 0);
+  }
+
+  if (!status) {
+    std::string().swap(ref_output);
+  }
+
+  close(file);
+  return status;
+}
+
+// static
+bool File::GetTextFileUtf8(
+  const std::wstring& filename,
+  std::string& ref_output,
+  bool default_utf16,
+  const CancellationToken* cancel) {
+
+  // UTF-16 files are read in chunks of this size and transcoded on the fly
+  const size_t kChunkSize = 64 * 1024;
+
+  ref_output.clear();
+
+  int file = open(Encoders::utf8_encode(filename).c_str(), O_RDONLY);
+  if (-1 == file) {
+    return false;
+  }
+
+  struct stat file_info;
+  if (0 != fstat(file, &file_info)) {
+    close(file);
+    return false;
+  }
+
+  // detect the encoding
+  unsigned char bom[3] = {0};
+  size_t bom_read = 0;
+  size_t bom_len = 0;
+  bool utf16 = default_utf16;
+
+  bool status = ReadAll(file, (char*)bom, sizeof(bom), bom_read);
+  if (status) {
+    if ((bom_read >= 2) && (0xFF == bom[0]) && (0xFE == bom[1])) {
+      utf16 = true;
+      bom_len = 2;
+    } else if ((bom_read >= 3) && 
+               (0xEF == bom[0]) && (0xBB == bom[1]) && (0xBF == bom[2])) {
+      utf16 = false;
+      bom_len = 3;
+    }
+
+    status = (lseek(file, bom_len, SEEK_SET) == (off_t)bom_len);
+  }
+
+  size_t content_size = (file_info.st_size > (off_t)bom_len) ?
+    (size_t)file_info.st_size - bom_len : 
+    0;
+
+  if (status && !utf16) {
+    // read straight into the output
+    TraceScope trace("read", "io");
+    size_t read_len = 0;
+    ref_output.resize(content_size);
+    if (content_size > 0) {
+      status = ReadChunks(
+        file, &ref_output[0], content_size, read_len, cancel);
+    }
+    ref_output.resize(status ? read_len : 0);
+  } else if (status) {
+    // +2 for the leftover of the previous chunk (a high surrogate and an
+    // odd byte at most)
+    const size_t kChunkUnits = kChunkSize / sizeof(uint16_t) + 2;
+
+    // read straight into UTF-16 units (little endian, like the file) - 
+    // wchar_t is 4 bytes wide here. Mostly ASCII - one output byte per 
+    // character, and the room |utf16_append_utf8| needs for the last chunk
+    TraceScope trace("read utf16", "transcode");
+    ref_output.reserve(content_size / sizeof(uint16_t) + 3 * kChunkUnits);
+
+    uint16_t chunk_units[kChunkUnits];
+    char* chunk = (char*)chunk_units;
+    size_t leftover = 0;
+    size_t remaining = content_size; // the owner may still be appending
+
+    while (status && (remaining > 0)) {
+      if (CancellationToken::IsCancelled(cancel)) {
+        status = false;
+        break;
+      }
+
+      size_t read_len = 0;
+      status = ReadAll(
+        file, 
+        chunk + leftover, 
+        std::min(remaining, kChunkSize), 
+        read_len);
+      if (!status || (0 == read_len)) {
+        break;
+      }
+      remaining -= read_len;
+
+      size_t available = leftover + read_len;
+      size_t consumed = Encoders::utf16_append_utf8(
+        chunk_units, 
+        available / sizeof(uint16_t), 
+        ref_output);
+
+      // a split surrogate pair and/or an odd byte
+      leftover = available - consumed * sizeof(uint16_t);
+      memmove(chunk, chunk + (available - leftover), leftover);
+    }
+
+    // a dangling high surrogate at the end of the file
+    if (status && (leftover >= sizeof(uint16_t))) {
+      Encoders::utf16_append_utf8(chunk_units, 1, ref_output, true);
+    }
+  }
+
+  if (!status) {
+    std::string().swap(ref_output);
+  }
+
+  close(file);
+  return status;
+}
+
+//static 
+bool File::GetFileTimes(
+  const std::wstring& filename, 
+  __int64& ref_creation_time,
+  __int64& ref_last_access_time,
+  __int64& ref_last_write_time) {
+
+  struct stat file_info;
+  if (0 != stat(Encoders::utf8_encode(filename).c_str(), &file_info)) {
+    return false;
+  }
+
+  // there is no creation time - the status change time is the closest
+  ref_creation_time = ToFileTime(file_info.st_ctim);
+  ref_last_access_time = ToFileTime(file_info.st_atim);
+  ref_last_write_time = ToFileTime(file_info.st_mtim);
+  return true;
+}
+
+// static
+bool File::WriteTextFile(
+  const std::wstring& filename,
+  const std::string& content) {
+  return WriteTextFile(filename, content.c_str(), content.size());
+}
+
+// static
+bool File::WriteTextFile(
+  const std::wstring& filename,
+  const char* content,
+  size_t size) {
+
+  int file = open(
+    Encoders::utf8_encode(filename).c_str(), 
+    O_WRONLY | O_CREAT | O_TRUNC, 
+    0644);
+  if (-1 == file) {
+    return false;
+  }
+
+  size_t written = 0;
+  while (written < size) {
+    ssize_t result = write(file, content + written, size - written);
+    if (result < 0) {
+      if (EINTR == errno) {
+        continue;
+      }
+      break;
+    }
+    written += (size_t)result;
+  }
+
+  close(file);
+  return (written == size);
+}
+
+// static
+bool File::CreateDirectories(const std::wstring& directory) {
+  std::string path = Encoders::utf8_encode(directory);
+  if (path.empty()) {
+    return false;
+  }
+
+  // every parent first (mkdir -p)
+  for (size_t separator = path.find('/', 1); 
+       separator != std::string::npos; 
+       separator = path.find('/', separator + 1)) {
+    std::string parent = path.substr(0, separator);
+    if ((0 != mkdir(parent.c_str(), 0755)) && (EEXIST != errno)) {
+      return false;
+    }
+  }
+
+  if ((0 != mkdir(path.c_str(), 0755)) && (EEXIST != errno)) {
+    return false;
+  }
+
+  return IsDirectory(directory);
+}
+
+// static
+bool File::RenameFile(const std::wstring& from, const std::wstring& to) {
+  return (0 == rename(
+    Encoders::utf8_encode(from).c_str(), 
+    Encoders::utf8_encode(to).c_str()));
+}
+
+// static
+bool File::ListDirectory(
+  const std::wstring& directory,
+  const std::wstring& pattern,
+  size_t page_size,
+  DirectoryPageCallback callback,
+  bool details) {
+
+  if (0 == page_size) {
+    page_size = 1;
+  }
+
+  // FindFirstFile's wildcards are case insensitive too
+  Glob glob;
+  if (!glob.Compile(pattern.empty() ? "*" : Encoders::utf8_encode(pattern))) {
+    return false;
+  }
+
+  DIR* dir = opendir(Encoders::utf8_encode(directory).c_str());
+  if (nullptr == dir) {
+    return false;
+  }
+
+  DirectoryEntries page;
+  page.reserve(page_size);
+
+  struct dirent* dir_entry;
+  while (nullptr != (dir_entry = readdir(dir))) {
+    const char* name = dir_entry->d_name;
+    if ((0 == strcmp(name, ".")) || (0 == strcmp(name, "..")) || 
+        !glob.Match(name)) {
+      continue;
+    }
+
+    // readdir tells most types - stat only for what it doesn't (links are 
+    // described by their targets) or when the size and times are needed
+    bool is_link = (DT_LNK == dir_entry->d_type);
+    bool is_directory = (DT_DIR == dir_entry->d_type);
+    bool stat_entry = details || is_link || (DT_UNKNOWN == dir_entry->d_type);
+
+    struct stat file_info;
+    if (stat_entry) {
+      // entries that vanished since they were listed are skipped
+      if (0 != fstatat(dirfd(dir), name, &file_info, AT_SYMLINK_NOFOLLOW)) {
+        continue;
+      }
+
+      is_link = S_ISLNK(file_info.st_mode);
+      if (is_link) {
+        // like a reparse point - describes the target
+        struct stat target_info;
+        if (0 == fstatat(dirfd(dir), name, &target_info, 0)) {
+          file_info = target_info;
+        }
+      }
+
+      is_directory = S_ISDIR(file_info.st_mode);
+    }
+
+    page.resize(page.size() + 1);
+    DirectoryEntry& entry = page.back();
+
+    entry.name = name;
+    entry.is_directory = is_directory;
+    entry.is_link = is_link;
+    entry.size = 0;
+    entry.creation_time = 0;
+    entry.last_write_time = 0;
+
+    if (stat_entry) {
+      if (!is_directory) {
+        entry.size = (unsigned __int64)file_info.st_size;
+      }
+      // there is no creation time - the status change time is the closest
+      entry.creation_time = ToFileTime(file_info.st_ctim);
+      entry.last_write_time = ToFileTime(file_info.st_mtim);
+    }
+
+    if (page.size() >= page_size) {
+      if (!callback(page, false)) {
+        closedir(dir);
+        return true;
+      }
+      page.clear();
+    }
+  }
+
+  closedir(dir);
+
+  callback(page, true);
+  return true;
+}
+
+#endif // _WIN32
\ No newline at end of file
@@ -0,0 +1,100 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef _WIN32
+
+#include "../MappedFile.h"
+#include "../Encoders.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace utils;
+
+MappedFile::MappedFile() : 
+  file_(-1),
+  view_(nullptr),
+  view_length_(0),
+  size_(0) {
+}
+
+MappedFile::~MappedFile() {
+  Close();
+}
+
+bool MappedFile::Open(const std::wstring& filename) {
+  Close();
+
+  file_ = open(Encoders::utf8_encode(filename).c_str(), O_RDONLY);
+  if (-1 == file_) {
+    return false;
+  }
+
+  struct stat file_info;
+  if ((0 != fstat(file_, &file_info)) || !S_ISREG(file_info.st_mode)) {
+    Close();
+    return false;
+  }
+
+  size_ = (unsigned __int64)file_info.st_size;
+  return true;
+}
+
+void MappedFile::Close() {
+  if (nullptr != view_) {
+    munmap(view_, view_length_);
+    view_ = nullptr;
+    view_length_ = 0;
+  }
+
+  if (-1 != file_) {
+    close(file_);
+    file_ = -1;
+  }
+
+  size_ = 0;
+}
+
+const char* MappedFile::Map(unsigned __int64 offset, size_t length) {
+  if (nullptr != view_) {
+    munmap(view_, view_length_);
+    view_ = nullptr;
+    view_length_ = 0;
+  }
+
+  if ((-1 == file_) || (0 == length) || (offset >= size_) || 
+      (length > size_ - offset)) {
+    return nullptr;
+  }
+
+  // views have to start on a page boundary
+  static const unsigned __int64 page_size = 
+    (unsigned __int64)sysconf(_SC_PAGESIZE);
+  unsigned __int64 view_offset = offset - (offset % page_size);
+  size_t delta = (size_t)(offset - view_offset);
+
+  void* view = mmap(
+    nullptr, 
+    length + delta, 
+    PROT_READ, 
+    MAP_SHARED, 
+    file_, 
+    (off_t)view_offset);
+
+  if (MAP_FAILED == view) {
+    return nullptr;
+  }
+
+  view_ = view;
+  view_length_ = length + delta;
+  return (const char*)view_ + delta;
+}
+
+unsigned __int64 MappedFile::size() const {
+  return size_;
+}
+
+#endif // _WIN32
\ No newline at end of file
@@ -0,0 +1,126 @@
+/*
+  Simple IO Plugin
+  Copyright (c) 2015 Overwolf Ltd.
+*/
+#ifndef _WIN32
+
+#include "../Thread.h"
+
+using namespace utils;
+
+Thread::Thread() : 
+  running_(false),
+  stopping_(false) {
+  pthread_mutex_init(&wait_mutex_, nullptr);
+  pthread_cond_init(&wait_condition_, nullptr);
+}
+
+Thread::~Thread() {
+  pthread_cond_destroy(&wait_condition_);
+  pthread_mutex_destroy(&wait_mutex_);
+}
+
+bool Thread::Start() {
+  if (running_) {
+    return false;
+  }
+
+  ClearQueue();
+
+  stopping_ = false;
+
+  running_ = (0 == pthread_create(&thread_, nullptr, ThreadProc, this));
+  return running_;
+}
+
+bool Thread::Stop() {
+  if (!running_) {
+    return true;
+  }
+
+  // make sure we don't process more messages
+  {
+    CriticalSectionLock lock(queue_critical_section_);
+    stopping_ = true;
+  }
+
+  pthread_mutex_lock(&wait_mutex_);
+  pthread_cond_broadcast(&wait_condition_);
+  pthread_mutex_unlock(&wait_mutex_);
+
+  running_ = false;
+
+  // stopped from one of our own tasks - the thread exits once it returns
+  if (pthread_equal(pthread_self(), thread_)) {
+    pthread_detach(thread_);
+    return false;
+  }
+
+  return (0 == pthread_join(thread_, nullptr));
+}
+
+bool Thread::PostTask(Task task_func) {
+  {
+    CriticalSectionLock lock(queue_critical_section_);
+
+    if (!running_) {
+      return false;
+    }
+
+    if (stopping_) {
+      return false;
+    }
+
+    task_queue_.push(task_func);
+  }
+
+  pthread_mutex_lock(&wait_mutex_);
+  pthread_cond_signal(&wait_condition_);
+  pthread_mutex_unlock(&wait_mutex_);
+
+  return true;
+}
+
+void* Thread::ThreadProc(void* param) {
+  Thread* p_thread_queue = (Thread*)param;
+
+  bool continue_running = true;
+
+  while (continue_running) {
+    Task task;
+
+    pthread_mutex_lock(&p_thread_queue->wait_mutex_);
+    while (true) {
+      {
+        CriticalSectionLock lock(p_thread_queue->queue_critical_section_);
+
+        if (p_thread_queue->stopping_) {
+          continue_running = false;
+          break;
+        }
+
+        if (!p_thread_queue->task_queue_.empty()) {
+          task = p_thread_queue->task_queue_.front();
+          p_thread_queue->task_queue_.pop();
+          break;
+        }
+      }
+
+      pthread_cond_wait(
+        &p_thread_queue->wait_condition_, 
+        &p_thread_queue->wait_mutex_);
+    }
+    pthread_mutex_unlock(&p_thread_queue->wait_mutex_);
+
+    if (task) {
+      task();
+    }
+  }
+
+  // cleanup
+  p_thread_queue->ClearQueue();
+
+  return nullptr;
+}
+
+#endif // _WIN32
\ No newline at end of file